@@ -45,7 +45,10 @@ enum World_Solver_Type{
   ODE_DEFAULT,
   DART_PGS,
   BULLET_PGS,
-  BULLET_LEMKE
+  BULLET_LEMKE,
+  /// Graph colored PGS, used by quickstep only. The world step solves
+  /// the LCP with ODE_DEFAULT instead.
+  ODE_COLORED_PGS
 };
 
 /**
@@ -109,7 +112,15 @@ ODE_API int dWorldGetIslandThreads (dWorldID);
 ODE_API void dWorldSetIslandThreads (dWorldID, int num_island_threads);
 
 /**
- * @brief Set the number of thread pool threads for quickstep
+ * @brief Get the number of thread pool threads for quickstep
+ *
+ * @ingroup world
+ */
+ODE_API int dWorldGetQuickStepThreads (dWorldID);
+
+/**
+ * @brief Set the number of thread pool threads for quickstep.
+ * They are used by the ODE_COLORED_PGS solver.
  *
  * @ingroup world
  */
@@ -561,6 +572,15 @@ ODE_API dReal *dWorldGetQuickStepRMSConstraintResidual (dWorldID);
  */
 ODE_API int dWorldGetQuickStepNumContacts (dWorldID);
 
+/**
+ * @brief Get the largest number of threads that solved the rows of one
+ * color together in the last ODE_COLORED_PGS quickstep, the stepping
+ * thread included.
+ * @ingroup world
+ * @returns the number of threads, 0 if ODE_COLORED_PGS never ran.
+ */
+ODE_API int dWorldGetQuickStepColoredPGSThreads (dWorldID);
+
 /* PGS experimental parameters */
 
 /**
@@ -687,7 +707,11 @@ ODE_API void dWorldSetQuickStepExtraFrictionIterations (dWorldID, int iters);
 ODE_API void dWorldSetQuickStepFrictionModel(dWorldID, Friction_Model fricmodel);
 
 /**
- * @brief Set the LCP Solver from: ODE_DEFAULT, DART_PGS, BULLET_PGS
+ * @brief Set the LCP Solver from: ODE_DEFAULT, DART_PGS, BULLET_PGS,
+ * BULLET_LEMKE and ODE_COLORED_PGS. ODE_COLORED_PGS makes quickstep
+ * color the constraint rows so that rows sharing a body are never solved
+ * concurrently by the quickstep threads, which makes the result
+ * independent of the number of threads.
  * @ingroup world
  * @param enum for LCP Solver
  */
@@ -2131,6 +2155,26 @@ ODE_API void dJointSetFeedback (dJointID, dJointFeedback *);
  */
 ODE_API dJointFeedback *dJointGetFeedback (dJointID);
 
+/**
+ * @brief Gets the constraint impulses computed for the joint by the last
+ * quickstep, which are used to warm start the next quickstep.
+ * @ingroup joints
+ * @param lambda array of 6 values, one per constraint row.
+ * @param lambda_erp array of 6 values, one per constraint row.
+ */
+ODE_API void dJointGetLambda (dJointID, dReal *lambda, dReal *lambda_erp);
+
+/**
+ * @brief Sets the constraint impulses used to warm start the next
+ * quickstep. Contact joints are created every step, this lets the impulses
+ * of a contact carry over to the contact that replaces it.
+ * @ingroup joints
+ * @param lambda array of 6 values, one per constraint row.
+ * @param lambda_erp array of 6 values, one per constraint row.
+ */
+ODE_API void dJointSetLambda (dJointID, const dReal *lambda,
+                              const dReal *lambda_erp);
+
 /**
  * @brief Set the joint anchor point.
  * @ingroup joints
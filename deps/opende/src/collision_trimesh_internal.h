@@ -177,12 +177,45 @@ struct TrimeshCollidersCache
 #endif // dTRIMESH_OPCODE
 };
 
+// The caches of threads without ODE thread data are registered, so that
+// opcode_collider_cleanup() empties every one of them, not only the cache
+// of the calling thread.
+void RegisterTrimeshCollidersCache(TrimeshCollidersCache *pccCacheInstance);
+void UnregisterTrimeshCollidersCache(TrimeshCollidersCache *pccCacheInstance);
+
+struct ThreadTrimeshCollidersCache
+{
+	ThreadTrimeshCollidersCache()
+	{
+		RegisterTrimeshCollidersCache(&m_ccCache);
+	}
+
+	~ThreadTrimeshCollidersCache()
+	{
+		UnregisterTrimeshCollidersCache(&m_ccCache);
+	}
+
+	TrimeshCollidersCache m_ccCache;
+};
+
+inline TrimeshCollidersCache *GetThreadTrimeshCollidersCache()
+{
+	// One instance per thread, so that trimeshes can be collided from
+	// several threads at once.
+	static thread_local ThreadTrimeshCollidersCache s_ccTrimeshCollidersCache;
+
+	return &s_ccTrimeshCollidersCache.m_ccCache;
+}
+
 #if dTLS_ENABLED
 
 inline TrimeshCollidersCache *GetTrimeshCollidersCache(unsigned uiTLSKind)
 {
 	EODETLSKIND tkTLSKind = (EODETLSKIND)uiTLSKind;
-	return GZCOdeTls::GetTrimeshCollidersCache(tkTLSKind);
+	TrimeshCollidersCache *pccColliderCache = GZCOdeTls::GetTrimeshCollidersCache(tkTLSKind);
+
+	// Worker threads of a parallel narrow phase don't allocate ODE data
+	return pccColliderCache ? pccColliderCache : GetThreadTrimeshCollidersCache();
 }
 
 
@@ -190,9 +223,7 @@ inline TrimeshCollidersCache *GetTrimeshCollidersCache(unsigned uiTLSKind)
 
 inline TrimeshCollidersCache *GetTrimeshCollidersCache(unsigned uiTLSKind)
 {
-	extern TrimeshCollidersCache g_ccTrimeshCollidersCache;
-
-	return &g_ccTrimeshCollidersCache;
+	return GetThreadTrimeshCollidersCache();
 }
 
 
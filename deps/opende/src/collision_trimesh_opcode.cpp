@@ -30,6 +30,9 @@
 #include "collision_util.h"
 #include "collision_trimesh_internal.h"
 
+#include <mutex>
+#include <set>
+
 #if dTRIMESH_ENABLED
 #if dTRIMESH_OPCODE
 
@@ -555,21 +558,48 @@ dxTriMesh::~dxTriMesh(){
     //
 }
 
+// Caches of the threads without ODE thread data
+static std::mutex &TrimeshCollidersCachesMutex()
+{
+	static std::mutex s_mtxCaches;
+	return s_mtxCaches;
+}
+
+static std::set<TrimeshCollidersCache *> &TrimeshCollidersCaches()
+{
+	static std::set<TrimeshCollidersCache *> s_spccCaches;
+	return s_spccCaches;
+}
+
+void RegisterTrimeshCollidersCache(TrimeshCollidersCache *pccCacheInstance)
+{
+	std::lock_guard<std::mutex> lock(TrimeshCollidersCachesMutex());
+	TrimeshCollidersCaches().insert(pccCacheInstance);
+}
+
+void UnregisterTrimeshCollidersCache(TrimeshCollidersCache *pccCacheInstance)
+{
+	std::lock_guard<std::mutex> lock(TrimeshCollidersCachesMutex());
+	TrimeshCollidersCaches().erase(pccCacheInstance);
+}
+
 // Cleanup for allocations when shutting down ODE
 /*extern */void opcode_collider_cleanup()
 {
-#if !dTLS_ENABLED
 #if dTRIMESH_ENABLED
 
-	// Clear TC caches
-	TrimeshCollidersCache *pccColliderCache = GetTrimeshCollidersCache(0);
-	pccColliderCache->Faces.Empty();
-	pccColliderCache->defaultSphereCache.TouchedPrimitives.Empty();
-	pccColliderCache->defaultBoxCache.TouchedPrimitives.Empty();
-	pccColliderCache->defaultCapsuleCache.TouchedPrimitives.Empty();
+	// Clear TC caches of every thread, the caches in ODE thread data are
+	// freed with it. No collision runs while ODE shuts down.
+	std::lock_guard<std::mutex> lock(TrimeshCollidersCachesMutex());
+	for (TrimeshCollidersCache *pccColliderCache : TrimeshCollidersCaches())
+	{
+		pccColliderCache->Faces.Empty();
+		pccColliderCache->defaultSphereCache.TouchedPrimitives.Empty();
+		pccColliderCache->defaultBoxCache.TouchedPrimitives.Empty();
+		pccColliderCache->defaultCapsuleCache.TouchedPrimitives.Empty();
+	}
 
 #endif // dTRIMESH_ENABLED
-#endif // dTLS_ENABLED
 }
 
 
@@ -116,6 +116,9 @@ struct dxQuickStepParameters {
   // rms_constraint_residual[3]: total (sum of previous 3)
   dReal rms_constraint_residual[4];     // all constraint errors
   int num_contacts;           // for monitoring number of contacts
+  // largest number of threads that solved rows of one color together in
+  // the last ODE_COLORED_PGS step, the calling thread included.
+  int num_colored_threads;
   bool dynamic_inertia_reduction;  // turn on/off quickstep inertia reduction.
   dReal smooth_contacts;  // control quickstep smoothing for contact solution.
   dReal contact_sor_scale;  // sor scaling factor for contacts only
@@ -185,6 +188,16 @@ struct dxBody : public dObject {
 };
 
 
+// an island as scheduled by dxProcessIslands when island threads are used
+struct dxIslandTask {
+  int island;           // index of the island, and of its working memory
+  int bodyoffset;       // offset of the first body in the island body list
+  int jointoffset;      // offset of the first joint in the island joint list
+  int bcount, jcount;   // number of bodies and joints
+  size_t cost;          // estimated cost, constraint rows times iterations
+};
+
+
 struct dxWorld : public dBase {
   dxBody *firstbody;    // body linked list
   dxJoint *firstjoint;    // joint linked list
@@ -204,6 +217,8 @@ struct dxWorld : public dBase {
   dReal max_angular_speed;      // limit the angular velocity to this magnitude
   boost::threadpool::pool *threadpool;
   boost::threadpool::pool *row_threadpool;
+  std::vector<dxIslandTask> island_tasks; // islands sorted by decreasing cost
+  std::vector<int> island_chunks; // first task of each chunk, plus the end
 };
 
 
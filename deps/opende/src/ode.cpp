@@ -1543,6 +1543,27 @@ dJointFeedback *dJointGetFeedback (dxJoint *joint)
 }
 
 
+void dJointGetLambda (dxJoint *joint, dReal *lambda, dReal *lambda_erp)
+{
+  dAASSERT (joint && lambda && lambda_erp);
+  for (int i = 0; i < 6; i++) {
+    lambda[i] = joint->lambda[i];
+    lambda_erp[i] = joint->lambda_erp[i];
+  }
+}
+
+
+void dJointSetLambda (dxJoint *joint, const dReal *lambda,
+                      const dReal *lambda_erp)
+{
+  dAASSERT (joint && lambda && lambda_erp);
+  for (int i = 0; i < 6; i++) {
+    joint->lambda[i] = lambda[i];
+    joint->lambda_erp[i] = lambda_erp[i];
+  }
+}
+
+
 
 dJointID dConnectingJoint (dBodyID in_b1, dBodyID in_b2)
 {
@@ -1662,6 +1683,7 @@ dxWorld * dWorldCreate()
   w->qs.rms_constraint_residual[2] = 0;
   w->qs.rms_constraint_residual[3] = 0;
   w->qs.num_contacts = 0;
+  w->qs.num_colored_threads = 0;
   w->qs.dynamic_inertia_reduction = true;
   w->qs.smooth_contacts = 0.01;
   w->qs.contact_sor_scale = 0.25;
@@ -1792,6 +1814,16 @@ void dWorldSetIslandThreads (dWorldID w, int num_island_threads)
   }
 }
 
+int dWorldGetQuickStepThreads (dWorldID w)
+{
+  dAASSERT (w);
+  if (!w->row_threadpool) {
+    return 0;
+  }
+  // else
+  return w->row_threadpool->size();
+}
+
 void dWorldSetQuickStepThreads (dWorldID w, int num_quickstep_threads)
 {
   dAASSERT (w);
@@ -1802,7 +1834,6 @@ void dWorldSetQuickStepThreads (dWorldID w, int num_quickstep_threads)
   }
   if (num_quickstep_threads > 0) {
     w->row_threadpool = new boost::threadpool::pool(num_quickstep_threads);
-    printf("setting quickstep pool threads to %d\n",num_quickstep_threads);
   }
 }
 
@@ -2282,6 +2313,12 @@ int dWorldGetQuickStepNumContacts (dWorldID w)
   return w->qs.num_contacts;
 }
 
+int dWorldGetQuickStepColoredPGSThreads (dWorldID w)
+{
+  dAASSERT(w);
+  return w->qs.num_colored_threads;
+}
+
 /* experimental PGS */
 bool dWorldGetQuickStepInertiaRatioReduction (dWorldID w)
 {
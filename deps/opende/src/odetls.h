@@ -95,7 +95,9 @@ public:
 
 	static TrimeshCollidersCache *GetTrimeshCollidersCache(EODETLSKIND tkTLSKind)
 	{ 
-		return (TrimeshCollidersCache *)CThreadLocalStorage::UnsafeGetStorageValue(m_ahtkStorageKeys[tkTLSKind], OTI_TRIMESH_TRIMESH_COLLIDER_CACHE);
+		// Must be a safe call, threads that didn't allocate ODE data collide
+		// with a cache of their own
+		return (TrimeshCollidersCache *)CThreadLocalStorage::gzGetStorageValue(m_ahtkStorageKeys[tkTLSKind], OTI_TRIMESH_TRIMESH_COLLIDER_CACHE);
 	}
 
 public:
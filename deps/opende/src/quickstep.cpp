@@ -512,10 +512,8 @@ void dxQuickStepper (dxWorldProcessContext *context,
                caccel,caccel_erp,cforce,
                rhs,rhs_erp,rhs_precon,
                lo,hi,cfm,findex,
-               &world->qs
-#ifdef USE_TPROW
-               , world->row_threadpool
-#endif
+               &world->qs,
+               world->row_threadpool
       );
 
     } END_STATE_SAVE(context, lcpstate);
@@ -524,8 +522,8 @@ void dxQuickStepper (dxWorldProcessContext *context,
     {
       // warm starting
       // save lambda for the next iteration
-      //@@@ note that this doesn't work for contact joints yet, as they are
-      // recreated every iteration
+      // contact joints are recreated every iteration, the caller can carry
+      // their lambda over with dJointGetLambda and dJointSetLambda
       const dReal *lambdacurr = lambda;
       const dReal *lambda_erpcurr = lambda_erp;
       const dJointWithInfo1 *jicurr = jointiinfos;
@@ -57,7 +57,7 @@ void quickstep::CG_LCP (dxWorldProcessContext *context,
 
   // precompute iMJ = inv(M)*J'
   dReal *iMJ = context->AllocateArray<dReal> (m*12);
-  compute_invM_JT (m,J,iMJ,jb,body,invMOI);
+  compute_invM_JT (m,nb,J,iMJ,jb,body,invMOI);
 
   dReal last_rho = 0;
   dReal *r = context->AllocateArray<dReal> (m);
@@ -0,0 +1,446 @@
+/*************************************************************************
+*                                                                       *
+* Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+* All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+*                                                                       *
+* This library is free software; you can redistribute it and/or         *
+* modify it under the terms of EITHER:                                  *
+*   (1) The GNU Lesser General Public License as published by the Free  *
+*       Software Foundation; either version 2.1 of the License, or (at  *
+*       your option) any later version. The text of the GNU Lesser      *
+*       General Public License is included with this library in the     *
+*       file LICENSE.TXT.                                               *
+*   (2) The BSD-style license that is included with this library in     *
+*       the file LICENSE-BSD.TXT.                                       *
+*                                                                       *
+* This library is distributed in the hope that it will be useful,       *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+* LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+*                                                                       *
+*************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <gazebo/ode/common.h>
+#include <gazebo/ode/odemath.h>
+#include <gazebo/ode/timer.h>
+#include <gazebo/ode/error.h>
+#include <gazebo/ode/matrix.h>
+#include <gazebo/ode/misc.h>
+#include "config.h"
+#include "objects.h"
+#include "joints/joint.h"
+#include "util.h"
+#include <boost/bind.hpp>
+#include <ignition/common/Profiler.hh>
+
+#include "quickstep_util.h"
+#include "quickstep_colored_pgs_lcp.h"
+
+using namespace ode;
+
+// the blocks of a color are handed out in chunks, so that a thread that
+// is slow to start doesn't hold up the barrier at the end of the color.
+static const int CHUNKS_PER_THREAD = 4;
+
+// number of residual sums kept per block: rms_dlambda[0..2] followed by
+// rms_error[0..2], indexed by constraint type as in ComputeRows.
+static const int SUMS_PER_BLOCK = 6;
+
+namespace {
+// state of one ColoredPGS_LCP call, shared by the threads of a sweep
+struct dxColoredPGSSweep
+{
+  const dxPGSLCPParameters *params;
+
+  // row indices, grouped by block, blocks grouped by color
+  std::vector<int> rows;
+  // first entry of each block in rows, plus one past the end
+  std::vector<int> blockrows;
+  // first block of each color, plus one past the end
+  std::vector<int> colorblocks;
+
+  // per block residual sums and row counts of the current iteration
+  std::vector<dReal> sums;
+  std::vector<int> counts;
+
+  bool friction_only;
+  int blockstart;
+  int blockend;
+  int chunksize;
+  std::atomic<int> nextchunk;
+
+  // threads that solved blocks of the current color
+  std::atomic<int> activethreads;
+};
+}
+
+// constraint type of a row for the residual sums:
+// 0 bilateral, 1 contact normal, 2 friction.
+static inline int dxRowType(int constraint_index)
+{
+  if (constraint_index == -1)
+    return 0;
+  if (constraint_index == -2)
+    return 1;
+  return 2;
+}
+
+// groups consecutive rows that constrain the same pair of bodies into
+// blocks and colors the blocks greedily in row order, so that no two
+// blocks of a color share a body. each block takes the smallest color
+// that none of its bodies uses yet. a chain of links coupled by joints
+// thus needs two colors, however long it is.
+static void dxColorBlocks(dxColoredPGSSweep &sweep)
+{
+  IGN_PROFILE("dxColorBlocks");
+
+  const dxPGSLCPParameters &params = *sweep.params;
+  const int m = params.m;
+  const int nb = params.nb;
+  const int *jb = params.jb;
+  const int *findex = params.findex;
+
+  // split the rows into blocks
+  std::vector<int> blockfirst;
+  blockfirst.reserve(m + 1);
+  for (int i = 0; i < m; ++i) {
+    if (i == 0 || jb[i*2] != jb[i*2-2] || jb[i*2+1] != jb[i*2-1])
+      blockfirst.push_back(i);
+  }
+  const int nblocks = static_cast<int>(blockfirst.size());
+  blockfirst.push_back(m);
+
+  // colors used by each body, stored in a flat array with an offset per
+  // body. a block uses at most one color per body, so the number of
+  // blocks touching a body bounds the number of its colors.
+  std::vector<int> bodyoffset(nb + 1, 0);
+  for (int b = 0; b < nblocks; ++b) {
+    const int row = blockfirst[b];
+    ++bodyoffset[jb[row*2] + 1];
+    if (jb[row*2+1] >= 0)
+      ++bodyoffset[jb[row*2+1] + 1];
+  }
+  for (int i = 0; i < nb; ++i)
+    bodyoffset[i+1] += bodyoffset[i];
+  std::vector<int> bodycolors(bodyoffset[nb]);
+  std::vector<int> bodycolorcount(nb, 0);
+
+  // mark[c] == b when color c is taken by a body of block b
+  std::vector<int> mark(nblocks + 1, -1);
+  std::vector<int> blockcolor(nblocks);
+  int ncolors = 0;
+  for (int b = 0; b < nblocks; ++b) {
+    const int row = blockfirst[b];
+    const int body[2] = {jb[row*2], jb[row*2+1]};
+    for (int k = 0; k < 2; ++k) {
+      if (body[k] < 0)
+        continue;
+      const int *colors = &bodycolors[bodyoffset[body[k]]];
+      for (int j = 0; j < bodycolorcount[body[k]]; ++j)
+        mark[colors[j]] = b;
+    }
+    int color = 0;
+    while (mark[color] == b)
+      ++color;
+    blockcolor[b] = color;
+    ncolors = std::max(ncolors, color + 1);
+    for (int k = 0; k < 2; ++k) {
+      if (body[k] < 0)
+        continue;
+      bodycolors[bodyoffset[body[k]] + bodycolorcount[body[k]]++] = color;
+    }
+  }
+
+  // sort the blocks by color, keeping the row order within a color
+  sweep.colorblocks.assign(ncolors + 1, 0);
+  for (int b = 0; b < nblocks; ++b)
+    ++sweep.colorblocks[blockcolor[b] + 1];
+  for (int c = 0; c < ncolors; ++c)
+    sweep.colorblocks[c+1] += sweep.colorblocks[c];
+  std::vector<int> sorted(nblocks);
+  {
+    std::vector<int> next(sweep.colorblocks.begin(), sweep.colorblocks.end() - 1);
+    for (int b = 0; b < nblocks; ++b)
+      sorted[next[blockcolor[b]]++] = b;
+  }
+
+  // within a block, the rows with findex < 0 come first, so that the
+  // friction bounds see the normal force of this iteration.
+  sweep.rows.resize(m);
+  sweep.blockrows.resize(nblocks + 1);
+  int r = 0;
+  for (int s = 0; s < nblocks; ++s) {
+    const int b = sorted[s];
+    sweep.blockrows[s] = r;
+    for (int i = blockfirst[b]; i < blockfirst[b+1]; ++i) {
+      if (findex[i] < 0)
+        sweep.rows[r++] = i;
+    }
+    for (int i = blockfirst[b]; i < blockfirst[b+1]; ++i) {
+      if (findex[i] >= 0)
+        sweep.rows[r++] = i;
+    }
+  }
+  sweep.blockrows[nblocks] = r;
+
+  sweep.sums.resize(nblocks * SUMS_PER_BLOCK);
+  sweep.counts.resize(nblocks * 3);
+}
+
+// solves one row with the non-preconditioned update of ComputeRows,
+// position correction inline, and records its residual in sums and
+// counts.
+static void dxSolveColoredRow(const dxPGSLCPParameters &params, int index,
+                              dReal *sums, int *counts)
+{
+  const dxQuickStepParameters *qs = params.qs;
+  const int *jb = params.jb;
+  dRealPtr hi = params.hi;
+  dRealPtr lo = params.lo;
+  dRealPtr Ad = params.Ad;
+  dRealPtr Adcfm = params.Adcfm;
+  dRealPtr J = params.J;
+  dRealPtr iMJ = params.iMJ;
+  dRealPtr rhs = params.rhs;
+  dRealPtr rhs_erp = params.rhs_erp;
+  dRealMutablePtr caccel = params.caccel;
+  dRealMutablePtr caccel_erp = params.caccel_erp;
+  dRealMutablePtr lambda = params.lambda;
+  dRealMutablePtr lambda_erp = params.lambda_erp;
+
+  const int constraint_index = params.findex[index];
+
+  const int b1 = jb[index*2];
+  const int b2 = jb[index*2+1];
+  dRealMutablePtr caccel_ptr1 = caccel + 6*b1;
+  dRealMutablePtr caccel_ptr2 = (b2 >= 0) ? caccel + 6*b2 : NULL;
+  dRealMutablePtr caccel_erp_ptr1 = caccel_erp + 6*b1;
+  dRealMutablePtr caccel_erp_ptr2 = (b2 >= 0) ? caccel_erp + 6*b2 : NULL;
+
+  const dReal old_lambda = lambda[index];
+  const dReal old_lambda_erp = lambda_erp[index];
+
+  dRealPtr J_ptr = J + index*12;
+  dReal delta = rhs[index] - old_lambda*Adcfm[index];
+  delta -= quickstep::dot6(caccel_ptr1, J_ptr);
+  dReal delta_erp = rhs_erp[index] - old_lambda_erp*Adcfm[index];
+  delta_erp -= quickstep::dot6(caccel_erp_ptr1, J_ptr);
+  if (caccel_ptr2) {
+    delta -= quickstep::dot6(caccel_ptr2, J_ptr + 6);
+    delta_erp -= quickstep::dot6(caccel_erp_ptr2, J_ptr + 6);
+  }
+
+  // set the limits for this constraint. the normal row of a contact is in
+  // the same block and solved before its friction rows.
+  dReal hi_act, lo_act, hi_act_erp, lo_act_erp;
+  if (constraint_index >= 0 && (index - constraint_index >= 3 ||
+      qs->friction_model == pyramid_friction)) {
+    // torsional friction, or pyramid friction
+    hi_act = dFabs (hi[index] * lambda[constraint_index]);
+    lo_act = -hi_act;
+    hi_act_erp = dFabs (hi[index] * lambda_erp[constraint_index]);
+    lo_act_erp = -hi_act_erp;
+  }
+  else if (constraint_index >= 0) {
+    // box friction, ColoredPGS_LCPSupported rules out the cone model
+    hi_act = hi[index];
+    lo_act = -hi_act;
+    hi_act_erp = hi[index];
+    lo_act_erp = -hi_act_erp;
+  }
+  else {
+    hi_act = hi[index];
+    lo_act = lo[index];
+    hi_act_erp = hi[index];
+    lo_act_erp = lo[index];
+  }
+
+  // compute lambda and clamp it to [lo,hi].
+  lambda[index] = old_lambda + delta;
+  if (lambda[index] < lo_act) {
+    delta = lo_act-old_lambda;
+    lambda[index] = lo_act;
+  }
+  else if (lambda[index] > hi_act) {
+    delta = hi_act-old_lambda;
+    lambda[index] = hi_act;
+  }
+
+  lambda_erp[index] = old_lambda_erp + delta_erp;
+  if (lambda_erp[index] < lo_act_erp) {
+    delta_erp = lo_act_erp-old_lambda_erp;
+    lambda_erp[index] = lo_act_erp;
+  }
+  else if (lambda_erp[index] > hi_act_erp) {
+    delta_erp = hi_act_erp-old_lambda_erp;
+    lambda_erp[index] = hi_act_erp;
+  }
+
+#ifdef SMOOTH_LAMBDA
+  // smooth delta lambda of the contact rows, as ComputeRows does
+  if (constraint_index != -1) {
+    lambda[index] = (1.0 - qs->smooth_contacts)*lambda[index]
+      + qs->smooth_contacts*old_lambda;
+  }
+#endif
+
+  // update caccel
+  dRealPtr iMJ_ptr = iMJ + index*12;
+  quickstep::sum6(caccel_ptr1, delta, iMJ_ptr);
+  quickstep::sum6(caccel_erp_ptr1, delta_erp, iMJ_ptr);
+  if (caccel_ptr2) {
+    quickstep::sum6(caccel_ptr2, delta, iMJ_ptr + 6);
+    quickstep::sum6(caccel_erp_ptr2, delta_erp, iMJ_ptr + 6);
+  }
+
+  // record residual (error), see ComputeRows
+  dReal Ad2 = 0.0;
+  if (!_dequal(Ad[index], 0.0))
+    Ad2 = 1.0 / (Ad[index] * Ad[index]);
+
+  const int type = dxRowType(constraint_index);
+  const dReal delta2 = delta*delta;
+  sums[type] += delta2;
+  sums[3 + type] += delta2*Ad2;
+  counts[type]++;
+}
+
+// solves the blocks of the current color handed out by the shared cursor,
+// until there are none left.
+static void dxProcessColoredChunks(dxColoredPGSSweep *sweep)
+{
+  const dxPGSLCPParameters &params = *sweep->params;
+  const int *findex = params.findex;
+
+  bool active = false;
+  for (int chunk = sweep->nextchunk.fetch_add(1); ; chunk = sweep->nextchunk.fetch_add(1)) {
+    const int start = sweep->blockstart + chunk * sweep->chunksize;
+    if (start >= sweep->blockend)
+      break;
+    const int end = std::min(start + sweep->chunksize, sweep->blockend);
+    if (!active) {
+      active = true;
+      sweep->activethreads.fetch_add(1);
+    }
+    for (int b = start; b < end; ++b) {
+      dReal *sums = &sweep->sums[b * SUMS_PER_BLOCK];
+      int *counts = &sweep->counts[b * 3];
+      dSetZero(sums, SUMS_PER_BLOCK);
+      counts[0] = counts[1] = counts[2] = 0;
+      for (int r = sweep->blockrows[b]; r < sweep->blockrows[b+1]; ++r) {
+        const int index = sweep->rows[r];
+        // during the extra friction iterations, only solve friction rows
+        if (sweep->friction_only && findex[index] < 0)
+          continue;
+        dxSolveColoredRow(params, index, sums, counts);
+      }
+    }
+  }
+}
+
+bool quickstep::ColoredPGS_LCPSupported(const dxQuickStepParameters *qs)
+{
+  return qs->precon_iterations <= 0 && qs->friction_model != cone_friction;
+}
+
+void quickstep::ColoredPGS_LCP(const dxPGSLCPParameters &params,
+  boost::threadpool::pool *pool)
+{
+  IGN_PROFILE("ColoredPGS_LCP");
+
+  dxQuickStepParameters *qs = params.qs;
+
+  dxColoredPGSSweep sweep;
+  sweep.params = &params;
+  dxColorBlocks(sweep);
+
+  const int ncolors = static_cast<int>(sweep.colorblocks.size()) - 1;
+  const int nblocks = static_cast<int>(sweep.blockrows.size()) - 1;
+  const int poolsize = pool ? static_cast<int>(pool->size()) : 0;
+
+  const int num_iterations = qs->num_iterations;
+  const int total_iterations = num_iterations + qs->friction_iterations;
+
+  dReal rms_dlambda[3] = {0, 0, 0};
+  dReal rms_error[3] = {0, 0, 0};
+  int m_rms_dlambda[3] = {0, 0, 0};
+  int maxthreads = 0;
+
+  IFTIMING (dTimerNow ("start colored pgs rows"));
+  for (int iteration = 0; iteration < total_iterations; ++iteration)
+  {
+    sweep.friction_only = iteration >= num_iterations;
+
+    for (int c = 0; c < ncolors; ++c)
+    {
+      sweep.blockstart = sweep.colorblocks[c];
+      sweep.blockend = sweep.colorblocks[c+1];
+      const int nblockscolor = sweep.blockend - sweep.blockstart;
+      sweep.chunksize = std::max(1,
+        nblockscolor / ((poolsize + 1) * CHUNKS_PER_THREAD));
+      sweep.nextchunk = 0;
+      sweep.activethreads = 0;
+
+      // the calling thread takes chunks too, pool->wait() is the barrier
+      // between two colors.
+      const int chunkcount =
+        (nblockscolor + sweep.chunksize - 1) / sweep.chunksize;
+      const int workers = std::min(poolsize, chunkcount - 1);
+      for (int i = 0; i < workers; ++i)
+        pool->schedule(boost::bind(dxProcessColoredChunks, &sweep));
+      dxProcessColoredChunks(&sweep);
+      if (workers > 0)
+      {
+        IGN_PROFILE("ColoredPGS_LCP::wait");
+        pool->wait();
+      }
+      maxthreads = std::max(maxthreads, sweep.activethreads.load());
+    }
+
+    // sum the residuals in block order, which doesn't depend on the
+    // threads. the extra friction iterations keep the sums of the
+    // bilateral and contact normal rows of the last full iteration.
+    const int first_type = sweep.friction_only ? 2 : 0;
+    for (int t = first_type; t < 3; ++t)
+    {
+      rms_dlambda[t] = 0;
+      rms_error[t] = 0;
+      m_rms_dlambda[t] = 0;
+    }
+    for (int b = 0; b < nblocks; ++b)
+    {
+      const dReal *sums = &sweep.sums[b * SUMS_PER_BLOCK];
+      const int *counts = &sweep.counts[b * 3];
+      for (int t = first_type; t < 3; ++t)
+      {
+        rms_dlambda[t] += sums[t];
+        rms_error[t] += sums[3 + t];
+        m_rms_dlambda[t] += counts[t];
+      }
+    }
+
+    const int m_total = m_rms_dlambda[0] + m_rms_dlambda[1] + m_rms_dlambda[2];
+    for (int t = 0; t < 3; ++t)
+    {
+      qs->rms_dlambda[t] = m_rms_dlambda[t] > 0 ?
+        sqrt(rms_dlambda[t]/(dReal)m_rms_dlambda[t]) : 0.0;
+      qs->rms_constraint_residual[t] = m_rms_dlambda[t] > 0 ?
+        sqrt(rms_error[t]/(dReal)m_rms_dlambda[t]) : 0.0;
+    }
+    qs->rms_dlambda[3] = m_total > 0 ?
+      sqrt((rms_dlambda[0] + rms_dlambda[1] + rms_dlambda[2])/(dReal)m_total) :
+      0.0;
+    qs->rms_constraint_residual[3] = m_total > 0 ?
+      sqrt((rms_error[0] + rms_error[1] + rms_error[2])/(dReal)m_total) : 0.0;
+    qs->num_contacts = m_rms_dlambda[1];
+
+    // option to stop when tolerance has been met
+    if (qs->rms_constraint_residual[3] < qs->pgs_lcp_tolerance)
+      break;
+  }
+  qs->num_colored_threads = maxthreads;
+  IFTIMING (dTimerNow ("colored pgs rows done"));
+}
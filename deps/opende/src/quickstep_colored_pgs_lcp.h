@@ -0,0 +1,62 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef _ODE_QUICK_STEP_COLORED_PGS_LCP_H_
+#define _ODE_QUICK_STEP_COLORED_PGS_LCP_H_
+
+#include <gazebo/ode/common.h>
+#include <boost/threadpool.hpp>
+#include "quickstep_util.h"
+
+namespace ode {
+    namespace quickstep{
+
+/// \brief Check whether the graph colored PGS solver supports the quickstep
+/// parameters. Preconditioning and the cone friction model are not
+/// supported, PGS_LCP then solves the rows itself.
+/// \param[in] qs Quickstep parameters.
+/// \return True if ColoredPGS_LCP can solve the rows.
+bool ColoredPGS_LCPSupported(const dxQuickStepParameters *qs);
+
+/// \brief Solve the constraint rows prepared by PGS_LCP with a graph
+/// colored projected Gauss-Seidel sweep.
+///
+/// Consecutive rows that constrain the same pair of bodies, such as the
+/// rows of one joint, form a block. The blocks are colored greedily, in row
+/// order, so that no two blocks of a color share a body. Every iteration
+/// sweeps the colors one after the other, and the blocks of a color are
+/// solved in parallel, with a barrier between colors. Within a block, the
+/// rows with findex < 0 are solved before the friction rows, as in
+/// PGS_LCP. A row is solved the same way whichever thread solves it, and
+/// the residuals are summed in row order, so the result doesn't depend on
+/// the number of threads. Position correction rows are solved inline.
+///
+/// \param[in] params Rows to solve, as set up by PGS_LCP. The order,
+/// mutex, nStart, nChunkSize, precon and cforce fields are ignored.
+/// \param[in] pool Threads that join the caller in each sweep, may be
+/// NULL.
+void ColoredPGS_LCP(const dxPGSLCPParameters &params,
+  boost::threadpool::pool *pool);
+
+    } // namespace quickstep
+} // namespace ode
+#endif
@@ -0,0 +1,286 @@
+/*************************************************************************
+*                                                                       *
+* Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+* All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+*                                                                       *
+* This library is free software; you can redistribute it and/or         *
+* modify it under the terms of EITHER:                                  *
+*   (1) The GNU Lesser General Public License as published by the Free  *
+*       Software Foundation; either version 2.1 of the License, or (at  *
+*       your option) any later version. The text of the GNU Lesser      *
+*       General Public License is included with this library in the     *
+*       file LICENSE.TXT.                                               *
+*   (2) The BSD-style license that is included with this library in     *
+*       the file LICENSE-BSD.TXT.                                       *
+*                                                                       *
+* This library is distributed in the hope that it will be useful,       *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+* LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+*                                                                       *
+*************************************************************************/
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <gazebo/ode/common.h>
+#include <gazebo/ode/odemath.h>
+#include <gazebo/ode/error.h>
+#include <gazebo/ode/matrix.h>
+
+#include "quickstep_kernels.h"
+
+using namespace ode;
+
+//***************************************************************************
+// scalar kernels, the reference for the other instruction sets
+
+static void ScalarMultiply1_12q1 (dReal *A, const dReal *B, const dReal *C, int q)
+{
+  dIASSERT (q>0 && A && B && C);
+
+  dReal a = 0;
+  dReal b = 0;
+  dReal c = 0;
+  dReal d = 0;
+  dReal e = 0;
+  dReal f = 0;
+  dReal s;
+
+  for(int i=0, k = 0; i<q; k += 12, i++)
+  {
+    s = C[i]; //C[i] and B[n+k] cannot overlap because its value has been read into a temporary.
+
+    //For the rest of the loop, the only memory dependency (array) is from B[]
+    a += B[  k] * s;
+    b += B[1+k] * s;
+    c += B[2+k] * s;
+    d += B[3+k] * s;
+    e += B[4+k] * s;
+    f += B[5+k] * s;
+  }
+
+  A[0] = a;
+  A[1] = b;
+  A[2] = c;
+  A[3] = d;
+  A[4] = e;
+  A[5] = f;
+}
+
+static void ScalarComputeInvM_JT (int m, const dReal *J, dReal *iMJ, const int *jb,
+  const dReal *invMass, const dReal *invMOI)
+{
+  dReal *iMJ_ptr = iMJ;
+  const dReal *J_ptr = J;
+  for (int i=0; i<m; J_ptr += 12, iMJ_ptr += 12, i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    dReal k1 = invMass[b1];
+    for (int j=0; j<3; j++) iMJ_ptr[j] = k1*J_ptr[j];
+    const dReal *invMOIrow1 = invMOI + 12*b1;
+    dMultiply0_331 (iMJ_ptr + 3, invMOIrow1, J_ptr + 3);
+    if (b2 >= 0) {
+      dReal k2 = invMass[b2];
+      for (int j=0; j<3; j++) iMJ_ptr[j+6] = k2*J_ptr[j+6];
+      const dReal *invMOIrow2 = invMOI + 12*b2;
+      dMultiply0_331 (iMJ_ptr + 9, invMOIrow2, J_ptr + 9);
+    }
+  }
+}
+
+static void ScalarMultiplyInvM_JT (int m, int nb, const dReal *iMJ, const int *jb,
+  const dReal *in, dReal *out)
+{
+  dSetZero (out,6*nb);
+  const dReal *iMJ_ptr = iMJ;
+  for (int i=0; i<m; i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    const dReal in_i = in[i];
+    dReal *out_ptr = out + b1*6;
+    for (int j=0; j<6; j++) out_ptr[j] += iMJ_ptr[j] * in_i;
+    iMJ_ptr += 6;
+    if (b2 >= 0) {
+      out_ptr = out + b2*6;
+      for (int j=0; j<6; j++) out_ptr[j] += iMJ_ptr[j] * in_i;
+    }
+    iMJ_ptr += 6;
+  }
+}
+
+static void ScalarMultiplyJ (int m, const dReal *J, const int *jb,
+  const dReal *in, dReal *out)
+{
+  const dReal *J_ptr = J;
+  for (int i=0; i<m; i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    dReal sum = 0;
+    const dReal *in_ptr = in + b1*6;
+    for (int j=0; j<6; j++) sum += J_ptr[j] * in_ptr[j];
+    J_ptr += 6;
+    if (b2 >= 0) {
+      in_ptr = in + b2*6;
+      for (int j=0; j<6; j++) sum += J_ptr[j] * in_ptr[j];
+    }
+    J_ptr += 6;
+    out[i] = sum;
+  }
+}
+
+static const quickstep::dxQuickStepKernels scalar_kernels = {
+  "scalar",
+  ScalarMultiply1_12q1,
+  ScalarComputeInvM_JT,
+  ScalarMultiplyInvM_JT,
+  ScalarMultiplyJ
+};
+
+//***************************************************************************
+// check kernels: run the fastest kernels, then the scalar ones on a copy
+// of the output, and compare the two bitwise.
+
+// the tables only hold vector kernels that beat the scalar ones, so the
+// widest instruction set is never slower.
+static const quickstep::dxQuickStepKernels *FastestKernels()
+{
+  const quickstep::dxQuickStepKernels *kernels = quickstep::AVX2Kernels();
+  if (!kernels)
+    kernels = quickstep::SSE2Kernels();
+  if (!kernels)
+    kernels = &scalar_kernels;
+  return kernels;
+}
+
+// compares the n values at a and b, and reports the first mismatch of
+// each kernel only.
+static void CheckBitwise(const char *kernel, std::atomic<bool> &reported,
+  const dReal *fast, const dReal *scalar, int n)
+{
+  if (memcmp(fast, scalar, n * sizeof(dReal)) == 0 || reported.exchange(true))
+    return;
+  for (int i=0; i<n; i++) {
+    if (memcmp(fast + i, scalar + i, sizeof(dReal)) != 0) {
+      dMessage (0, "quickstep kernel %s (%s) differs from scalar at %d: %.17g != %.17g",
+        kernel, FastestKernels()->name, i, (double)fast[i], (double)scalar[i]);
+      return;
+    }
+  }
+}
+
+static thread_local std::vector<dReal> check_scratch;
+
+static void CheckMultiply1_12q1 (dReal *A, const dReal *B, const dReal *C, int q)
+{
+  static std::atomic<bool> reported(false);
+  dReal ref[6];
+  FastestKernels()->Multiply1_12q1(A, B, C, q);
+  ScalarMultiply1_12q1(ref, B, C, q);
+  CheckBitwise("Multiply1_12q1", reported, A, ref, 6);
+}
+
+static void CheckComputeInvM_JT (int m, const dReal *J, dReal *iMJ, const int *jb,
+  const dReal *invMass, const dReal *invMOI)
+{
+  static std::atomic<bool> reported(false);
+  // rows of a single body leave their second half alone
+  check_scratch.assign(iMJ, iMJ + 12*m);
+  FastestKernels()->compute_invM_JT(m, J, iMJ, jb, invMass, invMOI);
+  ScalarComputeInvM_JT(m, J, check_scratch.data(), jb, invMass, invMOI);
+  CheckBitwise("compute_invM_JT", reported, iMJ, check_scratch.data(), 12*m);
+}
+
+static void CheckMultiplyInvM_JT (int m, int nb, const dReal *iMJ, const int *jb,
+  const dReal *in, dReal *out)
+{
+  static std::atomic<bool> reported(false);
+  check_scratch.resize(6*nb);
+  FastestKernels()->multiply_invM_JT(m, nb, iMJ, jb, in, out);
+  ScalarMultiplyInvM_JT(m, nb, iMJ, jb, in, check_scratch.data());
+  CheckBitwise("multiply_invM_JT", reported, out, check_scratch.data(), 6*nb);
+}
+
+static void CheckMultiplyJ (int m, const dReal *J, const int *jb,
+  const dReal *in, dReal *out)
+{
+  static std::atomic<bool> reported(false);
+  check_scratch.resize(m);
+  FastestKernels()->multiply_J(m, J, jb, in, out);
+  ScalarMultiplyJ(m, J, jb, in, check_scratch.data());
+  CheckBitwise("multiply_J", reported, out, check_scratch.data(), m);
+}
+
+static const quickstep::dxQuickStepKernels check_kernels = {
+  "check",
+  CheckMultiply1_12q1,
+  CheckComputeInvM_JT,
+  CheckMultiplyInvM_JT,
+  CheckMultiplyJ
+};
+
+//***************************************************************************
+// run time dispatch
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ODE_QUICKSTEP_CPU_DISPATCH
+#endif
+
+const quickstep::dxQuickStepKernels *quickstep::ScalarKernels()
+{
+  return &scalar_kernels;
+}
+
+const quickstep::dxQuickStepKernels *quickstep::SSE2Kernels()
+{
+#ifdef ODE_QUICKSTEP_CPU_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    return BuiltInSSE2Kernels();
+#endif
+  return NULL;
+}
+
+const quickstep::dxQuickStepKernels *quickstep::AVX2Kernels()
+{
+#ifdef ODE_QUICKSTEP_CPU_DISPATCH
+  // libgcc only reports avx2 when the OS saves the ymm registers
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return BuiltInAVX2Kernels();
+#endif
+  return NULL;
+}
+
+const quickstep::dxQuickStepKernels *quickstep::FindKernels(const char *name)
+{
+  if (strcmp(name, "scalar") == 0)
+    return ScalarKernels();
+  if (strcmp(name, "sse2") == 0)
+    return SSE2Kernels();
+  if (strcmp(name, "avx2") == 0)
+    return AVX2Kernels();
+  if (strcmp(name, "check") == 0)
+    return &check_kernels;
+  return NULL;
+}
+
+static const quickstep::dxQuickStepKernels *SelectKernels()
+{
+  const char *name = getenv("ODE_QUICKSTEP_KERNELS");
+  if (name && *name) {
+    const quickstep::dxQuickStepKernels *kernels = quickstep::FindKernels(name);
+    if (kernels)
+      return kernels;
+    dMessage (0, "quickstep kernels [%s] are not available, using [%s]",
+      name, FastestKernels()->name);
+  }
+  return FastestKernels();
+}
+
+const quickstep::dxQuickStepKernels &quickstep::Kernels()
+{
+  static const dxQuickStepKernels *kernels = SelectKernels();
+  return *kernels;
+}
@@ -0,0 +1,99 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef _ODE_QUICK_STEP_KERNELS_H_
+#define _ODE_QUICK_STEP_KERNELS_H_
+
+#include <gazebo/ode/common.h>
+
+namespace ode {
+    namespace quickstep{
+
+/// \brief Batch kernels of quickstep that work on whole sets of 12-wide
+/// Jacobian rows. Each instruction set has its own table, the one used by
+/// quickstep is picked at run time, see Kernels().
+///
+/// Every implementation does the same floating point operations in the
+/// same order per output element as the scalar one, so that their results
+/// are bitwise identical. The vector versions only spread independent
+/// elements, or independent rows, over the lanes.
+struct dxQuickStepKernels
+{
+  /// \brief Name of the instruction set: "scalar", "sse2", "avx2" or
+  /// "check".
+  const char *name;
+
+  /// \brief A = B'*C, with B a block of q rows of 12 dReal of which the
+  /// first 6 are used, and C a vector of q. See Multiply1_12q1.
+  void (*Multiply1_12q1)(dReal *A, const dReal *B, const dReal *C, int q);
+
+  /// \brief iMJ = inv(M)*J'. invMass holds the inverse mass of each body,
+  /// invMOI its 3x4 inverse inertia. The second half of a row is left
+  /// alone when its second body is < 0.
+  void (*compute_invM_JT)(int m, const dReal *J, dReal *iMJ, const int *jb,
+    const dReal *invMass, const dReal *invMOI);
+
+  /// \brief out = inv(M)*J'*in, with out of size 6*nb.
+  void (*multiply_invM_JT)(int m, int nb, const dReal *iMJ, const int *jb,
+    const dReal *in, dReal *out);
+
+  /// \brief out = J*in, with in of size 6*nb.
+  void (*multiply_J)(int m, const dReal *J, const int *jb,
+    const dReal *in, dReal *out);
+};
+
+/// \brief Portable kernels, always available.
+const dxQuickStepKernels *ScalarKernels();
+
+/// \brief SSE2 kernels, or NULL when they are not built in or the
+/// processor lacks SSE2.
+const dxQuickStepKernels *SSE2Kernels();
+
+/// \brief AVX2 kernels, or NULL when they are not built in or the
+/// processor lacks AVX2.
+const dxQuickStepKernels *AVX2Kernels();
+
+/// \brief Find kernels by name. "check" returns kernels that run both the
+/// fastest available kernels and the scalar ones, and report through
+/// dMessage the first result of each kernel that differs bitwise.
+/// \param[in] name Name of the kernels.
+/// \return The kernels, or NULL when they are not available.
+ODE_API const dxQuickStepKernels *FindKernels(const char *name);
+
+/// \brief Kernels used by quickstep. The fastest available ones are
+/// picked on first use, unless the ODE_QUICKSTEP_KERNELS environment
+/// variable names others, as in FindKernels.
+ODE_API const dxQuickStepKernels &Kernels();
+
+    } // namespace quickstep
+} // namespace ode
+
+// tables of the instruction set specific translation units, NULL when the
+// compiler doesn't target the instruction set. they don't check the
+// processor.
+namespace ode {
+    namespace quickstep{
+        const dxQuickStepKernels *BuiltInSSE2Kernels();
+        const dxQuickStepKernels *BuiltInAVX2Kernels();
+    } // namespace quickstep
+} // namespace ode
+#endif
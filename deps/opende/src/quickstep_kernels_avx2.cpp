@@ -0,0 +1,129 @@
+/*************************************************************************
+*                                                                       *
+* Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+* All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+*                                                                       *
+* This library is free software; you can redistribute it and/or         *
+* modify it under the terms of EITHER:                                  *
+*   (1) The GNU Lesser General Public License as published by the Free  *
+*       Software Foundation; either version 2.1 of the License, or (at  *
+*       your option) any later version. The text of the GNU Lesser      *
+*       General Public License is included with this library in the     *
+*       file LICENSE.TXT.                                               *
+*   (2) The BSD-style license that is included with this library in     *
+*       the file LICENSE-BSD.TXT.                                       *
+*                                                                       *
+* This library is distributed in the hope that it will be useful,       *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+* LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+*                                                                       *
+*************************************************************************/
+// AVX2 quickstep kernels. this file is compiled with -mavx2 when the
+// compiler supports it, and without contraction of multiply-adds, so that
+// the results are bitwise identical to the scalar kernels. only the
+// dispatch in quickstep_kernels.cpp may call them, after checking the
+// processor.
+#include <gazebo/ode/common.h>
+
+#include "quickstep_kernels.h"
+
+#if defined(__AVX2__) && defined(dDOUBLE)
+#include <immintrin.h>
+
+using namespace ode;
+
+// iMJ_ptr[0..5] = [k*J_ptr[0..2], invMOIrow*J_ptr[3..5]]
+static inline void AVX2InvM_JT6 (dReal *iMJ_ptr, const dReal *J_ptr, dReal k,
+  const dReal *invMOIrow, __m256i mask3)
+{
+  _mm256_maskstore_pd(iMJ_ptr, mask3,
+    _mm256_mul_pd(_mm256_set1_pd(k), _mm256_maskload_pd(J_ptr, mask3)));
+
+  // the three rows of the 3x4 matrix in the first three lanes, summed in
+  // the order of dCalcVectorDot3
+  const __m256d row0 = _mm256_loadu_pd(invMOIrow);
+  const __m256d row1 = _mm256_loadu_pd(invMOIrow + 4);
+  const __m256d row2 = _mm256_loadu_pd(invMOIrow + 8);
+  // transpose to the columns (a0 a4 a8 -), (a1 a5 a9 -), (a2 a6 a10 -)
+  const __m256d t0 = _mm256_unpacklo_pd(row0, row1);  // a0 a4 a2 a6
+  const __m256d t1 = _mm256_unpackhi_pd(row0, row1);  // a1 a5 a3 a7
+  const __m256d t2 = _mm256_unpacklo_pd(row2, row2);  // a8 a8 a10 a10
+  const __m256d t3 = _mm256_unpackhi_pd(row2, row2);  // a9 a9 a11 a11
+  const __m256d col0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+  const __m256d col1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+  const __m256d col2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+
+  __m256d r = _mm256_mul_pd(col0, _mm256_set1_pd(J_ptr[3]));
+  r = _mm256_add_pd(r, _mm256_mul_pd(col1, _mm256_set1_pd(J_ptr[4])));
+  r = _mm256_add_pd(r, _mm256_mul_pd(col2, _mm256_set1_pd(J_ptr[5])));
+  _mm256_maskstore_pd(iMJ_ptr + 3, mask3, r);
+}
+
+static void AVX2ComputeInvM_JT (int m, const dReal *J, dReal *iMJ, const int *jb,
+  const dReal *invMass, const dReal *invMOI)
+{
+  const __m256i mask3 = _mm256_set_epi64x(0, -1, -1, -1);
+  dReal *iMJ_ptr = iMJ;
+  const dReal *J_ptr = J;
+  for (int i=0; i<m; J_ptr += 12, iMJ_ptr += 12, i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    AVX2InvM_JT6(iMJ_ptr, J_ptr, invMass[b1], invMOI + 12*b1, mask3);
+    if (b2 >= 0)
+      AVX2InvM_JT6(iMJ_ptr + 6, J_ptr + 6, invMass[b2], invMOI + 12*b2, mask3);
+  }
+}
+
+// out_ptr[0..5] += iMJ_ptr[0..5] * in_i
+static inline void AVX2Sum6 (dReal *out_ptr, const dReal *iMJ_ptr, __m256d in_i)
+{
+  _mm256_storeu_pd(out_ptr, _mm256_add_pd(_mm256_loadu_pd(out_ptr),
+    _mm256_mul_pd(_mm256_loadu_pd(iMJ_ptr), in_i)));
+  _mm_storeu_pd(out_ptr + 4, _mm_add_pd(_mm_loadu_pd(out_ptr + 4),
+    _mm_mul_pd(_mm_loadu_pd(iMJ_ptr + 4), _mm256_castpd256_pd128(in_i))));
+}
+
+static void AVX2MultiplyInvM_JT (int m, int nb, const dReal *iMJ, const int *jb,
+  const dReal *in, dReal *out)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  int j = 0;
+  for (; j+4<=6*nb; j+=4) _mm256_storeu_pd(out + j, zero);
+  for (; j<6*nb; j++) out[j] = 0;
+
+  const dReal *iMJ_ptr = iMJ;
+  for (int i=0; i<m; iMJ_ptr += 12, i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    const __m256d in_i = _mm256_set1_pd(in[i]);
+    AVX2Sum6(out + b1*6, iMJ_ptr, in_i);
+    if (b2 >= 0)
+      AVX2Sum6(out + b2*6, iMJ_ptr + 6, in_i);
+  }
+}
+
+const quickstep::dxQuickStepKernels *quickstep::BuiltInAVX2Kernels()
+{
+  // the scalar loops of Multiply1_12q1 and J*in are as fast, see
+  // test/performance/quickstep_kernels.cc: the first is bound by memory,
+  // and spreading the rows of the second over the lanes costs more
+  // shuffles than it saves multiplies
+  static const dxQuickStepKernels kernels = {
+    "avx2",
+    ScalarKernels()->Multiply1_12q1,
+    AVX2ComputeInvM_JT,
+    AVX2MultiplyInvM_JT,
+    ScalarKernels()->multiply_J
+  };
+  return &kernels;
+}
+
+#else
+
+const ode::quickstep::dxQuickStepKernels *ode::quickstep::BuiltInAVX2Kernels()
+{
+  return NULL;
+}
+
+#endif
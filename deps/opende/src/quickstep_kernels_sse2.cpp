@@ -0,0 +1,82 @@
+/*************************************************************************
+*                                                                       *
+* Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+* All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+*                                                                       *
+* This library is free software; you can redistribute it and/or         *
+* modify it under the terms of EITHER:                                  *
+*   (1) The GNU Lesser General Public License as published by the Free  *
+*       Software Foundation; either version 2.1 of the License, or (at  *
+*       your option) any later version. The text of the GNU Lesser      *
+*       General Public License is included with this library in the     *
+*       file LICENSE.TXT.                                               *
+*   (2) The BSD-style license that is included with this library in     *
+*       the file LICENSE-BSD.TXT.                                       *
+*                                                                       *
+* This library is distributed in the hope that it will be useful,       *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+* LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+*                                                                       *
+*************************************************************************/
+// SSE2 quickstep kernels. this file is compiled with -msse2 when the
+// compiler supports it, and without contraction of multiply-adds, so that
+// the results are bitwise identical to the scalar kernels.
+#include <gazebo/ode/common.h>
+
+#include "quickstep_kernels.h"
+
+#if defined(__SSE2__) && defined(dDOUBLE)
+#include <emmintrin.h>
+
+using namespace ode;
+
+// out_ptr[0..5] += iMJ_ptr[0..5] * in_i
+static inline void SSE2Sum6 (dReal *out_ptr, const dReal *iMJ_ptr, __m128d in_i)
+{
+  for (int j=0; j<6; j+=2) {
+    _mm_storeu_pd(out_ptr + j, _mm_add_pd(_mm_loadu_pd(out_ptr + j),
+      _mm_mul_pd(_mm_loadu_pd(iMJ_ptr + j), in_i)));
+  }
+}
+
+static void SSE2MultiplyInvM_JT (int m, int nb, const dReal *iMJ, const int *jb,
+  const dReal *in, dReal *out)
+{
+  const __m128d zero = _mm_setzero_pd();
+  for (int j=0; j<6*nb; j+=2) _mm_storeu_pd(out + j, zero);
+
+  const dReal *iMJ_ptr = iMJ;
+  for (int i=0; i<m; iMJ_ptr += 12, i++) {
+    int b1 = jb[i*2];
+    int b2 = jb[i*2+1];
+    const __m128d in_i = _mm_set1_pd(in[i]);
+    SSE2Sum6(out + b1*6, iMJ_ptr, in_i);
+    if (b2 >= 0)
+      SSE2Sum6(out + b2*6, iMJ_ptr + 6, in_i);
+  }
+}
+
+const quickstep::dxQuickStepKernels *quickstep::BuiltInSSE2Kernels()
+{
+  // only the scatter of inv(M)*J'*in measurably beats the scalar loops
+  // (see test/performance/quickstep_kernels.cc). the two lanes don't pay
+  // for their loads and shuffles in the others, which stay scalar.
+  static const dxQuickStepKernels kernels = {
+    "sse2",
+    ScalarKernels()->Multiply1_12q1,
+    ScalarKernels()->compute_invM_JT,
+    SSE2MultiplyInvM_JT,
+    ScalarKernels()->multiply_J
+  };
+  return &kernels;
+}
+
+#else
+
+const ode::quickstep::dxQuickStepKernels *ode::quickstep::BuiltInSSE2Kernels()
+{
+  return NULL;
+}
+
+#endif
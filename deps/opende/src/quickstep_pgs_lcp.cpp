@@ -40,6 +40,7 @@
 
 #include "quickstep_util.h"
 #include "quickstep_pgs_lcp.h"
+#include "quickstep_colored_pgs_lcp.h"
 #ifndef TIMING
 #ifdef HDF5_INSTRUMENT
 #define DUMP
@@ -975,16 +976,14 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
   dRealMutablePtr caccel, dRealMutablePtr caccel_erp, dRealMutablePtr cforce,
   dRealMutablePtr rhs, dRealMutablePtr rhs_erp, dRealMutablePtr rhs_precon,
   dRealPtr lo, dRealPtr hi, dRealPtr cfm, const int *findex,
-  dxQuickStepParameters *qs
-#ifdef USE_TPROW
-  , boost::threadpool::pool* row_threadpool
-#endif
+  dxQuickStepParameters *qs,
+  boost::threadpool::pool* row_threadpool
   )
 {
 
   // precompute iMJ = inv(M)*J'
   dReal *iMJ = context->AllocateArray<dReal> (m*12);
-  compute_invM_JT (m,J,iMJ,jb,body,invMOI);
+  compute_invM_JT (m,nb,J,iMJ,jb,body,invMOI);
 
   if (qs->warm_start > 0)
   {
@@ -1106,6 +1105,38 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
     }
   }
 
+  if (qs->world_solver_type == ODE_COLORED_PGS &&
+      quickstep::ColoredPGS_LCPSupported(qs))
+  {
+    // graph colored sweep, deterministic whatever the number of threads
+    dxPGSLCPParameters colored_params;
+    memset(&colored_params, 0, sizeof(colored_params));
+    colored_params.body = body;
+    colored_params.inline_position_correction = true;
+    colored_params.qs = qs;
+    colored_params.m = m;
+    colored_params.nb = nb;
+    colored_params.jb = jb;
+    colored_params.findex = findex;
+    colored_params.hi = hi;
+    colored_params.lo = lo;
+    colored_params.invMOI = invMOI;
+    colored_params.MOI = MOI;
+    colored_params.Ad = Ad;
+    colored_params.Adcfm = Adcfm;
+    colored_params.J = J;
+    colored_params.iMJ = iMJ;
+    colored_params.J_orig = J_orig;
+    colored_params.rhs = rhs;
+    colored_params.caccel = caccel;
+    colored_params.lambda = lambda;
+    colored_params.rhs_erp = rhs_erp;
+    colored_params.caccel_erp = caccel_erp;
+    colored_params.lambda_erp = lambda_erp;
+    quickstep::ColoredPGS_LCP(colored_params, row_threadpool);
+    return;
+  }
+
 
   // order to solve constraint rows in
   IndexError *order = context->AllocateArray<IndexError> (m);
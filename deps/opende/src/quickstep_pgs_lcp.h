@@ -24,6 +24,7 @@
 #define _ODE_QUICK_STEP_PGS_LCP_H_
 
 #include <gazebo/ode/common.h>
+#include <boost/threadpool.hpp>
 #include "quickstep_util.h"
 
 namespace ode {
@@ -43,10 +44,8 @@ void PGS_LCP (dxWorldProcessContext *context,
   dRealMutablePtr caccel, dRealMutablePtr caccel_erp, dRealMutablePtr cforce,
   dRealMutablePtr rhs, dRealMutablePtr rhs_erp, dRealMutablePtr rhs_precon,
   dRealPtr lo, dRealPtr hi, dRealPtr cfm, const int *findex,
-  dxQuickStepParameters *qs
-#ifdef USE_TPROW
-  , boost::threadpool::pool* row_threadpool
-#endif
+  dxQuickStepParameters *qs,
+  boost::threadpool::pool* row_threadpool
   );
 
 /// \brief Compute the hi and lo bound for cone friction model to project onto
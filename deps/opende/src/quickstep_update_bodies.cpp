@@ -331,7 +331,7 @@ void quickstep::dxUpdateBodies(
       // add correction term dlambda = J*v(n+1)/dt
       // and caccel += dt*invM*JT*dlambda (dt's cancel out)
       dReal *iMJ = context->AllocateArray<dReal> (m*12);
-      compute_invM_JT (m,J,iMJ,jb,body,invMOI);
+      compute_invM_JT (m,nb,J,iMJ,jb,body,invMOI);
       // compute caccel_corr=(inv(M)*J')*dlambda, correction term
       // as we change lambda.
       multiply_invM_JT (m,nb,iMJ,jb,tmp,caccel_corr);
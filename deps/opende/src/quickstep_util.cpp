@@ -31,112 +31,50 @@
 #include "joints/joint.h"
 #include "util.h"
 
+#include <vector>
+
 #ifndef _WIN32
   #include <sys/time.h>
 #endif
 
 #include "quickstep_util.h"
+#include "quickstep_kernels.h"
 
 using namespace ode;
 // multiply block of B matrix (q x 6) with 12 dReal per row with C vektor (q)
 void quickstep::Multiply1_12q1 (dReal *A, const dReal *B, const dReal *C, int q)
 {
-  dIASSERT (q>0 && A && B && C);
-
-  dReal a = 0;
-  dReal b = 0;
-  dReal c = 0;
-  dReal d = 0;
-  dReal e = 0;
-  dReal f = 0;
-  dReal s;
-
-  for(int i=0, k = 0; i<q; k += 12, i++)
-  {
-    s = C[i]; //C[i] and B[n+k] cannot overlap because its value has been read into a temporary.
-
-    //For the rest of the loop, the only memory dependency (array) is from B[]
-    a += B[  k] * s;
-    b += B[1+k] * s;
-    c += B[2+k] * s;
-    d += B[3+k] * s;
-    e += B[4+k] * s;
-    f += B[5+k] * s;
-  }
-
-  A[0] = a;
-  A[1] = b;
-  A[2] = c;
-  A[3] = d;
-  A[4] = e;
-  A[5] = f;
+  Kernels().Multiply1_12q1 (A,B,C,q);
 }
 
 //***************************************************************************
-// various common computations involving the matrix J
+// various common computations involving the matrix J. the work is done by
+// the kernels of the instruction set picked at run time, see
+// quickstep_kernels.h
 
 // compute iMJ = inv(M)*J'
-void quickstep::compute_invM_JT (int m, dRealPtr J, dRealMutablePtr iMJ, int *jb,
+void quickstep::compute_invM_JT (int m, int nb, dRealPtr J, dRealMutablePtr iMJ, int *jb,
   dxBody * const *body, dRealPtr invMOI)
 {
-  dRealMutablePtr iMJ_ptr = iMJ;
-  dRealPtr J_ptr = J;
-  for (int i=0; i<m; J_ptr += 12, iMJ_ptr += 12, i++) {
-    int b1 = jb[i*2];
-    int b2 = jb[i*2+1];
-    dReal k1 = body[b1]->invMass;
-    for (int j=0; j<3; j++) iMJ_ptr[j] = k1*J_ptr[j];
-    const dReal *invMOIrow1 = invMOI + 12*b1;
-    dMultiply0_331 (iMJ_ptr + 3, invMOIrow1, J_ptr + 3);
-    if (b2 >= 0) {
-      dReal k2 = body[b2]->invMass;
-      for (int j=0; j<3; j++) iMJ_ptr[j+6] = k2*J_ptr[j+6];
-      const dReal *invMOIrow2 = invMOI + 12*b2;
-      dMultiply0_331 (iMJ_ptr + 9, invMOIrow2, J_ptr + 9);
-    }
-  }
+  // the kernels read the inverse masses from a flat array
+  static thread_local std::vector<dReal> invMass;
+  invMass.resize(nb);
+  for (int b=0; b<nb; b++) invMass[b] = body[b]->invMass;
+  Kernels().compute_invM_JT (m,J,iMJ,jb,invMass.data(),invMOI);
 }
 
 // compute out = inv(M)*J'*in.
 void quickstep::multiply_invM_JT (int m, int nb, dRealMutablePtr iMJ, int *jb,
   dRealPtr in, dRealMutablePtr out)
 {
-  dSetZero (out,6*nb);
-  dRealPtr iMJ_ptr = iMJ;
-  for (int i=0; i<m; i++) {
-    int b1 = jb[i*2];
-    int b2 = jb[i*2+1];
-    const dReal in_i = in[i];
-    dRealMutablePtr out_ptr = out + b1*6;
-    for (int j=0; j<6; j++) out_ptr[j] += iMJ_ptr[j] * in_i;
-    iMJ_ptr += 6;
-    if (b2 >= 0) {
-      out_ptr = out + b2*6;
-      for (int j=0; j<6; j++) out_ptr[j] += iMJ_ptr[j] * in_i;
-    }
-    iMJ_ptr += 6;
-  }
+  Kernels().multiply_invM_JT (m,nb,iMJ,jb,in,out);
 }
 
 // compute out = J*in.
 void quickstep::multiply_J (int m, dRealPtr J, int *jb,
   dRealPtr in, dRealMutablePtr out)
 {
-  dRealPtr J_ptr = J;
-  for (int i=0; i<m; i++) {
-    int b1 = jb[i*2];
-    int b2 = jb[i*2+1];
-    dReal sum = 0;
-    dRealPtr in_ptr = in + b1*6;
-    for (int j=0; j<6; j++) sum += J_ptr[j] * in_ptr[j];
-    J_ptr += 6;
-    if (b2 >= 0) {
-      in_ptr = in + b2*6;
-      for (int j=0; j<6; j++) sum += J_ptr[j] * in_ptr[j];
-    }
-    J_ptr += 6;
-    out[i] = sum;
-  }
+  Kernels().multiply_J (m,J,jb,in,out);
 }
 
 #ifdef USE_CG_LCP
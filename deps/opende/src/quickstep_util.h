@@ -184,7 +184,7 @@ namespace ode {
 void Multiply1_12q1 (dReal *A, const dReal *B, const dReal *C, int q);
 
 // compute iMJ = inv(M)*J'
-void compute_invM_JT (int m, dRealPtr J, dRealMutablePtr iMJ, int *jb,
+void compute_invM_JT (int m, int nb, dRealPtr J, dRealMutablePtr iMJ, int *jb,
   dxBody * const *body, dRealPtr invMOI);
 
 // compute out = inv(M)*J'*in.
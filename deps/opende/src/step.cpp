@@ -736,8 +736,9 @@ void dInternalStepIsland_x2 (dxWorldProcessContext *context,
     BEGIN_STATE_SAVE(context, lcpstate) {
       IFTIMING(dTimerNow ("solving LCP problem"));
 
-      if (solver_type == ODE_DEFAULT)
+      if (solver_type == ODE_DEFAULT || solver_type == ODE_COLORED_PGS)
       {
+        // ODE_COLORED_PGS is a quickstep solver, use dantzig here
         // solve the LCP problem and get lambda.
         // this will destroy A but that's OK
         dSolveLCP (context, m, A, lambda, rhs, NULL, nub, lo, hi, findex);
@@ -28,8 +28,11 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/bind.hpp>
 #include <gazebo/ode/timer.h>
+#include <ignition/common/Profiler.hh>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
-#undef REPORT_THREAD_TIMING
 #undef TIMING
 #ifdef TIMING
 #define IFTIMING(x) x
@@ -574,27 +577,103 @@ void dxProcessOneIsland(dxWorldProcessContext *island_context, dxWorld *world, d
                         dxJoint *const *jointstart,
                         int jcount)
 {
-#ifdef REPORT_THREAD_TIMING
-    struct timeval tv;
-    double cur_time;
-    gettimeofday(&tv,NULL);
-    cur_time = (double)tv.tv_sec + (double)tv.tv_usec / 1.e6;
-    printf("island thread started time %f\n",cur_time);
-#endif
+    IGN_PROFILE("dxProcessOneIsland");
 
     BEGIN_STATE_SAVE(island_context, island_stepperstate) {
       stepper (island_context,world,bodystart,bcount,jointstart,jcount,stepsize);
     } END_STATE_SAVE(island_context, island_stepperstate);
+}
 
-#ifdef REPORT_THREAD_TIMING
-    gettimeofday(&tv,NULL);
-    double end_time = (double)tv.tv_sec + (double)tv.tv_usec / 1.e6;
-    printf("----- island thread start time %f ended at time %f with duration %f\n",cur_time,end_time,end_time - cur_time);
-#endif
+// estimates the cost of stepping an island: the number of constraint rows,
+// plus one per body for the integration, times the number of solver
+// iterations.
+static size_t EstimateIslandCost(dxWorld *world, int bcount, dxJoint *const *jointstart, int jcount)
+{
+  size_t rows = bcount;
+  for (int j = 0; j < jcount; ++j) {
+    dxJoint::SureMaxInfo info;
+    jointstart[j]->getSureMaxInfo(&info);
+    rows += info.max_m;
+  }
+  size_t iterations = world->qs.num_iterations > 0 ? world->qs.num_iterations : 1;
+  return rows * iterations;
+}
+
+// steps the islands of the chunks handed out by a shared cursor, until there
+// are none left. chunks are sorted by decreasing cost, so the largest ones
+// start first and the small ones fill in the gaps at the end.
+static void dxProcessIslandChunks(dxWorld *world, dReal stepsize, dstepper_fn_t stepper,
+                                  dxBody *const *body, dxJoint *const *joint,
+                                  std::atomic<int> *nextchunk)
+{
+  IGN_PROFILE("dxProcessIslandChunks");
+
+  const int chunkcount = static_cast<int>(world->island_chunks.size()) - 1;
+  for (int chunk = nextchunk->fetch_add(1); chunk < chunkcount; chunk = nextchunk->fetch_add(1)) {
+    for (int t = world->island_chunks[chunk]; t < world->island_chunks[chunk + 1]; ++t) {
+      const dxIslandTask &task = world->island_tasks[t];
+      dxStepWorkingMemory *island_wmem = world->island_wmems[task.island];
+      dIASSERT(island_wmem != NULL);
+      dxProcessOneIsland(island_wmem->GetWorldProcessingContext(), world, stepsize, stepper,
+                         body + task.bodyoffset, task.bcount, joint + task.jointoffset, task.jcount);
+    }
+  }
+}
+
+// sorts the islands by decreasing cost, and groups the small ones into
+// chunks so that no chunk is much cheaper than the share of a thread
+// divided by CHUNKS_PER_THREAD. returns the number of chunks.
+static const int CHUNKS_PER_THREAD = 4;
+
+static int dxScheduleIslands(dxWorld *world, int islandcount, int const *islandsizes,
+                             dxJoint *const *joint, int threadcount)
+{
+  IGN_PROFILE("dxScheduleIslands");
+
+  const int sizeelements = 2;
+  std::vector<dxIslandTask> &tasks = world->island_tasks;
+  tasks.resize(islandcount);
+
+  size_t totalcost = 0;
+  int bodyoffset = 0, jointoffset = 0;
+  for (int i = 0; i < islandcount; ++i) {
+    dxIslandTask &task = tasks[i];
+    task.island = i;
+    task.bodyoffset = bodyoffset;
+    task.jointoffset = jointoffset;
+    task.bcount = islandsizes[i * sizeelements];
+    task.jcount = islandsizes[i * sizeelements + 1];
+    task.cost = EstimateIslandCost(world, task.bcount, joint + jointoffset, task.jcount);
+    totalcost += task.cost;
+    bodyoffset += task.bcount;
+    jointoffset += task.jcount;
+  }
+
+  // ties are broken by island index so that the schedule is reproducible
+  std::sort(tasks.begin(), tasks.end(), [](const dxIslandTask &a, const dxIslandTask &b) {
+    return a.cost != b.cost ? a.cost > b.cost : a.island < b.island;
+  });
+
+  const size_t mincost = totalcost / (threadcount * CHUNKS_PER_THREAD) + 1;
+  std::vector<int> &chunks = world->island_chunks;
+  chunks.clear();
+  size_t chunkcost = mincost;
+  for (int i = 0; i < islandcount; ++i) {
+    if (chunkcost >= mincost) {
+      chunks.push_back(i);
+      chunkcost = 0;
+    }
+    chunkcost += tasks[i].cost;
+  }
+  chunks.push_back(islandcount);
+
+  return static_cast<int>(chunks.size()) - 1;
 }
 
 void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
 {
+  IGN_PROFILE("dxProcessIslands");
+
   const int sizeelements = 2;
 
   dxStepWorkingMemory *wmem = world->wmem;
@@ -609,60 +688,49 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   dxJoint *const *joint;
   context->RetrievePreallocations(islandcount, islandsizes, body, joint, islandreqs);
 
-  dxBody *const *bodystart = body;
-  dxJoint *const *jointstart = joint;
-
   IFTIMING(dTimerStart("preprocessing islands"));
-  int island_index = 0;
-  int const *const sizesend = islandsizes + islandcount * sizeelements;
-
-#ifdef REPORT_THREAD_TIMING
-  struct timeval tv;
-  double cur_time;
-  gettimeofday(&tv,NULL);
-  cur_time = (double)tv.tv_sec + (double)tv.tv_usec / 1.e6;
-  printf(">>>>>>>>>>>> start island spawn threads at time %f\n",cur_time);
-#endif
 
-  for (int const *sizescurr = islandsizes; sizescurr != sizesend; sizescurr += sizeelements) {
-    int bcount = sizescurr[0];
-    int jcount = sizescurr[1];
-
-    // get working memory for each island
-    dxStepWorkingMemory *island_wmem = world->island_wmems[island_index++];
-    dIASSERT(island_wmem != NULL);
-    dxWorldProcessContext *island_context = island_wmem->GetWorldProcessingContext();
-
-#define USE_TPISLAND
-#ifdef USE_TPISLAND
-    IFTIMING(dTimerNow("scheduling island"));
-    //printf("debug opende tp %d\n",world->threadpool->size());
-    if (world->threadpool && world->threadpool->size() > 0)
-      world->threadpool->schedule(boost::bind(dxProcessOneIsland,island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount));
-    else //automatically skip threadpool if only 1 thread allocated
+  const int poolsize = world->threadpool ? static_cast<int>(world->threadpool->size()) : 0;
+  if (poolsize > 0 && islandcount > 1) {
+    // the calling thread takes chunks too rather than waiting idle
+    const int chunkcount = dxScheduleIslands(world, islandcount, islandsizes, joint, poolsize + 1);
+    std::atomic<int> nextchunk(0);
+
+    IFTIMING(dTimerNow("scheduling islands"));
+    const int workers = std::min(poolsize, chunkcount - 1);
+    for (int i = 0; i < workers; ++i)
+      world->threadpool->schedule(boost::bind(dxProcessIslandChunks, world, stepsize, stepper, body, joint, &nextchunk));
+    dxProcessIslandChunks(world, stepsize, stepper, body, joint, &nextchunk);
+
+    IFTIMING(dTimerNow("islands wait"));
+    {
+      IGN_PROFILE("dxProcessIslands::wait");
+      world->threadpool->wait();
+    }
+  }
+  else {
+    dxBody *const *bodystart = body;
+    dxJoint *const *jointstart = joint;
+    int island_index = 0;
+    int const *const sizesend = islandsizes + islandcount * sizeelements;
+    for (int const *sizescurr = islandsizes; sizescurr != sizesend; sizescurr += sizeelements) {
+      int bcount = sizescurr[0];
+      int jcount = sizescurr[1];
+
+      // get working memory for each island
+      dxStepWorkingMemory *island_wmem = world->island_wmems[island_index++];
+      dIASSERT(island_wmem != NULL);
+      dxWorldProcessContext *island_context = island_wmem->GetWorldProcessingContext();
+
       dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#else
-    dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#endif
 
-    bodystart += bcount;
-    jointstart += jcount;
+      bodystart += bcount;
+      jointstart += jcount;
+    }
   }
-#ifdef USE_TPISLAND
-  IFTIMING(dTimerNow("islands wait"));
-  if (world->threadpool && world->threadpool->size() > 0)
-    world->threadpool->wait();
-#endif
   IFTIMING(dTimerEnd());
   IFTIMING(dTimerReport (stdout,1));
 
-
-#ifdef REPORT_THREAD_TIMING
-  gettimeofday(&tv,NULL);
-  double end_time = (double)tv.tv_sec + (double)tv.tv_usec / 1.e6;
-  printf("<<<<<<<<<<<< all island threads stopped at time %f with duration %f\n",end_time,end_time - cur_time);
-#endif
-
   for (auto &m : world->island_wmems)
   {
     m->GetWorldProcessingContext()->CleanupContext();
@@ -57,6 +57,7 @@
 
 #include "gazebo/msgs/msgs.hh"
 
+#include "gazebo/sensors/SensorManager.hh"
 #include "gazebo/sensors/SensorsIface.hh"
 
 #include "gazebo/physics/PhysicsFactory.hh"
@@ -167,16 +168,24 @@ bool Server::ParseArgs(int _argc, char **_argv)
     ("play,p", po::value<std::string>(), "Play a log file.")
     ("record,r", "Record state data.")
     ("record_encoding", po::value<std::string>()->default_value("zlib"),
-     "Compression encoding format for log data (zlib|bz2|txt).")
+     "Compression encoding format for log data (zlib|bz2|txt|bin).")
     ("record_path", po::value<std::string>()->default_value(""),
      "Absolute path in which to store state data")
     ("record_period", po::value<double>()->default_value(-1),
      "Recording period (seconds).")
     ("record_filter", po::value<std::string>()->default_value(""),
      "Recording filter (supports wildcard and regular expression).")
+    ("record_keyframe_interval", po::value<unsigned int>()->default_value(0),
+     "Frames between keyframes of a bin log, other frames are deltas.")
+    ("record_keyframe_period", po::value<double>()->default_value(0),
+     "Sim time (seconds) between keyframes of a bin log.")
     ("record_resources", "Recording with model meshes and materials.")
     ("seed",  po::value<double>(), "Start with a given random number seed.")
     ("iters",  po::value<unsigned int>(), "Number of iterations to simulate.")
+    ("model_update_threads", po::value<unsigned int>(),
+     "Number of threads used to update models in parallel (0 for serial).")
+    ("sensor_update_threads", po::value<unsigned int>(),
+     "Number of threads used to update sensors in parallel (0 for serial).")
     ("minimal_comms", "Reduce the TCP/IP traffic output by gzserver")
     ("server-plugin,s", po::value<std::vector<std::string> >(),
      "Load a plugin.")
@@ -295,6 +304,20 @@ bool Server::ParseArgs(int _argc, char **_argv)
     }
   }
 
+  if (this->dataPtr->vm.count("model_update_threads"))
+  {
+    this->dataPtr->params["model_update_threads"] =
+        boost::lexical_cast<std::string>(
+        this->dataPtr->vm["model_update_threads"].as<unsigned int>());
+  }
+
+  if (this->dataPtr->vm.count("sensor_update_threads"))
+  {
+    this->dataPtr->params["sensor_update_threads"] =
+        boost::lexical_cast<std::string>(
+        this->dataPtr->vm["sensor_update_threads"].as<unsigned int>());
+  }
+
   if (this->dataPtr->vm.count("lockstep"))
   {
     this->dataPtr->lockstep = true;
@@ -699,10 +722,40 @@ void Server::ProcessParams()
       params.path = iter->second;
       params.period = this->dataPtr->vm["record_period"].as<double>();
       params.filter = this->dataPtr->vm["record_filter"].as<std::string>();
+      params.keyframeInterval =
+          this->dataPtr->vm["record_keyframe_interval"].as<unsigned int>();
+      params.keyframePeriod =
+          this->dataPtr->vm["record_keyframe_period"].as<double>();
       params.recordResources =
           this->dataPtr->params.count("record_resources") > 0;
       util::LogRecord::Instance()->Start(params);
     }
+    else if (iter->first == "model_update_threads")
+    {
+      try
+      {
+        physics::get_world()->SetModelUpdateThreads(
+            boost::lexical_cast<unsigned int>(iter->second));
+      }
+      catch(...)
+      {
+        gzerr << "Unable to set model update threads to ["
+          << iter->second << "]\n";
+      }
+    }
+    else if (iter->first == "sensor_update_threads")
+    {
+      try
+      {
+        sensors::SensorManager::Instance()->SetSensorUpdateThreads(
+            boost::lexical_cast<unsigned int>(iter->second));
+      }
+      catch(...)
+      {
+        gzerr << "Unable to set sensor update threads to ["
+          << iter->second << "]\n";
+      }
+    }
   }
 }
 
@@ -0,0 +1,990 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/common/Material.hh"
+#include "gazebo/common/Mesh.hh"
+#include "gazebo/common/Skeleton.hh"
+#include "gazebo/common/SkeletonAnimation.hh"
+#include "gazebo/common/MeshCache.hh"
+
+using namespace gazebo;
+using namespace common;
+
+/// \brief Identifies a cache file.
+static const char kMagic[4] = {'G', 'Z', 'M', 'C'};
+
+/// \brief Version of the cache format, increase it on every change.
+static const uint32_t kVersion = 2;
+
+/// \brief Written in native byte order, a cache file written on a machine
+/// of another endianness doesn't match it.
+static const uint32_t kByteOrder = 0x01020304;
+
+namespace gazebo
+{
+  namespace common
+  {
+    /// \internal
+    /// \brief Private data for MeshCache
+    class MeshCachePrivate
+    {
+      /// \brief Directory holding the cache files.
+      public: std::string path;
+    };
+  }
+}
+
+/// \brief 64 bit FNV-1a hash.
+/// \param[in] _data Data to hash.
+/// \param[in] _size Size of the data.
+/// \param[in] _hash Hash of the previous data, to hash in chunks.
+/// \return The hash.
+static uint64_t Fnv1a(const char *_data, const size_t _size,
+    uint64_t _hash = 14695981039346656037ULL)
+{
+  for (size_t i = 0; i < _size; ++i)
+  {
+    _hash ^= static_cast<unsigned char>(_data[i]);
+    _hash *= 1099511628211ULL;
+  }
+  return _hash;
+}
+
+/// \brief Hash the content of a file.
+/// \param[in] _filename Path of the file.
+/// \param[out] _hash The hash.
+/// \return True if the file could be read.
+static bool ContentHash(const std::string &_filename, uint64_t &_hash)
+{
+  std::ifstream file(_filename, std::ios::binary);
+  if (!file)
+    return false;
+
+  std::vector<char> buffer(1 << 16);
+  _hash = Fnv1a(nullptr, 0);
+  while (file)
+  {
+    file.read(buffer.data(), buffer.size());
+    _hash = Fnv1a(buffer.data(), file.gcount(), _hash);
+  }
+  return file.eof();
+}
+
+/// \brief Get the modification time and size of a file.
+/// \param[in] _filename Path of the file.
+/// \param[out] _mtime Modification time.
+/// \param[out] _size Size in bytes.
+/// \return True if the file exists.
+static bool FileStamp(const std::string &_filename, int64_t &_mtime,
+    uint64_t &_size)
+{
+  boost::system::error_code ec;
+  std::time_t mtime = boost::filesystem::last_write_time(_filename, ec);
+  if (ec)
+    return false;
+  uintmax_t size = boost::filesystem::file_size(_filename, ec);
+  if (ec)
+    return false;
+
+  _mtime = static_cast<int64_t>(mtime);
+  _size = static_cast<uint64_t>(size);
+  return true;
+}
+
+/// \brief Get the material files of an OBJ file, which the OBJ loader
+/// reads with it, so that editing one invalidates the cache entry.
+/// \param[in] _filename Path of the mesh file.
+/// \return Paths of the material files, empty for other formats.
+static std::vector<std::string> Dependencies(const std::string &_filename)
+{
+  std::vector<std::string> result;
+  std::string extension =
+    boost::filesystem::path(_filename).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+  if (extension != ".obj")
+    return result;
+
+  // Material files are relative to the directory of the OBJ file, as in
+  // OBJLoader.
+  std::string path;
+  size_t idx = _filename.rfind('/');
+  if (idx != std::string::npos)
+    path = _filename.substr(0, idx+1);
+
+  std::ifstream file(_filename);
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream stream(line);
+    std::string keyword, name;
+    stream >> keyword;
+    if (keyword != "mtllib")
+      continue;
+    while (stream >> name)
+      result.push_back(path + name);
+  }
+  return result;
+}
+
+namespace
+{
+/// \brief A file a cache entry was built from, as it was when the entry
+/// was saved.
+struct SourceFile
+{
+  /// \brief Path of the file.
+  std::string path;
+
+  /// \brief Whether the file existed. A missing material file doesn't
+  /// prevent loading an OBJ file, but creating it invalidates the entry.
+  uint8_t exists = 0;
+
+  /// \brief Modification time.
+  int64_t mtime = 0;
+
+  /// \brief Size in bytes.
+  uint64_t size = 0;
+
+  /// \brief Content hash.
+  uint64_t hash = 0;
+};
+
+/// \brief Read only view of a whole file, memory mapped when supported.
+class MappedFile
+{
+  /// \brief Map a file.
+  /// \param[in] _filename Path of the file.
+  public: explicit MappedFile(const std::string &_filename)
+  {
+#ifndef _WIN32
+    int fd = open(_filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+
+    off_t end = lseek(fd, 0, SEEK_END);
+    if (end > 0)
+    {
+      void *addr = mmap(nullptr, end, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED)
+      {
+        this->data = static_cast<const char *>(addr);
+        this->size = end;
+      }
+    }
+    close(fd);
+#else
+    std::ifstream file(_filename, std::ios::binary);
+    if (!file)
+      return;
+    this->buffer.assign(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+    this->data = this->buffer.data();
+    this->size = this->buffer.size();
+#endif
+  }
+
+  /// \brief Unmap the file.
+  public: ~MappedFile()
+  {
+#ifndef _WIN32
+    if (this->data)
+      munmap(const_cast<char *>(this->data), this->size);
+#endif
+  }
+
+  /// \brief Content of the file, nullptr if it couldn't be read.
+  public: const char *data = nullptr;
+
+  /// \brief Size of the file.
+  public: size_t size = 0;
+
+#ifdef _WIN32
+  /// \brief Content of the file, where mapping isn't supported.
+  private: std::vector<char> buffer;
+#endif
+};
+
+/// \brief Bounds checked reader of a cache file.
+class Reader
+{
+  /// \brief Constructor.
+  /// \param[in] _data Data to read.
+  /// \param[in] _size Size of the data.
+  public: Reader(const char *_data, const size_t _size)
+    : data(_data), size(_size)
+  {
+  }
+
+  /// \brief Read a value.
+  /// \param[out] _value The value.
+  /// \return False if the data is too short.
+  public: template<typename T> bool Read(T &_value)
+  {
+    if (this->size - this->pos < sizeof(T))
+      return false;
+    std::memcpy(&_value, this->data + this->pos, sizeof(T));
+    this->pos += sizeof(T);
+    return true;
+  }
+
+  /// \brief Read a string.
+  /// \param[out] _value The string.
+  /// \return False if the data is too short.
+  public: bool Read(std::string &_value)
+  {
+    uint32_t length;
+    if (!this->Read(length) || this->size - this->pos < length)
+      return false;
+    _value.assign(this->data + this->pos, length);
+    this->pos += length;
+    return true;
+  }
+
+  /// \brief Read a matrix.
+  /// \param[out] _value The matrix.
+  /// \return False if the data is too short.
+  public: bool Read(ignition::math::Matrix4d &_value)
+  {
+    double m[16];
+    for (double &v : m)
+    {
+      if (!this->Read(v))
+        return false;
+    }
+    _value.Set(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+        m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+    return true;
+  }
+
+  /// \brief Read the count of an array, checking that the data holds it.
+  /// \param[in] _itemSize Size of an item of the array.
+  /// \param[out] _count The count.
+  /// \return False if the data is too short.
+  public: bool ReadCount(const size_t _itemSize, uint32_t &_count)
+  {
+    return this->Read(_count) &&
+        (this->size - this->pos) / _itemSize >= _count;
+  }
+
+  /// \brief Data to read.
+  private: const char *data;
+
+  /// \brief Size of the data.
+  private: size_t size;
+
+  /// \brief Read position.
+  private: size_t pos = 0;
+};
+
+/// \brief Writer of a cache file.
+class Writer
+{
+  /// \brief Write a value.
+  /// \param[in] _value The value.
+  public: template<typename T> void Write(const T &_value)
+  {
+    this->buffer.append(reinterpret_cast<const char *>(&_value), sizeof(T));
+  }
+
+  /// \brief Write a string.
+  /// \param[in] _value The string.
+  public: void Write(const std::string &_value)
+  {
+    this->Write(static_cast<uint32_t>(_value.size()));
+    this->buffer.append(_value);
+  }
+
+  /// \brief Write a matrix.
+  /// \param[in] _value The matrix.
+  public: void Write(const ignition::math::Matrix4d &_value)
+  {
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      for (unsigned int j = 0; j < 4; ++j)
+        this->Write(_value(i, j));
+    }
+  }
+
+  /// \brief Write a color.
+  /// \param[in] _value The color.
+  public: void Write(const ignition::math::Color &_value)
+  {
+    this->Write(_value.R());
+    this->Write(_value.G());
+    this->Write(_value.B());
+    this->Write(_value.A());
+  }
+
+  /// \brief The written data.
+  public: std::string buffer;
+};
+}
+
+/// \brief Get the stamp and content hash of a file.
+/// \param[in] _path Path of the file.
+/// \return The file, which doesn't exist if it couldn't be read.
+static SourceFile StampSource(const std::string &_path)
+{
+  SourceFile source;
+  source.path = _path;
+  source.exists = FileStamp(_path, source.mtime, source.size) &&
+      ContentHash(_path, source.hash);
+  return source;
+}
+
+/// \brief Check that a file is as it was when a cache entry was saved.
+/// \param[in] _source The file when the entry was saved.
+/// \param[in] _savedTime When the entry was saved.
+/// \return True if the file is unchanged.
+static bool Unchanged(const SourceFile &_source, const int64_t _savedTime)
+{
+  int64_t mtime;
+  uint64_t size;
+  if (!FileStamp(_source.path, mtime, size))
+    return !_source.exists;
+  if (!_source.exists || size != _source.size)
+    return false;
+
+  // Modification times have a resolution of a second, so a file modified
+  // in the second the entry was saved, or later, can change again without a
+  // new time. Only an older time is trusted, otherwise the content is
+  // hashed. A file copied or checked out again also has a new time but the
+  // same content, hashing it is still much faster than parsing it.
+  if (mtime == _source.mtime && mtime < _savedTime)
+    return true;
+
+  uint64_t hash;
+  return ContentHash(_source.path, hash) && hash == _source.hash;
+}
+
+/// \brief Write an array of coordinates, as float32 when that is lossless,
+/// so that a cached mesh is identical to the parsed one.
+/// \param[in] _values The coordinates.
+/// \param[in,out] _writer Writer.
+static void WriteCoords(const std::vector<double> &_values, Writer &_writer)
+{
+  bool exact = std::all_of(_values.begin(), _values.end(),
+      [](const double _v)
+      {
+        return static_cast<double>(static_cast<float>(_v)) == _v;
+      });
+
+  _writer.Write(static_cast<uint8_t>(exact));
+  _writer.Write(static_cast<uint32_t>(_values.size()));
+  for (const double v : _values)
+  {
+    if (exact)
+      _writer.Write(static_cast<float>(v));
+    else
+      _writer.Write(v);
+  }
+}
+
+/// \brief Read an array of coordinates written by WriteCoords.
+/// \param[in,out] _reader Reader.
+/// \param[in] _dims Number of coordinates per item.
+/// \param[out] _values The coordinates.
+/// \return False if the data is invalid.
+static bool ReadCoords(Reader &_reader, const uint32_t _dims,
+    std::vector<double> &_values)
+{
+  uint8_t exact;
+  uint32_t count;
+  if (!_reader.Read(exact) ||
+      !_reader.ReadCount(exact ? sizeof(float) : sizeof(double), count) ||
+      count % _dims != 0)
+  {
+    return false;
+  }
+
+  _values.resize(count);
+  for (double &v : _values)
+  {
+    if (exact)
+    {
+      float f;
+      _reader.Read(f);
+      v = f;
+    }
+    else
+    {
+      _reader.Read(v);
+    }
+  }
+  return true;
+}
+
+/// \brief Write a skeleton node and its children.
+/// \param[in] _node The node.
+/// \param[in,out] _writer Writer.
+static void WriteNode(SkeletonNode *_node, Writer &_writer)
+{
+  _writer.Write(_node->GetName());
+  _writer.Write(_node->GetId());
+  _writer.Write(static_cast<uint8_t>(_node->IsJoint()));
+  _writer.Write(_node->Transform());
+  _writer.Write(_node->InverseBindTransform());
+
+  std::vector<NodeTransform> rawTransforms = _node->GetRawTransforms();
+  _writer.Write(static_cast<uint32_t>(rawTransforms.size()));
+  for (auto &raw : rawTransforms)
+  {
+    _writer.Write(raw.GetSID());
+    _writer.Write(static_cast<uint32_t>(raw.GetType()));
+    _writer.Write(raw.GetTransform());
+  }
+
+  _writer.Write(static_cast<uint32_t>(_node->GetChildCount()));
+  for (unsigned int i = 0; i < _node->GetChildCount(); ++i)
+    WriteNode(_node->GetChild(i), _writer);
+}
+
+/// \brief Read a skeleton node and its children.
+/// \param[in,out] _reader Reader.
+/// \param[in] _parent Parent of the node, nullptr for the root.
+/// \param[out] _node The node.
+/// \return False if the data is invalid.
+static bool ReadNode(Reader &_reader, SkeletonNode *_parent,
+    SkeletonNode *&_node)
+{
+  std::string name, id;
+  uint8_t joint;
+  ignition::math::Matrix4d transform, invBindTransform;
+  if (!_reader.Read(name) || !_reader.Read(id) || !_reader.Read(joint) ||
+      !_reader.Read(transform) || !_reader.Read(invBindTransform))
+  {
+    return false;
+  }
+
+  _node = new SkeletonNode(_parent, name, id,
+      joint ? SkeletonNode::JOINT : SkeletonNode::NODE);
+  _node->SetTransform(transform, false);
+  _node->SetInverseBindTransform(invBindTransform);
+
+  uint32_t rawCount;
+  if (!_reader.Read(rawCount))
+    return false;
+  for (uint32_t i = 0; i < rawCount; ++i)
+  {
+    std::string sid;
+    uint32_t type;
+    ignition::math::Matrix4d matrix;
+    if (!_reader.Read(sid) || !_reader.Read(type) || !_reader.Read(matrix) ||
+        type > NodeTransform::MATRIX)
+    {
+      return false;
+    }
+    _node->AddRawTransform(NodeTransform(matrix, sid,
+        static_cast<NodeTransform::TransformType>(type)));
+  }
+
+  uint32_t childCount;
+  if (!_reader.Read(childCount))
+    return false;
+  for (uint32_t i = 0; i < childCount; ++i)
+  {
+    SkeletonNode *child;
+    if (!ReadNode(_reader, _node, child))
+      return false;
+  }
+  return true;
+}
+
+/// \brief Delete a skeleton node and its children, SkeletonNode doesn't.
+/// \param[in] _node The node.
+static void DeleteNode(SkeletonNode *_node)
+{
+  for (unsigned int i = 0; i < _node->GetChildCount(); ++i)
+    DeleteNode(_node->GetChild(i));
+  delete _node;
+}
+
+/// \brief Write the content of a mesh.
+/// \param[in] _mesh The mesh.
+/// \param[in,out] _writer Writer.
+static void WriteMesh(const Mesh &_mesh, Writer &_writer)
+{
+  _writer.Write(_mesh.GetPath());
+
+  _writer.Write(static_cast<uint32_t>(_mesh.GetMaterialCount()));
+  for (unsigned int i = 0; i < _mesh.GetMaterialCount(); ++i)
+  {
+    const Material *mat = _mesh.GetMaterial(i);
+    double srcFactor, dstFactor;
+    mat->GetBlendFactors(srcFactor, dstFactor);
+
+    _writer.Write(mat->GetTextureImage());
+    _writer.Write(mat->Ambient());
+    _writer.Write(mat->Diffuse());
+    _writer.Write(mat->Specular());
+    _writer.Write(mat->Emissive());
+    _writer.Write(mat->GetTransparency());
+    _writer.Write(mat->GetShininess());
+    _writer.Write(mat->GetPointSize());
+    _writer.Write(srcFactor);
+    _writer.Write(dstFactor);
+    _writer.Write(static_cast<uint32_t>(mat->GetBlendMode()));
+    _writer.Write(static_cast<uint32_t>(mat->GetShadeMode()));
+    _writer.Write(static_cast<uint8_t>(mat->GetDepthWrite()));
+    _writer.Write(static_cast<uint8_t>(mat->GetLighting()));
+  }
+
+  std::vector<double> coords;
+  _writer.Write(static_cast<uint32_t>(_mesh.GetSubMeshCount()));
+  for (unsigned int i = 0; i < _mesh.GetSubMeshCount(); ++i)
+  {
+    const SubMesh *subMesh = _mesh.GetSubMesh(i);
+    _writer.Write(subMesh->GetName());
+    _writer.Write(static_cast<uint32_t>(subMesh->GetPrimitiveType()));
+    _writer.Write(static_cast<uint32_t>(subMesh->GetMaterialIndex()));
+
+    coords.clear();
+    for (unsigned int j = 0; j < subMesh->GetVertexCount(); ++j)
+    {
+      ignition::math::Vector3d v = subMesh->Vertex(j);
+      coords.insert(coords.end(), {v.X(), v.Y(), v.Z()});
+    }
+    WriteCoords(coords, _writer);
+
+    coords.clear();
+    for (unsigned int j = 0; j < subMesh->GetNormalCount(); ++j)
+    {
+      ignition::math::Vector3d n = subMesh->Normal(j);
+      coords.insert(coords.end(), {n.X(), n.Y(), n.Z()});
+    }
+    WriteCoords(coords, _writer);
+
+    coords.clear();
+    for (unsigned int j = 0; j < subMesh->GetTexCoordCount(); ++j)
+    {
+      ignition::math::Vector2d t = subMesh->TexCoord(j);
+      coords.insert(coords.end(), {t.X(), t.Y()});
+    }
+    WriteCoords(coords, _writer);
+
+    _writer.Write(static_cast<uint32_t>(subMesh->GetIndexCount()));
+    for (unsigned int j = 0; j < subMesh->GetIndexCount(); ++j)
+      _writer.Write(static_cast<uint32_t>(subMesh->GetIndex(j)));
+
+    _writer.Write(static_cast<uint32_t>(subMesh->GetNodeAssignmentsCount()));
+    for (unsigned int j = 0; j < subMesh->GetNodeAssignmentsCount(); ++j)
+    {
+      NodeAssignment na = subMesh->GetNodeAssignment(j);
+      _writer.Write(static_cast<uint32_t>(na.vertexIndex));
+      _writer.Write(static_cast<uint32_t>(na.nodeIndex));
+      _writer.Write(na.weight);
+    }
+  }
+
+  // The raw vertex weights of the skeleton aren't written, the loaders only
+  // use them to build the node assignments of the submeshes.
+  Skeleton *skeleton = _mesh.GetSkeleton();
+  _writer.Write(static_cast<uint8_t>(skeleton && skeleton->GetRootNode()));
+  if (!skeleton || !skeleton->GetRootNode())
+    return;
+
+  _writer.Write(skeleton->BindShapeTransform());
+  WriteNode(skeleton->GetRootNode(), _writer);
+
+  _writer.Write(static_cast<uint32_t>(skeleton->GetNumAnimations()));
+  for (unsigned int i = 0; i < skeleton->GetNumAnimations(); ++i)
+  {
+    SkeletonAnimation *anim = skeleton->GetAnimation(i);
+    _writer.Write(anim->GetName());
+    _writer.Write(static_cast<uint32_t>(anim->GetNodeCount()));
+    for (unsigned int j = 0; j < anim->GetNodeCount(); ++j)
+    {
+      const NodeAnimation *nodeAnim = anim->NodeAnimationByIndex(j);
+      _writer.Write(nodeAnim->GetName());
+      _writer.Write(static_cast<uint32_t>(nodeAnim->GetFrameCount()));
+      for (unsigned int k = 0; k < nodeAnim->GetFrameCount(); ++k)
+      {
+        std::pair<double, ignition::math::Matrix4d> frame =
+            nodeAnim->KeyFrame(k);
+        _writer.Write(frame.first);
+        _writer.Write(frame.second);
+      }
+    }
+  }
+}
+
+/// \brief Read the content of a mesh.
+/// \param[in,out] _reader Reader.
+/// \param[in,out] _mesh The mesh to fill.
+/// \return False if the data is invalid.
+static bool ReadMesh(Reader &_reader, Mesh &_mesh)
+{
+  std::string path;
+  if (!_reader.Read(path))
+    return false;
+  _mesh.SetPath(path);
+
+  uint32_t materialCount;
+  if (!_reader.Read(materialCount))
+    return false;
+  for (uint32_t i = 0; i < materialCount; ++i)
+  {
+    std::string texture;
+    float color[4][4];
+    double transparency, shininess, pointSize, srcFactor, dstFactor;
+    uint32_t blendMode, shadeMode;
+    uint8_t depthWrite, lighting;
+
+    if (!_reader.Read(texture))
+      return false;
+    for (auto &c : color)
+    {
+      for (float &v : c)
+      {
+        if (!_reader.Read(v))
+          return false;
+      }
+    }
+    if (!_reader.Read(transparency) || !_reader.Read(shininess) ||
+        !_reader.Read(pointSize) || !_reader.Read(srcFactor) ||
+        !_reader.Read(dstFactor) || !_reader.Read(blendMode) ||
+        !_reader.Read(shadeMode) || !_reader.Read(depthWrite) ||
+        !_reader.Read(lighting) || blendMode >= Material::BLEND_COUNT ||
+        shadeMode >= Material::SHADE_COUNT)
+    {
+      return false;
+    }
+
+    Material *mat = new Material();
+    mat->SetTextureImage(texture);
+    mat->SetAmbient(ignition::math::Color(
+          color[0][0], color[0][1], color[0][2], color[0][3]));
+    mat->SetDiffuse(ignition::math::Color(
+          color[1][0], color[1][1], color[1][2], color[1][3]));
+    mat->SetSpecular(ignition::math::Color(
+          color[2][0], color[2][1], color[2][2], color[2][3]));
+    mat->SetEmissive(ignition::math::Color(
+          color[3][0], color[3][1], color[3][2], color[3][3]));
+    mat->SetTransparency(transparency);
+    mat->SetShininess(shininess);
+    mat->SetPointSize(pointSize);
+    mat->SetBlendFactors(srcFactor, dstFactor);
+    mat->SetBlendMode(static_cast<Material::BlendMode>(blendMode));
+    mat->SetShadeMode(static_cast<Material::ShadeMode>(shadeMode));
+    mat->SetDepthWrite(depthWrite != 0);
+    mat->SetLighting(lighting != 0);
+    _mesh.AddMaterial(mat);
+  }
+
+  // Number of skeleton nodes the node assignments refer to, checked once
+  // the skeleton is read.
+  uint64_t nodeCount = 0;
+
+  std::vector<double> coords;
+  uint32_t subMeshCount;
+  if (!_reader.Read(subMeshCount))
+    return false;
+  for (uint32_t i = 0; i < subMeshCount; ++i)
+  {
+    SubMesh *subMesh = new SubMesh();
+    _mesh.AddSubMesh(subMesh);
+
+    std::string name;
+    uint32_t primitiveType, materialIndex;
+    // A submesh without material has the largest index.
+    if (!_reader.Read(name) || !_reader.Read(primitiveType) ||
+        !_reader.Read(materialIndex) || primitiveType > SubMesh::TRISTRIPS ||
+        (materialIndex >= materialCount &&
+         materialIndex != std::numeric_limits<uint32_t>::max()))
+    {
+      return false;
+    }
+    subMesh->SetName(name);
+    subMesh->SetPrimitiveType(
+        static_cast<SubMesh::PrimitiveType>(primitiveType));
+    subMesh->SetMaterialIndex(materialIndex);
+
+    if (!ReadCoords(_reader, 3, coords))
+      return false;
+    subMesh->SetVertexCount(coords.size() / 3);
+    for (size_t j = 0; j < coords.size() / 3; ++j)
+    {
+      subMesh->SetVertex(j, ignition::math::Vector3d(
+            coords[j * 3], coords[j * 3 + 1], coords[j * 3 + 2]));
+    }
+
+    if (!ReadCoords(_reader, 3, coords))
+      return false;
+    subMesh->SetNormalCount(coords.size() / 3);
+    for (size_t j = 0; j < coords.size() / 3; ++j)
+    {
+      subMesh->SetNormal(j, ignition::math::Vector3d(
+            coords[j * 3], coords[j * 3 + 1], coords[j * 3 + 2]));
+    }
+
+    if (!ReadCoords(_reader, 2, coords))
+      return false;
+    subMesh->SetTexCoordCount(coords.size() / 2);
+    for (size_t j = 0; j < coords.size() / 2; ++j)
+    {
+      subMesh->SetTexCoord(j, ignition::math::Vector2d(
+            coords[j * 2], coords[j * 2 + 1]));
+    }
+
+    // The renderers and physics engines index the vertices without
+    // checking.
+    const uint32_t vertexCount = subMesh->GetVertexCount();
+    uint32_t count;
+    if (!_reader.ReadCount(sizeof(uint32_t), count))
+      return false;
+    for (uint32_t j = 0; j < count; ++j)
+    {
+      uint32_t index;
+      _reader.Read(index);
+      if (index >= vertexCount)
+        return false;
+      subMesh->AddIndex(index);
+    }
+
+    if (!_reader.ReadCount(2 * sizeof(uint32_t) + sizeof(float), count))
+      return false;
+    for (uint32_t j = 0; j < count; ++j)
+    {
+      uint32_t vertexIndex, nodeIndex;
+      float weight;
+      _reader.Read(vertexIndex);
+      _reader.Read(nodeIndex);
+      _reader.Read(weight);
+      if (vertexIndex >= vertexCount)
+        return false;
+      nodeCount = std::max(nodeCount, uint64_t{nodeIndex} + 1);
+      subMesh->AddNodeAssignment(vertexIndex, nodeIndex, weight);
+    }
+  }
+
+  uint8_t hasSkeleton;
+  if (!_reader.Read(hasSkeleton))
+    return false;
+  if (!hasSkeleton)
+    return nodeCount == 0;
+
+  ignition::math::Matrix4d bindShapeTransform;
+  SkeletonNode *root = nullptr;
+  if (!_reader.Read(bindShapeTransform))
+    return false;
+  if (!ReadNode(_reader, nullptr, root))
+  {
+    if (root)
+      DeleteNode(root);
+    return false;
+  }
+
+  Skeleton *skeleton = new Skeleton(root);
+  skeleton->SetBindShapeTransform(bindShapeTransform);
+  _mesh.SetSkeleton(skeleton);
+  if (nodeCount > skeleton->GetNumNodes())
+    return false;
+
+  uint32_t animCount;
+  if (!_reader.Read(animCount))
+    return false;
+  for (uint32_t i = 0; i < animCount; ++i)
+  {
+    std::string animName;
+    uint32_t nodeCount;
+    if (!_reader.Read(animName) || !_reader.Read(nodeCount))
+      return false;
+
+    SkeletonAnimation *anim = new SkeletonAnimation(animName);
+    skeleton->AddAnimation(anim);
+    for (uint32_t j = 0; j < nodeCount; ++j)
+    {
+      std::string nodeName;
+      uint32_t frameCount;
+      if (!_reader.Read(nodeName) ||
+          !_reader.ReadCount(17 * sizeof(double), frameCount))
+      {
+        return false;
+      }
+      for (uint32_t k = 0; k < frameCount; ++k)
+      {
+        double time;
+        ignition::math::Matrix4d frame;
+        _reader.Read(time);
+        _reader.Read(frame);
+        anim->AddKeyFrame(nodeName, time, frame);
+      }
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+MeshCache::MeshCache(const std::string &_path)
+  : dataPtr(new MeshCachePrivate)
+{
+  this->dataPtr->path = _path;
+}
+
+//////////////////////////////////////////////////
+MeshCache::~MeshCache()
+{
+}
+
+//////////////////////////////////////////////////
+std::string MeshCache::Path() const
+{
+  return this->dataPtr->path;
+}
+
+//////////////////////////////////////////////////
+std::string MeshCache::CacheFilename(const std::string &_filename) const
+{
+  std::ostringstream stream;
+  stream << std::hex << std::setw(16) << std::setfill('0')
+         << Fnv1a(_filename.data(), _filename.size()) << ".gzmesh";
+  return (boost::filesystem::path(this->dataPtr->path) / stream.str()).string();
+}
+
+//////////////////////////////////////////////////
+Mesh *MeshCache::Load(const std::string &_filename) const
+{
+  std::string cacheFilename = this->CacheFilename(_filename);
+  MappedFile file(cacheFilename);
+  if (!file.data)
+    return nullptr;
+
+  // The mesh file comes first, followed by the files it depends on.
+  Reader reader(file.data, file.size);
+  char magic[4];
+  uint32_t version, byteOrder, sourceCount;
+  int64_t savedTime;
+  if (!reader.Read(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) ||
+      !reader.Read(version) || version != kVersion ||
+      !reader.Read(byteOrder) || byteOrder != kByteOrder ||
+      !reader.Read(savedTime) || !reader.Read(sourceCount) ||
+      sourceCount == 0)
+  {
+    return nullptr;
+  }
+
+  for (uint32_t i = 0; i < sourceCount; ++i)
+  {
+    SourceFile source;
+    if (!reader.Read(source.path) || !reader.Read(source.exists) ||
+        !reader.Read(source.mtime) || !reader.Read(source.size) ||
+        !reader.Read(source.hash) ||
+        (i == 0 && source.path != _filename) ||
+        !Unchanged(source, savedTime))
+    {
+      return nullptr;
+    }
+  }
+
+  Mesh *mesh = new Mesh();
+  if (!ReadMesh(reader, *mesh))
+  {
+    gzwarn << "Invalid mesh cache file [" << cacheFilename << "] for ["
+           << _filename << "]\n";
+    delete mesh;
+    return nullptr;
+  }
+
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+bool MeshCache::Save(const std::string &_filename, const Mesh &_mesh) const
+{
+  // Taken before the stamps, so that a file modified while saving is never
+  // trusted on its modification time alone.
+  const int64_t savedTime = static_cast<int64_t>(std::time(nullptr));
+
+  std::vector<SourceFile> sources = {StampSource(_filename)};
+  if (!sources[0].exists)
+    return false;
+  for (const std::string &dependency : Dependencies(_filename))
+    sources.push_back(StampSource(dependency));
+
+  Writer writer;
+  writer.Write(kMagic);
+  writer.Write(kVersion);
+  writer.Write(kByteOrder);
+  writer.Write(savedTime);
+  writer.Write(static_cast<uint32_t>(sources.size()));
+  for (const SourceFile &source : sources)
+  {
+    writer.Write(source.path);
+    writer.Write(source.exists);
+    writer.Write(source.mtime);
+    writer.Write(source.size);
+    writer.Write(source.hash);
+  }
+  WriteMesh(_mesh, writer);
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(this->dataPtr->path, ec);
+  if (ec)
+  {
+    gzwarn << "Unable to create mesh cache directory ["
+           << this->dataPtr->path << "]: " << ec.message() << "\n";
+    return false;
+  }
+
+  // Write to a temporary file and rename it, so that another process never
+  // reads a partial cache file.
+  std::string cacheFilename = this->CacheFilename(_filename);
+  boost::filesystem::path tmpPath = boost::filesystem::unique_path(
+      cacheFilename + ".%%%%-%%%%.tmp");
+  {
+    std::ofstream out(tmpPath.string(), std::ios::binary);
+    out.write(writer.buffer.data(), writer.buffer.size());
+    if (!out)
+    {
+      out.close();
+      boost::filesystem::remove(tmpPath, ec);
+      return false;
+    }
+  }
+
+  boost::filesystem::rename(tmpPath, cacheFilename, ec);
+  if (ec)
+  {
+    boost::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+
+  return true;
+}
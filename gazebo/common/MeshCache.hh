@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_MESHCACHE_HH_
+#define GAZEBO_COMMON_MESHCACHE_HH_
+
+#include <memory>
+#include <string>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace common
+  {
+    class Mesh;
+
+    // Forward declare private data class
+    class MeshCachePrivate;
+
+    /// \addtogroup gazebo_common Common
+    /// \{
+
+    /// \class MeshCache MeshCache.hh common/common.hh
+    /// \brief Binary on-disk cache of loaded meshes. A cache file holds the
+    /// submeshes, materials and skeleton of a mesh file. Vertex data is
+    /// stored as float32 when that is lossless, as for STL files, so that a
+    /// cached mesh is identical to the parsed one. An entry is keyed by the
+    /// path of the mesh file, and is valid while the mesh file and the
+    /// material files of an OBJ file are unchanged: either their
+    /// modification time is unchanged and older than the entry, or their
+    /// content hash is unchanged. Cache files are memory mapped when read,
+    /// so that loading a cached mesh skips parsing the original file.
+    class GZ_COMMON_VISIBLE MeshCache
+    {
+      /// \brief Constructor.
+      /// \param[in] _path Directory holding the cache files, created on
+      /// the first save.
+      public: explicit MeshCache(const std::string &_path);
+
+      /// \brief Destructor.
+      public: ~MeshCache();
+
+      /// \brief Get the directory holding the cache files.
+      /// \return The directory.
+      public: std::string Path() const;
+
+      /// \brief Get the cache file of a mesh file.
+      /// \param[in] _filename Full path of the mesh file.
+      /// \return Full path of the cache file.
+      public: std::string CacheFilename(const std::string &_filename) const;
+
+      /// \brief Load a mesh from the cache.
+      /// \param[in] _filename Full path of the mesh file.
+      /// \return A new mesh, or nullptr if the cache holds no valid entry
+      /// for the file.
+      public: Mesh *Load(const std::string &_filename) const;
+
+      /// \brief Save a mesh to the cache.
+      /// \param[in] _filename Full path of the mesh file the mesh was loaded
+      /// from.
+      /// \param[in] _mesh The mesh.
+      /// \return True if the cache file was written.
+      public: bool Save(const std::string &_filename, const Mesh &_mesh) const;
+
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<MeshCachePrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
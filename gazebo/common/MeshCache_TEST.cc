@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2012 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "test_config.h"
+#include "gazebo/common/ColladaLoader.hh"
+#include "gazebo/common/Material.hh"
+#include "gazebo/common/Mesh.hh"
+#include "gazebo/common/MeshCache.hh"
+#include "gazebo/common/OBJLoader.hh"
+#include "gazebo/common/Skeleton.hh"
+#include "gazebo/common/SkeletonAnimation.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class MeshCacheTest : public gazebo::testing::AutoLogFixture
+{
+  /// \brief Create a temporary directory with a copy of a test mesh.
+  protected: void SetUp() override
+  {
+    gazebo::testing::AutoLogFixture::SetUp();
+
+    this->tmpDir = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("gazebo_mesh_cache_%%%%-%%%%");
+    boost::filesystem::create_directories(this->tmpDir);
+
+    this->meshFile =
+        (this->tmpDir / "box_nested_animation.dae").string();
+    boost::filesystem::copy_file(std::string(PROJECT_SOURCE_PATH) +
+        "/test/data/box_nested_animation.dae", this->meshFile);
+
+    this->cache.reset(
+        new common::MeshCache((this->tmpDir / "cache").string()));
+  }
+
+  /// \brief Remove the temporary directory.
+  protected: void TearDown() override
+  {
+    boost::filesystem::remove_all(this->tmpDir);
+    gazebo::testing::AutoLogFixture::TearDown();
+  }
+
+  /// \brief Temporary directory.
+  public: boost::filesystem::path tmpDir;
+
+  /// \brief Copy of the test mesh.
+  public: std::string meshFile;
+
+  /// \brief Cache under test.
+  public: std::unique_ptr<common::MeshCache> cache;
+};
+
+/////////////////////////////////////////////////
+TEST_F(MeshCacheTest, RoundTrip)
+{
+  EXPECT_EQ(nullptr, this->cache->Load(this->meshFile));
+
+  common::ColladaLoader loader;
+  std::unique_ptr<common::Mesh> mesh(loader.Load(this->meshFile));
+  ASSERT_NE(nullptr, mesh);
+  ASSERT_TRUE(this->cache->Save(this->meshFile, *mesh));
+  EXPECT_TRUE(boost::filesystem::exists(
+      this->cache->CacheFilename(this->meshFile)));
+
+  std::unique_ptr<common::Mesh> cached(this->cache->Load(this->meshFile));
+  ASSERT_NE(nullptr, cached);
+
+  EXPECT_EQ(mesh->GetPath(), cached->GetPath());
+  ASSERT_EQ(mesh->GetSubMeshCount(), cached->GetSubMeshCount());
+  for (unsigned int i = 0; i < mesh->GetSubMeshCount(); ++i)
+  {
+    const common::SubMesh *a = mesh->GetSubMesh(i);
+    const common::SubMesh *b = cached->GetSubMesh(i);
+    EXPECT_EQ(a->GetName(), b->GetName());
+    EXPECT_EQ(a->GetPrimitiveType(), b->GetPrimitiveType());
+    EXPECT_EQ(a->GetMaterialIndex(), b->GetMaterialIndex());
+
+    // Vertex data is identical, not only close.
+    ASSERT_EQ(a->GetVertexCount(), b->GetVertexCount());
+    for (unsigned int j = 0; j < a->GetVertexCount(); ++j)
+      EXPECT_EQ(a->Vertex(j), b->Vertex(j));
+    ASSERT_EQ(a->GetNormalCount(), b->GetNormalCount());
+    for (unsigned int j = 0; j < a->GetNormalCount(); ++j)
+      EXPECT_EQ(a->Normal(j), b->Normal(j));
+    ASSERT_EQ(a->GetTexCoordCount(), b->GetTexCoordCount());
+    for (unsigned int j = 0; j < a->GetTexCoordCount(); ++j)
+      EXPECT_EQ(a->TexCoord(j), b->TexCoord(j));
+    ASSERT_EQ(a->GetIndexCount(), b->GetIndexCount());
+    for (unsigned int j = 0; j < a->GetIndexCount(); ++j)
+      EXPECT_EQ(a->GetIndex(j), b->GetIndex(j));
+
+    ASSERT_EQ(a->GetNodeAssignmentsCount(), b->GetNodeAssignmentsCount());
+    for (unsigned int j = 0; j < a->GetNodeAssignmentsCount(); ++j)
+    {
+      EXPECT_EQ(a->GetNodeAssignment(j).vertexIndex,
+          b->GetNodeAssignment(j).vertexIndex);
+      EXPECT_EQ(a->GetNodeAssignment(j).nodeIndex,
+          b->GetNodeAssignment(j).nodeIndex);
+      EXPECT_EQ(a->GetNodeAssignment(j).weight,
+          b->GetNodeAssignment(j).weight);
+    }
+  }
+
+  ASSERT_EQ(mesh->GetMaterialCount(), cached->GetMaterialCount());
+  for (unsigned int i = 0; i < mesh->GetMaterialCount(); ++i)
+  {
+    const common::Material *a = mesh->GetMaterial(i);
+    const common::Material *b = cached->GetMaterial(i);
+    EXPECT_EQ(a->GetTextureImage(), b->GetTextureImage());
+    EXPECT_EQ(a->Ambient(), b->Ambient());
+    EXPECT_EQ(a->Diffuse(), b->Diffuse());
+    EXPECT_EQ(a->Specular(), b->Specular());
+    EXPECT_EQ(a->Emissive(), b->Emissive());
+    EXPECT_DOUBLE_EQ(a->GetTransparency(), b->GetTransparency());
+    EXPECT_DOUBLE_EQ(a->GetShininess(), b->GetShininess());
+    EXPECT_EQ(a->GetBlendMode(), b->GetBlendMode());
+    EXPECT_EQ(a->GetShadeMode(), b->GetShadeMode());
+    EXPECT_EQ(a->GetLighting(), b->GetLighting());
+  }
+
+  common::Skeleton *skeleton = mesh->GetSkeleton();
+  common::Skeleton *cachedSkeleton = cached->GetSkeleton();
+  ASSERT_NE(nullptr, skeleton);
+  ASSERT_NE(nullptr, cachedSkeleton);
+  EXPECT_EQ(skeleton->BindShapeTransform(),
+      cachedSkeleton->BindShapeTransform());
+  ASSERT_EQ(skeleton->GetNumNodes(), cachedSkeleton->GetNumNodes());
+  for (unsigned int i = 0; i < skeleton->GetNumNodes(); ++i)
+  {
+    common::SkeletonNode *a = skeleton->GetNodeByHandle(i);
+    common::SkeletonNode *b = cachedSkeleton->GetNodeByHandle(i);
+    EXPECT_EQ(a->GetName(), b->GetName());
+    EXPECT_EQ(a->GetId(), b->GetId());
+    EXPECT_EQ(a->IsJoint(), b->IsJoint());
+    EXPECT_EQ(a->Transform(), b->Transform());
+    EXPECT_EQ(a->InverseBindTransform(), b->InverseBindTransform());
+    EXPECT_EQ(a->GetNumRawTrans(), b->GetNumRawTrans());
+  }
+
+  ASSERT_EQ(1u, cachedSkeleton->GetNumAnimations());
+  common::SkeletonAnimation *anim = skeleton->GetAnimation(0);
+  common::SkeletonAnimation *cachedAnim = cachedSkeleton->GetAnimation(0);
+  EXPECT_EQ(anim->GetName(), cachedAnim->GetName());
+  EXPECT_EQ(anim->GetNodeCount(), cachedAnim->GetNodeCount());
+  EXPECT_DOUBLE_EQ(anim->GetLength(), cachedAnim->GetLength());
+  EXPECT_TRUE(cachedAnim->HasNode("Bone"));
+  EXPECT_EQ(anim->PoseAt(0).at("Bone"), cachedAnim->PoseAt(0).at("Bone"));
+  EXPECT_EQ(anim->PoseAt(1.0).at("Bone"),
+      cachedAnim->PoseAt(1.0).at("Bone"));
+}
+
+/////////////////////////////////////////////////
+TEST_F(MeshCacheTest, Invalidation)
+{
+  common::ColladaLoader loader;
+  std::unique_ptr<common::Mesh> mesh(loader.Load(this->meshFile));
+  ASSERT_NE(nullptr, mesh);
+  ASSERT_TRUE(this->cache->Save(this->meshFile, *mesh));
+
+  // A new modification time with the same content is still valid.
+  std::time_t mtime = boost::filesystem::last_write_time(this->meshFile);
+  boost::filesystem::last_write_time(this->meshFile, mtime + 10);
+  std::unique_ptr<common::Mesh> cached(this->cache->Load(this->meshFile));
+  EXPECT_NE(nullptr, cached);
+
+  // Another file with a different path doesn't match the entry.
+  std::string otherFile = (this->tmpDir / "other.dae").string();
+  boost::filesystem::copy_file(this->meshFile, otherFile);
+  cached.reset(this->cache->Load(otherFile));
+  EXPECT_EQ(nullptr, cached);
+
+  // A new content invalidates the entry.
+  {
+    std::ofstream out(this->meshFile, std::ios::app);
+    out << "<!-- modified -->\n";
+  }
+  cached.reset(this->cache->Load(this->meshFile));
+  EXPECT_EQ(nullptr, cached);
+
+  // So does a truncated cache file.
+  ASSERT_TRUE(this->cache->Save(this->meshFile, *mesh));
+  std::string cacheFile = this->cache->CacheFilename(this->meshFile);
+  boost::filesystem::resize_file(cacheFile,
+      boost::filesystem::file_size(cacheFile) / 2);
+  cached.reset(this->cache->Load(this->meshFile));
+  EXPECT_EQ(nullptr, cached);
+}
+
+/////////////////////////////////////////////////
+// A file modified in the second its entry was saved can change again
+// without a new modification time, so its content is checked.
+TEST_F(MeshCacheTest, SameModificationTime)
+{
+  common::ColladaLoader loader;
+  std::unique_ptr<common::Mesh> mesh(loader.Load(this->meshFile));
+  ASSERT_NE(nullptr, mesh);
+
+  // A time in the future can't be older than the entry.
+  std::time_t mtime = std::time(nullptr) + 10;
+  boost::filesystem::last_write_time(this->meshFile, mtime);
+  ASSERT_TRUE(this->cache->Save(this->meshFile, *mesh));
+  std::unique_ptr<common::Mesh> cached(this->cache->Load(this->meshFile));
+  EXPECT_NE(nullptr, cached);
+
+  // Same size and time, new content.
+  std::string content;
+  {
+    std::ifstream in(this->meshFile, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+  }
+  size_t pos = content.find("<asset>");
+  ASSERT_NE(std::string::npos, pos);
+  content.replace(pos, 7, "<ASSET>");
+  {
+    std::ofstream out(this->meshFile, std::ios::binary);
+    out << content;
+  }
+  boost::filesystem::last_write_time(this->meshFile, mtime);
+
+  cached.reset(this->cache->Load(this->meshFile));
+  EXPECT_EQ(nullptr, cached);
+}
+
+/////////////////////////////////////////////////
+// The material file of an OBJ file is part of its entry.
+TEST_F(MeshCacheTest, ObjMaterial)
+{
+  std::string objFile = (this->tmpDir / "box.obj").string();
+  std::string mtlFile = (this->tmpDir / "box.mtl").string();
+  boost::filesystem::copy_file(std::string(PROJECT_SOURCE_PATH) +
+      "/test/data/box.obj", objFile);
+  boost::filesystem::copy_file(std::string(PROJECT_SOURCE_PATH) +
+      "/test/data/box.mtl", mtlFile);
+
+  common::OBJLoader loader;
+  std::unique_ptr<common::Mesh> mesh(loader.Load(objFile));
+  ASSERT_NE(nullptr, mesh);
+  ASSERT_TRUE(this->cache->Save(objFile, *mesh));
+  std::unique_ptr<common::Mesh> cached(this->cache->Load(objFile));
+  EXPECT_NE(nullptr, cached);
+
+  {
+    std::ofstream out(mtlFile, std::ios::app);
+    out << "Kd 1.0 0.0 0.0\n";
+  }
+  cached.reset(this->cache->Load(objFile));
+  EXPECT_EQ(nullptr, cached);
+
+  // Removing the material file invalidates the entry too.
+  ASSERT_TRUE(this->cache->Save(objFile, *mesh));
+  boost::filesystem::remove(mtlFile);
+  cached.reset(this->cache->Load(objFile));
+  EXPECT_EQ(nullptr, cached);
+}
+
+/////////////////////////////////////////////////
+// An entry with indices out of range is rejected, instead of crashing the
+// renderers and physics engines later.
+TEST_F(MeshCacheTest, InvalidIndices)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    common::Mesh mesh;
+    common::SubMesh *subMesh = new common::SubMesh();
+    mesh.AddSubMesh(subMesh);
+    subMesh->AddVertex(0, 0, 0);
+    subMesh->AddVertex(1, 0, 0);
+    subMesh->AddVertex(0, 1, 0);
+    subMesh->AddIndex(0);
+    subMesh->AddIndex(1);
+
+    if (i == 0)
+    {
+      subMesh->AddIndex(3);
+    }
+    else if (i == 1)
+    {
+      // No material.
+      subMesh->AddIndex(2);
+      subMesh->SetMaterialIndex(0);
+    }
+    else if (i == 2)
+    {
+      // No skeleton.
+      subMesh->AddIndex(2);
+      subMesh->AddNodeAssignment(0, 0, 1.0f);
+    }
+    else
+    {
+      subMesh->AddIndex(2);
+    }
+
+    ASSERT_TRUE(this->cache->Save(this->meshFile, mesh));
+    std::unique_ptr<common::Mesh> cached(this->cache->Load(this->meshFile));
+    if (i < 3)
+    {
+      EXPECT_EQ(nullptr, cached) << i;
+    }
+    else
+    {
+      ASSERT_NE(nullptr, cached);
+      EXPECT_EQ(3u, cached->GetSubMesh(0)->GetIndexCount());
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,13 +16,19 @@
  */
 
 #include <sys/stat.h>
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <map>
+#include <mutex>
+
+#include <boost/thread/recursive_mutex.hpp>
 
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/Exception.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Mesh.hh"
+#include "gazebo/common/MeshCache.hh"
 #include "gazebo/common/ColladaLoader.hh"
 #include "gazebo/common/ColladaExporter.hh"
 #include "gazebo/common/STLLoader.hh"
@@ -56,20 +62,23 @@ class MeshManagerPrivate
   // \todo The FBX loader needs to be implemented.
   // public: FBXLoader *fbxLoader = nullptr;
 
+  /// \brief On-disk cache of loaded mesh files, null if disabled.
+  public: std::unique_ptr<MeshCache> meshCache;
+
   /// \brief Dictionary of meshes, indexed by name
   public: std::map<std::string, Mesh*> meshes;
 
   /// \brief supported file extensions for meshes
   public: std::vector<std::string> fileExtensions;
 
-  /// \brief Mutex to protect from loading the same mesh in different threads
-  /// at the same time.
-  public: boost::mutex mutex;
-};
+  /// \brief Per file mutexes of the meshes being loaded, to prevent
+  /// loading the same mesh in different threads at the same time.
+  public: std::map<std::string, std::shared_ptr<std::mutex>> loading;
 
-// added here for ABI compatibility
-// TODO move to header / private class when merging forward.
-static OBJLoader objLoader;
+  /// \brief Mutex to protect meshes and loading. Recursive because
+  /// functions holding it call HasMesh.
+  public: boost::recursive_mutex mutex;
+};
 
 //////////////////////////////////////////////////
 MeshManager::MeshManager()
@@ -79,6 +88,18 @@ MeshManager::MeshManager()
   this->dataPtr->colladaExporter = new ColladaExporter();
   this->dataPtr->stlLoader = new STLLoader();
 
+  // GAZEBO_MESH_CACHE_PATH overrides the location of the mesh cache, set to
+  // an empty string it disables the cache.
+  const char *cachePath = getenv("GAZEBO_MESH_CACHE_PATH");
+  const char *homePath = getenv("HOME");
+  std::string meshCachePath;
+  if (cachePath)
+    meshCachePath = cachePath;
+  else if (homePath)
+    meshCachePath = std::string(homePath) + "/.gazebo/mesh_cache";
+  if (!meshCachePath.empty())
+    this->dataPtr->meshCache.reset(new MeshCache(meshCachePath));
+
   // Create some basic shapes
   this->CreatePlane("unit_plane",
       ignition::math::Planed(
@@ -138,77 +159,109 @@ const Mesh *MeshManager::Load(const std::string &_filename)
     return nullptr;
   }
 
-  Mesh *mesh = nullptr;
+  // Lookup under the lock, the map may be written by another thread that
+  // is loading a different mesh.
+  {
+    boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
+    auto iter = this->dataPtr->meshes.find(_filename);
+    if (iter != this->dataPtr->meshes.end())
+      return iter->second;
+  }
 
-  std::string extension;
+  std::string fullname = common::find_file(_filename);
+  if (fullname.empty())
+  {
+    gzerr << "Unable to find file[" << _filename << "]\n";
+    return nullptr;
+  }
 
-  if (this->HasMesh(_filename))
+  std::string extension = fullname.substr(fullname.rfind(".")+1,
+      fullname.size());
+  std::transform(extension.begin(), extension.end(),
+      extension.begin(), ::tolower);
+
+  // Loaders keep state while parsing, so each call uses its own and
+  // different meshes can be parsed at the same time.
+  std::unique_ptr<MeshLoader> loader;
+  if (extension == "stl" || extension == "stlb" || extension == "stla")
+    loader.reset(new STLLoader());
+  else if (extension == "dae")
+    loader.reset(new ColladaLoader());
+  else if (extension == "obj")
+    loader.reset(new OBJLoader());
+  else
   {
-    return this->dataPtr->meshes[_filename];
-
-    // This breaks trimesh geom. Each new trimesh should have a unique name.
-    /*
-    // erase mesh from this->dataPtr->meshes.
-    // This allows a mesh to be modified and
-    // inserted into gazebo again without closing gazebo.
-    std::map<std::string, Mesh*>::iterator iter;
-    iter = this->dataPtr->meshes.find(_filename);
-    delete iter->second;
-    iter->second = nullptr;
-    this->dataPtr->meshes.erase(iter);
-    */
+    gzerr << "Unsupported mesh format for file[" << _filename << "]\n";
+    return nullptr;
   }
 
-  std::string fullname = common::find_file(_filename);
+  // This mutex prevents two threads from loading the same mesh at the
+  // same time. The second one waits and gets the mesh of the first one.
+  // Only files that can be loaded get one, and each exit path below erases
+  // it.
+  std::shared_ptr<std::mutex> fileMutex;
+  {
+    boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
+    std::shared_ptr<std::mutex> &entry = this->dataPtr->loading[_filename];
+    if (!entry)
+      entry = std::make_shared<std::mutex>();
+    fileMutex = entry;
+  }
 
-  if (!fullname.empty())
+  std::lock_guard<std::mutex> fileLock(*fileMutex);
   {
-    extension = fullname.substr(fullname.rfind(".")+1, fullname.size());
-    std::transform(extension.begin(), extension.end(),
-        extension.begin(), ::tolower);
-    MeshLoader *loader = nullptr;
-
-    if (extension == "stl" || extension == "stlb" || extension == "stla")
-      loader = this->dataPtr->stlLoader;
-    else if (extension == "dae")
-      loader = this->dataPtr->colladaLoader;
-    else if (extension == "obj")
-      loader = &objLoader;
-    else
+    boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
+    auto iter = this->dataPtr->meshes.find(_filename);
+    if (iter != this->dataPtr->meshes.end())
     {
-      gzerr << "Unsupported mesh format for file[" << _filename << "]\n";
-      return nullptr;
+      this->dataPtr->loading.erase(_filename);
+      return iter->second;
     }
+  }
+
+  Mesh *mesh = nullptr;
+  try
+  {
+    if (this->dataPtr->meshCache)
+      mesh = this->dataPtr->meshCache->Load(fullname);
 
-    try
+    if (!mesh && (mesh = loader->Load(fullname)) != nullptr &&
+        this->dataPtr->meshCache)
     {
-      // This mutex prevents two threads from loading the same mesh at the
-      // same time.
-      boost::mutex::scoped_lock lock(this->dataPtr->mutex);
-      if (!this->HasMesh(_filename))
-      {
-        if ((mesh = loader->Load(fullname)) != nullptr)
-        {
-          mesh->SetName(_filename);
-          this->dataPtr->meshes.insert(std::make_pair(_filename, mesh));
-        }
-        else
-          gzerr << "Unable to load mesh[" << fullname << "]\n";
-      }
-      else
-      {
-        mesh = this->dataPtr->meshes[_filename];
-      }
+      this->dataPtr->meshCache->Save(fullname, *mesh);
     }
-    catch(gazebo::common::Exception &e)
+  }
+  catch(gazebo::common::Exception &e)
+  {
+    gzerr << "Error loading mesh[" << fullname << "]\n";
+    gzerr << e << "\n";
     {
-      gzerr << "Error loading mesh[" << fullname << "]\n";
-      gzerr << e << "\n";
-      gzthrow(e);
+      boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
+      this->dataPtr->loading.erase(_filename);
     }
+    gzthrow(e);
   }
-  else
-    gzerr << "Unable to find file[" << _filename << "]\n";
+
+  boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
+  this->dataPtr->loading.erase(_filename);
+
+  if (!mesh)
+  {
+    gzerr << "Unable to load mesh[" << fullname << "]\n";
+    return nullptr;
+  }
+
+  // A thread that waited on a mutex erased from loading may have loaded
+  // the same file meanwhile.
+  auto iter = this->dataPtr->meshes.find(_filename);
+  if (iter != this->dataPtr->meshes.end())
+  {
+    delete mesh;
+    return iter->second;
+  }
+
+  mesh->SetName(_filename);
+  this->dataPtr->meshes.insert(std::make_pair(_filename, mesh));
 
   return mesh;
 }
@@ -264,6 +317,7 @@ void MeshManager::GenSphericalTexCoord(const Mesh *_mesh,
 //////////////////////////////////////////////////
 void MeshManager::AddMesh(Mesh *_mesh)
 {
+  boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
   if (!this->HasMesh(_mesh->GetName()))
     this->dataPtr->meshes[_mesh->GetName()] = _mesh;
 }
@@ -271,6 +325,7 @@ void MeshManager::AddMesh(Mesh *_mesh)
 //////////////////////////////////////////////////
 const Mesh *MeshManager::GetMesh(const std::string &_name) const
 {
+  boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
   std::map<std::string, Mesh*>::const_iterator iter;
 
   iter = this->dataPtr->meshes.find(_name);
@@ -287,6 +342,7 @@ bool MeshManager::HasMesh(const std::string &_name) const
   if (_name.empty())
     return false;
 
+  boost::recursive_mutex::scoped_lock lock(this->dataPtr->mutex);
   std::map<std::string, Mesh*>::const_iterator iter;
   iter = this->dataPtr->meshes.find(_name);
 
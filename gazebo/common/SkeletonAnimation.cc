@@ -15,6 +15,8 @@
  *
 */
 
+#include <iterator>
+
 #include "gazebo/common/SkeletonAnimation.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Assert.hh"
@@ -234,6 +236,18 @@ unsigned int SkeletonAnimation::GetNodeCount() const
   return this->animations.size();
 }
 
+//////////////////////////////////////////////////
+const NodeAnimation *SkeletonAnimation::NodeAnimationByIndex(
+    const unsigned int _i) const
+{
+  if (_i >= this->animations.size())
+    return nullptr;
+
+  auto iter = this->animations.begin();
+  std::advance(iter, _i);
+  return iter->second;
+}
+
 //////////////////////////////////////////////////
 bool SkeletonAnimation::HasNode(const std::string& _node) const
 {
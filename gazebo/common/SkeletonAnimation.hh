@@ -145,6 +145,12 @@ namespace gazebo
       /// \return the count
       public: unsigned int GetNodeCount() const;
 
+      /// \brief Returns a node animation
+      /// \param[in] _i the index of the node animation, in name order
+      /// \return the node animation, or nullptr if _i is out of bounds
+      public: const NodeAnimation *NodeAnimationByIndex(
+                  const unsigned int _i) const;
+
       /// \brief Looks for a node with a specific name in the animations
       /// \param[in] _node the name of the node
       /// \return true if the node exits
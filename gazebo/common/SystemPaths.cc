@@ -17,7 +17,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 #include <ignition/common/StringUtils.hh>
@@ -56,6 +60,98 @@ char pathDelimiter()
 /// TODO(chapulina): Move to member variable when porting forward
 std::vector<std::function<std::string (const std::string &)>> g_findFileCbs;
 
+/// \brief Cache of the paths found by FindFile, and index of the entries
+/// of the model paths.
+/// TODO Move to member variable when porting forward
+struct FindFileCache
+{
+  /// \brief Protects the members below.
+  std::mutex mutex;
+
+  /// \brief Found paths, by working directory and file name.
+  std::unordered_map<std::string, std::string> paths;
+
+  /// \brief Entries of the model paths, by model path.
+  std::map<std::string, std::set<std::string>> modelPathIndex;
+
+  /// \brief Incremented when the cache is cleared, so that a search that
+  /// started before doesn't add a stale path.
+  uint64_t generation = 0;
+
+  /// \brief True to cache found paths.
+  bool enabled = true;
+
+  /// \brief True to use modelPathIndex.
+  bool indexEnabled = true;
+
+  /// \brief Number of lookups answered by the cache.
+  uint64_t hits = 0;
+
+  /// \brief Number of lookups that searched the file system.
+  uint64_t misses = 0;
+};
+
+/// \brief Get the cache of FindFile.
+/// \return The cache.
+static FindFileCache &findFileCache()
+{
+  static FindFileCache cache;
+  return cache;
+}
+
+/// \brief Clear the cache of FindFile, called when search paths change.
+static void clearFindFileCache()
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.paths.clear();
+  cache.modelPathIndex.clear();
+  ++cache.generation;
+}
+
+/// \brief Get whether a model path holds an entry according to the index,
+/// listing the model path the first time.
+/// \param[in] _modelPath The model path.
+/// \param[in] _entry Name of the entry, such as a model name.
+/// \return True if the entry was listed, or if the index is disabled.
+static bool modelPathHasEntry(const std::string &_modelPath,
+    const std::string &_entry)
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (!cache.indexEnabled)
+    return true;
+
+  auto iter = cache.modelPathIndex.find(_modelPath);
+  if (iter == cache.modelPathIndex.end())
+  {
+    std::set<std::string> &entries = cache.modelPathIndex[_modelPath];
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator dirIter(_modelPath, ec);
+         !ec && dirIter != boost::filesystem::directory_iterator();
+         dirIter.increment(ec))
+    {
+      entries.insert(dirIter->path().filename().string());
+    }
+    return entries.count(_entry) > 0;
+  }
+
+  return iter->second.count(_entry) > 0;
+}
+
+/// \brief Add an entry found in a model path after it was listed.
+/// \param[in] _modelPath The model path.
+/// \param[in] _entry Name of the entry.
+static void addModelPathEntry(const std::string &_modelPath,
+    const std::string &_entry)
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto iter = cache.modelPathIndex.find(_modelPath);
+  if (iter != cache.modelPathIndex.end())
+    iter->second.insert(_entry);
+}
+
 //////////////////////////////////////////////////
 SystemPaths::SystemPaths()
 {
@@ -315,15 +411,27 @@ std::string SystemPaths::FindFileURI(const std::string &_uri)
   // paths
   if (prefix == "model")
   {
+    // The first pass checks the model paths that hold the model according
+    // to the index. The second pass checks the others, in case the model
+    // was added after the index was built.
+    std::string modelName = suffix.substr(0, suffix.find('/'));
     boost::filesystem::path path;
-    for (std::list<std::string>::iterator iter = this->modelPaths.begin();
-         iter != this->modelPaths.end(); ++iter)
+    for (int pass = 0; pass < 2 && filename.empty(); ++pass)
     {
-      path = boost::filesystem::path(*iter) / suffix;
-      if (boost::filesystem::exists(path))
+      for (std::list<std::string>::iterator iter = this->modelPaths.begin();
+           iter != this->modelPaths.end(); ++iter)
       {
-        filename = path.string();
-        break;
+        if (modelPathHasEntry(*iter, modelName) != (pass == 0))
+          continue;
+
+        path = boost::filesystem::path(*iter) / suffix;
+        if (boost::filesystem::exists(path))
+        {
+          filename = path.string();
+          if (pass == 1)
+            addModelPathEntry(*iter, modelName);
+          break;
+        }
       }
     }
 
@@ -350,10 +458,55 @@ static bool isAbsolute(const std::string &_filename)
 std::string SystemPaths::FindFile(const std::string &_filename,
                                   bool _searchLocalPath)
 {
-  boost::filesystem::path path;
-
   if (_filename.empty())
-    return path.string();
+    return std::string();
+
+  // Pick up changes of GAZEBO_RESOURCE_PATH, which clear the cache.
+  if (this->gazeboPathsFromEnv)
+    this->UpdateGazeboPaths();
+
+  // Relative file names may be found in the working directory.
+  std::string key = _searchLocalPath ? "1" : "0";
+  if (_filename.find("://") == std::string::npos && !isAbsolute(_filename))
+  {
+    boost::system::error_code ec;
+    key += boost::filesystem::current_path(ec).string();
+  }
+  key += '\n' + _filename;
+
+  FindFileCache &cache = findFileCache();
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.enabled)
+    {
+      auto iter = cache.paths.find(key);
+      if (iter != cache.paths.end())
+      {
+        ++cache.hits;
+        return iter->second;
+      }
+    }
+    ++cache.misses;
+    generation = cache.generation;
+  }
+
+  // The search may call FindFile again, e.g. for file:// URIs, so it runs
+  // without holding the lock.
+  std::string result = this->FindFileUncached(_filename, _searchLocalPath);
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.enabled && !result.empty() && generation == cache.generation)
+    cache.paths[key] = result;
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+std::string SystemPaths::FindFileUncached(const std::string &_filename,
+                                          bool _searchLocalPath)
+{
+  boost::filesystem::path path;
 
   // Handle as URI
   if (_filename.find("://") != std::string::npos)
@@ -475,6 +628,7 @@ void SystemPaths::AddFindFileCallback(
 void SystemPaths::ClearGazeboPaths()
 {
   this->gazeboPaths.clear();
+  clearFindFileCache();
 }
 
 /////////////////////////////////////////////////
@@ -493,6 +647,7 @@ void SystemPaths::ClearPluginPaths()
 void SystemPaths::ClearModelPaths()
 {
   this->modelPaths.clear();
+  clearFindFileCache();
 }
 
 /////////////////////////////////////////////////
@@ -559,7 +714,10 @@ void SystemPaths::InsertUnique(const std::string &_path,
                                std::list<std::string> &_list)
 {
   if (std::find(_list.begin(), _list.end(), _path) == _list.end())
+  {
     _list.push_back(_path);
+    clearFindFileCache();
+  }
 }
 
 /////////////////////////////////////////////////
@@ -576,4 +734,71 @@ void SystemPaths::AddSearchPathSuffix(const std::string &_suffix)
     s += "/";
 
   this->suffixPaths.push_back(s);
+  clearFindFileCache();
+}
+
+/////////////////////////////////////////////////
+void SystemPaths::SetFindFileCacheEnabled(const bool _enabled)
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.enabled = _enabled;
+  if (!_enabled)
+    cache.paths.clear();
+}
+
+/////////////////////////////////////////////////
+bool SystemPaths::FindFileCacheEnabled() const
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.enabled;
+}
+
+/////////////////////////////////////////////////
+void SystemPaths::SetModelPathIndexEnabled(const bool _enabled)
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.indexEnabled = _enabled;
+  cache.modelPathIndex.clear();
+}
+
+/////////////////////////////////////////////////
+bool SystemPaths::ModelPathIndexEnabled() const
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.indexEnabled;
+}
+
+/////////////////////////////////////////////////
+void SystemPaths::ClearFindFileCache()
+{
+  clearFindFileCache();
+}
+
+/////////////////////////////////////////////////
+uint64_t SystemPaths::FindFileCacheHits() const
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.hits;
+}
+
+/////////////////////////////////////////////////
+uint64_t SystemPaths::FindFileCacheMisses() const
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.misses;
+}
+
+/////////////////////////////////////////////////
+void SystemPaths::ResetFindFileCacheStats()
+{
+  FindFileCache &cache = findFileCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.hits = 0;
+  cache.misses = 0;
 }
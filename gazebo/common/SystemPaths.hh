@@ -29,6 +29,7 @@
 #endif
 
 #include <boost/filesystem.hpp>
+#include <cstdint>
 #include <list>
 #include <string>
 
@@ -116,6 +117,47 @@ namespace gazebo
       public: std::string FindFile(const std::string &_filename,
                                    bool _searchLocalPath = true);
 
+      /// \brief Enable or disable the cache of FindFile. The cache keeps the
+      /// paths found by FindFile, so that looking up a file again doesn't
+      /// touch the file system. It is cleared when search paths are added
+      /// or cleared, including paths read from GAZEBO_RESOURCE_PATH and
+      /// GAZEBO_MODEL_PATH. Files that are not found are not cached.
+      /// Enabled by default.
+      /// \param[in] _enabled True to cache found paths.
+      public: void SetFindFileCacheEnabled(const bool _enabled);
+
+      /// \brief Get whether the cache of FindFile is enabled.
+      /// \return True if found paths are cached.
+      public: bool FindFileCacheEnabled() const;
+
+      /// \brief Enable or disable the index of the model paths. The index
+      /// holds the entries of each model path, listed once, so that
+      /// FindFileURI only checks the model paths that hold the requested
+      /// model. Models added to a model path after it was listed are still
+      /// found. Enabled by default.
+      /// \param[in] _enabled True to use the index.
+      public: void SetModelPathIndexEnabled(const bool _enabled);
+
+      /// \brief Get whether the index of the model paths is enabled.
+      /// \return True if the index is used.
+      public: bool ModelPathIndexEnabled() const;
+
+      /// \brief Clear the cache of FindFile and the index of the model
+      /// paths, e.g. after files were moved or deleted.
+      public: void ClearFindFileCache();
+
+      /// \brief Get the number of FindFile calls answered by the cache.
+      /// \return Number of hits.
+      public: uint64_t FindFileCacheHits() const;
+
+      /// \brief Get the number of FindFile calls that searched the file
+      /// system.
+      /// \return Number of misses.
+      public: uint64_t FindFileCacheMisses() const;
+
+      /// \brief Reset the hit and miss counts of the cache of FindFile.
+      public: void ResetFindFileCacheStats();
+
       /// \brief Add a callback to use when Gazebo can't find a file.
       /// The callback should return a full local path to the requested file, or
       /// and empty string if the file was not found in the callback.
@@ -163,6 +205,14 @@ namespace gazebo
       /// \param[in] _suffix The suffix to add
       public: void AddSearchPathSuffix(const std::string &_suffix);
 
+      /// \brief Search the file system for a file, see FindFile.
+      /// \param[in] _filename Name of the file to find.
+      /// \param[in] _searchLocalPath True to search in the current working
+      /// directory.
+      /// \return Full path name to the file, or an empty string.
+      private: std::string FindFileUncached(const std::string &_filename,
+                                            bool _searchLocalPath);
+
       /// \brief re-read SystemPaths#gazeboPaths from environment variable
       private: void UpdateModelPaths();
 
@@ -16,6 +16,9 @@
 */
 #include <gtest/gtest.h>
 
+#include <boost/filesystem.hpp>
+
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -90,6 +93,64 @@ TEST_F(SystemPathsTest, FindFile)
   }
 }
 
+//////////////////////////////////////////////////
+TEST_F(SystemPathsTest, FindFileCache)
+{
+  auto sysPaths = common::SystemPaths::Instance();
+  EXPECT_TRUE(sysPaths->FindFileCacheEnabled());
+  EXPECT_TRUE(sysPaths->ModelPathIndexEnabled());
+
+  boost::filesystem::path root = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("gazebo_find_file_%%%%-%%%%");
+  boost::filesystem::create_directories(root / "models_a" / "model_a");
+  boost::filesystem::create_directories(root / "models_b");
+  std::ofstream((root / "models_a" / "model_a" / "model.config").string());
+
+  sysPaths->AddModelPaths((root / "models_a").string() + ":" +
+      (root / "models_b").string());
+  sysPaths->ResetFindFileCacheStats();
+
+  // The second lookup is answered by the cache.
+  const std::string configA =
+      (root / "models_a" / "model_a" / "model.config").string();
+  EXPECT_EQ(configA, sysPaths->FindFile("model://model_a/model.config"));
+  EXPECT_EQ(1u, sysPaths->FindFileCacheMisses());
+  EXPECT_EQ(0u, sysPaths->FindFileCacheHits());
+  EXPECT_EQ(configA, sysPaths->FindFile("model://model_a/model.config"));
+  EXPECT_EQ(1u, sysPaths->FindFileCacheMisses());
+  EXPECT_EQ(1u, sysPaths->FindFileCacheHits());
+
+  // A model added after the model paths were indexed is found.
+  boost::filesystem::create_directories(root / "models_b" / "model_b");
+  std::ofstream((root / "models_b" / "model_b" / "model.config").string());
+  const std::string configB =
+      (root / "models_b" / "model_b" / "model.config").string();
+  EXPECT_EQ(configB, sysPaths->FindFile("model://model_b/model.config"));
+
+  // Adding a model path clears the cache, a model in the new path is found
+  // even if it shadows a cached one.
+  boost::filesystem::create_directories(root / "models_c" / "model_a");
+  std::ofstream((root / "models_c" / "model_a" / "model.config").string());
+  sysPaths->ClearModelPaths();
+  sysPaths->AddModelPaths((root / "models_c").string());
+  sysPaths->ResetFindFileCacheStats();
+  EXPECT_EQ((root / "models_c" / "model_a" / "model.config").string(),
+      sysPaths->FindFile("model://model_a/model.config"));
+  EXPECT_EQ(0u, sysPaths->FindFileCacheHits());
+
+  // Disabled cache
+  sysPaths->SetFindFileCacheEnabled(false);
+  sysPaths->ResetFindFileCacheStats();
+  sysPaths->FindFile("model://model_a/model.config");
+  sysPaths->FindFile("model://model_a/model.config");
+  EXPECT_EQ(0u, sysPaths->FindFileCacheHits());
+  EXPECT_EQ(2u, sysPaths->FindFileCacheMisses());
+  sysPaths->SetFindFileCacheEnabled(true);
+
+  sysPaths->ClearModelPaths();
+  boost::filesystem::remove_all(root);
+}
+
 //////////////////////////////////////////////////
 TEST_F(SystemPathsTest, SystemPaths)
 {
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
+#include <atomic>
+#include <set>
+
+#include "gazebo/common/CommonIface.hh"
+#include "gazebo/common/Console.hh"
+#include "gazebo/common/Exception.hh"
+#include "gazebo/common/HeightmapData.hh"
+#include "gazebo/common/MeshManager.hh"
+#include "gazebo/common/SystemPaths.hh"
+#include "gazebo/physics/AssetPrefetcher.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+/// \brief Collect the files of the meshes and heightmaps used by the
+/// collisions of an element and its descendants.
+/// \param[in] _elem The element.
+/// \param[in,out] _meshes Full paths of the meshes to load.
+/// \param[in,out] _heightmaps Full paths of the heightmaps to load.
+static void CollectAssets(const sdf::ElementPtr &_elem,
+    std::set<std::string> &_meshes, std::set<std::string> &_heightmaps)
+{
+  if (_elem->GetName() == "collision")
+  {
+    if (!_elem->HasElement("geometry"))
+      return;
+
+    sdf::ElementPtr geomElem = _elem->GetElement("geometry");
+    if (geomElem->HasElement("mesh"))
+    {
+      // Resolve the file the way MeshShape::Init does, so that the mesh is
+      // stored under the name MeshShape looks up.
+      sdf::ElementPtr meshElem = geomElem->GetElement("mesh");
+      std::string uri = common::asFullPath(meshElem->Get<std::string>("uri"),
+          meshElem->FilePath());
+      common::MeshManager *meshManager = common::MeshManager::Instance();
+      if (meshManager->HasMesh(uri))
+        return;
+
+      std::string filename = common::find_file(uri);
+      if (!filename.empty() && filename != "__default__" &&
+          meshManager->IsValidFilename(filename) &&
+          !meshManager->HasMesh(filename))
+      {
+        _meshes.insert(filename);
+      }
+    }
+    else if (geomElem->HasElement("heightmap"))
+    {
+      std::string filename = common::find_file(
+          geomElem->GetElement("heightmap")->Get<std::string>("uri"));
+      if (!filename.empty())
+        _heightmaps.insert(filename);
+    }
+    return;
+  }
+
+  // The content of plugins is free form.
+  if (_elem->GetName() == "plugin")
+    return;
+
+  for (sdf::ElementPtr child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    CollectAssets(child, _meshes, _heightmaps);
+  }
+}
+
+//////////////////////////////////////////////////
+AssetPrefetcher::~AssetPrefetcher()
+{
+  this->Clear();
+}
+
+//////////////////////////////////////////////////
+unsigned int AssetPrefetcher::Prefetch(
+    const std::vector<sdf::ElementPtr> &_elems)
+{
+  if (!this->Enabled())
+    return 0;
+
+  // Resolving file names may download models from the model database, it
+  // stays in this thread.
+  std::set<std::string> meshSet;
+  std::set<std::string> heightmapSet;
+  for (auto const &elem : _elems)
+  {
+    if (elem)
+      CollectAssets(elem, meshSet, heightmapSet);
+  }
+
+  if (meshSet.empty() && heightmapSet.empty())
+    return 0;
+
+  // The loaders find the files again, make sure the search paths are set
+  // before they are read from several threads.
+  common::SystemPaths::Instance()->GetGazeboPaths();
+
+  std::vector<std::string> meshes(meshSet.begin(), meshSet.end());
+  std::atomic<unsigned int> loaded(0);
+
+  // Heightmaps are loaded one after the other, in a single task, since the
+  // image and DEM libraries are not known to be thread safe. Meshes are
+  // loaded in parallel with them.
+  tbb::task_group group;
+  group.run([this, &heightmapSet, &loaded]()
+  {
+    for (auto const &filename : heightmapSet)
+    {
+      common::HeightmapData *data =
+          common::HeightmapDataLoader::LoadTerrainFile(filename);
+      if (!data)
+        continue;
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto iter = this->heightmaps.find(filename);
+      if (iter != this->heightmaps.end())
+        delete iter->second;
+      this->heightmaps[filename] = data;
+      ++loaded;
+    }
+  });
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, meshes.size(), 1),
+      [&meshes, &loaded](const tbb::blocked_range<size_t> &_r)
+  {
+    for (size_t i = _r.begin(); i != _r.end(); ++i)
+    {
+      try
+      {
+        if (common::MeshManager::Instance()->Load(meshes[i]))
+          ++loaded;
+      }
+      catch(common::Exception &)
+      {
+        // MeshShape loads the mesh again, and handles the error.
+      }
+    }
+  });
+
+  group.wait();
+
+  gzdbg << "Prefetched " << loaded << " of "
+        << meshes.size() + heightmapSet.size() << " assets\n";
+
+  return loaded;
+}
+
+//////////////////////////////////////////////////
+common::HeightmapData *AssetPrefetcher::TakeHeightmap(
+    const std::string &_filename)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto iter = this->heightmaps.find(_filename);
+  if (iter == this->heightmaps.end())
+    return nullptr;
+
+  common::HeightmapData *data = iter->second;
+  this->heightmaps.erase(iter);
+  return data;
+}
+
+//////////////////////////////////////////////////
+void AssetPrefetcher::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (auto &iter : this->heightmaps)
+    delete iter.second;
+  this->heightmaps.clear();
+}
+
+//////////////////////////////////////////////////
+void AssetPrefetcher::SetEnabled(const bool _enabled)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->enabled = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool AssetPrefetcher::Enabled() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->enabled;
+}
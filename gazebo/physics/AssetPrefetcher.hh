@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_ASSETPREFETCHER_HH_
+#define GAZEBO_PHYSICS_ASSETPREFETCHER_HH_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sdf/sdf.hh>
+
+#include "gazebo/common/SingletonT.hh"
+#include "gazebo/util/system.hh"
+
+/// \brief Explicit instantiation for typed SingletonT.
+GZ_SINGLETON_DECLARE(GZ_PHYSICS_VISIBLE, gazebo, physics, AssetPrefetcher)
+
+namespace gazebo
+{
+  namespace common
+  {
+    class HeightmapData;
+  }
+
+  namespace physics
+  {
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class AssetPrefetcher AssetPrefetcher.hh physics/physics.hh
+    /// \brief Loads the meshes and heightmaps used by the collisions of an
+    /// SDF tree in parallel, before the entities of the tree are created
+    /// one after the other. Meshes end up in common::MeshManager, where
+    /// MeshShape finds them. Heightmaps are kept until a HeightmapShape
+    /// takes them, or until Clear is called.
+    class GZ_PHYSICS_VISIBLE AssetPrefetcher
+      : public SingletonT<AssetPrefetcher>
+    {
+      /// \brief Load the assets used by the collisions of SDF elements.
+      /// File names are resolved in the calling thread, the files are
+      /// loaded on the TBB thread pool. Assets that fail to load are
+      /// skipped, the shapes that use them report the error when they load
+      /// them again.
+      /// \param[in] _elems Elements to search, such as worlds or models.
+      /// \return Number of assets loaded.
+      public: unsigned int Prefetch(const std::vector<sdf::ElementPtr> &_elems);
+
+      /// \brief Take a prefetched heightmap.
+      /// \param[in] _filename Full path of the heightmap file.
+      /// \return The heightmap, owned by the caller, or nullptr if it was
+      /// not prefetched.
+      public: common::HeightmapData *TakeHeightmap(
+                  const std::string &_filename);
+
+      /// \brief Delete the heightmaps that were not taken.
+      public: void Clear();
+
+      /// \brief Enable or disable prefetching. When disabled, Prefetch does
+      /// nothing. Enabled by default.
+      /// \param[in] _enabled True to prefetch assets.
+      public: void SetEnabled(const bool _enabled);
+
+      /// \brief Get whether prefetching is enabled.
+      /// \return True if assets are prefetched.
+      public: bool Enabled() const;
+
+      /// \brief Constructor.
+      private: AssetPrefetcher() = default;
+
+      /// \brief Destructor.
+      private: virtual ~AssetPrefetcher();
+
+      /// \brief Protects the members below.
+      private: mutable std::mutex mutex;
+
+      /// \brief Prefetched heightmaps, by full path.
+      private: std::map<std::string, common::HeightmapData *> heightmaps;
+
+      /// \brief True to prefetch assets.
+      private: bool enabled = true;
+
+      /// \brief This is a singleton.
+      private: friend class SingletonT<AssetPrefetcher>;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "test_config.h"
+#include "test/util.hh"
+#include "gazebo/common/HeightmapData.hh"
+#include "gazebo/common/MeshManager.hh"
+#include "gazebo/physics/AssetPrefetcher.hh"
+
+using namespace gazebo;
+
+class AssetPrefetcherTest : public gazebo::testing::AutoLogFixture { };
+
+/// \brief Get the SDF of a collision.
+/// \param[in] _name Name of the collision.
+/// \param[in] _geometry SDF of the geometry.
+/// \return The SDF.
+static std::string CollisionSDF(const std::string &_name,
+    const std::string &_geometry)
+{
+  return "<collision name='" + _name + "'><geometry>" + _geometry +
+      "</geometry></collision>";
+}
+
+//////////////////////////////////////////////////
+TEST_F(AssetPrefetcherTest, Prefetch)
+{
+  const std::string meshFile =
+      std::string(PROJECT_SOURCE_PATH) + "/test/data/box.dae";
+  const std::string visualMeshFile =
+      std::string(PROJECT_SOURCE_PATH) + "/test/data/box_offset.dae";
+  const std::string heightmapFile = std::string(PROJECT_SOURCE_PATH) +
+      "/media/materials/textures/heightmap_bowl.png";
+
+  common::MeshManager *meshManager = common::MeshManager::Instance();
+  EXPECT_FALSE(meshManager->HasMesh(meshFile));
+  EXPECT_FALSE(meshManager->HasMesh(visualMeshFile));
+
+  std::ostringstream modelStr;
+  modelStr << "<sdf version='" << SDF_VERSION << "'>"
+    << "<model name='model'><link name='link'>"
+    << CollisionSDF("mesh_a", "<mesh><uri>" + meshFile + "</uri></mesh>")
+    << CollisionSDF("mesh_b", "<mesh><uri>" + meshFile + "</uri></mesh>")
+    << CollisionSDF("heightmap", "<heightmap><uri>" + heightmapFile +
+        "</uri><size>129 129 10</size></heightmap>")
+    << CollisionSDF("missing",
+        "<mesh><uri>/does/not/exist.dae</uri></mesh>")
+    << "<visual name='visual'><geometry>"
+    << "<mesh><uri>" + visualMeshFile + "</uri></mesh>"
+    << "</geometry></visual>"
+    << "</link></model></sdf>";
+
+  sdf::ElementPtr modelSDF(new sdf::Element);
+  sdf::initFile("model.sdf", modelSDF);
+  ASSERT_TRUE(sdf::readString(modelStr.str(), modelSDF));
+
+  physics::AssetPrefetcher *prefetcher = physics::AssetPrefetcher::Instance();
+  EXPECT_TRUE(prefetcher->Enabled());
+
+  // The mesh is loaded once, the missing mesh is skipped and visuals are
+  // ignored.
+  EXPECT_EQ(2u, prefetcher->Prefetch({modelSDF}));
+  EXPECT_TRUE(meshManager->HasMesh(meshFile));
+  EXPECT_FALSE(meshManager->HasMesh(visualMeshFile));
+
+  // The heightmap can be taken once.
+  std::unique_ptr<common::HeightmapData> heightmap(
+      prefetcher->TakeHeightmap(heightmapFile));
+  ASSERT_NE(nullptr, heightmap);
+  EXPECT_EQ(129u, heightmap->GetWidth());
+  EXPECT_EQ(nullptr, prefetcher->TakeHeightmap(heightmapFile));
+
+  // Loaded meshes are not loaded again.
+  EXPECT_EQ(1u, prefetcher->Prefetch({modelSDF}));
+  prefetcher->Clear();
+  EXPECT_EQ(nullptr, prefetcher->TakeHeightmap(heightmapFile));
+
+  // Nothing is loaded when disabled.
+  prefetcher->SetEnabled(false);
+  EXPECT_FALSE(prefetcher->Enabled());
+  EXPECT_EQ(0u, prefetcher->Prefetch({modelSDF}));
+  prefetcher->SetEnabled(true);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -89,6 +89,9 @@ void Base::Fini()
 {
   this->UnregisterIntrospectionItems();
 
+  if (this->world)
+    this->world->UnindexEntity(this);
+
   // Remove self as a child of the parent
   if (this->parent)
   {
@@ -193,6 +196,9 @@ void Base::AddChild(BasePtr _child)
   {
     this->children.push_back(_child);
   }
+
+  if (_child->world)
+    _child->world->IndexEntity(_child);
 }
 
 //////////////////////////////////////////////////
@@ -278,6 +284,11 @@ void Base::RemoveChildren()
 BasePtr Base::GetById(unsigned int _id) const
 {
   BasePtr result;
+
+  // The index of the world avoids walking the children
+  if (this->world && this->world->IndexedBaseById(this, _id, result))
+    return result;
+
   Base_V::const_iterator biter;
 
   for (biter = this->children.begin(); biter != this->children.end(); ++biter)
@@ -299,6 +310,11 @@ BasePtr Base::GetByName(const std::string &_name)
     return shared_from_this();
 
   BasePtr result;
+
+  // The index of the world avoids walking the tree
+  if (this->world && this->world->IndexedBaseByName(this, _name, result))
+    return result;
+
   Base_V::const_iterator iter;
 
   for (iter = this->children.begin();
@@ -371,6 +387,9 @@ void Base::ComputeScopedName()
       this->scopedName.insert(0, p->GetName()+"::");
     p = p->GetParent();
   }
+
+  if (this->world)
+    this->world->ReindexEntity(this);
 }
 
 //////////////////////////////////////////////////
@@ -428,6 +447,14 @@ bool Base::operator ==(const Base &ent) const
 //////////////////////////////////////////////////
 void Base::SetWorld(const WorldPtr &_newWorld)
 {
+  // Move to the index of the new world
+  if (this->world && this->world != _newWorld)
+  {
+    BasePtr self = this->world->UnindexEntity(this).lock();
+    if (self && _newWorld)
+      _newWorld->IndexEntity(self);
+  }
+
   this->world = _newWorld;
 
   Base_V::iterator iter;
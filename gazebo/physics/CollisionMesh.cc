@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gazebo/common/Mesh.hh"
+#include "gazebo/physics/CollisionMesh.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+/// \brief Append the vertices and indices of a submesh.
+/// \param[in] _subMesh Submesh to append.
+/// \param[in] _scale Scale applied to the vertices.
+/// \param[in] _offset Value added to the indices.
+/// \param[in,out] _vertices Vertices to append to.
+/// \param[in,out] _indices Indices to append to.
+static void AppendSubMesh(const common::SubMesh &_subMesh,
+    const ignition::math::Vector3d &_scale, const unsigned int _offset,
+    std::vector<float> &_vertices, std::vector<int> &_indices)
+{
+  for (unsigned int i = 0; i < _subMesh.GetVertexCount(); ++i)
+  {
+    ignition::math::Vector3d v = _subMesh.Vertex(i) * _scale;
+    _vertices.push_back(static_cast<float>(v.X()));
+    _vertices.push_back(static_cast<float>(v.Y()));
+    _vertices.push_back(static_cast<float>(v.Z()));
+  }
+
+  for (unsigned int i = 0; i < _subMesh.GetIndexCount(); ++i)
+    _indices.push_back(_subMesh.GetIndex(i) + _offset);
+}
+
+/////////////////////////////////////////////////
+CollisionMesh::CollisionMesh(const common::Mesh *_mesh,
+    const common::SubMesh *_subMesh, const ignition::math::Vector3d &_scale)
+{
+  if (_subMesh)
+  {
+    AppendSubMesh(*_subMesh, _scale, 0, this->vertices, this->indices);
+    return;
+  }
+
+  if (!_mesh)
+    return;
+
+  // Same layout as common::Mesh::FillArrays, which skips the submeshes
+  // that can't hold a triangle.
+  unsigned int offset = 0;
+  for (unsigned int i = 0; i < _mesh->GetSubMeshCount(); ++i)
+  {
+    const common::SubMesh *subMesh = _mesh->GetSubMesh(i);
+    if (subMesh->GetVertexCount() <= 2)
+      continue;
+
+    AppendSubMesh(*subMesh, _scale, offset, this->vertices, this->indices);
+    offset += subMesh->GetMaxIndex() + 1;
+  }
+}
+
+/////////////////////////////////////////////////
+unsigned int CollisionMesh::VertexCount() const
+{
+  return this->vertices.size() / 3;
+}
+
+/////////////////////////////////////////////////
+unsigned int CollisionMesh::IndexCount() const
+{
+  return this->indices.size();
+}
+
+/////////////////////////////////////////////////
+const float *CollisionMesh::Vertices() const
+{
+  return this->vertices.data();
+}
+
+/////////////////////////////////////////////////
+const int *CollisionMesh::Indices() const
+{
+  return this->indices.data();
+}
+
+/////////////////////////////////////////////////
+uint64_t CollisionMesh::ByteSize() const
+{
+  return this->vertices.size() * sizeof(float) +
+         this->indices.size() * sizeof(int);
+}
+
+/////////////////////////////////////////////////
+CollisionMeshPtr CollisionMeshCache::Get(const common::Mesh *_mesh,
+    const common::SubMesh *_subMesh, const bool _centered,
+    const ignition::math::Vector3d &_scale)
+{
+  if (!_mesh && !_subMesh)
+    return CollisionMeshPtr();
+
+  Key key(_mesh ? _mesh->GetName() : std::string(),
+      _subMesh ? _subMesh->GetName() : std::string(), _centered,
+      _scale.X(), _scale.Y(), _scale.Z());
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->enabled)
+    {
+      CollisionMeshPtr cached = this->meshes[key].lock();
+      if (cached)
+      {
+        ++this->hits;
+        this->savedBytes += cached->ByteSize();
+        return cached;
+      }
+    }
+  }
+
+  // Build without holding the lock, meshes of other keys can be built at
+  // the same time.
+  CollisionMeshPtr mesh =
+      std::make_shared<CollisionMesh>(_mesh, _subMesh, _scale);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  ++this->misses;
+  if (!this->enabled)
+    return mesh;
+
+  // Another thread may have built the same key meanwhile.
+  std::weak_ptr<const CollisionMesh> &entry = this->meshes[key];
+  CollisionMeshPtr cached = entry.lock();
+  if (cached)
+    return cached;
+
+  entry = mesh;
+
+  // Drop the entries of meshes nobody uses anymore.
+  for (auto iter = this->meshes.begin(); iter != this->meshes.end();)
+  {
+    if (iter->second.expired())
+      iter = this->meshes.erase(iter);
+    else
+      ++iter;
+  }
+
+  return mesh;
+}
+
+/////////////////////////////////////////////////
+void CollisionMeshCache::SetEnabled(const bool _enabled)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->enabled = _enabled;
+}
+
+/////////////////////////////////////////////////
+bool CollisionMeshCache::Enabled() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->enabled;
+}
+
+/////////////////////////////////////////////////
+uint64_t CollisionMeshCache::Hits() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hits;
+}
+
+/////////////////////////////////////////////////
+uint64_t CollisionMeshCache::Misses() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->misses;
+}
+
+/////////////////////////////////////////////////
+uint64_t CollisionMeshCache::SavedBytes() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->savedBytes;
+}
+
+/////////////////////////////////////////////////
+void CollisionMeshCache::ResetStats()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->hits = 0;
+  this->misses = 0;
+  this->savedBytes = 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_COLLISIONMESH_HH_
+#define GAZEBO_PHYSICS_COLLISIONMESH_HH_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/CommonTypes.hh"
+#include "gazebo/common/SingletonT.hh"
+#include "gazebo/util/system.hh"
+
+/// \brief Explicit instantiation for typed SingletonT.
+GZ_SINGLETON_DECLARE(GZ_PHYSICS_VISIBLE, gazebo, physics, CollisionMeshCache)
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class CollisionMesh CollisionMesh.hh physics/physics.hh
+    /// \brief Scaled vertex and index buffers of a triangle mesh used for
+    /// collision, shared by all the collisions that use the same mesh,
+    /// submesh and scale. The buffers are immutable once built. Physics
+    /// engines attach the structures they build from the buffers, such as
+    /// a bounding volume tree, with EngineData so that those are shared
+    /// too.
+    class GZ_PHYSICS_VISIBLE CollisionMesh
+    {
+      /// \brief Build the buffers of a mesh, or of one of its submeshes.
+      /// \param[in] _mesh The mesh, used when _subMesh is null.
+      /// \param[in] _subMesh The submesh, or null for the whole mesh.
+      /// \param[in] _scale Scale applied to the vertices.
+      public: CollisionMesh(const common::Mesh *_mesh,
+                  const common::SubMesh *_subMesh,
+                  const ignition::math::Vector3d &_scale);
+
+      /// \brief Get the number of vertices.
+      /// \return Number of vertices.
+      public: unsigned int VertexCount() const;
+
+      /// \brief Get the number of indices.
+      /// \return Number of indices, three per triangle.
+      public: unsigned int IndexCount() const;
+
+      /// \brief Get the scaled vertices, three floats per vertex.
+      /// \return The vertices.
+      public: const float *Vertices() const;
+
+      /// \brief Get the indices, three per triangle.
+      /// \return The indices.
+      public: const int *Indices() const;
+
+      /// \brief Get the memory used by the buffers.
+      /// \return Size of the buffers in bytes.
+      public: uint64_t ByteSize() const;
+
+      /// \brief Get the data a physics engine built from the buffers,
+      /// building it the first time.
+      /// \param[in] _engine Name of the physics engine.
+      /// \param[in] _create Function that builds the data.
+      /// \return The data of the engine.
+      public: template<typename T>
+              std::shared_ptr<T> EngineData(const std::string &_engine,
+                  const std::function<std::shared_ptr<T>()> &_create) const
+              {
+                std::lock_guard<std::mutex> lock(this->engineMutex);
+                std::shared_ptr<void> &data = this->engineData[_engine];
+                if (!data)
+                  data = _create();
+                return std::static_pointer_cast<T>(data);
+              }
+
+      /// \brief Scaled vertices, three per vertex.
+      private: std::vector<float> vertices;
+
+      /// \brief Indices, three per triangle.
+      private: std::vector<int> indices;
+
+      /// \brief Protects engineData.
+      private: mutable std::mutex engineMutex;
+
+      /// \brief Data built by physics engines, by engine name. Declared
+      /// after the buffers so that it is destroyed before them.
+      private: mutable std::map<std::string, std::shared_ptr<void>>
+               engineData;
+    };
+
+    /// \brief Shared pointer to an immutable CollisionMesh.
+    typedef std::shared_ptr<const CollisionMesh> CollisionMeshPtr;
+
+    /// \class CollisionMeshCache CollisionMesh.hh physics/physics.hh
+    /// \brief Process wide cache of collision meshes, keyed by mesh name,
+    /// submesh name and scale. An entry lives as long as a collision uses
+    /// it.
+    class GZ_PHYSICS_VISIBLE CollisionMeshCache
+      : public SingletonT<CollisionMeshCache>
+    {
+      /// \brief Get the collision mesh of a mesh, or of one of its
+      /// submeshes.
+      /// \param[in] _mesh The mesh, its name is the URI it was loaded from.
+      /// \param[in] _subMesh The submesh, or null for the whole mesh.
+      /// \param[in] _centered True if _subMesh was centered, which makes it
+      /// differ from the submesh of the same name in _mesh.
+      /// \param[in] _scale Scale applied to the vertices.
+      /// \return The collision mesh, shared with the other users of the
+      /// same key.
+      public: CollisionMeshPtr Get(const common::Mesh *_mesh,
+                  const common::SubMesh *_subMesh, const bool _centered,
+                  const ignition::math::Vector3d &_scale);
+
+      /// \brief Enable or disable sharing. When disabled, Get builds a
+      /// new collision mesh on every call. Enabled by default.
+      /// \param[in] _enabled True to share collision meshes.
+      public: void SetEnabled(const bool _enabled);
+
+      /// \brief Get whether sharing is enabled.
+      /// \return True if collision meshes are shared.
+      public: bool Enabled() const;
+
+      /// \brief Get the number of calls to Get that returned an existing
+      /// collision mesh.
+      /// \return Number of hits.
+      public: uint64_t Hits() const;
+
+      /// \brief Get the number of calls to Get that built a collision mesh.
+      /// \return Number of misses.
+      public: uint64_t Misses() const;
+
+      /// \brief Get the memory that sharing saved, the size of the buffers
+      /// of every hit.
+      /// \return Saved memory in bytes.
+      public: uint64_t SavedBytes() const;
+
+      /// \brief Reset the statistics.
+      public: void ResetStats();
+
+      /// \brief Constructor.
+      private: CollisionMeshCache() = default;
+
+      /// \brief Name of the mesh, name of the submesh, centered, scale.
+      private: typedef std::tuple<std::string, std::string, bool,
+               double, double, double> Key;
+
+      /// \brief Protects the members below.
+      private: mutable std::mutex mutex;
+
+      /// \brief The entries. Weak so that a mesh no collision uses anymore
+      /// is freed.
+      private: std::map<Key, std::weak_ptr<const CollisionMesh>> meshes;
+
+      /// \brief True to share collision meshes.
+      private: bool enabled = true;
+
+      /// \brief Number of hits.
+      private: uint64_t hits = 0;
+
+      /// \brief Number of misses.
+      private: uint64_t misses = 0;
+
+      /// \brief Saved memory in bytes.
+      private: uint64_t savedBytes = 0;
+
+      /// \brief This is a singleton.
+      private: friend class SingletonT<CollisionMeshCache>;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+
+#include "test/util.hh"
+#include "gazebo/common/Mesh.hh"
+#include "gazebo/common/MeshManager.hh"
+#include "gazebo/physics/CollisionMesh.hh"
+
+using namespace gazebo;
+
+class CollisionMeshTest : public gazebo::testing::AutoLogFixture { };
+
+//////////////////////////////////////////////////
+TEST_F(CollisionMeshTest, Buffers)
+{
+  common::MeshManager::Instance()->CreateBox("collision_mesh_box",
+      ignition::math::Vector3d(1, 2, 3), ignition::math::Vector2d(1, 1));
+  const common::Mesh *mesh =
+      common::MeshManager::Instance()->GetMesh("collision_mesh_box");
+  ASSERT_NE(nullptr, mesh);
+
+  physics::CollisionMesh collisionMesh(mesh, nullptr,
+      ignition::math::Vector3d(2, 2, 2));
+  EXPECT_EQ(mesh->GetVertexCount(), collisionMesh.VertexCount());
+  EXPECT_EQ(mesh->GetIndexCount(), collisionMesh.IndexCount());
+  EXPECT_EQ(collisionMesh.VertexCount() * 3 * sizeof(float) +
+      collisionMesh.IndexCount() * sizeof(int), collisionMesh.ByteSize());
+
+  // The vertices are scaled.
+  ignition::math::Vector3d min = mesh->Min();
+  ignition::math::Vector3d max = mesh->Max();
+  for (unsigned int i = 0; i < collisionMesh.VertexCount(); ++i)
+  {
+    EXPECT_LE(collisionMesh.Vertices()[i * 3], max.X() * 2 + 1e-6);
+    EXPECT_GE(collisionMesh.Vertices()[i * 3], min.X() * 2 - 1e-6);
+    EXPECT_LE(collisionMesh.Vertices()[i * 3 + 2], max.Z() * 2 + 1e-6);
+  }
+  for (unsigned int i = 0; i < collisionMesh.IndexCount(); ++i)
+  {
+    EXPECT_GE(collisionMesh.Indices()[i], 0);
+    EXPECT_LT(static_cast<unsigned int>(collisionMesh.Indices()[i]),
+        collisionMesh.VertexCount());
+  }
+
+  // Engine data is built once.
+  int created = 0;
+  auto create = [&created]()
+  {
+    ++created;
+    return std::make_shared<int>(42);
+  };
+  std::shared_ptr<int> first = collisionMesh.EngineData<int>("test", create);
+  std::shared_ptr<int> second = collisionMesh.EngineData<int>("test", create);
+  EXPECT_EQ(1, created);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(42, *second);
+}
+
+//////////////////////////////////////////////////
+TEST_F(CollisionMeshTest, Cache)
+{
+  common::MeshManager::Instance()->CreateBox("collision_mesh_cache_box",
+      ignition::math::Vector3d(1, 1, 1), ignition::math::Vector2d(1, 1));
+  const common::Mesh *mesh =
+      common::MeshManager::Instance()->GetMesh("collision_mesh_cache_box");
+  ASSERT_NE(nullptr, mesh);
+
+  physics::CollisionMeshCache *cache =
+      physics::CollisionMeshCache::Instance();
+  EXPECT_TRUE(cache->Enabled());
+  cache->ResetStats();
+
+  const ignition::math::Vector3d one = ignition::math::Vector3d::One;
+  physics::CollisionMeshPtr a = cache->Get(mesh, nullptr, false, one);
+  physics::CollisionMeshPtr b = cache->Get(mesh, nullptr, false, one);
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(1u, cache->Misses());
+  EXPECT_EQ(1u, cache->Hits());
+  EXPECT_EQ(a->ByteSize(), cache->SavedBytes());
+
+  // A different scale is a different entry.
+  physics::CollisionMeshPtr c =
+      cache->Get(mesh, nullptr, false, ignition::math::Vector3d(2, 1, 1));
+  EXPECT_NE(a, c);
+  EXPECT_EQ(2u, cache->Misses());
+
+  // So is a submesh, and a centered copy of it.
+  const common::SubMesh *subMesh = mesh->GetSubMesh(0);
+  ASSERT_NE(nullptr, subMesh);
+  physics::CollisionMeshPtr d = cache->Get(mesh, subMesh, false, one);
+  physics::CollisionMeshPtr e = cache->Get(mesh, subMesh, true, one);
+  EXPECT_NE(a, d);
+  EXPECT_NE(d, e);
+  EXPECT_EQ(4u, cache->Misses());
+
+  // An entry nobody uses is freed.
+  std::weak_ptr<const physics::CollisionMesh> weak = a;
+  a.reset();
+  b.reset();
+  EXPECT_TRUE(weak.expired());
+  physics::CollisionMeshPtr f = cache->Get(mesh, nullptr, false, one);
+  EXPECT_EQ(5u, cache->Misses());
+
+  // Disabled, every call builds a new mesh.
+  cache->SetEnabled(false);
+  physics::CollisionMeshPtr g = cache->Get(mesh, nullptr, false, one);
+  EXPECT_NE(f, g);
+  EXPECT_EQ(6u, cache->Misses());
+  EXPECT_EQ(1u, cache->Hits());
+  cache->SetEnabled(true);
+
+  EXPECT_EQ(nullptr, cache->Get(nullptr, nullptr, false, one));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 #include "gazebo/transport/Node.hh"
@@ -23,6 +24,8 @@
 #include "gazebo/common/Time.hh"
 
 #include "gazebo/physics/World.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/Link.hh"
 #include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/Contact.hh"
 #include "gazebo/physics/ContactManager.hh"
@@ -99,41 +102,13 @@ bool ContactManager::SubscribersConnected(Collision *_collision1,
   if (this->contactPub->HasConnections()) return true;
 
   boost::recursive_mutex::scoped_lock lock(*this->customMutex);
-  boost::unordered_map<std::string, ContactPublisher *>::const_iterator iter;
-  for (iter = this->customContactPublishers.begin();
-       iter != this->customContactPublishers.end(); ++iter)
-  {
-    // A model can simply be loaded later, so check the collisionNames as well.
-    if (!iter->second->collisionNames.empty())
-    {
-      std::vector<std::string>::const_iterator it;
-      for (it = iter->second->collisionNames.begin();
-           it != iter->second->collisionNames.end(); ++it)
-      {
-        BasePtr b = this->world->BaseByName(*it);
-        if (b)
-        {
-          return true;
-        }
-        // We could do the same transformation which is done in
-        // GetCustomPublishers() here (insert collisions which now have been
-        // loaded), but this would remove the const qualifier of this function.
-        // It would however speed up repeated calls of this function without
-        // a call of NewContact() or GetCustomPublishers() in between.
-      }
-    }
 
-    // only reason _collision1 or _collision1 cannot be const parameters
-    // is that compiler can't find const pointers in unordered set
-    if (iter->second->collisions.find(_collision1) !=
-        iter->second->collisions.end() ||
-        iter->second->collisions.find(_collision2) !=
-        iter->second->collisions.end())
-    {
-      return true;
-    }
-  }
-  return false;
+  // Collisions that filters are waiting for are resolved when their model
+  // is inserted, so the index is all there is to check.
+  return this->collisionPublishers.find(_collision1) !=
+         this->collisionPublishers.end() ||
+         this->collisionPublishers.find(_collision2) !=
+         this->collisionPublishers.end();
 }
 
 /////////////////////////////////////////////////
@@ -142,43 +117,29 @@ void ContactManager::GetCustomPublishers(Collision *_collision1,
                      std::vector<ContactPublisher*> &_publishers)
 {
   boost::recursive_mutex::scoped_lock lock(*this->customMutex);
-  boost::unordered_map<std::string, ContactPublisher *>::iterator iter;
-  for (iter = this->customContactPublishers.begin();
-       iter != this->customContactPublishers.end(); ++iter)
+
+  const size_t start = _publishers.size();
+  Collision *pair[2] = {_collision1, _collision2};
+  for (unsigned int i = 0; i < 2; ++i)
   {
-    // A model can simply be loaded later, so convert ones that are not yet
-    // found
-    if (!iter->second->collisionNames.empty())
-    {
-      std::vector<std::string>::iterator it;
-      for (it = iter->second->collisionNames.begin();
-          it != iter->second->collisionNames.end();)
-      {
-        Collision *col = boost::dynamic_pointer_cast<Collision>(
-            this->world->BaseByName(*it)).get();
-        if (!col)
-        {
-          ++it;
-          continue;
-        }
-        it = iter->second->collisionNames.erase(it);
-        iter->second->collisions.insert(col);
-      }
-    }
+    auto iter = this->collisionPublishers.find(pair[i]);
+    if (iter == this->collisionPublishers.end())
+      continue;
 
-    // only reason _collision1 or _collision1 cannot be const parameters
-    // is that compiler can't find const pointers in unordered set
-    if (iter->second->collisions.find(_collision1) !=
-        iter->second->collisions.end() ||
-        iter->second->collisions.find(_collision2) !=
-        iter->second->collisions.end())
+    for (ContactPublisher *contactPublisher : iter->second)
     {
-      GZ_ASSERT(iter->second->publisher != NULL,
+      GZ_ASSERT(contactPublisher->publisher != NULL,
                 "ContactPublisher must have a valid publisher");
-      if (!_getOnlyConnected || iter->second->publisher->HasConnections())
+
+      // A publisher filtering both collisions is listed once.
+      if (i > 0 && std::find(_publishers.begin() + start, _publishers.end(),
+            contactPublisher) != _publishers.end())
       {
-        _publishers.push_back(iter->second);
+        continue;
       }
+
+      if (!_getOnlyConnected || contactPublisher->publisher->HasConnections())
+        _publishers.push_back(contactPublisher);
     }
   }
 }
@@ -198,7 +159,8 @@ Contact *ContactManager::NewContact(Collision *_collision1,
   // This is a signal to the Physics engine that it can skip the extra
   // processing necessary to get back contact information.
 
-  std::vector<ContactPublisher *> publishers;
+  std::vector<ContactPublisher *> &publishers = this->pairPublishers;
+  publishers.clear();
   bool getOnlyConnected = false;
   // TODO check: getOnlyConnected set to false to keep same behaviour as before.
   // But should we not only add publishers which are connected, as is done
@@ -285,9 +247,6 @@ void ContactManager::Clear()
 /////////////////////////////////////////////////
 void ContactManager::PublishContacts()
 {
-//  if (this->contacts.size() == 0)
-//    return;
-
   if (!this->contactPub)
   {
     gzerr << "ContactManager has not been initialized. "
@@ -295,21 +254,14 @@ void ContactManager::PublishContacts()
     return;
   }
 
+  // Messages are only built for topics that have subscribers, otherwise the
+  // contacts just stay in the pooled Contact objects.
+
   // publish to default topic, ~/physics/contacts
-  if (!transport::getMinimalComms())
+  if (!transport::getMinimalComms() && this->contactPub->HasConnections())
   {
-    msgs::Contacts msg;
-    for (unsigned int i = 0; i < this->contactIndex; ++i)
-    {
-      if (this->contacts[i]->count == 0)
-        continue;
-
-      msgs::Contact *contactMsg = msg.add_contact();
-      this->contacts[i]->FillMsg(*contactMsg);
-    }
-
-    msgs::Set(msg.mutable_time(), this->world->SimTime());
-    this->contactPub->Publish(msg);
+    this->FillContactsMsg(this->contacts, this->contactIndex);
+    this->contactPub->Publish(this->contactsMsg);
   }
 
   // publish to other custom topics
@@ -319,22 +271,33 @@ void ContactManager::PublishContacts()
       iter != this->customContactPublishers.end(); ++iter)
   {
     ContactPublisher *contactPublisher = iter->second;
-    msgs::Contacts msg2;
-    for (unsigned int j = 0;
-        j < contactPublisher->contacts.size(); ++j)
+    if (contactPublisher->publisher->HasConnections())
     {
-      if (contactPublisher->contacts[j]->count == 0)
-        continue;
-
-      msgs::Contact *contactMsg = msg2.add_contact();
-      contactPublisher->contacts[j]->FillMsg(*contactMsg);
+      this->FillContactsMsg(contactPublisher->contacts,
+          contactPublisher->contacts.size());
+      contactPublisher->publisher->Publish(this->contactsMsg);
     }
-    msgs::Set(msg2.mutable_time(), this->world->SimTime());
-    contactPublisher->publisher->Publish(msg2);
     contactPublisher->contacts.clear();
   }
 }
 
+/////////////////////////////////////////////////
+void ContactManager::FillContactsMsg(const std::vector<Contact *> &_contacts,
+    const unsigned int _count)
+{
+  // Clearing keeps the elements of the repeated fields for reuse, so the
+  // message stops allocating once it has grown to the number of contacts.
+  this->contactsMsg.Clear();
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    if (_contacts[i]->count == 0)
+      continue;
+
+    _contacts[i]->FillMsg(*this->contactsMsg.add_contact());
+  }
+  msgs::Set(this->contactsMsg.mutable_time(), this->world->SimTime());
+}
+
 /////////////////////////////////////////////////
 std::string ContactManager::CreateFilter(const std::string &_name,
     const std::string &_collision)
@@ -375,6 +338,7 @@ std::string ContactManager::CreateFilter(const std::string &_name,
   {
     boost::recursive_mutex::scoped_lock lock(*this->customMutex);
     this->customContactPublishers[name] = contactPublisher;
+    this->RebuildIndex();
   }
 
   return topic;
@@ -417,7 +381,8 @@ std::string ContactManager::CreateFilter(const std::string &_name,
     GZ_ASSERT(this->customContactPublishers.count(name) > 0,
         "Failed to create a custom filter");
 
-    // Let it know about collisions not yet found.
+    // Let it know about collisions not yet found, they are resolved when
+    // their model is inserted.
     this->customContactPublishers[name]->collisionNames = collisionNames;
   }
 
@@ -442,7 +407,117 @@ void ContactManager::RemoveFilter(const std::string &_name)
     contactPublisher->publisher->Fini();
     contactPublisher->publisher.reset();
     this->customContactPublishers.erase(iter);
+    this->RebuildIndex();
+    delete contactPublisher;
+  }
+}
+
+/////////////////////////////////////////////////
+void ContactManager::OnModelInserted(const ModelPtr &_model)
+{
+  if (!_model)
+    return;
+
+  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+
+  bool pending = false;
+  for (const auto &iter : this->customContactPublishers)
+    pending = pending || !iter.second->collisionNames.empty();
+
+  // Most insertions don't concern any filter.
+  if (!pending)
+    return;
+
+  std::vector<CollisionPtr> modelCollisions;
+  ModelCollisions(_model, modelCollisions);
+
+  // Filters may name collisions by scoped or short name, as in
+  // World::BaseByName. A short name matches the first such collision.
+  boost::unordered_map<std::string, Collision *> byName;
+  for (const auto &col : modelCollisions)
+    byName[col->GetScopedName()] = col.get();
+  for (const auto &col : modelCollisions)
+    byName.insert(std::make_pair(col->GetName(), col.get()));
+
+  bool changed = false;
+  for (auto &iter : this->customContactPublishers)
+  {
+    std::vector<std::string> &names = iter.second->collisionNames;
+    for (auto it = names.begin(); it != names.end();)
+    {
+      auto found = byName.find(*it);
+      if (found == byName.end())
+      {
+        ++it;
+        continue;
+      }
+      iter.second->collisions.insert(found->second);
+      it = names.erase(it);
+      changed = true;
+    }
   }
+
+  if (changed)
+    this->RebuildIndex();
+}
+
+/////////////////////////////////////////////////
+void ContactManager::OnModelRemoved(const ModelPtr &_model)
+{
+  if (!_model)
+    return;
+
+  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+
+  if (this->collisionPublishers.empty())
+    return;
+
+  std::vector<CollisionPtr> modelCollisions;
+  ModelCollisions(_model, modelCollisions);
+
+  bool changed = false;
+  for (const auto &col : modelCollisions)
+  {
+    auto index = this->collisionPublishers.find(col.get());
+    if (index == this->collisionPublishers.end())
+      continue;
+
+    // A model with the same name may be inserted again.
+    for (ContactPublisher *contactPublisher : index->second)
+    {
+      contactPublisher->collisions.erase(col.get());
+      contactPublisher->collisionNames.push_back(col->GetScopedName());
+    }
+    changed = true;
+  }
+
+  if (changed)
+    this->RebuildIndex();
+}
+
+/////////////////////////////////////////////////
+void ContactManager::RebuildIndex()
+{
+  this->collisionPublishers.clear();
+  for (const auto &iter : this->customContactPublishers)
+  {
+    for (Collision *col : iter.second->collisions)
+      this->collisionPublishers[col].push_back(iter.second);
+  }
+}
+
+/////////////////////////////////////////////////
+void ContactManager::ModelCollisions(const ModelPtr &_model,
+    std::vector<CollisionPtr> &_collisions)
+{
+  for (const auto &link : _model->GetLinks())
+  {
+    for (const auto &col : link->GetCollisions())
+      _collisions.push_back(col);
+  }
+
+  for (const auto &nested : _model->NestedModels())
+    ModelCollisions(nested, _collisions);
 }
 
 /////////////////////////////////////////////////
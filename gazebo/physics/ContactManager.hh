@@ -27,6 +27,7 @@
 #include <boost/unordered/unordered_map.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 
+#include "gazebo/msgs/msgs.hh"
 #include "gazebo/transport/TransportTypes.hh"
 
 #include "gazebo/physics/PhysicsTypes.hh"
@@ -49,8 +50,9 @@ namespace gazebo
       public: boost::unordered_set<Collision *> collisions;
 
       /// \internal
-      /// \brief Names of collisions passed in by CreateFilter. Cleared
-      /// once converted to pointers.
+      /// \brief Names of collisions passed in by CreateFilter that are not
+      /// in the world yet. A name is moved to collisions when a model
+      /// containing it is inserted, and back when that model is removed.
       public: std::vector<std::string> collisionNames;
 
       /// \brief A list of contacts associated to the collisions.
@@ -125,12 +127,8 @@ namespace gazebo
       /// there are any subscribers for the contacts, but the test here is
       /// optimized because it returns as soon as one subscriber is found which
       /// listens to either of the collisions.
-      /// Note that this function needs to go through the list of custom
-      /// publishers and check whether \e _collsion1 or \e _collision2
-      /// are part of the custom publishers and whether they have been loaded
-      /// into the world, which comes at a cost.
-      /// Unless there are any benefits in calling this function ahead of
-      /// NewContact, it may be better to just use NewContact() directly.
+      /// The custom publishers are looked up in an index from collision to
+      /// publishers, so the cost doesn't depend on the number of filters.
       /// Also note that in order to exclude that NewContact() returns NULL,
       /// it is advisable to check NeverDropContacts() first (if it returns
       /// true, NewContacts() never returns NULL).
@@ -159,7 +157,9 @@ namespace gazebo
       /// \brief Clear all stored contacts.
       public: void Clear();
 
-      /// \brief Publish all contacts in a msgs::Contacts message.
+      /// \brief Publish all contacts in a msgs::Contacts message. Messages
+      /// are only built for the default topic and the filters that have
+      /// subscribers.
       public: void PublishContacts();
 
       /// \brief Set the contact count to zero.
@@ -195,6 +195,17 @@ namespace gazebo
       /// param[in] _name Filter name.
       public: void RemoveFilter(const std::string &_name);
 
+      /// \brief Resolve the collisions of a model that filters are waiting
+      /// for. Called by the world after the model was inserted.
+      /// \param[in] _model The inserted model.
+      public: void OnModelInserted(const ModelPtr &_model);
+
+      /// \brief Drop the collisions of a model from the filters, they go
+      /// back to waiting for a collision with the same name. Called by the
+      /// world before the model is removed.
+      /// \param[in] _model The model being removed.
+      public: void OnModelRemoved(const ModelPtr &_model);
+
       /// \brief Get the number of filters in the contact manager.
       /// return Number of filters
       public: unsigned int GetFilterCount();
@@ -215,6 +226,23 @@ namespace gazebo
                        Collision *_collision2, const bool _getOnlyConnected,
                        std::vector<ContactPublisher*> &_publishers);
 
+      /// \brief Fill contactsMsg with contacts.
+      /// \param[in] _contacts The contacts.
+      /// \param[in] _count Number of valid contacts at the start of
+      /// _contacts.
+      private: void FillContactsMsg(const std::vector<Contact *> &_contacts,
+                   const unsigned int _count);
+
+      /// \brief Rebuild collisionPublishers from the custom publishers.
+      /// The custom mutex must be locked.
+      private: void RebuildIndex();
+
+      /// \brief Collect the collisions of a model and its nested models.
+      /// \param[in] _model Model to get the collisions of.
+      /// \param[out] _collisions The collisions.
+      private: static void ModelCollisions(const ModelPtr &_model,
+                   std::vector<CollisionPtr> &_collisions);
+
       private: std::vector<Contact*> contacts;
 
       private: unsigned int contactIndex;
@@ -233,6 +261,19 @@ namespace gazebo
       private: boost::unordered_map<std::string, ContactPublisher *>
           customContactPublishers;
 
+      /// \brief The custom publishers of each filtered collision, rebuilt
+      /// when filters or models change.
+      private: boost::unordered_map<Collision *,
+               std::vector<ContactPublisher *>> collisionPublishers;
+
+      /// \brief Publishers of the pair passed to NewContact, kept to reuse
+      /// its memory.
+      private: std::vector<ContactPublisher *> pairPublishers;
+
+      /// \brief Message filled by PublishContacts, reused to avoid
+      /// allocating one per topic and step.
+      private: msgs::Contacts contactsMsg;
+
       /// \brief Mutex to protect the list of custom publishers.
       private: boost::recursive_mutex *customMutex;
 
@@ -15,6 +15,9 @@
  *
 */
 
+#include <mutex>
+#include <vector>
+
 #include "gazebo/physics/ContactManager.hh"
 #include "gazebo/test/ServerFixture.hh"
 
@@ -194,6 +197,126 @@ TEST_F(ContactManagerTest, NeverDropContacts)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, FilterIndex)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  physics::ContactManager *manager = physics->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  physics::ModelPtr box = world->ModelByName("box");
+  physics::ModelPtr ground = world->ModelByName("ground_plane");
+  ASSERT_TRUE(box != nullptr);
+  ASSERT_TRUE(ground != nullptr);
+  physics::CollisionPtr boxCol =
+      box->GetLink("link")->GetCollision("collision");
+  physics::CollisionPtr groundCol =
+      ground->GetLink("link")->GetCollision("collision");
+  ASSERT_TRUE(boxCol != nullptr);
+  ASSERT_TRUE(groundCol != nullptr);
+
+  EXPECT_FALSE(manager->SubscribersConnected(boxCol.get(), groundCol.get()));
+
+  // One filter on a collision of the world, and one on a collision of a
+  // model that isn't inserted yet.
+  manager->CreateFilter("box_filter", "box::link::collision");
+  manager->CreateFilter("spawned_filter", "spawned::body::geom");
+  manager->CreateFilter("short_filter", "geom");
+  EXPECT_TRUE(manager->SubscribersConnected(boxCol.get(), groundCol.get()));
+  EXPECT_TRUE(manager->SubscribersConnected(groundCol.get(), boxCol.get()));
+  EXPECT_FALSE(
+      manager->SubscribersConnected(groundCol.get(), groundCol.get()));
+
+  // The pending filter is resolved when the model is inserted.
+  SpawnBox("spawned", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(5, 0, 0.5));
+  physics::ModelPtr spawned = world->ModelByName("spawned");
+  ASSERT_TRUE(spawned != nullptr);
+  physics::CollisionPtr spawnedCol =
+      spawned->GetLink("body")->GetCollision("geom");
+  ASSERT_TRUE(spawnedCol != nullptr);
+  for (int i = 0; i < 100 &&
+      !manager->SubscribersConnected(spawnedCol.get(), groundCol.get()); ++i)
+  {
+    common::Time::MSleep(10);
+  }
+  EXPECT_TRUE(manager->SubscribersConnected(spawnedCol.get(), groundCol.get()));
+
+  // The filter on the short name was resolved too.
+  manager->RemoveFilter("spawned_filter");
+  EXPECT_TRUE(manager->SubscribersConnected(spawnedCol.get(), groundCol.get()));
+
+  // Contacts are created for both filtered models.
+  world->Step(1);
+  EXPECT_GT(manager->GetContactCount(), 0u);
+
+  // Removing the model drops its collision from the index.
+  world->RemoveModel("spawned");
+  EXPECT_FALSE(
+      manager->SubscribersConnected(spawnedCol.get(), groundCol.get()));
+
+  // Removing the filter does too.
+  manager->RemoveFilter("box_filter");
+  EXPECT_FALSE(manager->SubscribersConnected(boxCol.get(), groundCol.get()));
+}
+
+/////////////////////////////////////////////////
+// Record the number of contacts of each message received.
+class ContactsCounter
+{
+  public: void OnContacts(ConstContactsPtr &_msg)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->received.push_back(_msg->contact_size());
+  }
+
+  public: std::mutex mutex;
+  public: std::vector<int> received;
+};
+
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, PublishContacts)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ContactManager *manager = world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  ContactsCounter counter;
+  transport::NodePtr node(new transport::Node());
+  node->Init();
+  transport::SubscriberPtr sub = node->Subscribe("~/physics/contacts",
+      &ContactsCounter::OnContacts, &counter);
+
+  // Each step publishes the contacts of that step only, the message reused
+  // from step to step must not keep contacts of the previous one.
+  world->Step(10);
+  for (int i = 0; i < 100; ++i)
+  {
+    {
+      std::lock_guard<std::mutex> lock(counter.mutex);
+      if (counter.received.size() >= 10)
+        break;
+    }
+    common::Time::MSleep(10);
+  }
+
+  std::lock_guard<std::mutex> lock(counter.mutex);
+  ASSERT_GE(counter.received.size(), 10u);
+  EXPECT_EQ(1, counter.received.back());
+  EXPECT_EQ(manager->GetContactCount(), 1u);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -25,6 +25,7 @@
 #include "gazebo/common/Image.hh"
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/SphericalCoordinates.hh"
+#include "gazebo/physics/AssetPrefetcher.hh"
 #include "gazebo/physics/HeightmapShape.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/transport/transport.hh"
@@ -81,7 +82,12 @@ void HeightmapShape::OnRequest(ConstRequestPtr &_msg)
 //////////////////////////////////////////////////
 int HeightmapShape::LoadTerrainFile(const std::string &_filename)
 {
-  this->heightmapData = common::HeightmapDataLoader::LoadTerrainFile(_filename);
+  this->heightmapData = AssetPrefetcher::Instance()->TakeHeightmap(_filename);
+  if (!this->heightmapData)
+  {
+    this->heightmapData =
+        common::HeightmapDataLoader::LoadTerrainFile(_filename);
+  }
   if (!this->heightmapData)
   {
     gzerr << "Unable to load heightmap data" << std::endl;
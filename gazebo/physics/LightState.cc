@@ -17,6 +17,8 @@
 
 #include "gazebo/physics/Light.hh"
 #include "gazebo/physics/LightState.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/util/BinaryLog.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -29,6 +31,18 @@ LightState::LightState(const LightPtr _light, const common::Time &_realTime,
   this->pose = _light->WorldPose();
 }
 
+/////////////////////////////////////////////////
+void LightState::Load(const StateSnapshot &_snapshot,
+    const unsigned int _index)
+{
+  this->name = _snapshot.layout->lightNames[_index];
+  this->wallTime = _snapshot.wallTime;
+  this->realTime = _snapshot.realTime;
+  this->simTime = _snapshot.simTime;
+  this->iterations = _snapshot.iterations;
+  this->pose = _snapshot.lightPoses[_index];
+}
+
 /////////////////////////////////////////////////
 LightState::LightState(const sdf::ElementPtr _sdf)
   : State()
@@ -49,6 +63,32 @@ void LightState::Load(const sdf::ElementPtr _elem)
     this->pose.Set(0, 0, 0, 0, 0, 0);
 }
 
+/////////////////////////////////////////////////
+void LightState::WriteBinary(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  _writer.WritePose(this->pose);
+}
+
+/////////////////////////////////////////////////
+bool LightState::ReadBinary(util::BinaryLogReader &_reader)
+{
+  return _reader.ReadString(this->name) && _reader.ReadPose(this->pose);
+}
+
+/////////////////////////////////////////////////
+bool LightState::WriteBinaryDelta(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  return _writer.WriteDeltaPose(this->pose);
+}
+
+/////////////////////////////////////////////////
+bool LightState::ReadBinaryDelta(util::BinaryLogReader &_reader)
+{
+  return _reader.ReadString(this->name) && _reader.ReadDeltaPose(this->pose);
+}
+
 /////////////////////////////////////////////////
 void LightState::Load(const LightPtr _light, const common::Time &_realTime,
     const common::Time &_simTime, const uint64_t _iterations)
@@ -103,7 +143,7 @@ LightState LightState::operator+(const LightState &_state) const
 
   result.name = this->name;
   result.pose.Pos() = this->pose.Pos() + _state.pose.Pos();
-  result.pose.Rot() = _state.pose.Rot() * this->pose.Rot();
+  result.pose.Rot() = this->pose.Rot() * _state.pose.Rot();
 
   return result;
 }
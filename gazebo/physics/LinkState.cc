@@ -20,6 +20,8 @@
 #include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/LinkState.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/util/BinaryLog.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -47,6 +49,24 @@ LinkState::LinkState(const LinkPtr _link, const common::Time &_realTime,
   this->wrench.Set(_link->WorldForce(), ignition::math::Quaterniond::Identity);
 }
 
+/////////////////////////////////////////////////
+void LinkState::Load(const StateSnapshot &_snapshot, const unsigned int _index)
+{
+  this->name = _snapshot.layout->linkNames[_index];
+  this->wallTime = _snapshot.wallTime;
+  this->realTime = _snapshot.realTime;
+  this->simTime = _snapshot.simTime;
+  this->iterations = _snapshot.iterations;
+
+  this->pose = _snapshot.linkPoses[_index];
+  this->velocity.Set(_snapshot.linkLinearVels[_index],
+                     _snapshot.linkAngularVels[_index]);
+  this->acceleration.Set(_snapshot.linkLinearAccels[_index],
+                         _snapshot.linkAngularAccels[_index]);
+  this->wrench.Set(_snapshot.linkForces[_index],
+      ignition::math::Quaterniond::Identity);
+}
+
 /////////////////////////////////////////////////
 LinkState::LinkState(const LinkPtr _link)
   : State(_link->GetName(), _link->GetWorld()->RealTime(),
@@ -132,6 +152,67 @@ void LinkState::Load(const sdf::ElementPtr _elem)
     this->wrench.Set(0, 0, 0, 0, 0, 0);
 }
 
+/////////////////////////////////////////////////
+void LinkState::WriteBinary(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  _writer.WritePose(this->pose);
+
+  // Velocity is only stored when requested, as in the text log
+  const bool recordVel = this->RecordVelocity();
+  _writer.Write(static_cast<uint8_t>(recordVel));
+  if (recordVel)
+    _writer.WritePose(this->velocity);
+}
+
+/////////////////////////////////////////////////
+bool LinkState::ReadBinary(util::BinaryLogReader &_reader)
+{
+  uint8_t hasVelocity = 0;
+  if (!_reader.ReadString(this->name) || !_reader.ReadPose(this->pose) ||
+      !_reader.Read(hasVelocity))
+  {
+    return false;
+  }
+
+  this->velocity.Set(0, 0, 0, 0, 0, 0);
+  this->acceleration.Set(0, 0, 0, 0, 0, 0);
+  this->wrench.Set(0, 0, 0, 0, 0, 0);
+
+  return !hasVelocity || _reader.ReadPose(this->velocity);
+}
+
+/////////////////////////////////////////////////
+bool LinkState::WriteBinaryDelta(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  if (!_writer.WriteDeltaPose(this->pose))
+    return false;
+
+  const bool recordVel = this->RecordVelocity();
+  _writer.Write(static_cast<uint8_t>(recordVel));
+  if (recordVel)
+    _writer.WritePose(this->velocity);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LinkState::ReadBinaryDelta(util::BinaryLogReader &_reader)
+{
+  uint8_t hasVelocity = 0;
+  if (!_reader.ReadString(this->name) || !_reader.ReadDeltaPose(this->pose) ||
+      !_reader.Read(hasVelocity))
+  {
+    return false;
+  }
+
+  this->velocity.Set(0, 0, 0, 0, 0, 0);
+  this->acceleration.Set(0, 0, 0, 0, 0, 0);
+  this->wrench.Set(0, 0, 0, 0, 0, 0);
+
+  return !hasVelocity || _reader.ReadPose(this->velocity);
+}
+
 /////////////////////////////////////////////////
 const ignition::math::Pose3d &LinkState::Pose() const
 {
@@ -279,11 +360,13 @@ LinkState LinkState::operator+(const LinkState &_state) const
   result.name = this->name;
 
   result.pose.Pos() = this->pose.Pos() + _state.pose.Pos();
-  result.pose.Rot() = _state.pose.Rot() * this->pose.Rot();
+  result.pose.Rot() = this->pose.Rot() * _state.pose.Rot();
 
-  result.velocity = this->velocity + _state.velocity;
-  result.acceleration = this->acceleration + _state.acceleration;
-  result.wrench = this->wrench + _state.wrench;
+  // Pose3d::operator+ reverts Pose3d::operator- when the difference is on
+  // the left hand side.
+  result.velocity = _state.velocity + this->velocity;
+  result.acceleration = _state.acceleration + this->acceleration;
+  result.wrench = _state.wrench + this->wrench;
 
   // Disabled for efficiency
   // Insert the collision differences
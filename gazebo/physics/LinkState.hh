@@ -31,8 +31,16 @@
 
 namespace gazebo
 {
+  namespace util
+  {
+    class BinaryLogReader;
+    class BinaryLogWriter;
+  }
+
   namespace physics
   {
+    class StateSnapshot;
+
     /// \addtogroup gazebo_physics
     /// \{
 
@@ -87,12 +95,41 @@ namespace gazebo
       public: void Load(const LinkPtr _link, const common::Time &_realTime,
                   const common::Time &_simTime, const uint64_t _iterations);
 
+      /// \brief Load state from a snapshot.
+      /// \param[in] _snapshot Snapshot of the world.
+      /// \param[in] _index Index of the link in the snapshot.
+      public: void Load(const StateSnapshot &_snapshot,
+                  const unsigned int _index);
+
       /// \brief Load state from SDF element.
       ///
       /// Load LinkState information from stored data in and SDF::Element.
       /// \param[in] _elem Pointer to the SDF::Element containing state info.
       public: virtual void Load(const sdf::ElementPtr _elem);
 
+      /// \brief Append the state to a binary log frame.
+      /// \param[in] _writer Writer to append the state to.
+      public: void WriteBinary(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load state from a binary log frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinary.
+      /// \return False if the data is truncated.
+      public: bool ReadBinary(util::BinaryLogReader &_reader);
+
+      /// \brief Append the state to a binary log delta frame. The state is
+      /// expected to be a difference computed with operator-, its poses are
+      /// quantized.
+      /// \param[in] _writer Writer to append the state to.
+      /// \return False if a difference is too large to be quantized.
+      public: bool WriteBinaryDelta(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load a difference from a binary log delta frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinaryDelta.
+      /// \return False if the data is truncated.
+      public: bool ReadBinaryDelta(util::BinaryLogReader &_reader);
+
       /// \brief Get the link pose.
       /// \return The ignition::math::Pose3d of the Link.
       public: const ignition::math::Pose3d &Pose() const;
@@ -174,8 +211,9 @@ namespace gazebo
       /// \return The resulting state.
       public: LinkState operator-(const LinkState &_state) const;
 
-      /// \brief Addition operator.
-      /// \param[in] _pt A state to add.
+      /// \brief Addition operator. Applies a difference computed with
+      /// operator-, so that b + (a - b) equals a.
+      /// \param[in] _state Difference to add.
       /// \return The resulting state.
       public: LinkState operator+(const LinkState &_state) const;
 
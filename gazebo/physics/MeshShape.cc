@@ -100,6 +100,25 @@ void MeshShape::Init()
   }
 }
 
+//////////////////////////////////////////////////
+CollisionMeshPtr MeshShape::SharedCollisionMesh() const
+{
+  if (!this->mesh)
+    return CollisionMeshPtr();
+
+  // A centered submesh differs from the one of the same name in the mesh.
+  bool centered = false;
+  if (this->submesh)
+  {
+    sdf::ElementPtr submeshElem = this->sdf->GetElement("submesh");
+    centered = submeshElem->HasElement("center") &&
+        submeshElem->Get<bool>("center");
+  }
+
+  return CollisionMeshCache::Instance()->Get(this->mesh, this->submesh,
+      centered, this->sdf->Get<ignition::math::Vector3d>("scale"));
+}
+
 //////////////////////////////////////////////////
 void MeshShape::SetScale(const ignition::math::Vector3d &_scale)
 {
@@ -20,6 +20,7 @@
 #include <string>
 
 #include "gazebo/common/CommonTypes.hh"
+#include "gazebo/physics/CollisionMesh.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/Shape.hh"
 #include "gazebo/util/system.hh"
@@ -78,6 +79,12 @@ namespace gazebo
       /// \param[in] _msg Message that contains triangle mesh info.
       public: virtual void ProcessMsg(const msgs::Geometry &_msg);
 
+      /// \brief Get the collision mesh of this shape from the
+      /// CollisionMeshCache, shared with every shape using the same mesh,
+      /// submesh and scale.
+      /// \return The collision mesh, null if no mesh is loaded.
+      protected: CollisionMeshPtr SharedCollisionMesh() const;
+
       /// \brief Pointer to the mesh data.
       protected: const common::Mesh *mesh;
 
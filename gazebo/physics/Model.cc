@@ -401,6 +401,59 @@ void Model::Update()
     model->Update();
 }
 
+//////////////////////////////////////////////////
+bool Model::UpdateIsolated() const
+{
+  if (this->IsStatic())
+    return true;
+
+  boost::recursive_mutex::scoped_lock lock(this->updateMutex);
+
+  // Joint animations move links through the joint controller and may
+  // invoke a user callback on completion.
+  if (!this->jointAnimations.empty())
+    return false;
+
+  if (this->jointsIsolatedDirty)
+  {
+    // Find the top level model that owns this model.
+    auto topLevel = [](const Base *_base)
+    {
+      while (_base->GetParent() && _base->GetParent()->HasType(MODEL))
+        _base = _base->GetParent().get();
+      return _base;
+    };
+    const Base *top = topLevel(this);
+
+    // Joint forces are applied to both the parent and the child link,
+    // so both must belong to the same top level model as this one.
+    this->jointsIsolated = true;
+    for (auto const &joint : this->joints)
+    {
+      for (unsigned int i = 0; i < 2 && this->jointsIsolated; ++i)
+      {
+        LinkPtr link = joint->GetJointLink(i);
+        if (link && topLevel(link.get()) != top)
+          this->jointsIsolated = false;
+      }
+      if (!this->jointsIsolated)
+        break;
+    }
+    this->jointsIsolatedDirty = false;
+  }
+
+  if (!this->jointsIsolated)
+    return false;
+
+  for (auto const &model : this->models)
+  {
+    if (!model->UpdateIsolated())
+      return false;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 void Model::SetJointPosition(
   const std::string &_jointName, double _position, int _index)
@@ -443,6 +496,7 @@ void Model::RemoveChild(EntityPtr _child)
             jlink0->GetName() == jlink1->GetName())
         {
           this->joints.erase(jiter);
+          this->jointsIsolatedDirty = true;
           done = false;
           break;
         }
@@ -493,6 +547,7 @@ void Model::Fini()
       joint->Fini();
   }
   this->joints.clear();
+  this->jointsIsolatedDirty = true;
   this->jointController.reset();
 
   // Destroy all links
@@ -972,6 +1027,7 @@ void Model::LoadJoint(sdf::ElementPtr _sdf)
   }
 
   this->joints.push_back(joint);
+  this->jointsIsolatedDirty = true;
 
   if (!this->jointController)
     this->jointController.reset(new JointController(
@@ -1582,6 +1638,7 @@ gazebo::physics::JointPtr Model::CreateJoint(
   // need to call Joint::Load to clone Joint::sdfJoint into Joint::sdf
   joint->Load(_parent, _child, ignition::math::Pose3d::Zero);
   this->joints.push_back(joint);
+  this->jointsIsolatedDirty = true;
   return joint;
 }
 
@@ -1635,6 +1692,7 @@ bool Model::RemoveJoint(const std::string &_name)
     this->joints.erase(
       std::remove(this->joints.begin(), this->joints.end(), joint),
       this->joints.end());
+    this->jointsIsolatedDirty = true;
     this->world->SetPaused(paused);
     return true;
   }
@@ -78,6 +78,14 @@ namespace gazebo
       /// \brief Update the model.
       public: void Update() override;
 
+      /// \brief Get whether Update() only touches state owned by this
+      /// model, so that it may run concurrently with the update of other
+      /// models. This is false while joint animations are playing, or when
+      /// a joint of this model or one of its nested models connects to a
+      /// link of another model.
+      /// \return True if the model can be updated in parallel.
+      public: bool UpdateIsolated() const;
+
       /// \brief Finalize the model.
       public: virtual void Fini() override;
 
@@ -549,6 +557,14 @@ namespace gazebo
       /// \brief Mutex used during the update cycle.
       private: mutable boost::recursive_mutex updateMutex;
 
+      /// \brief True when jointsIsolated needs to be recomputed because
+      /// the set of joints has changed.
+      private: mutable bool jointsIsolatedDirty = true;
+
+      /// \brief Cached result of checking that all joints connect links of
+      /// this model only.
+      private: mutable bool jointsIsolated = false;
+
       /// \brief Mutex to protect incoming message buffers.
       private: std::mutex receiveMutex;
 
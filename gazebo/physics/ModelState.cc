@@ -15,11 +15,15 @@
  *
  */
 
+#include <boost/iterator/counting_iterator.hpp>
+
 #include "gazebo/common/Exception.hh"
 #include "gazebo/physics/Model.hh"
 #include "gazebo/physics/Link.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/ModelState.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/util/BinaryLog.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -157,6 +161,45 @@ void ModelState::Load(const ModelPtr _model, const common::Time &_realTime,
   }*/
 }
 
+/////////////////////////////////////////////////
+void ModelState::Load(const StateSnapshot &_snapshot,
+    const unsigned int _index)
+{
+  const StateSnapshotLayout &layout = *_snapshot.layout;
+
+  this->name = layout.modelNames[_index];
+  this->wallTime = _snapshot.wallTime;
+  this->realTime = _snapshot.realTime;
+  this->simTime = _snapshot.simTime;
+  this->iterations = _snapshot.iterations;
+  this->pose = _snapshot.modelPoses[_index];
+  this->scale = _snapshot.modelScales[_index];
+
+  const unsigned int linkStart = layout.modelLinkStart[_index];
+  const unsigned int linkEnd = layout.modelLinkStart[_index + 1];
+  if (layout.SortedByName())
+  {
+    LoadSnapshotStates(_snapshot, layout.linkNames,
+        layout.linksByName.begin() + linkStart,
+        layout.linksByName.begin() + linkEnd, this->linkStates);
+
+    const std::vector<unsigned int> &nested =
+        layout.nestedModelsByName[_index];
+    LoadSnapshotStates(_snapshot, layout.modelNames, nested.begin(),
+        nested.end(), this->modelStates);
+  }
+  else
+  {
+    LoadSnapshotStates(_snapshot, layout.linkNames,
+        boost::counting_iterator<unsigned int>(linkStart),
+        boost::counting_iterator<unsigned int>(linkEnd), this->linkStates);
+
+    const std::vector<unsigned int> &nested = layout.nestedModels[_index];
+    LoadSnapshotStates(_snapshot, layout.modelNames, nested.begin(),
+        nested.end(), this->modelStates);
+  }
+}
+
 /////////////////////////////////////////////////
 void ModelState::Load(const sdf::ElementPtr _elem)
 {
@@ -218,6 +261,117 @@ void ModelState::Load(const sdf::ElementPtr _elem)
   }*/
 }
 
+/////////////////////////////////////////////////
+void ModelState::WriteBinary(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  _writer.WritePose(this->pose);
+  _writer.WriteVector3(this->scale);
+
+  _writer.Write(static_cast<uint32_t>(this->linkStates.size()));
+  for (const auto &linkState : this->linkStates)
+    linkState.second.WriteBinary(_writer);
+
+  _writer.Write(static_cast<uint32_t>(this->modelStates.size()));
+  for (const auto &modelState : this->modelStates)
+    modelState.second.WriteBinary(_writer);
+}
+
+/////////////////////////////////////////////////
+bool ModelState::ReadBinary(util::BinaryLogReader &_reader)
+{
+  if (!_reader.ReadString(this->name) || !_reader.ReadPose(this->pose) ||
+      !_reader.ReadVector3(this->scale))
+  {
+    return false;
+  }
+
+  uint32_t count = 0;
+  this->linkStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    LinkState linkState;
+    if (!linkState.ReadBinary(_reader))
+      return false;
+    this->linkStates[linkState.GetName()] = linkState;
+  }
+
+  this->modelStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ModelState modelState;
+    if (!modelState.ReadBinary(_reader))
+      return false;
+    this->modelStates[modelState.GetName()] = modelState;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ModelState::WriteBinaryDelta(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  if (!_writer.WriteDeltaPose(this->pose))
+    return false;
+  _writer.WriteVector3(this->scale);
+
+  _writer.Write(static_cast<uint32_t>(this->linkStates.size()));
+  for (const auto &linkState : this->linkStates)
+  {
+    if (!linkState.second.WriteBinaryDelta(_writer))
+      return false;
+  }
+
+  _writer.Write(static_cast<uint32_t>(this->modelStates.size()));
+  for (const auto &modelState : this->modelStates)
+  {
+    if (!modelState.second.WriteBinaryDelta(_writer))
+      return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ModelState::ReadBinaryDelta(util::BinaryLogReader &_reader)
+{
+  if (!_reader.ReadString(this->name) || !_reader.ReadDeltaPose(this->pose) ||
+      !_reader.ReadVector3(this->scale))
+  {
+    return false;
+  }
+
+  uint32_t count = 0;
+  this->linkStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    LinkState linkState;
+    if (!linkState.ReadBinaryDelta(_reader))
+      return false;
+    this->linkStates[linkState.GetName()] = linkState;
+  }
+
+  this->modelStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ModelState modelState;
+    if (!modelState.ReadBinaryDelta(_reader))
+      return false;
+    this->modelStates[modelState.GetName()] = modelState;
+  }
+
+  return true;
+}
+
 /////////////////////////////////////////////////
 const ignition::math::Pose3d &ModelState::Pose() const
 {
@@ -515,65 +669,50 @@ ModelState ModelState::operator+(const ModelState &_state) const
 
   result.name = this->name;
   result.pose.Pos() = this->pose.Pos() + _state.pose.Pos();
-  result.pose.Rot() = _state.pose.Rot() * this->pose.Rot();
+  result.pose.Rot() = this->pose.Rot() * _state.pose.Rot();
   result.scale = this->scale + _state.scale;
 
-  // Insert the link state diffs.
-  for (LinkState_M::const_iterator iter =
-       this->linkStates.begin(); iter != this->linkStates.end(); ++iter)
+  // Add the link state diffs. Links without a diff are unchanged.
+  for (const auto &ls : this->linkStates)
   {
-    try
+    if (_state.HasLinkState(ls.second.GetName()))
     {
-      if (_state.HasLinkState(iter->second.GetName()))
-      {
-        LinkState state = iter->second + _state.GetLinkState(
-            iter->second.GetName());
-        result.linkStates.insert(std::make_pair(state.GetName(), state));
-      }
+      LinkState state = ls.second + _state.GetLinkState(ls.second.GetName());
+      result.linkStates.insert(std::make_pair(state.GetName(), state));
     }
-    catch(common::Exception &)
+    else
     {
-      // Ignore exception, which is just the fact that a link state may not
-      // have been recorded.
+      result.linkStates.insert(ls);
     }
   }
 
-  // Insert the model state diffs.
+  // Add the model state diffs.
   for (const auto &ms : this->modelStates)
   {
-    try
+    if (_state.HasNestedModelState(ms.second.GetName()))
     {
-      if (_state.HasNestedModelState(ms.second.GetName()))
-      {
-        ModelState state = ms.second + _state.NestedModelState(
-            ms.second.GetName());
-        result.modelStates.insert(std::make_pair(state.GetName(), state));
-      }
+      ModelState state = ms.second + _state.NestedModelState(
+          ms.second.GetName());
+      result.modelStates.insert(std::make_pair(state.GetName(), state));
     }
-    catch(common::Exception &)
+    else
     {
-      // Ignore exception, which is just the fact that a model state may not
-      // have been recorded.
+      result.modelStates.insert(ms);
     }
   }
 
-  // Insert the joint state diffs.
-  for (JointState_M::const_iterator iter =
-       this->jointStates.begin(); iter != this->jointStates.end(); ++iter)
+  // Add the joint state diffs.
+  for (const auto &js : this->jointStates)
   {
-    try
+    if (_state.HasJointState(js.second.GetName()))
     {
-      if (_state.HasJointState(iter->second.GetName()))
-      {
-        JointState state = iter->second +
-          _state.GetJointState(iter->second.GetName());
-        result.jointStates.insert(std::make_pair(state.GetName(), state));
-      }
+      JointState state = js.second + _state.GetJointState(
+          js.second.GetName());
+      result.jointStates.insert(std::make_pair(state.GetName(), state));
     }
-    catch(common::Exception &)
+    else
     {
-      // Ignore exception, which is just the fact that a joint state may not
-      // have been recorded.
+      result.jointStates.insert(js);
     }
   }
 
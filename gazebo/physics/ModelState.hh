@@ -32,8 +32,16 @@
 
 namespace gazebo
 {
+  namespace util
+  {
+    class BinaryLogReader;
+    class BinaryLogWriter;
+  }
+
   namespace physics
   {
+    class StateSnapshot;
+
     /// \addtogroup gazebo_physics
     /// \{
 
@@ -88,12 +96,46 @@ namespace gazebo
       public: void Load(const ModelPtr _model, const common::Time &_realTime,
                   const common::Time &_simTime, const uint64_t _iterations);
 
+      /// \brief Load state from a snapshot.
+      ///
+      /// Build a ModelState, including the states of the links and nested
+      /// models, from a snapshot of the world. The states of links and
+      /// nested models loaded from a previous snapshot with the same layout
+      /// are updated in place.
+      /// \param[in] _snapshot Snapshot of the world.
+      /// \param[in] _index Index of the model in the snapshot.
+      public: void Load(const StateSnapshot &_snapshot,
+                  const unsigned int _index);
+
       /// \brief Load state from SDF element.
       ///
       /// Load ModelState information from stored data in and SDF::Element
       /// \param[in] _elem Pointer to the SDF::Element containing state info.
       public: virtual void Load(const sdf::ElementPtr _elem);
 
+      /// \brief Append the state to a binary log frame.
+      /// \param[in] _writer Writer to append the state to.
+      public: void WriteBinary(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load state from a binary log frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinary.
+      /// \return False if the data is truncated.
+      public: bool ReadBinary(util::BinaryLogReader &_reader);
+
+      /// \brief Append the state to a binary log delta frame. The state is
+      /// expected to be a difference computed with operator-, its poses are
+      /// quantized.
+      /// \param[in] _writer Writer to append the state to.
+      /// \return False if a difference is too large to be quantized.
+      public: bool WriteBinaryDelta(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load a difference from a binary log delta frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinaryDelta.
+      /// \return False if the data is truncated.
+      public: bool ReadBinaryDelta(util::BinaryLogReader &_reader);
+
       /// \brief Get the stored model pose.
       /// \return The ignition::math::Pose3d of the Model.
       public: const ignition::math::Pose3d &Pose() const;
@@ -231,8 +273,10 @@ namespace gazebo
       /// \return The resulting state.
       public: ModelState operator-(const ModelState &_state) const;
 
-      /// \brief Addition operator.
-      /// \param[in] _pt A state to substract.
+      /// \brief Addition operator. Applies a difference computed with
+      /// operator-, so that b + (a - b) equals a. Entities without a
+      /// difference in _state are unchanged.
+      /// \param[in] _state Difference to add.
       /// \return The resulting state.
       public: ModelState operator+(const ModelState &_state) const;
 
@@ -243,6 +243,16 @@ bool PhysicsEngine::SetParam(const std::string &_key,
       this->world->SetMagneticField(
           any_cast<ignition::math::Vector3d>(copy));
     }
+    else if (_key == "model_update_threads")
+    {
+      int threads = any_cast<int>(_value);
+      if (threads < 0)
+      {
+        gzerr << "model_update_threads must be non-negative" << std::endl;
+        return false;
+      }
+      this->world->SetModelUpdateThreads(static_cast<unsigned int>(threads));
+    }
     else
     {
       gzwarn << "SetParam failed for [" << _key << "] in physics engine "
@@ -295,6 +305,8 @@ bool PhysicsEngine::GetParam(const std::string &_key,
     _value = this->world->Gravity();
   else if (_key == "magnetic_field")
     _value = this->world->MagneticField();
+  else if (_key == "model_update_threads")
+    _value = static_cast<int>(this->world->ModelUpdateThreads());
   else
   {
     gzwarn << "GetParam failed for [" << _key << "] in physics engine "
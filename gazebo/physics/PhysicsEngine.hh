@@ -215,6 +215,8 @@ namespace gazebo
       ///          (defined but not used in ode).
       ///       -# "max_step_size" (double) - maximum physics step size when
       ///          physics update step must return.
+      ///       -# "model_update_threads" (int) - number of threads used to
+      ///          update models in World::Update, 0 for serial updates.
       ///
       /// \param[in] _value The value to set to
       /// \return true if SetParam is successful, false if operation fails.
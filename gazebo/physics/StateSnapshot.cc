@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include "gazebo/common/Assert.hh"
+#include "gazebo/physics/Light.hh"
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/World.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+/// \brief Append a model and its nested models to a layout.
+/// \param[in] _model Model to append.
+/// \param[in,out] _layout Layout to append to.
+/// \param[in,out] _entities Entities of the layout, in capture order.
+/// \return Index of the model in the layout.
+static unsigned int AddModel(const ModelPtr &_model,
+    StateSnapshotLayout &_layout, std::vector<BasePtr> &_entities)
+{
+  unsigned int index = _layout.modelNames.size();
+  _layout.modelNames.push_back(_model->GetName());
+  _layout.nestedModels.emplace_back();
+  _entities.push_back(_model);
+
+  _layout.modelLinkStart.push_back(_layout.linkNames.size());
+  for (const auto &link : _model->GetLinks())
+  {
+    _layout.linkNames.push_back(link->GetName());
+    _entities.push_back(link);
+  }
+
+  for (const auto &nested : _model->NestedModels())
+  {
+    unsigned int child = AddModel(nested, _layout, _entities);
+    _layout.nestedModels[index].push_back(child);
+  }
+
+  return index;
+}
+
+/// \brief Sort indices by the names of the entities they refer to.
+/// \param[in] _names Names of the entities.
+/// \param[in] _begin First index to sort.
+/// \param[in] _end End of the indices to sort.
+static void SortIndices(const std::vector<std::string> &_names,
+    std::vector<unsigned int>::iterator _begin,
+    std::vector<unsigned int>::iterator _end)
+{
+  std::stable_sort(_begin, _end,
+      [&_names](const unsigned int _a, const unsigned int _b)
+      {
+        return _names[_a] < _names[_b];
+      });
+}
+
+/////////////////////////////////////////////////
+void StateSnapshotLayout::SortByName()
+{
+  this->linksByName.resize(this->linkNames.size());
+  for (unsigned int i = 0; i < this->linksByName.size(); ++i)
+    this->linksByName[i] = i;
+  for (unsigned int i = 0; i + 1 < this->modelLinkStart.size(); ++i)
+  {
+    SortIndices(this->linkNames,
+        this->linksByName.begin() + this->modelLinkStart[i],
+        this->linksByName.begin() + this->modelLinkStart[i + 1]);
+  }
+
+  this->nestedModelsByName = this->nestedModels;
+  for (auto &nested : this->nestedModelsByName)
+    SortIndices(this->modelNames, nested.begin(), nested.end());
+
+  this->lightsByName.resize(this->lightNames.size());
+  for (unsigned int i = 0; i < this->lightsByName.size(); ++i)
+    this->lightsByName[i] = i;
+  SortIndices(this->lightNames, this->lightsByName.begin(),
+      this->lightsByName.end());
+}
+
+/////////////////////////////////////////////////
+bool StateSnapshotLayout::SortedByName() const
+{
+  return this->linksByName.size() == this->linkNames.size() &&
+      this->nestedModelsByName.size() == this->nestedModels.size() &&
+      this->lightsByName.size() == this->lightNames.size();
+}
+
+/////////////////////////////////////////////////
+void StateSnapshot::Capture(World &_world, std::vector<BasePtr> &_entities,
+    StateSnapshotLayoutPtr &_layout)
+{
+  this->wallTime = common::Time::GetWallTime();
+  this->realTime = _world.RealTime();
+  this->simTime = _world.SimTime();
+  this->iterations = _world.Iterations();
+
+  if (_layout && this->Fill(_world, _entities))
+  {
+    this->layout = _layout;
+    return;
+  }
+
+  // The entities of the world changed, start a new layout.
+  auto newLayout = std::make_shared<StateSnapshotLayout>();
+  newLayout->worldName = _world.Name();
+  _entities.clear();
+
+  for (unsigned int i = 0; i < _world.ModelCount(); ++i)
+  {
+    newLayout->topModels.push_back(
+        AddModel(_world.ModelByIndex(i), *newLayout, _entities));
+  }
+  newLayout->modelLinkStart.push_back(newLayout->linkNames.size());
+
+  for (const auto &light : _world.Lights())
+  {
+    newLayout->lightNames.push_back(light->GetName());
+    _entities.push_back(light);
+  }
+
+  newLayout->SortByName();
+  _layout = newLayout;
+
+  bool filled = this->Fill(_world, _entities);
+  GZ_ASSERT(filled, "Snapshot doesn't match the layout it was built with");
+  (void)filled;
+
+  this->layout = _layout;
+}
+
+/////////////////////////////////////////////////
+bool StateSnapshot::Fill(World &_world, const std::vector<BasePtr> &_entities)
+{
+  unsigned int entity = 0;
+  unsigned int modelIndex = 0;
+  unsigned int linkIndex = 0;
+
+  for (unsigned int i = 0; i < _world.ModelCount(); ++i)
+  {
+    if (!this->FillModel(_world.ModelByIndex(i), _entities, entity,
+          modelIndex, linkIndex))
+    {
+      return false;
+    }
+  }
+  this->modelPoses.resize(modelIndex);
+  this->modelScales.resize(modelIndex);
+  this->linkPoses.resize(linkIndex);
+  this->linkLinearVels.resize(linkIndex);
+  this->linkAngularVels.resize(linkIndex);
+  this->linkLinearAccels.resize(linkIndex);
+  this->linkAngularAccels.resize(linkIndex);
+  this->linkForces.resize(linkIndex);
+
+  unsigned int lightIndex = 0;
+  for (const auto &light : _world.Lights())
+  {
+    if (entity >= _entities.size() || _entities[entity] != light)
+      return false;
+    ++entity;
+
+    if (lightIndex >= this->lightPoses.size())
+      this->lightPoses.resize(lightIndex + 1);
+    this->lightPoses[lightIndex++] = light->WorldPose();
+  }
+  this->lightPoses.resize(lightIndex);
+
+  return entity == _entities.size();
+}
+
+/////////////////////////////////////////////////
+bool StateSnapshot::FillModel(const ModelPtr &_model,
+    const std::vector<BasePtr> &_entities, unsigned int &_entity,
+    unsigned int &_modelIndex, unsigned int &_linkIndex)
+{
+  if (_entity >= _entities.size() || _entities[_entity] != _model)
+    return false;
+  ++_entity;
+
+  // The arrays only grow while the first snapshot of a layout is taken,
+  // later ones reuse the memory.
+  if (_modelIndex >= this->modelPoses.size())
+  {
+    this->modelPoses.resize(_modelIndex + 1);
+    this->modelScales.resize(_modelIndex + 1);
+  }
+  this->modelPoses[_modelIndex] = _model->WorldPose();
+  this->modelScales[_modelIndex] = _model->Scale();
+  ++_modelIndex;
+
+  for (const auto &link : _model->GetLinks())
+  {
+    if (_entity >= _entities.size() || _entities[_entity] != link)
+      return false;
+    ++_entity;
+
+    if (_linkIndex >= this->linkPoses.size())
+    {
+      unsigned int size = _linkIndex + 1;
+      this->linkPoses.resize(size);
+      this->linkLinearVels.resize(size);
+      this->linkAngularVels.resize(size);
+      this->linkLinearAccels.resize(size);
+      this->linkAngularAccels.resize(size);
+      this->linkForces.resize(size);
+    }
+    this->linkPoses[_linkIndex] = link->WorldPose();
+    this->linkLinearVels[_linkIndex] = link->WorldLinearVel();
+    this->linkAngularVels[_linkIndex] = link->WorldAngularVel();
+    this->linkLinearAccels[_linkIndex] = link->WorldLinearAccel();
+    this->linkAngularAccels[_linkIndex] = link->WorldAngularAccel();
+    this->linkForces[_linkIndex] = link->WorldForce();
+    ++_linkIndex;
+  }
+
+  for (const auto &nested : _model->NestedModels())
+  {
+    if (!this->FillModel(nested, _entities, _entity, _modelIndex, _linkIndex))
+      return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+StateSnapshotRing::StateSnapshotRing(const unsigned int _capacity)
+  : slots(std::max(_capacity, 1u))
+{
+}
+
+/////////////////////////////////////////////////
+StateSnapshot *StateSnapshotRing::Claim()
+{
+  uint64_t h = this->head.load(std::memory_order_relaxed);
+  if (h - this->tail.load(std::memory_order_acquire) >= this->slots.size())
+    return nullptr;
+
+  return &this->slots[h % this->slots.size()];
+}
+
+/////////////////////////////////////////////////
+void StateSnapshotRing::Publish()
+{
+  this->head.store(this->head.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+StateSnapshot *StateSnapshotRing::Front()
+{
+  uint64_t t = this->tail.load(std::memory_order_relaxed);
+  if (t == this->head.load(std::memory_order_acquire))
+    return nullptr;
+
+  return &this->slots[t % this->slots.size()];
+}
+
+/////////////////////////////////////////////////
+void StateSnapshotRing::Pop()
+{
+  this->tail.store(this->tail.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+bool StateSnapshotRing::Empty() const
+{
+  return this->tail.load(std::memory_order_acquire) ==
+         this->head.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+unsigned int StateSnapshotRing::Capacity() const
+{
+  return this->slots.size();
+}
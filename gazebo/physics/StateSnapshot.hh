@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_STATESNAPSHOT_HH_
+#define GAZEBO_PHYSICS_STATESNAPSHOT_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class StateSnapshotLayout StateSnapshot.hh physics/physics.hh
+    /// \brief Names and hierarchy of the entities stored in a
+    /// StateSnapshot. A layout is immutable once built, and shared by all
+    /// the snapshots taken while the set of entities in the world doesn't
+    /// change.
+    class GZ_PHYSICS_VISIBLE StateSnapshotLayout
+    {
+      /// \brief Name of the world.
+      public: std::string worldName;
+
+      /// \brief Names of all the models, nested models included, in depth
+      /// first order.
+      public: std::vector<std::string> modelNames;
+
+      /// \brief Index of the first link of each model. The links of model i
+      /// are [modelLinkStart[i], modelLinkStart[i + 1]), so the vector has
+      /// one more element than modelNames.
+      public: std::vector<unsigned int> modelLinkStart;
+
+      /// \brief Indices of the nested models of each model.
+      public: std::vector<std::vector<unsigned int>> nestedModels;
+
+      /// \brief Indices of the models that are direct children of the
+      /// world.
+      public: std::vector<unsigned int> topModels;
+
+      /// \brief Names of all the links.
+      public: std::vector<std::string> linkNames;
+
+      /// \brief Names of all the lights.
+      public: std::vector<std::string> lightNames;
+
+      /// \brief Indices of the links of each model sorted by name, over the
+      /// same ranges as modelLinkStart. Filled by SortByName.
+      public: std::vector<unsigned int> linksByName;
+
+      /// \brief Indices of the nested models of each model sorted by name.
+      /// Filled by SortByName.
+      public: std::vector<std::vector<unsigned int>> nestedModelsByName;
+
+      /// \brief Indices of the lights sorted by name. Filled by SortByName.
+      public: std::vector<unsigned int> lightsByName;
+
+      /// \brief Fill the members that order entities by name, from the
+      /// other members. The states built from snapshots are maps keyed by
+      /// name, walking the entities in the same order lets them be updated
+      /// in place.
+      public: void SortByName();
+
+      /// \brief Get whether the members that order entities by name match
+      /// the other members.
+      /// \return True if SortByName was called on the complete layout.
+      public: bool SortedByName() const;
+    };
+
+    /// \brief Shared pointer to a StateSnapshotLayout.
+    typedef std::shared_ptr<const StateSnapshotLayout> StateSnapshotLayoutPtr;
+
+    /// \class StateSnapshot StateSnapshot.hh physics/physics.hh
+    /// \brief Raw state of a world at one simulation step, stored as one
+    /// flat array per quantity. Taking a snapshot only copies poses and
+    /// twists, and doesn't allocate once the arrays have grown to the size
+    /// of the world. A WorldState is built from a snapshot with
+    /// WorldState::Load, away from the physics thread.
+    class GZ_PHYSICS_VISIBLE StateSnapshot
+    {
+      /// \brief Copy the state of a world. Must be called from the physics
+      /// thread.
+      /// \param[in] _world World to copy the state of.
+      /// \param[in,out] _entities Entities captured by the previous call.
+      /// The layout is rebuilt when they don't match the entities of the
+      /// world. The pointers keep the entities alive, so that one created
+      /// at the address of a deleted one can't be mistaken for it.
+      /// \param[in,out] _layout Layout of the previous capture, replaced
+      /// when the entities of the world changed.
+      public: void Capture(World &_world, std::vector<BasePtr> &_entities,
+                  StateSnapshotLayoutPtr &_layout);
+
+      /// \brief Copy the state of the world, assuming its entities match
+      /// _entities.
+      /// \param[in] _world World to copy the state of.
+      /// \param[in] _entities Entities of the current layout.
+      /// \return False if the entities of the world don't match.
+      private: bool Fill(World &_world, const std::vector<BasePtr> &_entities);
+
+      /// \brief Copy the state of a model and its nested models.
+      /// \param[in] _model Model to copy.
+      /// \param[in] _entities Entities of the current layout.
+      /// \param[in,out] _entity Index of the next entity.
+      /// \param[in,out] _modelIndex Index of the next model.
+      /// \param[in,out] _linkIndex Index of the next link.
+      /// \return False if the entities of the world don't match.
+      private: bool FillModel(const ModelPtr &_model,
+                   const std::vector<BasePtr> &_entities,
+                   unsigned int &_entity, unsigned int &_modelIndex,
+                   unsigned int &_linkIndex);
+
+      /// \brief Layout of the snapshot.
+      public: StateSnapshotLayoutPtr layout;
+
+      /// \brief Wall time at which the snapshot was taken.
+      public: common::Time wallTime;
+
+      /// \brief Real time of the world.
+      public: common::Time realTime;
+
+      /// \brief Sim time of the world.
+      public: common::Time simTime;
+
+      /// \brief Simulation iterations.
+      public: uint64_t iterations = 0;
+
+      /// \brief World pose of each model.
+      public: std::vector<ignition::math::Pose3d> modelPoses;
+
+      /// \brief Scale of each model.
+      public: std::vector<ignition::math::Vector3d> modelScales;
+
+      /// \brief World pose of each link.
+      public: std::vector<ignition::math::Pose3d> linkPoses;
+
+      /// \brief World linear velocity of each link.
+      public: std::vector<ignition::math::Vector3d> linkLinearVels;
+
+      /// \brief World angular velocity of each link.
+      public: std::vector<ignition::math::Vector3d> linkAngularVels;
+
+      /// \brief World linear acceleration of each link.
+      public: std::vector<ignition::math::Vector3d> linkLinearAccels;
+
+      /// \brief World angular acceleration of each link.
+      public: std::vector<ignition::math::Vector3d> linkAngularAccels;
+
+      /// \brief World force applied to each link.
+      public: std::vector<ignition::math::Vector3d> linkForces;
+
+      /// \brief World pose of each light.
+      public: std::vector<ignition::math::Pose3d> lightPoses;
+    };
+
+    /// \brief Load the states of entities of a snapshot into a map keyed by
+    /// name. When the map already holds the states of the same entities,
+    /// they are updated in place, which doesn't allocate.
+    /// \param[in] _snapshot The snapshot.
+    /// \param[in] _names Names of the entities, by index in the snapshot.
+    /// \param[in] _begin First index of the entities to load. The states are
+    /// updated in place only if the indices are sorted by name.
+    /// \param[in] _end End of the indices of the entities to load.
+    /// \param[in,out] _states The states, such as LinkState or ModelState,
+    /// which must have a Load(const StateSnapshot &, unsigned int) function.
+    template<typename S, typename I>
+    void LoadSnapshotStates(const StateSnapshot &_snapshot,
+        const std::vector<std::string> &_names, const I _begin, const I _end,
+        std::map<std::string, S> &_states)
+    {
+      bool inPlace = _states.size() ==
+          static_cast<size_t>(std::distance(_begin, _end));
+      auto state = _states.begin();
+      for (I i = _begin; inPlace && i != _end; ++i, ++state)
+      {
+        if (state->first == _names[*i])
+          state->second.Load(_snapshot, *i);
+        else
+          inPlace = false;
+      }
+
+      if (inPlace)
+        return;
+
+      _states.clear();
+      for (I i = _begin; i != _end; ++i)
+        _states[_names[*i]].Load(_snapshot, *i);
+    }
+
+    /// \class StateSnapshotRing StateSnapshot.hh physics/physics.hh
+    /// \brief Fixed size single producer, single consumer queue of
+    /// snapshots. The slots are allocated once and reused, and neither
+    /// side ever blocks: the producer fills the slot returned by Claim and
+    /// makes it visible with Publish, the consumer reads the slot returned
+    /// by Front and releases it with Pop.
+    class GZ_PHYSICS_VISIBLE StateSnapshotRing
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Number of slots.
+      public: explicit StateSnapshotRing(const unsigned int _capacity = 128);
+
+      /// \brief Get the slot to fill next. Producer only.
+      /// \return The slot, or nullptr if the ring is full.
+      public: StateSnapshot *Claim();
+
+      /// \brief Make the slot returned by Claim visible to the consumer.
+      /// Producer only.
+      public: void Publish();
+
+      /// \brief Get the oldest published snapshot. Consumer only.
+      /// \return The snapshot, or nullptr if the ring is empty.
+      public: StateSnapshot *Front();
+
+      /// \brief Release the snapshot returned by Front. Consumer only.
+      public: void Pop();
+
+      /// \brief Get whether there is no published snapshot.
+      /// \return True if the ring is empty.
+      public: bool Empty() const;
+
+      /// \brief Get the number of slots.
+      /// \return Capacity of the ring.
+      public: unsigned int Capacity() const;
+
+      /// \brief The slots.
+      private: std::vector<StateSnapshot> slots;
+
+      /// \brief Number of snapshots published. Written by the producer.
+      private: std::atomic<uint64_t> head{0};
+
+      /// \brief Number of snapshots popped. Written by the consumer.
+      private: std::atomic<uint64_t> tail{0};
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <thread>
+
+#include "test/util.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/physics/WorldState.hh"
+
+using namespace gazebo;
+
+class StateSnapshotTest : public gazebo::testing::AutoLogFixture { };
+
+//////////////////////////////////////////////////
+TEST_F(StateSnapshotTest, RingOrder)
+{
+  physics::StateSnapshotRing ring(4);
+  EXPECT_EQ(4u, ring.Capacity());
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_EQ(nullptr, ring.Front());
+
+  // Fill the ring, the next claim must fail instead of overwriting.
+  for (uint64_t i = 0; i < 4; ++i)
+  {
+    physics::StateSnapshot *slot = ring.Claim();
+    ASSERT_NE(nullptr, slot);
+    slot->iterations = i;
+    ring.Publish();
+  }
+  EXPECT_EQ(nullptr, ring.Claim());
+  EXPECT_FALSE(ring.Empty());
+
+  // Popping one frees a slot.
+  ASSERT_NE(nullptr, ring.Front());
+  EXPECT_EQ(0u, ring.Front()->iterations);
+  ring.Pop();
+
+  physics::StateSnapshot *slot = ring.Claim();
+  ASSERT_NE(nullptr, slot);
+  slot->iterations = 4;
+  ring.Publish();
+
+  for (uint64_t i = 1; i < 5; ++i)
+  {
+    ASSERT_NE(nullptr, ring.Front());
+    EXPECT_EQ(i, ring.Front()->iterations);
+    ring.Pop();
+  }
+  EXPECT_TRUE(ring.Empty());
+}
+
+//////////////////////////////////////////////////
+TEST_F(StateSnapshotTest, RingThreads)
+{
+  const uint64_t count = 100000;
+  physics::StateSnapshotRing ring(16);
+
+  std::thread producer([&ring, count]
+      {
+        for (uint64_t i = 0; i < count;)
+        {
+          physics::StateSnapshot *slot = ring.Claim();
+          if (!slot)
+          {
+            std::this_thread::yield();
+            continue;
+          }
+          slot->iterations = i;
+          slot->modelPoses.assign(1, ignition::math::Pose3d(i, 0, 0, 0, 0, 0));
+          ring.Publish();
+          ++i;
+        }
+      });
+
+  for (uint64_t i = 0; i < count;)
+  {
+    physics::StateSnapshot *slot = ring.Front();
+    if (!slot)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(i, slot->iterations);
+    ASSERT_EQ(1u, slot->modelPoses.size());
+    ASSERT_DOUBLE_EQ(static_cast<double>(i), slot->modelPoses[0].Pos().X());
+    ring.Pop();
+    ++i;
+  }
+
+  producer.join();
+  EXPECT_TRUE(ring.Empty());
+}
+
+//////////////////////////////////////////////////
+TEST_F(StateSnapshotTest, WorldStateLoad)
+{
+  // Model "box" with one link and a nested model "arm" with two links, and
+  // a model "sphere" with one link.
+  auto layout = std::make_shared<physics::StateSnapshotLayout>();
+  layout->worldName = "default";
+  layout->modelNames = {"box", "arm", "sphere"};
+  layout->modelLinkStart = {0, 1, 3, 4};
+  layout->nestedModels = {{1}, {}, {}};
+  layout->topModels = {0, 2};
+  layout->linkNames = {"base", "upper", "lower", "link"};
+  layout->lightNames = {"sun"};
+
+  physics::StateSnapshot snapshot;
+  snapshot.layout = layout;
+  snapshot.simTime = common::Time(2, 0);
+  snapshot.realTime = common::Time(3, 0);
+  snapshot.iterations = 2000;
+  for (unsigned int i = 0; i < layout->modelNames.size(); ++i)
+  {
+    snapshot.modelPoses.push_back(ignition::math::Pose3d(i, 0, 0, 0, 0, 0));
+    snapshot.modelScales.push_back(ignition::math::Vector3d::One);
+  }
+  for (unsigned int i = 0; i < layout->linkNames.size(); ++i)
+  {
+    snapshot.linkPoses.push_back(ignition::math::Pose3d(0, i, 0, 0, 0, 0));
+    snapshot.linkLinearVels.push_back(ignition::math::Vector3d(i, 0, 0));
+    snapshot.linkAngularVels.push_back(ignition::math::Vector3d::Zero);
+    snapshot.linkLinearAccels.push_back(ignition::math::Vector3d::Zero);
+    snapshot.linkAngularAccels.push_back(ignition::math::Vector3d::Zero);
+    snapshot.linkForces.push_back(ignition::math::Vector3d(0, 0, i));
+  }
+  snapshot.lightPoses.push_back(ignition::math::Pose3d(0, 0, 10, 0, 0, 0));
+
+  physics::WorldState state;
+  state.Load(physics::WorldPtr(), snapshot);
+
+  EXPECT_EQ("default", state.GetName());
+  EXPECT_EQ(common::Time(2, 0), state.GetSimTime());
+  EXPECT_EQ(2000u, state.GetIterations());
+  EXPECT_EQ(2u, state.GetModelStateCount());
+  EXPECT_EQ(1u, state.LightStateCount());
+
+  ASSERT_TRUE(state.HasModelState("box"));
+  physics::ModelState box = state.GetModelState("box");
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 0, 0, 0, 0), box.Pose());
+  EXPECT_EQ(1u, box.GetLinkStateCount());
+  EXPECT_TRUE(box.HasLinkState("base"));
+
+  ASSERT_TRUE(box.HasNestedModelState("arm"));
+  physics::ModelState arm = box.NestedModelState("arm");
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), arm.Pose());
+  EXPECT_EQ(2u, arm.GetLinkStateCount());
+  physics::LinkState lower = arm.GetLinkState("lower");
+  EXPECT_EQ(ignition::math::Pose3d(0, 2, 0, 0, 0, 0), lower.Pose());
+  EXPECT_EQ(ignition::math::Vector3d(2, 0, 0), lower.Velocity().Pos());
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, 2), lower.Wrench().Pos());
+
+  ASSERT_TRUE(state.HasModelState("sphere"));
+  EXPECT_EQ(ignition::math::Pose3d(0, 3, 0, 0, 0, 0),
+      state.GetModelState("sphere").GetLinkState("link").Pose());
+
+  ASSERT_TRUE(state.HasLightState("sun"));
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 10, 0, 0, 0),
+      state.GetLightState("sun").Pose());
+
+  // Only the models that match the filter are loaded.
+  physics::WorldState filtered;
+  filtered.LoadWithFilter(physics::WorldPtr(), snapshot, "sph*");
+  EXPECT_EQ(1u, filtered.GetModelStateCount());
+  EXPECT_TRUE(filtered.HasModelState("sphere"));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
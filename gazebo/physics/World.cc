@@ -19,13 +19,16 @@
 
 #include <tbb/parallel_for.h>
 #include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
 
 #include <sdf/sdf.hh>
 
+#include <algorithm>
 #include <deque>
 #include <list>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -46,6 +49,7 @@
 #include "gazebo/transport/Publisher.hh"
 #include "gazebo/transport/Subscriber.hh"
 
+#include "gazebo/util/BinaryLog.hh"
 #include "gazebo/util/LogPlay.hh"
 
 #include "gazebo/common/ModelDatabase.hh"
@@ -65,6 +69,7 @@
 #include "gazebo/util/IntrospectionManager.hh"
 #include "gazebo/util/LogRecord.hh"
 
+#include "gazebo/physics/AssetPrefetcher.hh"
 #include "gazebo/physics/Road.hh"
 #include "gazebo/physics/RayShape.hh"
 #include "gazebo/physics/Joint.hh"
@@ -108,6 +113,63 @@ class ModelUpdate_TBB
   private: Model_V *models;
 };
 
+//////////////////////////////////////////////////
+/// \brief Check whether two model states have the same links and nested
+/// models, so that one can be expressed as a delta of the other.
+static bool SameEntities(const ModelState &_a, const ModelState &_b)
+{
+  if (_a.GetLinkStates().size() != _b.GetLinkStates().size() ||
+      _a.NestedModelStates().size() != _b.NestedModelStates().size())
+  {
+    return false;
+  }
+
+  for (auto const &link : _a.GetLinkStates())
+  {
+    if (!_b.HasLinkState(link.first))
+      return false;
+  }
+
+  for (auto const &nested : _a.NestedModelStates())
+  {
+    if (!_b.HasNestedModelState(nested.first) ||
+        !SameEntities(nested.second, _b.NestedModelState(nested.first)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether two world states have the same entities.
+static bool SameEntities(const WorldState &_a, const WorldState &_b)
+{
+  if (_a.GetModelStates().size() != _b.GetModelStates().size() ||
+      _a.LightStates().size() != _b.LightStates().size())
+  {
+    return false;
+  }
+
+  for (auto const &model : _a.GetModelStates())
+  {
+    if (!_b.HasModelState(model.first) ||
+        !SameEntities(model.second, _b.GetModelState(model.first)))
+    {
+      return false;
+    }
+  }
+
+  for (auto const &light : _a.LightStates())
+  {
+    if (!_b.HasLightState(light.first))
+      return false;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 World::World(const std::string &_name)
   : dataPtr(new WorldPrivate)
@@ -296,6 +358,31 @@ void World::Load(sdf::ElementPtr _sdf)
 
   this->dataPtr->physicsEngine->Load(physicsElem);
 
+  // The SDF specification has no element for the number of threads used to
+  // update models, so it is read from a custom element. The gzserver
+  // --model_update_threads flag is applied after loading and overrides it.
+  if (physicsElem->HasElement("gazebo:model_update_threads"))
+  {
+    std::string threads = physicsElem->GetElement(
+        "gazebo:model_update_threads")->Get<std::string>();
+    int value = -1;
+    try
+    {
+      value = std::stoi(threads);
+    }
+    catch(...)
+    {
+    }
+
+    if (value >= 0)
+      this->dataPtr->modelUpdateThreads = static_cast<unsigned int>(value);
+    else
+    {
+      gzerr << "Invalid <gazebo:model_update_threads> [" << threads
+            << "], models are updated serially\n";
+    }
+  }
+
   // This should come before loading of entities
   sdf::ElementPtr windElem = this->dataPtr->sdf->GetElement("wind");
 
@@ -341,25 +428,28 @@ void World::Load(sdf::ElementPtr _sdf)
   this->dataPtr->rootElement.reset(new Base(BasePtr()));
   this->dataPtr->rootElement->SetName(this->Name());
   this->dataPtr->rootElement->SetWorld(shared_from_this());
+  this->IndexEntity(this->dataPtr->rootElement);
 
   // A special order is necessary when loading a world that contains state
   // information. The joints must be created last, otherwise they get
   // initialized improperly.
   {
+    // Load the meshes and heightmaps of all the collisions in parallel,
+    // the entities then find them already loaded.
+    AssetPrefetcher::Instance()->Prefetch({this->dataPtr->sdf});
+
     // Create all the entities
     this->LoadEntities(this->dataPtr->sdf, this->dataPtr->rootElement);
 
     for (unsigned int i = 0; i < this->ModelCount(); ++i)
       this->ModelByIndex(i)->LoadJoints();
+
+    AssetPrefetcher::Instance()->Clear();
   }
 
-  // TODO: Performance test to see if TBB model updating is necessary
-  // Choose threaded or unthreaded model updating depending on the number of
-  // models in the scene
-  // if (this->ModelCount() < 20)
-  this->dataPtr->modelUpdateFunc = &World::ModelUpdateSingleLoop;
-  // else
-  // this->dataPtr->modelUpdateFunc = &World::ModelUpdateTBB;
+  // Choose threaded or unthreaded model updating. The number of threads
+  // may have been set before loading, or read from <physics> above.
+  this->SetModelUpdateThreads(this->dataPtr->modelUpdateThreads);
 
   event::Events::worldCreated(this->Name());
 
@@ -445,7 +535,6 @@ void World::Init(UpdateScenePosesFunc _func)
   this->dataPtr->updateInfo.worldName = this->Name();
 
   this->dataPtr->iterations = 0;
-  this->dataPtr->logPrevIteration = 0;
 
   util::DiagnosticManager::Instance()->Init(this->Name());
 
@@ -521,6 +610,12 @@ void World::Stop()
 {
   this->dataPtr->stop = true;
 
+  // The world thread may wait for the log worker, which stops too.
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logMutex);
+  }
+  this->dataPtr->logSnapshotFreed.notify_all();
+
   // Make sure that the thread does not try to join with itself
   if (this->dataPtr->thread &&
      this->dataPtr->thread->get_id() != std::this_thread::get_id())
@@ -611,10 +706,21 @@ void World::LogStep()
       {
         this->dataPtr->stepInc = 1;
 
-        this->dataPtr->logPlayStateSDF->Clear();
-        sdf::readString(data, this->dataPtr->logPlayStateSDF);
+        if (util::BinaryLog::IsFrame(data))
+        {
+          // Binary frames are decoded directly, without going through SDF.
+          // Delta frames are added to the previous state.
+          util::BinaryLogReader reader(data.data(), data.size());
+          if (!this->dataPtr->logPlayState.ReadBinaryFrames(reader))
+            gzerr << "Unable to decode binary log frame\n";
+        }
+        else
+        {
+          this->dataPtr->logPlayStateSDF->Clear();
+          sdf::readString(data, this->dataPtr->logPlayStateSDF);
 
-        this->dataPtr->logPlayState.Load(this->dataPtr->logPlayStateSDF);
+          this->dataPtr->logPlayState.Load(this->dataPtr->logPlayStateSDF);
+        }
 
         // If it's the first step, we're going back in time or
         // rt factor is close to zero, don't sleep.
@@ -851,21 +957,6 @@ void World::Update()
   DIAG_TIMER_LAP("World::Update", "PhysicsEngine::UpdateCollision");
 
   IGN_PROFILE_BEGIN("beforePhysicsUpdate");
-  // Wait for logging to finish, if it's running.
-  if (util::LogRecord::Instance()->Running())
-  {
-    std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
-
-    // It's possible the logWorker thread never processed the previous
-    // state. This checks to make sure that we don't continute until the log
-    // worker catchs up.
-    if (this->dataPtr->iterations - this->dataPtr->logPrevIteration > 1)
-    {
-      this->dataPtr->logCondition.notify_one();
-      this->dataPtr->logContinueCondition.wait(lock);
-    }
-  }
-
   // Give clients a possibility to react to collisions before the physics
   // gets updated.
   this->dataPtr->updateInfo.realTime = this->RealTime();
@@ -908,7 +999,13 @@ void World::Update()
   IGN_PROFILE_BEGIN("LogRecordNotify");
   // Only update state information if logging data.
   if (util::LogRecord::Instance()->Running())
-    this->dataPtr->logCondition.notify_one();
+    this->LogCapture();
+  else if (!this->dataPtr->logSnapshotEntities.empty())
+  {
+    // Don't keep deleted entities alive while not recording.
+    this->dataPtr->logSnapshotEntities.clear();
+    this->dataPtr->logSnapshotLayout.reset();
+  }
   IGN_PROFILE_END();
   DIAG_TIMER_LAP("World::Update", "LogRecordNotify");
 
@@ -981,6 +1078,9 @@ void World::Fini()
   this->dataPtr->publishModelScales.clear();
   this->dataPtr->publishLightPoses.clear();
 
+  this->dataPtr->logSnapshotEntities.clear();
+  this->dataPtr->logSnapshotLayout.reset();
+
   // Clean entities
   for (auto &model : this->dataPtr->models)
   {
@@ -1155,6 +1255,222 @@ ModelPtr World::ModelById(unsigned int _id) const
       this->dataPtr->rootElement->GetById(_id));
 }
 
+/// \brief Remove an entity from a list of entities of the index.
+/// \param[in] _entity The entity.
+/// \param[in] _key Key of the list.
+/// \param[in,out] _map The lists by key.
+static void removeIndexEntry(const Base *_entity, const std::string &_key,
+    std::unordered_map<std::string, std::vector<const Base *>> &_map)
+{
+  auto iter = _map.find(_key);
+  if (iter == _map.end())
+    return;
+
+  iter->second.erase(std::remove(iter->second.begin(), iter->second.end(),
+      _entity), iter->second.end());
+  if (iter->second.empty())
+    _map.erase(iter);
+}
+
+//////////////////////////////////////////////////
+void World::IndexEntity(const BasePtr &_entity)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+  auto &indexed = this->dataPtr->indexedEntities;
+  if (indexed.find(_entity.get()) != indexed.end())
+    return;
+
+  WorldPrivate::IndexedEntity &entry = indexed[_entity.get()];
+  entry.entity = _entity;
+  entry.name = _entity->GetName();
+  entry.scopedName = _entity->GetScopedName();
+  entry.id = _entity->GetId();
+
+  this->dataPtr->entitiesByName[entry.name].push_back(_entity.get());
+  if (entry.scopedName != entry.name)
+    this->dataPtr->entitiesByName[entry.scopedName].push_back(_entity.get());
+  this->dataPtr->entitiesById[entry.id] = _entity.get();
+}
+
+//////////////////////////////////////////////////
+void World::ReindexEntity(const Base *_entity)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+  auto iter = this->dataPtr->indexedEntities.find(_entity);
+  if (iter == this->dataPtr->indexedEntities.end())
+    return;
+
+  WorldPrivate::IndexedEntity &entry = iter->second;
+  if (entry.name == _entity->GetName() &&
+      entry.scopedName == _entity->GetScopedName())
+  {
+    return;
+  }
+
+  removeIndexEntry(_entity, entry.name, this->dataPtr->entitiesByName);
+  removeIndexEntry(_entity, entry.scopedName, this->dataPtr->entitiesByName);
+
+  entry.name = _entity->GetName();
+  entry.scopedName = _entity->GetScopedName();
+  this->dataPtr->entitiesByName[entry.name].push_back(_entity);
+  if (entry.scopedName != entry.name)
+    this->dataPtr->entitiesByName[entry.scopedName].push_back(_entity);
+}
+
+//////////////////////////////////////////////////
+boost::weak_ptr<Base> World::UnindexEntity(const Base *_entity)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+  auto iter = this->dataPtr->indexedEntities.find(_entity);
+  if (iter == this->dataPtr->indexedEntities.end())
+    return boost::weak_ptr<Base>();
+
+  boost::weak_ptr<Base> entity = iter->second.entity;
+  removeIndexEntry(_entity, iter->second.name, this->dataPtr->entitiesByName);
+  removeIndexEntry(_entity, iter->second.scopedName,
+      this->dataPtr->entitiesByName);
+
+  auto idIter = this->dataPtr->entitiesById.find(iter->second.id);
+  if (idIter != this->dataPtr->entitiesById.end() && idIter->second == _entity)
+    this->dataPtr->entitiesById.erase(idIter);
+
+  this->dataPtr->indexedEntities.erase(iter);
+  return entity;
+}
+
+/// \brief Tell whether an entity is a descendant of another.
+/// \param[in] _entity The entity.
+/// \param[in] _scope The ancestor.
+/// \return True if _scope is found walking up the parents of _entity.
+static bool inScope(const BasePtr &_entity, const Base *_scope)
+{
+  for (BasePtr parent = _entity->GetParent(); parent;
+       parent = parent->GetParent())
+  {
+    if (parent.get() == _scope)
+      return true;
+  }
+  return false;
+}
+
+/// \brief Find the first of several entities in depth first order. Only
+/// the subtrees holding them are searched, and the children of an entity
+/// are scanned until the first one leading to a candidate.
+/// \param[in] _entity The entity whose descendants are searched.
+/// \param[in] _candidates The candidates.
+/// \param[in] _ancestors The ancestors of the candidates below _entity.
+/// \return The first candidate, or null if none can be reached through the
+/// lists of children, such as entities removed from their parent.
+static BasePtr firstInTreeOrder(const Base *_entity,
+    const std::unordered_set<const Base *> &_candidates,
+    const std::unordered_set<const Base *> &_ancestors)
+{
+  for (unsigned int i = 0; i < _entity->GetChildCount(); ++i)
+  {
+    BasePtr child = _entity->GetChild(i);
+    if (_candidates.count(child.get()))
+      return child;
+
+    if (_ancestors.count(child.get()))
+    {
+      BasePtr result = firstInTreeOrder(child.get(), _candidates, _ancestors);
+      if (result)
+        return result;
+    }
+  }
+  return BasePtr();
+}
+
+//////////////////////////////////////////////////
+bool World::IndexedBaseByName(const Base *_scope, const std::string &_name,
+    BasePtr &_result) const
+{
+  _result.reset();
+
+  // Lock the candidates while holding the mutex, and use them after
+  // releasing it: the last reference of an entity may be dropped meanwhile,
+  // and its destructor removes it from the index.
+  Base_V candidates;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+    if (this->dataPtr->indexedEntities.find(_scope) ==
+        this->dataPtr->indexedEntities.end())
+    {
+      return false;
+    }
+
+    auto iter = this->dataPtr->entitiesByName.find(_name);
+    if (iter == this->dataPtr->entitiesByName.end())
+      return true;
+
+    for (const Base *entity : iter->second)
+    {
+      BasePtr candidate =
+          this->dataPtr->indexedEntities.at(entity).entity.lock();
+      if (candidate)
+        candidates.push_back(candidate);
+    }
+  }
+
+  // Keep the descendants of _scope.
+  auto end = std::remove_if(candidates.begin(), candidates.end(),
+      [_scope](const BasePtr &_candidate)
+      {
+        return !inScope(_candidate, _scope);
+      });
+  candidates.erase(end, candidates.end());
+
+  if (candidates.size() == 1)
+  {
+    _result = candidates.front();
+    return true;
+  }
+
+  // When several entities share the name, return the one a depth first
+  // search of the tree would find first, without entering the subtrees
+  // that hold none of them.
+  std::unordered_set<const Base *> candidateSet;
+  std::unordered_set<const Base *> ancestors;
+  for (auto const &candidate : candidates)
+  {
+    candidateSet.insert(candidate.get());
+    for (BasePtr parent = candidate->GetParent();
+         parent && parent.get() != _scope; parent = parent->GetParent())
+    {
+      if (!ancestors.insert(parent.get()).second)
+        break;
+    }
+  }
+  _result = firstInTreeOrder(_scope, candidateSet, ancestors);
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool World::IndexedBaseById(const Base *_scope, const unsigned int _id,
+    BasePtr &_result) const
+{
+  _result.reset();
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+    if (this->dataPtr->indexedEntities.find(_scope) ==
+        this->dataPtr->indexedEntities.end())
+    {
+      return false;
+    }
+
+    auto iter = this->dataPtr->entitiesById.find(_id);
+    if (iter != this->dataPtr->entitiesById.end())
+      _result = this->dataPtr->indexedEntities.at(iter->second).entity.lock();
+  }
+
+  // Only the children of _scope are searched
+  if (_result && _result->GetParent().get() != _scope)
+    _result.reset();
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 ModelPtr World::ModelByName(const std::string &_name) const
 {
@@ -1199,6 +1515,7 @@ ModelPtr World::LoadModel(sdf::ElementPtr _sdf , BasePtr _parent)
     model->SetWorld(shared_from_this());
     model->Load(_sdf);
 
+    this->dataPtr->physicsEngine->GetContactManager()->OnModelInserted(model);
     event::Events::addEntity(model->GetScopedName());
 
     msgs::Model msg;
@@ -1260,6 +1577,7 @@ ActorPtr World::LoadActor(sdf::ElementPtr _sdf , BasePtr _parent)
   actor->SetWorld(shared_from_this());
   actor->Load(_sdf);
 
+  this->dataPtr->physicsEngine->GetContactManager()->OnModelInserted(actor);
   event::Events::addEntity(actor->GetScopedName());
 
   msgs::Model msg;
@@ -1682,12 +2000,55 @@ void World::BuildSceneMsg(msgs::Scene &_scene, BasePtr _entity)
 
 
 //////////////////////////////////////////////////
-// void World::ModelUpdateTBB()
-// {
-//   tbb::parallel_for (tbb::blocked_range<size_t>(0,
-//   this->dataPtr->models.size(), 10),
-//       ModelUpdate_TBB(&this->dataPtr->models));
-// }
+void World::ModelUpdateTBB()
+{
+  DIAG_TIMER_START("World::ModelUpdateTBB");
+
+  IGN_PROFILE("World::ModelUpdateTBB");
+  IGN_PROFILE_BEGIN("partition");
+  // Split the children of the root element into models that can be
+  // updated concurrently and entities that touch shared state. The
+  // vectors are reused between iterations to avoid allocations.
+  this->dataPtr->parallelModels.clear();
+  this->dataPtr->serialEntities.clear();
+  for (unsigned int i = 0; i < this->dataPtr->rootElement->GetChildCount(); ++i)
+  {
+    BasePtr child = this->dataPtr->rootElement->GetChild(i);
+    if (child->HasType(Base::MODEL) && !child->HasType(Base::ACTOR))
+    {
+      ModelPtr model = boost::static_pointer_cast<Model>(child);
+      if (model->UpdateIsolated())
+      {
+        this->dataPtr->parallelModels.push_back(model);
+        continue;
+      }
+    }
+    this->dataPtr->serialEntities.push_back(child);
+  }
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::ModelUpdateTBB", "partition");
+
+  IGN_PROFILE_BEGIN("parallel");
+  // The arena keeps its worker threads alive between iterations, and the
+  // TBB scheduler balances the models across them with work stealing.
+  // Each Model::Update still locks its own updateMutex.
+  Model_V *models = &this->dataPtr->parallelModels;
+  this->dataPtr->modelUpdateArena->execute([models]()
+  {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, models->size()),
+        ModelUpdate_TBB(models));
+  });
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::ModelUpdateTBB", "parallel");
+
+  IGN_PROFILE_BEGIN("serial");
+  for (auto &entity : this->dataPtr->serialEntities)
+    entity->Update();
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::ModelUpdateTBB", "serial");
+
+  DIAG_TIMER_STOP("World::ModelUpdateTBB");
+}
 
 //////////////////////////////////////////////////
 void World::ModelUpdateSingleLoop()
@@ -1698,6 +2059,31 @@ void World::ModelUpdateSingleLoop()
 }
 
 
+//////////////////////////////////////////////////
+void World::SetModelUpdateThreads(const unsigned int _threads)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->worldUpdateMutex);
+
+  this->dataPtr->modelUpdateThreads = _threads;
+  if (_threads == 0)
+  {
+    this->dataPtr->modelUpdateArena.reset();
+    this->dataPtr->modelUpdateFunc = &World::ModelUpdateSingleLoop;
+  }
+  else
+  {
+    this->dataPtr->modelUpdateArena.reset(
+        new tbb::task_arena(static_cast<int>(_threads)));
+    this->dataPtr->modelUpdateFunc = &World::ModelUpdateTBB;
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int World::ModelUpdateThreads() const
+{
+  return this->dataPtr->modelUpdateThreads;
+}
+
 //////////////////////////////////////////////////
 void World::LoadPlugins()
 {
@@ -2267,6 +2653,13 @@ void World::ProcessFactoryMsgs()
     }
   }
 
+  // Load the assets of all the new models in parallel
+  if (!modelsToLoad.empty())
+  {
+    AssetPrefetcher::Instance()->Prefetch(
+        std::vector<sdf::ElementPtr>(modelsToLoad.begin(), modelsToLoad.end()));
+  }
+
   // Load models
   for (auto const &elem : modelsToLoad)
   {
@@ -2286,6 +2679,7 @@ void World::ProcessFactoryMsgs()
       gzerr << "Loading model from factory message failed\n";
     }
   }
+  AssetPrefetcher::Instance()->Clear();
 
   // Load lights
   for (auto const &elem : lightsToLoad)
@@ -2632,15 +3026,116 @@ void World::LogModelResources()
 bool World::OnLog(std::ostringstream &_stream)
 {
   int bufferIndex = this->dataPtr->currentStateBuffer;
+
+  // The "bin" encoding stores each state as a binary frame instead of SDF.
+  // With a keyframe interval or period, states between keyframes are stored
+  // as quantized deltas. Each call to OnLog produces a chunk of the log
+  // file, and each chunk starts with a keyframe so that it can be decoded
+  // on its own.
+  util::LogRecord *logRecord = util::LogRecord::Instance();
+  const bool binary = logRecord->Encoding() == "bin";
+  const unsigned int keyframeInterval = logRecord->KeyframeInterval();
+  const double keyframePeriod = logRecord->KeyframePeriod();
+  const bool deltas = binary && (keyframeInterval > 0 || keyframePeriod > 0);
+  this->dataPtr->logDeltaValid = false;
+
+  std::string frame;
+  auto writeState = [&](const WorldState &_state)
+  {
+    if (binary)
+    {
+      frame.clear();
+      util::BinaryLogWriter writer(frame);
+
+      bool keyframe = !deltas || !this->dataPtr->logDeltaValid ||
+        !_state.Insertions().empty() || !_state.Deletions().empty() ||
+        (keyframeInterval > 0 &&
+         this->dataPtr->logFramesSinceKeyframe + 1 >= keyframeInterval) ||
+        (keyframePeriod > 0 &&
+         (_state.GetSimTime() - this->dataPtr->logKeyframeTime).Double() >=
+         keyframePeriod) ||
+        !SameEntities(_state, this->dataPtr->logDeltaRef);
+
+      if (!keyframe)
+      {
+        WorldState delta = _state - this->dataPtr->logDeltaRef;
+        size_t offset = writer.BeginFrame(util::BinaryLogFrameType::DELTA,
+            _state.GetSimTime(), _state.GetIterations());
+        if (delta.WriteBinaryDelta(writer))
+        {
+          writer.EndFrame(offset);
+
+          // Advance the reference the same way a reader will.
+          util::BinaryLogReader reader(frame.data(), frame.size());
+          WorldState quantized;
+          util::BinaryLogFrameHeader header;
+          reader.ReadFrameHeader(header);
+          quantized.ReadBinaryDelta(reader);
+          this->dataPtr->logDeltaRef = this->dataPtr->logDeltaRef + quantized;
+          this->dataPtr->logDeltaRef.SetSimTime(_state.GetSimTime());
+          this->dataPtr->logDeltaRef.SetWallTime(_state.GetWallTime());
+          this->dataPtr->logDeltaRef.SetRealTime(_state.GetRealTime());
+          this->dataPtr->logDeltaRef.SetIterations(_state.GetIterations());
+          this->dataPtr->logFramesSinceKeyframe++;
+        }
+        else
+        {
+          // A value didn't fit in the delta encoding.
+          frame.clear();
+          keyframe = true;
+        }
+      }
+
+      if (keyframe)
+      {
+        size_t offset = writer.BeginFrame(util::BinaryLogFrameType::STATE,
+            _state.GetSimTime(), _state.GetIterations());
+        _state.WriteBinary(writer);
+        writer.EndFrame(offset);
+
+        if (deltas)
+        {
+          this->dataPtr->logDeltaRef = _state;
+          this->dataPtr->logDeltaValid = true;
+          this->dataPtr->logFramesSinceKeyframe = 0;
+          this->dataPtr->logKeyframeTime = _state.GetSimTime();
+        }
+      }
+
+      _stream.write(frame.data(), frame.size());
+    }
+    else
+    {
+      _stream << "<sdf version='" << SDF_VERSION << "'>"
+              << _state
+              << "</sdf>";
+    }
+  };
+
   // Save the entire state when its the first call to OnLog.
   if (util::LogRecord::Instance()->FirstUpdate())
   {
     this->dataPtr->sdf->Update();
-    _stream << "<sdf version ='";
-    _stream << SDF_VERSION;
-    _stream << "'>\n";
-    _stream << this->dataPtr->sdf->ToString("");
-    _stream << "</sdf>\n";
+    std::ostringstream sdfStream;
+    sdfStream << "<sdf version ='";
+    sdfStream << SDF_VERSION;
+    sdfStream << "'>\n";
+    sdfStream << this->dataPtr->sdf->ToString("");
+    sdfStream << "</sdf>\n";
+
+    if (binary)
+    {
+      util::BinaryLogWriter writer(frame);
+      size_t offset = writer.BeginFrame(util::BinaryLogFrameType::SDF,
+          this->dataPtr->simTime, this->dataPtr->iterations);
+      frame.append(sdfStream.str());
+      writer.EndFrame(offset);
+      _stream.write(frame.data(), frame.size());
+    }
+    else
+    {
+      _stream << sdfStream.str();
+    }
   }
   else if (this->dataPtr->states[bufferIndex].size() >= 1)
   {
@@ -2649,11 +3144,7 @@ bool World::OnLog(std::ostringstream &_stream)
       this->dataPtr->currentStateBuffer ^= 1;
     }
     for (auto const &worldState : this->dataPtr->states[bufferIndex])
-    {
-      _stream << "<sdf version='" << SDF_VERSION << "'>"
-              << worldState
-              << "</sdf>";
-    }
+      writeState(worldState);
 
     this->dataPtr->states[bufferIndex].clear();
   }
@@ -2665,22 +3156,16 @@ bool World::OnLog(std::ostringstream &_stream)
     std::lock_guard<std::mutex> lock(this->dataPtr->logBufferMutex);
 
     // Output any data that may have been pushed onto the queue
-    for (size_t i = 0;
-        i < this->dataPtr->states[this->dataPtr->currentStateBuffer^1].size();
-        ++i)
+    for (auto const &worldState :
+        this->dataPtr->states[this->dataPtr->currentStateBuffer^1])
     {
-      _stream << "<sdf version='" << SDF_VERSION << "'>"
-        << this->dataPtr->states[this->dataPtr->currentStateBuffer^1][i]
-        << "</sdf>";
+      writeState(worldState);
     }
 
-    for (size_t i = 0;
-        i < this->dataPtr->states[this->dataPtr->currentStateBuffer].size();
-        ++i)
+    for (auto const &worldState :
+        this->dataPtr->states[this->dataPtr->currentStateBuffer])
     {
-      _stream << "<sdf version='" << SDF_VERSION << "'>"
-        << this->dataPtr->states[this->dataPtr->currentStateBuffer][i]
-        << "</sdf>";
+      writeState(worldState);
     }
 
     // Clear everything.
@@ -2932,25 +3417,58 @@ void World::PublishLightPose(const physics::LightPtr _light)
 }
 
 //////////////////////////////////////////////////
-void World::LogWorker()
+void World::LogCapture()
 {
-  std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
+  StateSnapshot *snapshot = this->dataPtr->logSnapshots.Claim();
+  if (!snapshot)
+  {
+    // The log worker fell behind. Wait for it, so that every step is
+    // recorded, as when the world waited for each state to be logged.
+    std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
+    this->dataPtr->logSnapshotFreed.wait(lock, [this, &snapshot]
+        {
+          snapshot = this->dataPtr->logSnapshots.Claim();
+          return snapshot || this->dataPtr->stop;
+        });
+    if (!snapshot)
+      return;
+  }
+
+  snapshot->Capture(*this, this->dataPtr->logSnapshotEntities,
+      this->dataPtr->logSnapshotLayout);
+  this->dataPtr->logSnapshots.Publish();
+
+  // Take the lock so that the notification can't get lost between the
+  // worker checking the ring and going to sleep.
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logMutex);
+  }
+  this->dataPtr->logCondition.notify_one();
+}
 
+//////////////////////////////////////////////////
+void World::LogWorker()
+{
   WorldPtr self = shared_from_this();
-  this->dataPtr->logPrevIteration = this->dataPtr->iterations;
 
   GZ_ASSERT(self, "Self pointer to World is invalid");
 
-  // Init the prevUnfilteredState
-  this->dataPtr->prevUnfilteredState.Load(self);
+  // The first snapshot initializes prevUnfilteredState, so that the
+  // entities which already exist aren't reported as insertions.
+  bool first = true;
 
   while (!this->dataPtr->stop)
   {
-    // get unfiltered world state
-    WorldState unfilteredState;
+    StateSnapshot *snapshot = this->dataPtr->logSnapshots.Front();
+    if (!snapshot)
     {
-      std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
-      unfilteredState.Load(self);
+      // Wait until there is work to be done.
+      std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
+      this->dataPtr->logCondition.wait(lock, [this]
+          {
+            return this->dataPtr->stop || !this->dataPtr->logSnapshots.Empty();
+          });
+      continue;
     }
 
     // compute world state diff and find out about insertions and deletions
@@ -2958,34 +3476,57 @@ void World::LogWorker()
     std::vector<std::string> deletions;
     bool insertDelete = false;
 
+    // Models and lights are only inserted or deleted when the layout of the
+    // snapshots changes, the unfiltered state is only needed then.
+    if (first || snapshot->layout != this->dataPtr->prevUnfilteredLayout)
     {
-      WorldState unfilteredDiffState = unfilteredState -
-          this->dataPtr->prevUnfilteredState;
-      if (!unfilteredDiffState.IsZero())
+      // get unfiltered world state
+      WorldState unfilteredState;
+      unfilteredState.Load(self, *snapshot);
+
+      if (first)
       {
-        insertions = unfilteredDiffState.Insertions();
-        deletions = unfilteredDiffState.Deletions();
-        insertDelete = !insertions.empty() || !deletions.empty();
+        this->dataPtr->prevUnfilteredState = unfilteredState;
+        first = false;
       }
+
+      {
+        // Inserted entities are described by their SDF, which is read from
+        // the world.
+        std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
+        WorldState unfilteredDiffState = unfilteredState -
+            this->dataPtr->prevUnfilteredState;
+        if (!unfilteredDiffState.IsZero())
+        {
+          insertions = unfilteredDiffState.Insertions();
+          deletions = unfilteredDiffState.Deletions();
+          insertDelete = !insertions.empty() || !deletions.empty();
+        }
+      }
+      this->dataPtr->prevUnfilteredState = unfilteredState;
+      this->dataPtr->prevUnfilteredLayout = snapshot->layout;
     }
-    this->dataPtr->prevUnfilteredState = unfilteredState;
 
     // Throttle state capture based on log recording frequency.
-    auto simTime = this->SimTime();
+    auto simTime = snapshot->simTime;
     if ((simTime - this->dataPtr->logLastStateTime >=
         util::LogRecord::Instance()->Period()) || insertDelete)
     {
       int currState = (this->dataPtr->stateToggle + 1) % 2;
 
-      std::string filterStr = util::LogRecord::Instance()->Filter();
-      // compute diff for filtered states
+      // The filter is only parsed again when it changes.
+      uint32_t filterVersion = util::LogRecord::Instance()->FilterVersion();
+      if (filterVersion != this->dataPtr->logFilterVersion)
       {
-        std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
-        this->dataPtr->prevStates[currState].LoadWithFilter(self, filterStr);
+        this->dataPtr->logFilter.Set(util::LogRecord::Instance()->Filter());
+        this->dataPtr->logFilterVersion = filterVersion;
       }
+
+      // compute diff for filtered states
+      this->dataPtr->prevStates[currState].Load(self, *snapshot,
+          this->dataPtr->logFilter);
       WorldState diffState = this->dataPtr->prevStates[currState] -
           this->dataPtr->prevStates[this->dataPtr->stateToggle];
-      this->dataPtr->logPrevIteration = this->dataPtr->iterations;
 
       if (!diffState.IsZero() || insertDelete)
       {
@@ -3012,14 +3553,21 @@ void World::LogWorker()
       this->dataPtr->logLastStateTime = simTime;
     }
 
-    this->dataPtr->logContinueCondition.notify_all();
+    this->dataPtr->logSnapshots.Pop();
 
-    // Wait until there is work to be done.
-    this->dataPtr->logCondition.wait(lock);
+    // Take the lock so that the notification can't get lost between the
+    // physics thread checking the ring and going to sleep.
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->logMutex);
+    }
+    this->dataPtr->logSnapshotFreed.notify_one();
   }
 
-  // Make sure nothing is blocked by this thread.
-  this->dataPtr->logContinueCondition.notify_all();
+  // Don't leave the physics thread waiting for a slot.
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logMutex);
+  }
+  this->dataPtr->logSnapshotFreed.notify_one();
 }
 
 /////////////////////////////////////////////////
@@ -3085,6 +3633,8 @@ void World::RemoveModel(const std::string &_name)
     {
       if ((*model)->GetName() == _name || (*model)->GetScopedName() == _name)
       {
+        this->dataPtr->physicsEngine->GetContactManager()->OnModelRemoved(
+            *model);
         this->dataPtr->models.erase(model);
         this->dataPtr->rootElement->RemoveChild(_name);
         break;
@@ -459,6 +459,20 @@ namespace gazebo
       /// \return Unique model name.
       public: std::string UniqueModelName(const std::string &_name);
 
+      /// \brief Set the number of threads used to update models. Models are
+      /// updated on a persistent work-stealing thread pool, except for
+      /// actors and models whose update touches state shared with other
+      /// models (see Model::UpdateIsolated), which are updated serially on
+      /// the physics thread. The number of threads is loaded from the
+      /// <gazebo:model_update_threads> element of <physics>.
+      /// \param[in] _threads Number of threads. Zero selects the serial
+      /// model update loop.
+      public: void SetModelUpdateThreads(const unsigned int _threads);
+
+      /// \brief Get the number of threads used to update models.
+      /// \return Number of threads, zero if models are updated serially.
+      public: unsigned int ModelUpdateThreads() const;
+
       /// \brief Set callback 'waitForSensors'
       /// \param[in] function to be called
       public: void SetSensorWaitFunc(std::function<void(double, double)> _func);
@@ -471,6 +485,41 @@ namespace gazebo
       /// \param[in] _id The id of the Model
       /// \return A pointer to the model, or NULL if no Model was found.
       private: ModelPtr ModelById(const unsigned int _id) const;
+
+      /// \brief Add an entity to the index of entities by name and id.
+      /// Called by Base when the entity is added to the entity tree.
+      /// \param[in] _entity The entity.
+      private: void IndexEntity(const BasePtr &_entity);
+
+      /// \brief Update the names of an entity in the index, if the entity
+      /// is indexed. Called by Base when the scoped name is computed.
+      /// \param[in] _entity The entity.
+      private: void ReindexEntity(const Base *_entity);
+
+      /// \brief Remove an entity from the index. Called by Base.
+      /// \param[in] _entity The entity.
+      /// \return The removed entity, empty if it was not indexed.
+      private: boost::weak_ptr<Base> UnindexEntity(const Base *_entity);
+
+      /// \brief Find an entity by name or scoped name among the
+      /// descendants of an entity, using the index.
+      /// \param[in] _scope The entity whose descendants are searched.
+      /// \param[in] _name Name or scoped name of the entity.
+      /// \param[out] _result The first match in depth first order, or null
+      /// if there is none.
+      /// \return False if _scope is not indexed, in which case the caller
+      /// searches the tree.
+      private: bool IndexedBaseByName(const Base *_scope,
+                   const std::string &_name, BasePtr &_result) const;
+
+      /// \brief Find a child of an entity by id, using the index.
+      /// \param[in] _scope The entity whose children are searched.
+      /// \param[in] _id Id of the child.
+      /// \param[out] _result The child, or null if there is none.
+      /// \return False if _scope is not indexed, in which case the caller
+      /// searches its children.
+      private: bool IndexedBaseById(const Base *_scope,
+                   const unsigned int _id, BasePtr &_result) const;
       /// \endcond
 
       /// \brief Load all plugins.
@@ -616,6 +665,9 @@ namespace gazebo
       /// \brief Thread function for logging state data.
       private: void LogWorker();
 
+      /// \brief Take a snapshot of the state for the log worker thread.
+      private: void LogCapture();
+
       /// \brief Register items in the introspection service.
       private: void RegisterIntrospectionItems();
 
@@ -660,6 +712,9 @@ namespace gazebo
 
       /// Friend SimbodyPhysics so that it has access to dataPtr->dirtyPoses
       private: friend class SimbodyPhysics;
+
+      /// Friend Base so that it maintains the entity index
+      private: friend class Base;
     };
     /// \}
   }
@@ -27,8 +27,11 @@
 #include <string>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <condition_variable>
 
+#include <tbb/task_arena.h>
+
 #include <ignition/transport.hh>
 
 #include "gazebo/common/Event.hh"
@@ -40,6 +43,8 @@
 #include "gazebo/transport/TransportTypes.hh"
 
 #include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/physics/WorldStateFilter.hh"
 #include "gazebo/physics/WorldState.hh"
 
 namespace gazebo
@@ -158,6 +163,19 @@ namespace gazebo
       /// \brief Function pointer to the model update function.
       public: void (World::*modelUpdateFunc)();
 
+      /// \brief Number of threads used to update models, zero when models
+      /// are updated serially.
+      public: unsigned int modelUpdateThreads = 0;
+
+      /// \brief Persistent task arena used to update models in parallel.
+      public: std::unique_ptr<tbb::task_arena> modelUpdateArena;
+
+      /// \brief Models updated in parallel in the current iteration.
+      public: Model_V parallelModels;
+
+      /// \brief Entities updated serially in the current iteration.
+      public: Base_V serialEntities;
+
       /// \brief Last time a world statistics message was sent.
       public: common::Time prevStatTime;
 
@@ -272,9 +290,36 @@ namespace gazebo
       /// and deletions
       public: WorldState prevUnfilteredState;
 
+      /// \brief Layout of the snapshot prevUnfilteredState was loaded from.
+      /// Only used by the log worker thread.
+      public: StateSnapshotLayoutPtr prevUnfilteredLayout;
+
+      /// \brief Compiled log record filter. Only used by the log worker
+      /// thread.
+      public: WorldStateFilter logFilter;
+
+      /// \brief Version of the log record filter that logFilter was
+      /// compiled from.
+      public: uint32_t logFilterVersion = 0;
+
       /// \brief Int used to toggle between prevStates
       public: int stateToggle;
 
+      /// \brief Reference state that the next delta frame of a binary log
+      /// is computed against. This is the state as reconstructed by a
+      /// reader, so that quantization errors don't accumulate.
+      public: WorldState logDeltaRef;
+
+      /// \brief True when logDeltaRef holds a state written in the current
+      /// chunk of a binary log.
+      public: bool logDeltaValid = false;
+
+      /// \brief Number of delta frames written since the last keyframe.
+      public: unsigned int logFramesSinceKeyframe = 0;
+
+      /// \brief Sim time of the last keyframe.
+      public: common::Time logKeyframeTime;
+
       /// \brief State from from log file.
       public: sdf::ElementPtr logPlayStateSDF;
 
@@ -306,12 +351,20 @@ namespace gazebo
       /// \brief Condition used for log worker.
       public: std::condition_variable logCondition;
 
-      /// \brief Condition used to guarantee the log worker thread doesn't
-      /// skip an interation.
-      public: std::condition_variable logContinueCondition;
+      /// \brief Snapshots taken on the physics thread while recording, and
+      /// turned into WorldStates by the log worker thread.
+      public: StateSnapshotRing logSnapshots;
+
+      /// \brief Layout of the last snapshot taken.
+      public: StateSnapshotLayoutPtr logSnapshotLayout;
+
+      /// \brief Entities of logSnapshotLayout. Only used by the physics
+      /// thread.
+      public: std::vector<BasePtr> logSnapshotEntities;
 
-      /// \brief Last iteration recorded by the log worker thread.
-      public: uint64_t logPrevIteration;
+      /// \brief Condition used by the physics thread to wait for a free
+      /// slot in logSnapshots, notified by the log worker.
+      public: std::condition_variable logSnapshotFreed;
 
       /// \brief Real time value set from a log file.
       public: common::Time logRealTime;
@@ -385,6 +438,36 @@ namespace gazebo
 
       /// \brief SDF World DOM object
       public: std::unique_ptr<sdf::World> worldSDFDom;
+
+      /// \brief An entity of the index, with the keys it is stored under.
+      public: struct IndexedEntity
+              {
+                /// \brief The entity.
+                boost::weak_ptr<Base> entity;
+
+                /// \brief Name of the entity.
+                std::string name;
+
+                /// \brief Scoped name of the entity.
+                std::string scopedName;
+
+                /// \brief Id of the entity.
+                uint32_t id;
+              };
+
+      /// \brief Protects the entity index.
+      public: mutable std::mutex entityIndexMutex;
+
+      /// \brief All the entities in the tree of rootElement.
+      public: std::unordered_map<const Base *, IndexedEntity> indexedEntities;
+
+      /// \brief Entities by name and by scoped name, in the order they were
+      /// added.
+      public: std::unordered_map<std::string, std::vector<const Base *>>
+              entitiesByName;
+
+      /// \brief Entities by id.
+      public: std::unordered_map<uint32_t, const Base *> entitiesById;
     };
   }
 }
@@ -17,14 +17,17 @@
 /* Desc: A world state
  * Author: Nate Koenig
  */
-#include <boost/algorithm/string.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Exception.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/Model.hh"
 #include "gazebo/physics/Light.hh"
+#include "gazebo/physics/StateSnapshot.hh"
 #include "gazebo/physics/WorldState.hh"
+#include "gazebo/physics/WorldStateFilter.hh"
+#include "gazebo/util/BinaryLog.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -99,37 +102,13 @@ void WorldState::Load(const WorldPtr _world)
   this->insertions.clear();
   this->deletions.clear();
 
-  std::string filter = worldStateFilter;
-  std::list<std::string> mainParts, parts;
-  boost::split(mainParts, filter, boost::is_any_of("/"));
-
-  // Create the model filter
-  if (!mainParts.empty())
-  {
-    boost::split(parts, mainParts.front(), boost::is_any_of("."));
-    if (parts.empty() && !mainParts.front().empty())
-      parts.push_back(mainParts.front());
-  }
-  std::list<std::string>::iterator partIter = parts.begin();
-
   // Add a state for all the models that match the filter
+  WorldStateFilter filter(worldStateFilter);
   Model_V models = _world->Models();
   for (Model_V::const_iterator iter = models.begin();
        iter != models.end(); ++iter)
   {
-    bool add = true;
-
-    // The first element in the filter must be a model name or a star.
-    if (partIter != parts.end() && !parts.empty() &&
-        !(*partIter).empty() && (*partIter) != "*")
-    {
-      std::string regexStr = *partIter;
-      boost::replace_all(regexStr, "*", ".*");
-      boost::regex regex(regexStr);
-      add = boost::regex_match((*iter)->GetName(), regex);
-    }
-
-    if (add)
+    if (filter.Matches((*iter)->GetName()))
     {
       this->modelStates[(*iter)->GetName()].Load(*iter, this->realTime,
           this->simTime, this->iterations);
@@ -157,6 +136,60 @@ void WorldState::Load(const WorldPtr _world)
   }
 }
 
+/////////////////////////////////////////////////
+void WorldState::LoadWithFilter(const WorldPtr _world,
+    const StateSnapshot &_snapshot, const std::string &_filter)
+{
+  WorldStateFilter filter(_filter);
+  this->Load(_world, _snapshot, filter);
+}
+
+/////////////////////////////////////////////////
+void WorldState::Load(const WorldPtr _world, const StateSnapshot &_snapshot)
+{
+  WorldStateFilter filter(worldStateFilter);
+  this->Load(_world, _snapshot, filter);
+}
+
+/////////////////////////////////////////////////
+void WorldState::Load(const WorldPtr _world, const StateSnapshot &_snapshot,
+    WorldStateFilter &_filter)
+{
+  const StateSnapshotLayout &layout = *_snapshot.layout;
+
+  if (worldStateFilter != _filter.Filter())
+    worldStateFilter = _filter.Filter();
+
+  this->world = _world;
+  this->name = layout.worldName;
+  this->wallTime = _snapshot.wallTime;
+  this->simTime = _snapshot.simTime;
+  this->realTime = _snapshot.realTime;
+  this->iterations = _snapshot.iterations;
+  this->insertions.clear();
+  this->deletions.clear();
+
+  // The states of the previous snapshot are updated in place while the
+  // entities don't change.
+  const std::vector<unsigned int> &models = _filter.Models(_snapshot.layout);
+  LoadSnapshotStates(_snapshot, layout.modelNames, models.begin(),
+      models.end(), this->modelStates);
+
+  if (layout.SortedByName())
+  {
+    LoadSnapshotStates(_snapshot, layout.lightNames,
+        layout.lightsByName.begin(), layout.lightsByName.end(),
+        this->lightStates);
+  }
+  else
+  {
+    LoadSnapshotStates(_snapshot, layout.lightNames,
+        boost::counting_iterator<unsigned int>(0),
+        boost::counting_iterator<unsigned int>(layout.lightNames.size()),
+        this->lightStates);
+  }
+}
+
 /////////////////////////////////////////////////
 void WorldState::Load(const sdf::ElementPtr _elem)
 {
@@ -261,6 +294,198 @@ void WorldState::Load(const sdf::ElementPtr _elem)
   }
 }
 
+/////////////////////////////////////////////////
+void WorldState::WriteBinary(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteString(this->name);
+  _writer.WriteTime(this->simTime);
+  _writer.WriteTime(this->wallTime);
+  _writer.WriteTime(this->realTime);
+  _writer.Write(this->iterations);
+
+  _writer.Write(static_cast<uint32_t>(this->insertions.size()));
+  for (const auto &insertion : this->insertions)
+    _writer.WriteString(insertion);
+
+  _writer.Write(static_cast<uint32_t>(this->deletions.size()));
+  for (const auto &deletion : this->deletions)
+    _writer.WriteString(deletion);
+
+  _writer.Write(static_cast<uint32_t>(this->modelStates.size()));
+  for (const auto &modelState : this->modelStates)
+    modelState.second.WriteBinary(_writer);
+
+  _writer.Write(static_cast<uint32_t>(this->lightStates.size()));
+  for (const auto &lightState : this->lightStates)
+    lightState.second.WriteBinary(_writer);
+}
+
+/////////////////////////////////////////////////
+bool WorldState::ReadBinary(util::BinaryLogReader &_reader)
+{
+  if (!_reader.ReadString(this->name) || !_reader.ReadTime(this->simTime) ||
+      !_reader.ReadTime(this->wallTime) || !_reader.ReadTime(this->realTime) ||
+      !_reader.Read(this->iterations))
+  {
+    return false;
+  }
+
+  uint32_t count = 0;
+  this->insertions.clear();
+  if (!_reader.Read(count))
+    return false;
+  this->insertions.resize(count);
+  for (auto &insertion : this->insertions)
+  {
+    if (!_reader.ReadString(insertion))
+      return false;
+  }
+
+  this->deletions.clear();
+  if (!_reader.Read(count))
+    return false;
+  this->deletions.resize(count);
+  for (auto &deletion : this->deletions)
+  {
+    if (!_reader.ReadString(deletion))
+      return false;
+  }
+
+  this->modelStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ModelState modelState;
+    if (!modelState.ReadBinary(_reader))
+      return false;
+    modelState.SetSimTime(this->simTime);
+    modelState.SetWallTime(this->wallTime);
+    modelState.SetRealTime(this->realTime);
+    modelState.SetIterations(this->iterations);
+    this->modelStates[modelState.GetName()] = modelState;
+  }
+
+  this->lightStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    LightState lightState;
+    if (!lightState.ReadBinary(_reader))
+      return false;
+    lightState.SetSimTime(this->simTime);
+    lightState.SetWallTime(this->wallTime);
+    lightState.SetRealTime(this->realTime);
+    lightState.SetIterations(this->iterations);
+    this->lightStates[lightState.GetName()] = lightState;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool WorldState::WriteBinaryDelta(util::BinaryLogWriter &_writer) const
+{
+  _writer.WriteTime(this->simTime);
+  _writer.WriteTime(this->wallTime);
+  _writer.WriteTime(this->realTime);
+  _writer.Write(this->iterations);
+
+  _writer.Write(static_cast<uint32_t>(this->modelStates.size()));
+  for (const auto &modelState : this->modelStates)
+  {
+    if (!modelState.second.WriteBinaryDelta(_writer))
+      return false;
+  }
+
+  _writer.Write(static_cast<uint32_t>(this->lightStates.size()));
+  for (const auto &lightState : this->lightStates)
+  {
+    if (!lightState.second.WriteBinaryDelta(_writer))
+      return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool WorldState::ReadBinaryDelta(util::BinaryLogReader &_reader)
+{
+  if (!_reader.ReadTime(this->simTime) || !_reader.ReadTime(this->wallTime) ||
+      !_reader.ReadTime(this->realTime) || !_reader.Read(this->iterations))
+  {
+    return false;
+  }
+
+  this->insertions.clear();
+  this->deletions.clear();
+
+  uint32_t count = 0;
+  this->modelStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ModelState modelState;
+    if (!modelState.ReadBinaryDelta(_reader))
+      return false;
+    this->modelStates[modelState.GetName()] = modelState;
+  }
+
+  this->lightStates.clear();
+  if (!_reader.Read(count))
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    LightState lightState;
+    if (!lightState.ReadBinaryDelta(_reader))
+      return false;
+    this->lightStates[lightState.GetName()] = lightState;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool WorldState::ReadBinaryFrames(util::BinaryLogReader &_reader)
+{
+  util::BinaryLogFrameHeader header;
+  while (_reader.Remaining() > 0)
+  {
+    if (!_reader.ReadFrameHeader(header))
+      return false;
+
+    util::BinaryLogReader frame(
+        _reader.Data() + _reader.Offset(), header.size);
+    _reader.Skip(header.size);
+
+    if (header.type == util::BinaryLogFrameType::STATE)
+    {
+      if (!this->ReadBinary(frame))
+        return false;
+    }
+    else if (header.type == util::BinaryLogFrameType::DELTA)
+    {
+      WorldState delta;
+      if (!delta.ReadBinaryDelta(frame))
+        return false;
+
+      // Deltas don't carry insertions or deletions, those are always
+      // recorded in complete states.
+      *this = *this + delta;
+      this->insertions.clear();
+      this->deletions.clear();
+      this->SetSimTime(delta.simTime);
+      this->SetWallTime(delta.wallTime);
+      this->SetRealTime(delta.realTime);
+      this->SetIterations(delta.iterations);
+    }
+  }
+
+  return true;
+}
+
 /////////////////////////////////////////////////
 void WorldState::SetWorld(const WorldPtr _world)
 {
@@ -538,7 +763,8 @@ WorldState WorldState::operator-(const WorldState &_state) const
     if (!_state.HasLightState(light.second.GetName()) && this->world)
     {
       LightPtr lightPtr = this->world->LightByName(light.second.GetName());
-      result.insertions.push_back(lightPtr->GetSDF()->ToString(""));
+      if (lightPtr)
+        result.insertions.push_back(lightPtr->GetSDF()->ToString(""));
     }
   }
 
@@ -556,21 +782,34 @@ WorldState WorldState::operator+(const WorldState &_state) const
   result.wallTime = this->wallTime;
   result.iterations = this->iterations;
 
-  // Add the model states.
-  for (ModelState_M::const_iterator iter =
-       _state.modelStates.begin(); iter != _state.modelStates.end(); ++iter)
+  // Add the model states. Models without a diff are unchanged.
+  for (const auto &model : this->modelStates)
   {
-    ModelState state = this->GetModelState(iter->second.GetName()) +
-      iter->second;
-    result.modelStates.insert(std::make_pair(state.GetName(), state));
+    auto iter = _state.modelStates.find(model.first);
+    if (iter != _state.modelStates.end())
+    {
+      ModelState state = model.second + iter->second;
+      result.modelStates.insert(std::make_pair(state.GetName(), state));
+    }
+    else
+    {
+      result.modelStates.insert(model);
+    }
   }
 
   // Add the light states.
-  for (const auto &light : _state.lightStates)
+  for (const auto &light : this->lightStates)
   {
-    LightState state = this->GetLightState(light.second.GetName()) +
-        light.second;
-    result.lightStates.insert(std::make_pair(state.GetName(), state));
+    auto iter = _state.lightStates.find(light.first);
+    if (iter != _state.lightStates.end())
+    {
+      LightState state = light.second + iter->second;
+      result.lightStates.insert(std::make_pair(state.GetName(), state));
+    }
+    else
+    {
+      result.lightStates.insert(light);
+    }
   }
 
   return result;
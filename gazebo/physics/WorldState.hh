@@ -33,8 +33,17 @@
 
 namespace gazebo
 {
+  namespace util
+  {
+    class BinaryLogReader;
+    class BinaryLogWriter;
+  }
+
   namespace physics
   {
+    class StateSnapshot;
+    class WorldStateFilter;
+
     /// \addtogroup gazebo_physics
     /// \{
 
@@ -78,12 +87,74 @@ namespace gazebo
       public: void LoadWithFilter(const WorldPtr _world,
           const std::string &_filter);
 
+      /// \brief Load from a snapshot.
+      ///
+      /// Generate a WorldState from a snapshot of a world. This doesn't
+      /// access the entities of the world, so it can be called from any
+      /// thread.
+      /// \param[in] _world World the snapshot was taken from. Used to
+      /// describe insertions when states are subtracted.
+      /// \param[in] _snapshot Snapshot of the world.
+      public: void Load(const WorldPtr _world, const StateSnapshot &_snapshot);
+
+      /// \brief Load from a snapshot.
+      ///
+      /// Generate a WorldState from a snapshot of a world.
+      /// \param[in] _world World the snapshot was taken from.
+      /// \param[in] _snapshot Snapshot of the world.
+      /// \param[in] _filter String for filtering models states
+      public: void LoadWithFilter(const WorldPtr _world,
+          const StateSnapshot &_snapshot, const std::string &_filter);
+
+      /// \brief Load from a snapshot, with a compiled filter.
+      ///
+      /// Generate a WorldState from a snapshot of a world. When this state
+      /// was loaded from a snapshot with the same entities and filter, the
+      /// model, link and light states are updated in place, without
+      /// allocating memory.
+      /// \param[in] _world World the snapshot was taken from.
+      /// \param[in] _snapshot Snapshot of the world.
+      /// \param[in,out] _filter Filter selecting the models, which caches
+      /// its selection for the layout of the snapshot.
+      public: void Load(const WorldPtr _world, const StateSnapshot &_snapshot,
+          WorldStateFilter &_filter);
+
       /// \brief Load state from SDF element.
       ///
       /// Set a WorldState from an SDF element containing WorldState info.
       /// \param[in] _elem Pointer to the WorldState SDF element.
       public: virtual void Load(const sdf::ElementPtr _elem);
 
+      /// \brief Append the state to a binary log frame.
+      /// \param[in] _writer Writer to append the state to.
+      public: void WriteBinary(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load state from a binary log frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinary.
+      /// \return False if the data is truncated.
+      public: bool ReadBinary(util::BinaryLogReader &_reader);
+
+      /// \brief Append the state to a binary log delta frame. The state is
+      /// expected to be a difference computed with operator-, its poses are
+      /// quantized.
+      /// \param[in] _writer Writer to append the state to.
+      /// \return False if a difference is too large to be quantized.
+      public: bool WriteBinaryDelta(util::BinaryLogWriter &_writer) const;
+
+      /// \brief Load a difference from a binary log delta frame.
+      /// \param[in] _reader Reader positioned at a state written with
+      /// WriteBinaryDelta.
+      /// \return False if the data is truncated.
+      public: bool ReadBinaryDelta(util::BinaryLogReader &_reader);
+
+      /// \brief Load state from a sequence of binary log frames, as returned
+      /// by util::LogPlay::Step. Complete state frames replace this state,
+      /// delta frames are added to it and SDF frames are ignored.
+      /// \param[in] _reader Reader positioned at the first frame.
+      /// \return False if a frame is invalid or truncated.
+      public: bool ReadBinaryFrames(util::BinaryLogReader &_reader);
+
       /// \brief Set the world.
       /// \param[in] _world Pointer to the world.
       public: void SetWorld(const WorldPtr _world);
@@ -199,8 +270,10 @@ namespace gazebo
       /// \return The resulting state.
       public: WorldState operator-(const WorldState &_state) const;
 
-      /// \brief Addition operator.
-      /// \param[in] _pt A state to add.
+      /// \brief Addition operator. Applies a difference computed with
+      /// operator-, so that b + (a - b) equals a. Entities without a
+      /// difference in _state are unchanged.
+      /// \param[in] _state Difference to add.
       /// \return The resulting state.
       public: WorldState operator+(const WorldState &_state) const;
 
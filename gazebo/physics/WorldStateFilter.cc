@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/regex.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/physics/WorldStateFilter.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+/// \brief Private data for WorldStateFilter.
+class gazebo::physics::WorldStateFilterPrivate
+{
+  /// \brief The filter string.
+  public: std::string filter;
+
+  /// \brief False if all the models are selected.
+  public: bool filtered = false;
+
+  /// \brief Regular expression that selected model names match.
+  public: boost::regex modelRegex;
+
+  /// \brief Layout the selected models were computed for.
+  public: StateSnapshotLayoutPtr layout;
+
+  /// \brief Selected models of layout, sorted by name.
+  public: std::vector<unsigned int> models;
+};
+
+/////////////////////////////////////////////////
+WorldStateFilter::WorldStateFilter()
+  : dataPtr(new WorldStateFilterPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+WorldStateFilter::WorldStateFilter(const std::string &_filter)
+  : dataPtr(new WorldStateFilterPrivate)
+{
+  this->Set(_filter);
+}
+
+/////////////////////////////////////////////////
+WorldStateFilter::~WorldStateFilter()
+{
+}
+
+/////////////////////////////////////////////////
+void WorldStateFilter::Set(const std::string &_filter)
+{
+  this->dataPtr->filter = _filter;
+  this->dataPtr->filtered = false;
+  this->dataPtr->layout.reset();
+
+  // The first element in the filter must be a model name or a star.
+  std::string modelFilter = _filter.substr(0, _filter.find('/'));
+  modelFilter = modelFilter.substr(0, modelFilter.find('.'));
+  if (modelFilter.empty() || modelFilter == "*")
+    return;
+
+  boost::replace_all(modelFilter, "*", ".*");
+  try
+  {
+    this->dataPtr->modelRegex.assign(modelFilter);
+    this->dataPtr->filtered = true;
+  }
+  catch(boost::regex_error &_e)
+  {
+    gzerr << "Invalid world state filter [" << _filter << "], all the "
+          << "models are selected: " << _e.what() << "\n";
+  }
+}
+
+/////////////////////////////////////////////////
+const std::string &WorldStateFilter::Filter() const
+{
+  return this->dataPtr->filter;
+}
+
+/////////////////////////////////////////////////
+bool WorldStateFilter::Filtered() const
+{
+  return this->dataPtr->filtered;
+}
+
+/////////////////////////////////////////////////
+bool WorldStateFilter::Matches(const std::string &_modelName) const
+{
+  return !this->dataPtr->filtered ||
+      boost::regex_match(_modelName, this->dataPtr->modelRegex);
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &WorldStateFilter::Models(
+    const StateSnapshotLayoutPtr &_layout)
+{
+  if (_layout == this->dataPtr->layout)
+    return this->dataPtr->models;
+
+  // Keep a reference to the layout, so that a new layout allocated at the
+  // same address can't be mistaken for it.
+  this->dataPtr->layout = _layout;
+  this->dataPtr->models.clear();
+  if (!_layout)
+    return this->dataPtr->models;
+
+  for (const auto model : _layout->topModels)
+  {
+    if (this->Matches(_layout->modelNames[model]))
+      this->dataPtr->models.push_back(model);
+  }
+
+  const std::vector<std::string> &names = _layout->modelNames;
+  std::stable_sort(this->dataPtr->models.begin(), this->dataPtr->models.end(),
+      [&names](const unsigned int _a, const unsigned int _b)
+      {
+        return names[_a] < names[_b];
+      });
+
+  return this->dataPtr->models;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_WORLDSTATEFILTER_HH_
+#define GAZEBO_PHYSICS_WORLDSTATEFILTER_HH_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    // Forward declare private data class
+    class WorldStateFilterPrivate;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class WorldStateFilter WorldStateFilter.hh physics/physics.hh
+    /// \brief Compiled form of a log record filter string, which selects
+    /// the models that are part of a WorldState. The first element of the
+    /// filter, up to a '/' or a '.', is a model name where '*' matches any
+    /// sequence of characters. An empty filter or "*" selects all the
+    /// models. The filter string is parsed once, and the models it selects
+    /// in a snapshot layout are computed once per layout.
+    class GZ_PHYSICS_VISIBLE WorldStateFilter
+    {
+      /// \brief Constructor, for a filter that selects all the models.
+      public: WorldStateFilter();
+
+      /// \brief Constructor.
+      /// \param[in] _filter The filter string.
+      public: explicit WorldStateFilter(const std::string &_filter);
+
+      /// \brief Destructor.
+      public: ~WorldStateFilter();
+
+      /// \brief Set the filter string.
+      /// \param[in] _filter The filter string.
+      public: void Set(const std::string &_filter);
+
+      /// \brief Get the filter string.
+      /// \return The filter string.
+      public: const std::string &Filter() const;
+
+      /// \brief Get whether the filter selects a subset of the models.
+      /// \return False if all the models are selected.
+      public: bool Filtered() const;
+
+      /// \brief Get whether a model is selected.
+      /// \param[in] _modelName Name of a model that is a direct child of the
+      /// world.
+      /// \return True if the model is part of the state.
+      public: bool Matches(const std::string &_modelName) const;
+
+      /// \brief Get the selected models of a snapshot layout.
+      /// \param[in] _layout The layout.
+      /// \return Indices of the selected models among the models that are
+      /// direct children of the world, sorted by name. Valid until the next
+      /// call.
+      public: const std::vector<unsigned int> &Models(
+                  const StateSnapshotLayoutPtr &_layout);
+
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<WorldStateFilterPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
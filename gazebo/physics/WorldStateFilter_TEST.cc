@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test/util.hh"
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/physics/WorldState.hh"
+#include "gazebo/physics/WorldStateFilter.hh"
+
+using namespace gazebo;
+
+class WorldStateFilterTest : public gazebo::testing::AutoLogFixture { };
+
+/// \brief Create a snapshot of models "robot_b", "box" and "robot_a", each
+/// with links "upper" and "lower", and a light "sun".
+/// \param[in] _sorted True to call SortByName on the layout.
+/// \return The snapshot.
+static physics::StateSnapshot MakeSnapshot(const bool _sorted)
+{
+  auto layout = std::make_shared<physics::StateSnapshotLayout>();
+  layout->worldName = "default";
+  layout->modelNames = {"robot_b", "box", "robot_a"};
+  layout->modelLinkStart = {0, 2, 4, 6};
+  layout->nestedModels = {{}, {}, {}};
+  layout->topModels = {0, 1, 2};
+  layout->linkNames = {"upper", "lower", "upper", "lower", "upper", "lower"};
+  layout->lightNames = {"sun"};
+  if (_sorted)
+    layout->SortByName();
+
+  physics::StateSnapshot snapshot;
+  snapshot.layout = layout;
+  snapshot.modelPoses.resize(3);
+  snapshot.modelScales.assign(3, ignition::math::Vector3d::One);
+  snapshot.linkPoses.resize(6);
+  snapshot.linkLinearVels.resize(6);
+  snapshot.linkAngularVels.resize(6);
+  snapshot.linkLinearAccels.resize(6);
+  snapshot.linkAngularAccels.resize(6);
+  snapshot.linkForces.resize(6);
+  snapshot.lightPoses.resize(1);
+  return snapshot;
+}
+
+//////////////////////////////////////////////////
+TEST_F(WorldStateFilterTest, Parse)
+{
+  physics::WorldStateFilter all;
+  EXPECT_FALSE(all.Filtered());
+  EXPECT_TRUE(all.Matches("anything"));
+
+  for (auto const &filter : {"", "*", "*/link", "*.pose"})
+  {
+    physics::WorldStateFilter star(filter);
+    EXPECT_EQ(filter, star.Filter());
+    EXPECT_FALSE(star.Filtered()) << filter;
+  }
+
+  // Only the model part of the filter is used
+  physics::WorldStateFilter robots("robot*/link.pose");
+  EXPECT_TRUE(robots.Filtered());
+  EXPECT_TRUE(robots.Matches("robot"));
+  EXPECT_TRUE(robots.Matches("robot_a"));
+  EXPECT_FALSE(robots.Matches("box"));
+  EXPECT_FALSE(robots.Matches("my_robot"));
+
+  // Invalid expressions select all the models
+  physics::WorldStateFilter invalid("robot[");
+  EXPECT_FALSE(invalid.Filtered());
+
+  robots.Set("box");
+  EXPECT_EQ("box", robots.Filter());
+  EXPECT_TRUE(robots.Matches("box"));
+  EXPECT_FALSE(robots.Matches("robot_a"));
+}
+
+//////////////////////////////////////////////////
+TEST_F(WorldStateFilterTest, Models)
+{
+  physics::StateSnapshot snapshot = MakeSnapshot(true);
+
+  // Selected models are sorted by name
+  physics::WorldStateFilter robots("robot_*");
+  EXPECT_EQ(std::vector<unsigned int>({2, 0}),
+      robots.Models(snapshot.layout));
+  EXPECT_EQ(std::vector<unsigned int>({1, 2, 0}),
+      physics::WorldStateFilter().Models(snapshot.layout));
+
+  // The selection follows the filter and the layout
+  robots.Set("box");
+  EXPECT_EQ(std::vector<unsigned int>({1}), robots.Models(snapshot.layout));
+  physics::StateSnapshot other = MakeSnapshot(true);
+  EXPECT_EQ(std::vector<unsigned int>({1}), robots.Models(other.layout));
+  EXPECT_TRUE(robots.Models(nullptr).empty());
+}
+
+//////////////////////////////////////////////////
+TEST_F(WorldStateFilterTest, LoadInPlace)
+{
+  for (const bool sorted : {true, false})
+  {
+    physics::StateSnapshot snapshot = MakeSnapshot(sorted);
+    EXPECT_EQ(sorted, snapshot.layout->SortedByName());
+
+    physics::WorldStateFilter filter("robot_*");
+    physics::WorldState state;
+    state.Load(physics::WorldPtr(), snapshot, filter);
+    ASSERT_EQ(2u, state.GetModelStateCount());
+    ASSERT_TRUE(state.HasModelState("robot_a"));
+    EXPECT_FALSE(state.HasModelState("box"));
+    EXPECT_EQ(1u, state.LightStateCount());
+
+    const physics::ModelState *robotA =
+        &state.GetModelStates().at("robot_a");
+    const physics::LinkState *lower = &robotA->GetLinkStates().at("lower");
+    EXPECT_EQ(ignition::math::Pose3d::Zero, lower->Pose());
+
+    // A later snapshot with the same layout updates the states in place.
+    // Links are only updated in place when the layout orders them by name.
+    snapshot.iterations = 10;
+    snapshot.linkPoses[5].Pos().Set(1, 2, 3);
+    state.Load(physics::WorldPtr(), snapshot, filter);
+    EXPECT_EQ(10u, state.GetIterations());
+    ASSERT_EQ(2u, state.GetModelStateCount());
+    ASSERT_EQ(robotA, &state.GetModelStates().at("robot_a"));
+    if (sorted)
+      EXPECT_EQ(lower, &robotA->GetLinkStates().at("lower"));
+    lower = &robotA->GetLinkStates().at("lower");
+    EXPECT_EQ(ignition::math::Vector3d(1, 2, 3), lower->Pose().Pos());
+    EXPECT_EQ(10u, lower->GetIterations());
+
+    // Changing the filter rebuilds the states
+    filter.Set("box");
+    state.Load(physics::WorldPtr(), snapshot, filter);
+    EXPECT_EQ(1u, state.GetModelStateCount());
+    EXPECT_TRUE(state.HasModelState("box"));
+    EXPECT_EQ(2u, state.GetModelState("box").GetLinkStateCount());
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
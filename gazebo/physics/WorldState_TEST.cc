@@ -253,6 +253,19 @@ TEST_F(WorldStateTest, OperatorsNoInsertionsDeletions)
   EXPECT_EQ(lightStates["sun"].Pose(),
       ignition::math::Pose3d(10, 20, 40, 0, 0, 0));
 
+  // Adding a difference reverts the subtraction, entities without a
+  // difference are unchanged
+  worldState2 = worldState0 + (worldState1 - worldState0);
+  EXPECT_EQ(worldState2.GetModelStateCount(), 4u);
+  EXPECT_EQ(worldState2.LightStateCount(), 1u);
+  for (auto const &model : worldState1.GetModelStates())
+  {
+    EXPECT_EQ(worldState2.GetModelState(model.first).Pose(),
+        model.second.Pose());
+  }
+  EXPECT_EQ(worldState2.GetLightState("sun").Pose(),
+      worldState1.GetLightState("sun").Pose());
+
   // Copy by assignment
   worldState1 = worldState0;
 
@@ -15,6 +15,14 @@
  *
 */
 
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/Joint.hh"
+#include "gazebo/physics/JointController.hh"
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/PhysicsEngine.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/test/ServerFixture.hh"
@@ -216,6 +224,143 @@ TEST_F(WorldTest, Stop)
   EXPECT_TRUE(world->Running());
 }
 
+//////////////////////////////////////////////////
+/// \brief Test updating models in parallel gives the same result as the
+/// serial model update loop, with models driven by their joint controllers.
+TEST_F(WorldTest, ModelUpdateThreads)
+{
+  // The number of threads is read from <physics>
+  this->Load("test/worlds/model_update_threads.world", true);
+  auto world = physics::get_world("default");
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(world->ModelUpdateThreads(), 4u);
+
+  // And from the physics parameters
+  auto physics = world->Physics();
+  ASSERT_NE(nullptr, physics);
+  EXPECT_TRUE(physics->SetParam("model_update_threads", 2));
+  EXPECT_EQ(world->ModelUpdateThreads(), 2u);
+  EXPECT_EQ(boost::any_cast<int>(physics->GetParam("model_update_threads")),
+      2);
+  EXPECT_FALSE(physics->SetParam("model_update_threads", -1));
+
+  const unsigned int armCount = 4;
+  std::vector<physics::ModelPtr> arms;
+  for (unsigned int i = 0; i < armCount; ++i)
+  {
+    auto arm = world->ModelByName("arm_" + std::to_string(i));
+    ASSERT_NE(nullptr, arm);
+    EXPECT_TRUE(arm->UpdateIsolated());
+    arm->GetJointController()->SetPositionPID(
+        arm->GetJoint("joint")->GetScopedName(), common::PID(10, 0, 1));
+    arms.push_back(arm);
+  }
+
+  // Drive each arm to its own angle with the joint controllers, and
+  // record the arm poses. Reset clears the controller targets.
+  auto run = [&](const unsigned int _threads)
+  {
+    world->Reset();
+    world->SetModelUpdateThreads(_threads);
+    for (unsigned int i = 0; i < armCount; ++i)
+    {
+      arms[i]->GetJointController()->SetPositionTarget(
+          arms[i]->GetJoint("joint")->GetScopedName(), 0.5 + 0.25 * i);
+    }
+    world->Step(1000);
+
+    std::vector<ignition::math::Pose3d> poses;
+    for (auto const &arm : arms)
+      poses.push_back(arm->GetLink("arm")->WorldPose());
+    return poses;
+  };
+
+  // Each run follows a run of the same length, so that the controllers
+  // skip the same first step after the reset.
+  run(0);
+  auto parallelPoses = run(4);
+  auto serialPoses = run(0);
+
+  // The controllers reached their targets, and the models were updated
+  // the same way in parallel.
+  for (unsigned int i = 0; i < armCount; ++i)
+  {
+    EXPECT_NEAR(arms[i]->GetJoint("joint")->Position(0), 0.5 + 0.25 * i,
+        0.05) << i;
+    EXPECT_EQ(parallelPoses[i], serialPoses[i]) << i;
+  }
+}
+
+/// \brief Find an entity by name with a depth first search of the tree.
+/// \param[in] _base Entity to search from.
+/// \param[in] _name Name or scoped name of the entity.
+/// \return The first entity found, or nullptr.
+static physics::BasePtr SearchByName(const physics::BasePtr &_base,
+    const std::string &_name)
+{
+  if (_base->GetScopedName() == _name || _base->GetName() == _name)
+    return _base;
+
+  for (unsigned int i = 0; i < _base->GetChildCount(); ++i)
+  {
+    physics::BasePtr result = SearchByName(_base->GetChild(i), _name);
+    if (result)
+      return result;
+  }
+  return nullptr;
+}
+
+//////////////////////////////////////////////////
+/// \brief Test looking entities up by name through the index of the
+/// world.
+TEST_F(WorldTest, EntityIndex)
+{
+  this->Load("worlds/shapes.world", true);
+  auto world = physics::get_world("default");
+  ASSERT_NE(nullptr, world);
+
+  auto box = world->ModelByName("box");
+  ASSERT_NE(nullptr, box);
+  EXPECT_EQ(box->GetLink("link"), world->EntityByName("box::link"));
+  EXPECT_EQ(box->GetLink("link"), box->GetByName("link"));
+  EXPECT_EQ(nullptr, world->BaseByName("no_such_entity"));
+
+  // Ids resolve among the children only, as before.
+  auto link = box->GetLink("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ(link, box->GetById(link->GetId()));
+  EXPECT_EQ(box, world->ModelById(box->GetId()));
+  EXPECT_EQ(nullptr, world->ModelById(link->GetId()));
+  EXPECT_EQ(nullptr, box->GetById(box->GetId()));
+
+  // Names shared by several entities resolve to the first one in depth
+  // first order, as before.
+  for (auto const &name : {"link", "collision", "box::link::collision"})
+  {
+    auto entity = world->BaseByName(name);
+    ASSERT_NE(nullptr, entity) << name;
+    EXPECT_EQ(SearchByName(box->GetParent(), name), entity) << name;
+  }
+
+  // Renaming updates the index
+  box->SetName("renamed_box");
+  EXPECT_EQ(box, world->ModelByName("renamed_box"));
+  EXPECT_EQ(nullptr, world->ModelByName("box"));
+  box->SetName("box");
+  EXPECT_EQ(box, world->ModelByName("box"));
+
+  // Removed entities are not found anymore
+  auto sphere = world->ModelByName("sphere");
+  ASSERT_NE(nullptr, sphere);
+  const unsigned int sphereId = sphere->GetId();
+  sphere.reset();
+  world->RemoveModel("sphere");
+  EXPECT_EQ(nullptr, world->ModelByName("sphere"));
+  EXPECT_EQ(nullptr, world->ModelById(sphereId));
+  EXPECT_EQ(nullptr, world->EntityByName("sphere::link"));
+  EXPECT_NE(nullptr, world->ModelByName("cylinder"));
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -77,6 +77,43 @@ void BulletMesh::Init(const common::Mesh *_mesh,
   delete [] indices;
 }
 
+//////////////////////////////////////////////////
+void BulletMesh::Init(const CollisionMeshPtr &_mesh,
+                      BulletCollisionPtr _collision)
+{
+  if (!_mesh)
+    return;
+
+  std::shared_ptr<btTriangleIndexVertexArray> meshInterface =
+      _mesh->EngineData<btTriangleIndexVertexArray>("bullet", [&_mesh]()
+      {
+        btIndexedMesh part;
+        part.m_numTriangles = _mesh->IndexCount() / 3;
+        part.m_triangleIndexBase =
+            reinterpret_cast<const unsigned char *>(_mesh->Indices());
+        part.m_triangleIndexStride = 3 * sizeof(int);
+        part.m_indexType = PHY_INTEGER;
+        part.m_numVertices = _mesh->VertexCount();
+        part.m_vertexBase =
+            reinterpret_cast<const unsigned char *>(_mesh->Vertices());
+        part.m_vertexStride = 3 * sizeof(float);
+        part.m_vertexType = PHY_FLOAT;
+
+        auto array = std::make_shared<btTriangleIndexVertexArray>();
+        array->addIndexedMesh(part, PHY_INTEGER);
+        return array;
+      });
+
+  this->collisionMesh = _mesh;
+
+  // The shape is owned by the collision, only the mesh interface and the
+  // buffers are shared.
+  btGImpactMeshShape *gimpactMeshShape =
+    new btGImpactMeshShape(meshInterface.get());
+  gimpactMeshShape->updateBound();
+  _collision->SetCollisionShape(gimpactMeshShape);
+}
+
 /////////////////////////////////////////////////
 void BulletMesh::CreateMesh(float *_vertices, int *_indices,
     unsigned int _numVertices, unsigned int _numIndices,
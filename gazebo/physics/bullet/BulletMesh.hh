@@ -18,8 +18,10 @@
 #ifndef GAZEBO_PHYSICS_BULLET_BULLETMESH_HH_
 #define GAZEBO_PHYSICS_BULLET_BULLETMESH_HH_
 
+#include <memory>
 #include <ignition/math/Vector3.hh>
 
+#include "gazebo/physics/CollisionMesh.hh"
 #include "gazebo/physics/bullet/BulletTypes.hh"
 #include "gazebo/util/system.hh"
 
@@ -56,6 +58,14 @@ namespace gazebo
                       BulletCollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Create a mesh collision shape from a shared collision
+      /// mesh. The Bullet mesh interface points to the shared buffers
+      /// instead of copying them.
+      /// \param[in] _mesh The collision mesh, already scaled.
+      /// \param[in] _collision Pointer to the collision object.
+      public: void Init(const CollisionMeshPtr &_mesh,
+                      BulletCollisionPtr _collision);
+
       /// \brief Helper function to create the collision shape.
       /// \param[in] _vertices Array of vertices.
       /// \param[in] _indices Array of indices.
@@ -67,6 +77,10 @@ namespace gazebo
                    unsigned int _numVertices, unsigned int _numIndices,
                    BulletCollisionPtr _collision,
                    const ignition::math::Vector3d &_scale);
+
+      /// \brief Shared collision mesh, kept alive while the collision shape
+      /// uses its buffers.
+      private: CollisionMeshPtr collisionMesh;
     };
     /// \}
   }
@@ -60,14 +60,5 @@ void BulletMeshShape::Init()
   BulletCollisionPtr bParent =
     boost::static_pointer_cast<BulletCollision>(this->collisionParent);
 
-  if (this->submesh)
-  {
-    this->bulletMesh->Init(this->submesh, bParent,
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
-  }
-  else
-  {
-    this->bulletMesh->Init(this->mesh, bParent,
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
-  }
+  this->bulletMesh->Init(this->SharedCollisionMesh(), bParent);
 }
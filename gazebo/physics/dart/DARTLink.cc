@@ -46,6 +46,9 @@ DARTLink::DARTLink(EntityPtr _parent)
 //////////////////////////////////////////////////
 DARTLink::~DARTLink()
 {
+  if (this->dataPtr->registered)
+    this->dataPtr->dartPhysics->RemoveDARTLink(this);
+
   delete this->dataPtr;
   this->dataPtr = nullptr;
 }
@@ -253,11 +256,23 @@ void DARTLink::Init()
   // We don't add dart body node to the skeleton here because dart body node
   // should be set its parent joint before being added. This body node will be
   // added to the skeleton in DARTModel::Init().
+
+  if (!this->dataPtr->registered)
+  {
+    this->dataPtr->dartPhysics->AddDARTLink(this);
+    this->dataPtr->registered = true;
+  }
 }
 
 //////////////////////////////////////////////////
 void DARTLink::Fini()
 {
+  if (this->dataPtr->registered)
+  {
+    this->dataPtr->dartPhysics->RemoveDARTLink(this);
+    this->dataPtr->registered = false;
+  }
+
   Link::Fini();
 }
 
@@ -959,8 +974,11 @@ void DARTLink::updateDirtyPoseFromDARTTransformation()
 
   // Step 1: get dart body's transformation
   // Step 2: set gazebo link's pose using the transformation
-  ignition::math::Pose3d newPose = DARTTypes::ConvPoseIgn(
-      this->dataPtr->dtBodyNode->getTransform());
+  const Eigen::Isometry3d &transform =
+      this->dataPtr->dtBodyNode->getTransform();
+  ignition::math::Pose3d newPose = DARTTypes::ConvPoseIgn(transform);
+  this->dataPtr->syncedTransform = transform;
+  this->dataPtr->poseSynced = true;
 
   // Set the new pose to this link
   this->dirtyPose = newPose;
@@ -970,6 +988,21 @@ void DARTLink::updateDirtyPoseFromDARTTransformation()
   this->world->dataPtr->dirtyPoses.push_back(this);
 }
 
+//////////////////////////////////////////////////
+bool DARTLink::UpdateDirtyPoseIfMoved()
+{
+  // Exact comparison, static bodies keep the very same transformation
+  if (this->dataPtr->IsInitialized() && this->dataPtr->poseSynced &&
+      this->dataPtr->dtBodyNode->getTransform().matrix() ==
+      this->dataPtr->syncedTransform.matrix())
+  {
+    return false;
+  }
+
+  this->updateDirtyPoseFromDARTTransformation();
+  return true;
+}
+
 //////////////////////////////////////////////////
 DARTPhysicsPtr DARTLink::GetDARTPhysics(void) const
 {
@@ -161,6 +161,11 @@ namespace gazebo
       ///        Entity::SetWorldPose() for this link.
       public: void updateDirtyPoseFromDARTTransformation();
 
+      /// \brief Call updateDirtyPoseFromDARTTransformation if the DART
+      ///        transformation changed since the last call.
+      /// \return True if the pose was pushed to World::dirtyPoses.
+      public: bool UpdateDirtyPoseIfMoved();
+
       /// \brief Get pointer to DART Physics engine associated with this link.
       /// \return Pointer to the DART Physics engine.
       public: DARTPhysicsPtr GetDARTPhysics(void) const;
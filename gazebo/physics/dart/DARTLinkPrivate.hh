@@ -51,7 +51,9 @@ namespace gazebo
           dartChildJoints {},
           isSoftBody(false),
           staticLink(false),
-          dtWeldJointConst(nullptr)
+          dtWeldJointConst(nullptr),
+          registered(false),
+          poseSynced(false)
       {
       }
 
@@ -180,6 +182,16 @@ namespace gazebo
 
       /// \brief Weld joint constraint for SetLinkStatic()
       public: dart::constraint::WeldJointConstraintPtr dtWeldJointConst;
+
+      /// \brief True if this link is in the links of DARTPhysics.
+      public: bool registered;
+
+      /// \brief True if syncedTransform holds the last transformation
+      /// pushed to the dirty poses.
+      public: bool poseSynced;
+
+      /// \brief Last DART transformation pushed to the dirty poses.
+      public: Eigen::Isometry3d syncedTransform;
     };
   }
 }
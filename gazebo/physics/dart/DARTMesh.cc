@@ -27,6 +27,53 @@
 using namespace gazebo;
 using namespace physics;
 
+/// \brief Build an assimp scene holding a single triangle mesh.
+/// \param[in] _vertices Array of vertices.
+/// \param[in] _indices Array of indices.
+/// \param[in] _numVertices Number of vertices.
+/// \param[in] _numIndices Number of indices.
+/// \return The scene, owned by the DART mesh shape it is given to.
+static aiScene *CreateScene(const float *_vertices, const int *_indices,
+    unsigned int _numVertices, unsigned int _numIndices)
+{
+  // Create new aiScene (aiMesh)
+  aiScene *assimpScene = new aiScene;
+  aiMesh *assimpMesh = new aiMesh;
+  assimpScene->mNumMeshes = 1;
+  assimpScene->mMeshes = new aiMesh*[1];
+  assimpScene->mMeshes[0] = assimpMesh;
+  assimpScene->mRootNode = new aiNode();
+
+  // Set _vertices and normals
+  assimpMesh->mNumVertices = _numVertices;
+  assimpMesh->mVertices = new aiVector3D[_numVertices];
+  assimpMesh->mNormals = new aiVector3D[_numVertices];
+  aiVector3D itAIVector3d;
+
+  for (unsigned int i = 0; i < _numVertices; ++i)
+  {
+    itAIVector3d.Set(_vertices[i*3 + 0], _vertices[i*3 + 1],
+      _vertices[i*3 + 2]);
+    assimpMesh->mVertices[i] = itAIVector3d;
+    assimpMesh->mNormals[i]  = itAIVector3d;
+  }
+
+  // Set faces
+  assimpMesh->mNumFaces = _numIndices/3;
+  assimpMesh->mFaces = new aiFace[assimpMesh->mNumFaces];
+  for (unsigned int i = 0; i < assimpMesh->mNumFaces; ++i)
+  {
+    aiFace* itAIFace = &assimpMesh->mFaces[i];
+    itAIFace->mNumIndices = 3;
+    itAIFace->mIndices = new unsigned int[3];
+    itAIFace->mIndices[0] = _indices[i*3 + 0];
+    itAIFace->mIndices[1] = _indices[i*3 + 1];
+    itAIFace->mIndices[2] = _indices[i*3 + 2];
+  }
+
+  return assimpScene;
+}
+
 //////////////////////////////////////////////////
 DARTMesh::DARTMesh() : dataPtr(new DARTMeshPrivate())
 {
@@ -80,50 +127,43 @@ void DARTMesh::Init(const common::Mesh *_mesh,
   delete [] indices;
 }
 
+//////////////////////////////////////////////////
+void DARTMesh::Init(const CollisionMeshPtr &_mesh,
+                    DARTCollisionPtr _collision)
+{
+  if (!_mesh)
+    return;
+
+  // The vertices are already scaled, the shared shape keeps a unit scale.
+  dart::dynamics::ShapePtr dtMeshShape =
+      _mesh->EngineData<dart::dynamics::Shape>("dart", [&_mesh]()
+      {
+        return dart::dynamics::ShapePtr(new dart::dynamics::MeshShape(
+            Eigen::Vector3d::Ones(), CreateScene(_mesh->Vertices(),
+            _mesh->Indices(), _mesh->VertexCount(), _mesh->IndexCount())));
+      });
+
+  this->dataPtr->collisionMesh = _mesh;
+  this->AttachShape(dtMeshShape, _collision);
+}
+
 /////////////////////////////////////////////////
 void DARTMesh::CreateMesh(float *_vertices, int *_indices,
     unsigned int _numVertices, unsigned int _numIndices,
     DARTCollisionPtr _collision, const ignition::math::Vector3d &_scale)
 {
-  GZ_ASSERT(_collision, "DART collision is null");
-
-  // Create new aiScene (aiMesh)
-  aiScene *assimpScene = new aiScene;
-  aiMesh *assimpMesh = new aiMesh;
-  assimpScene->mNumMeshes = 1;
-  assimpScene->mMeshes = new aiMesh*[1];
-  assimpScene->mMeshes[0] = assimpMesh;
-  assimpScene->mRootNode = new aiNode();
-
-  // Set _vertices and normals
-  assimpMesh->mNumVertices = _numVertices;
-  assimpMesh->mVertices = new aiVector3D[_numVertices];
-  assimpMesh->mNormals = new aiVector3D[_numVertices];
-  aiVector3D itAIVector3d;
-
-  for (unsigned int i = 0; i < _numVertices; ++i)
-  {
-    itAIVector3d.Set(_vertices[i*3 + 0], _vertices[i*3 + 1],
-      _vertices[i*3 + 2]);
-    assimpMesh->mVertices[i] = itAIVector3d;
-    assimpMesh->mNormals[i]  = itAIVector3d;
-  }
+  dart::dynamics::ShapePtr dtMeshShape(new dart::dynamics::MeshShape(
+      DARTTypes::ConvVec3(_scale),
+      CreateScene(_vertices, _indices, _numVertices, _numIndices)));
 
-  // Set faces
-  assimpMesh->mNumFaces = _numIndices/3;
-  assimpMesh->mFaces = new aiFace[assimpMesh->mNumFaces];
-  for (unsigned int i = 0; i < assimpMesh->mNumFaces; ++i)
-  {
-    aiFace* itAIFace = &assimpMesh->mFaces[i];
-    itAIFace->mNumIndices = 3;
-    itAIFace->mIndices = new unsigned int[3];
-    itAIFace->mIndices[0] = _indices[i*3 + 0];
-    itAIFace->mIndices[1] = _indices[i*3 + 1];
-    itAIFace->mIndices[2] = _indices[i*3 + 2];
-  }
+  this->AttachShape(dtMeshShape, _collision);
+}
 
-  dart::dynamics::ShapePtr dtMeshShape(new dart::dynamics::MeshShape(
-      DARTTypes::ConvVec3(_scale), assimpScene));
+/////////////////////////////////////////////////
+void DARTMesh::AttachShape(dart::dynamics::ShapePtr _shape,
+    DARTCollisionPtr _collision)
+{
+  GZ_ASSERT(_collision, "DART collision is null");
   GZ_ASSERT(_collision->DARTBodyNode(),
             "DART _collision->DARTBodyNode() is null");
 
@@ -131,7 +171,7 @@ void DARTMesh::CreateMesh(float *_vertices, int *_indices,
     _collision->DARTBodyNode()->createShapeNodeWith<
       dart::dynamics::VisualAspect,
       dart::dynamics::CollisionAspect,
-      dart::dynamics::DynamicsAspect>(dtMeshShape);
+      dart::dynamics::DynamicsAspect>(_shape);
 
   this->dataPtr->dtMeshShape.set(node);
 }
@@ -20,6 +20,7 @@
 
 #include <ignition/math/Vector3.hh>
 
+#include "gazebo/physics/CollisionMesh.hh"
 #include "gazebo/physics/dart/DARTTypes.hh"
 #include "gazebo/util/system.hh"
 
@@ -59,6 +60,14 @@ namespace gazebo
                       DARTCollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Create a mesh collision shape from a shared collision
+      /// mesh. The DART mesh shape is built once per collision mesh and
+      /// shared by the shape nodes of all its users.
+      /// \param[in] _mesh The collision mesh, already scaled.
+      /// \param[in] _collision Pointer to the collision object.
+      public: void Init(const CollisionMeshPtr &_mesh,
+                      DARTCollisionPtr _collision);
+
       /// \brief Returns the DART mesh shape node
       public: dart::dynamics::ShapeNodePtr ShapeNode() const;
 
@@ -73,6 +82,13 @@ namespace gazebo
                    DARTCollisionPtr _collision,
                    const ignition::math::Vector3d &_scale);
 
+      /// \brief Helper function to attach a shape to the body node of a
+      /// collision.
+      /// \param[in] _shape The shape to attach.
+      /// \param[in] _collision Pointer to the collision object.
+      private: void AttachShape(dart::dynamics::ShapePtr _shape,
+                   DARTCollisionPtr _collision);
+
       /// \internal
       /// \brief Pointer to private data
       private: DARTMeshPrivate *dataPtr;
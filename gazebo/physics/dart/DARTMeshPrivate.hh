@@ -18,6 +18,7 @@
 #ifndef _GAZEBO_DARTMESH_PRIVATE_HH_
 #define _GAZEBO_DARTMESH_PRIVATE_HH_
 
+#include "gazebo/physics/CollisionMesh.hh"
 #include "gazebo/physics/dart/dart_inc.h"
 #include "gazebo/physics/dart/DARTTypes.hh"
 
@@ -49,6 +50,9 @@ namespace gazebo
 
       /// \brief DART mesh shape node
       public: dart::dynamics::ShapeNodePtr dtMeshShape;
+
+      /// \brief Shared collision mesh the shape was built from, if any.
+      public: CollisionMeshPtr collisionMesh;
     };
   }
 }
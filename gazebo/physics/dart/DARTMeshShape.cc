@@ -61,25 +61,15 @@ void DARTMeshShape::Init()
 {
   MeshShape::Init();
 
-
-  if (this->submesh)
-  {
-    this->dataPtr->dartMesh->Init(this->submesh,
-        boost::dynamic_pointer_cast<DARTCollision>(this->collisionParent),
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
-  }
-  else
+  if (!this->submesh && !this->mesh)
   {
-    if (!this->mesh)
-    {
-      gzerr << "No DART mesh specified\n";
-      return;
-    }
-    this->dataPtr->dartMesh->Init(this->mesh,
-        boost::dynamic_pointer_cast<DARTCollision>(this->collisionParent),
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
+    gzerr << "No DART mesh specified\n";
+    return;
   }
 
+  this->dataPtr->dartMesh->Init(this->SharedCollisionMesh(),
+      boost::dynamic_pointer_cast<DARTCollision>(this->collisionParent));
+
   BasePtr _parent = GetParent();
   GZ_ASSERT(boost::dynamic_pointer_cast<DARTCollision>(_parent),
             "Parent must be a DARTCollisionPtr");
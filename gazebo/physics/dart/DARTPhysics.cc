@@ -15,6 +15,8 @@
  *
 */
 
+#include <algorithm>
+
 // required for HAVE_DART_BULLET define
 #include <gazebo/gazebo_config.h>
 
@@ -451,25 +453,13 @@ void DARTPhysics::UpdatePhysics()
   this->dataPtr->dtWorld->step(
         this->dataPtr->resetAllForcesAfterSimulationStep);
 
-  // Update all the transformation of DART's links to gazebo's links
-  // TODO: How to visit all the links in the world?
-  unsigned int modelCount = this->world->ModelCount();
-  ModelPtr modelItr;
-
-  for (unsigned int i = 0; i < modelCount; ++i)
+  // Update the transformation of the DART links that moved to gazebo's
+  // links. Bodies that didn't move, such as static ones, are skipped.
+  this->dataPtr->movedLinkCount = 0;
+  for (DARTLink *link : this->dataPtr->links)
   {
-    modelItr = this->world->ModelByIndex(i);
-    // TODO: need to improve speed
-    Link_V links = modelItr->GetLinks();
-    unsigned int linkCount = links.size();
-    DARTLinkPtr dartLinkItr;
-
-    for (unsigned int j = 0; j < linkCount; ++j)
-    {
-      dartLinkItr
-          = boost::dynamic_pointer_cast<DARTLink>(links.at(j));
-      dartLinkItr->updateDirtyPoseFromDARTTransformation();
-    }
+    if (link->UpdateDirtyPoseIfMoved())
+      ++this->dataPtr->movedLinkCount;
   }
 
   RetrieveDARTCollisions(
@@ -479,6 +469,35 @@ void DARTPhysics::UpdatePhysics()
   IGN_PROFILE_END();
 }
 
+//////////////////////////////////////////////////
+void DARTPhysics::AddDARTLink(DARTLink *_link)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  this->dataPtr->links.push_back(_link);
+}
+
+//////////////////////////////////////////////////
+void DARTPhysics::RemoveDARTLink(DARTLink *_link)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  auto iter = std::find(this->dataPtr->links.begin(),
+      this->dataPtr->links.end(), _link);
+  if (iter != this->dataPtr->links.end())
+    this->dataPtr->links.erase(iter);
+}
+
+//////////////////////////////////////////////////
+unsigned int DARTPhysics::SyncedLinkCount() const
+{
+  return this->dataPtr->links.size();
+}
+
+//////////////////////////////////////////////////
+unsigned int DARTPhysics::MovedLinkCount() const
+{
+  return this->dataPtr->movedLinkCount;
+}
+
 //////////////////////////////////////////////////
 std::string DARTPhysics::GetType() const
 {
@@ -159,6 +159,29 @@ namespace gazebo
       /// detector has been loaded yet, the empty string is returned.
       public: std::string CollisionDetectorInUse() const;
 
+      /// \internal
+      /// \brief Add a link whose pose is pushed to gazebo after each step.
+      /// Called by DARTLink::Init.
+      /// \param[in] _link The link.
+      public: void AddDARTLink(DARTLink *_link);
+
+      /// \internal
+      /// \brief Remove a link added with AddDARTLink.
+      /// \param[in] _link The link.
+      public: void RemoveDARTLink(DARTLink *_link);
+
+      /// \internal
+      /// \brief Get the number of links whose poses are checked after
+      /// each step.
+      /// \return Number of links added with AddDARTLink.
+      public: unsigned int SyncedLinkCount() const;
+
+      /// \internal
+      /// \brief Get the number of links whose poses were pushed to gazebo
+      /// by the last step, because they moved.
+      /// \return Number of links pushed by the last step.
+      public: unsigned int MovedLinkCount() const;
+
       // Documentation inherited
       protected: virtual void OnRequest(ConstRequestPtr &_msg);
 
@@ -18,12 +18,16 @@
 #ifndef _GAZEBO_DARTPHYSICS_PRIVATE_HH_
 #define _GAZEBO_DARTPHYSICS_PRIVATE_HH_
 
+#include <vector>
+
 #include "gazebo/physics/dart/dart_inc.h"
 
 namespace gazebo
 {
   namespace physics
   {
+    class DARTLink;
+
     /// \internal
     /// \brief Private data class for DARTPhysics
     class DARTPhysicsPrivate
@@ -31,7 +35,8 @@ namespace gazebo
       /// \brief Constructor
       public: DARTPhysicsPrivate()
         : dtWorld(new dart::simulation::World()),
-          resetAllForcesAfterSimulationStep(true)
+          resetAllForcesAfterSimulationStep(true),
+          movedLinkCount(0)
       {
       }
 
@@ -50,6 +55,13 @@ namespace gazebo
       /// and torques (both internal and external) after completing a simulation
       /// step. Default value is true.
       public: bool resetAllForcesAfterSimulationStep;
+
+      /// \brief All the initialized links, so that poses are pushed to
+      /// gazebo without walking the models after each step.
+      public: std::vector<DARTLink *> links;
+
+      /// \brief Number of links pushed to the dirty poses by the last step.
+      public: unsigned int movedLinkCount;
     };
   }
 }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/physics/dart/DARTPhysics.hh"
+#include "gazebo/physics/dart/DARTTypes.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+class DARTPhysics_TEST : public ServerFixture
+{
+};
+
+/////////////////////////////////////////////////
+/// \brief Check that only the links that moved are pushed to the dirty
+/// poses after each step, and that removed links are unregistered.
+TEST_F(DARTPhysics_TEST, DirtyPoses)
+{
+  Load("worlds/empty.world", true, "dart");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  DARTPhysicsPtr dartPhysics =
+      boost::dynamic_pointer_cast<DARTPhysics>(world->Physics());
+  ASSERT_TRUE(dartPhysics != nullptr);
+
+  // The ground plane, static boxes, and a falling sphere
+  const unsigned int groundLinks = dartPhysics->SyncedLinkCount();
+  const unsigned int staticBoxes = 20;
+  for (unsigned int i = 0; i < staticBoxes; ++i)
+  {
+    SpawnBox("box_" + std::to_string(i), ignition::math::Vector3d::One,
+        ignition::math::Vector3d(2.0 * i, 5, 0.5),
+        ignition::math::Vector3d::Zero, true);
+  }
+  SpawnSphere("sphere", ignition::math::Vector3d(0, 0, 10),
+      ignition::math::Vector3d::Zero);
+  ModelPtr sphere = world->ModelByName("sphere");
+  ASSERT_TRUE(sphere != nullptr);
+
+  const unsigned int totalLinks = groundLinks + staticBoxes + 1;
+  EXPECT_EQ(totalLinks, dartPhysics->SyncedLinkCount());
+
+  // The first step pushes every link, static ones included.
+  world->Step(1);
+  EXPECT_EQ(totalLinks, dartPhysics->MovedLinkCount());
+
+  // Then only the falling sphere is pushed, every step, so the work per
+  // step follows the moving bodies rather than all the bodies.
+  double z = sphere->WorldPose().Pos().Z();
+  for (int i = 0; i < 100; ++i)
+  {
+    world->Step(1);
+    EXPECT_EQ(1u, dartPhysics->MovedLinkCount()) << i;
+    EXPECT_LT(sphere->WorldPose().Pos().Z(), z) << i;
+    z = sphere->WorldPose().Pos().Z();
+  }
+
+  // Removing the sphere unregisters its link, and nothing moves anymore.
+  world->RemoveModel("sphere");
+  sphere.reset();
+  EXPECT_EQ(totalLinks - 1, dartPhysics->SyncedLinkCount());
+  world->Step(10);
+  EXPECT_EQ(0u, dartPhysics->MovedLinkCount());
+
+  // A model spawned after the removal is pushed again.
+  SpawnSphere("sphere2", ignition::math::Vector3d(0, 0, 10),
+      ignition::math::Vector3d::Zero);
+  EXPECT_EQ(totalLinks, dartPhysics->SyncedLinkCount());
+  world->Step(1);
+  world->Step(1);
+  EXPECT_EQ(1u, dartPhysics->MovedLinkCount());
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
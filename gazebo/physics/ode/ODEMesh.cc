@@ -35,10 +35,28 @@ ODEMesh::ODEMesh()
 
 //////////////////////////////////////////////////
 ODEMesh::~ODEMesh()
+{
+  this->ReleaseData();
+}
+
+//////////////////////////////////////////////////
+void ODEMesh::ReleaseData()
 {
   delete [] this->vertices;
   delete [] this->indices;
-  dGeomTriMeshDataDestroy(this->odeData);
+  this->vertices = nullptr;
+  this->indices = nullptr;
+
+  if (this->sharedData)
+  {
+    this->sharedData.reset();
+    this->collisionMesh.reset();
+  }
+  else if (this->odeData)
+  {
+    dGeomTriMeshDataDestroy(this->odeData);
+  }
+  this->odeData = nullptr;
 }
 
 //////////////////////////////////////////////////
@@ -89,6 +107,10 @@ void ODEMesh::Init(const common::SubMesh *_subMesh, ODECollisionPtr _collision,
   unsigned int numVertices = _subMesh->GetVertexCount();
   unsigned int numIndices = _subMesh->GetIndexCount();
 
+  if (this->sharedData)
+    this->ReleaseData();
+  delete [] this->vertices;
+  delete [] this->indices;
   this->vertices = nullptr;
   this->indices = nullptr;
 
@@ -110,6 +132,10 @@ void ODEMesh::Init(const common::Mesh *_mesh, ODECollisionPtr _collision,
   unsigned int numVertices = _mesh->GetVertexCount();
   unsigned int numIndices = _mesh->GetIndexCount();
 
+  if (this->sharedData)
+    this->ReleaseData();
+  delete [] this->vertices;
+  delete [] this->indices;
   this->vertices = nullptr;
   this->indices = nullptr;
 
@@ -120,6 +146,41 @@ void ODEMesh::Init(const common::Mesh *_mesh, ODECollisionPtr _collision,
   this->CreateMesh(numVertices, numIndices, _collision, _scale);
 }
 
+//////////////////////////////////////////////////
+void ODEMesh::Init(const CollisionMeshPtr &_mesh, ODECollisionPtr _collision)
+{
+  if (!_mesh)
+    return;
+
+  std::shared_ptr<dxTriMeshData> data = _mesh->EngineData<dxTriMeshData>(
+      "ode", [&_mesh]()
+      {
+        dTriMeshDataID newData = dGeomTriMeshDataCreate();
+        dGeomTriMeshDataBuildSingle(newData,
+            _mesh->Vertices(), 3*sizeof(float), _mesh->VertexCount(),
+            _mesh->Indices(), _mesh->IndexCount(), 3*sizeof(int));
+        return std::shared_ptr<dxTriMeshData>(newData,
+            dGeomTriMeshDataDestroy);
+      });
+
+  // Keep the previous data alive until the geom uses the new one.
+  dTriMeshDataID oldData = this->sharedData ? nullptr : this->odeData;
+  std::shared_ptr<dxTriMeshData> oldShared = this->sharedData;
+
+  this->collisionMesh = _mesh;
+  this->sharedData = data;
+  this->odeData = data.get();
+  this->AttachData(_collision);
+  this->collisionId = _collision->GetCollisionId();
+
+  delete [] this->vertices;
+  delete [] this->indices;
+  this->vertices = nullptr;
+  this->indices = nullptr;
+  if (oldData)
+    dGeomTriMeshDataDestroy(oldData);
+}
+
 //////////////////////////////////////////////////
 void ODEMesh::CreateMesh(unsigned int _numVertices, unsigned int _numIndices,
     ODECollisionPtr _collision, const ignition::math::Vector3d &_scale)
@@ -141,6 +202,12 @@ void ODEMesh::CreateMesh(unsigned int _numVertices, unsigned int _numIndices,
       this->vertices, 3*sizeof(this->vertices[0]), _numVertices,
       this->indices, _numIndices, 3*sizeof(this->indices[0]));
 
+  this->AttachData(_collision);
+}
+
+//////////////////////////////////////////////////
+void ODEMesh::AttachData(ODECollisionPtr _collision)
+{
   if (_collision->GetCollisionId() == nullptr)
   {
     _collision->SetSpaceId(dSimpleSpaceCreate(_collision->GetSpaceId()));
@@ -18,8 +18,10 @@
 #ifndef GAZEBO_PHYSICS_ODE_ODEMESH_HH_
 #define GAZEBO_PHYSICS_ODE_ODEMESH_HH_
 
+#include <memory>
 #include <ignition/math/Vector3.hh>
 
+#include "gazebo/physics/CollisionMesh.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 #include "gazebo/physics/ode/ode_inc.h"
 #include "gazebo/physics/MeshShape.hh"
@@ -49,6 +51,15 @@ namespace gazebo
                       ODECollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Set odeData on the collision, creating the trimesh geom if
+      /// needed.
+      /// \param[in] _collision Pointer to the collision object.
+      private: void AttachData(ODECollisionPtr _collision);
+
+      /// \brief Release the trimesh data and the arrays, unless they are
+      /// shared.
+      private: void ReleaseData();
+
       /// \brief Create a mesh collision shape using a mesh.
       /// \param[in] _mesh Pointer to the mesh.
       /// \param[in] _collision Pointer to the collision object.
@@ -57,6 +68,14 @@ namespace gazebo
                       ODECollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Create a mesh collision shape from a shared collision
+      /// mesh. The ODE trimesh data, with its bounding volume tree, is
+      /// built once and shared by all the users of the collision mesh.
+      /// \param[in] _mesh The collision mesh, already scaled.
+      /// \param[in] _collision Pointer to the collision object.
+      public: void Init(const CollisionMeshPtr &_mesh,
+                      ODECollisionPtr _collision);
+
       /// \brief Update the collision mesh.
       public: virtual void Update();
 
@@ -85,6 +104,13 @@ namespace gazebo
 
       /// \brief The collision id that this mesh is attached to.
       private: dGeomID collisionId;
+
+      /// \brief Shared collision mesh, null unless initialized with one.
+      private: CollisionMeshPtr collisionMesh;
+
+      /// \brief Trimesh data shared through collisionMesh. odeData points
+      /// to it when set.
+      private: std::shared_ptr<dxTriMeshData> sharedData;
     };
     /// \}
   }
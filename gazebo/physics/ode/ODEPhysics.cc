@@ -17,12 +17,15 @@
 
 #include <tbb/parallel_for.h>
 #include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
 
 #include <sdf/sdf.hh>
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -98,32 +101,46 @@ class ContactUpdate_TBB
 };
 */
 
-class Colliders_TBB
+/// \brief Get the geom whose ODE collider keeps scratch data in the geom
+/// itself when colliding a pair. Heightfields keep temporary buffers, and
+/// trimeshes keep temporal coherence caches for the primitives they collide
+/// with. Pairs that share such a geom must not be collided concurrently.
+/// \param[in] _collision1 First collision of the pair.
+/// \param[in] _collision2 Second collision of the pair.
+/// \return The geom, or nullptr if the pair can be collided concurrently
+/// with any other pair.
+static dGeomID StatefulGeom(ODECollision *_collision1,
+    ODECollision *_collision2)
 {
-  public: Colliders_TBB(
-              std::vector<std::pair<ODECollision*, ODECollision*> > *_colliders,
-              ODEPhysics *_engine,
-              dContactGeom* _contactCollisions) :
-    colliders(_colliders),
-              engine(_engine), contactCollisions(_contactCollisions)
-  {
-    // dAllocateODEDataForThread(dAllocateMaskAll);
-  }
-
-  public: void operator() (const tbb::blocked_range<size_t> &_r) const
-  {
-    for (size_t i = _r.begin(); i != _r.end(); i++)
-    {
-      ODECollision *collision1 = (*this->colliders)[i].first;
-      ODECollision *collision2 = (*this->colliders)[i].second;
-      this->engine->Collide(collision1, collision2, contactCollisions);
-    }
-  }
+  dGeomID geom1 = _collision1->GetCollisionId();
+  dGeomID geom2 = _collision2->GetCollisionId();
+  int class1 = dGeomGetClass(geom1);
+  int class2 = dGeomGetClass(geom2);
+
+  if (class1 == dHeightfieldClass)
+    return geom1;
+  if (class2 == dHeightfieldClass)
+    return geom2;
+
+  // The trimesh-trimesh collider only uses the per thread collider cache.
+  if (class1 == dTriMeshClass && class2 != dTriMeshClass)
+    return geom1;
+  if (class2 == dTriMeshClass && class1 != dTriMeshClass)
+    return geom2;
+
+  return nullptr;
+}
 
-  private: std::vector< std::pair<ODECollision*, ODECollision*> > *colliders;
-  private: ODEPhysics *engine;
-  private: dContactGeom* contactCollisions;
-};
+/// \brief Order the collision pairs of persistent contacts.
+/// \param[in] _a First pair.
+/// \param[in] _b Second pair.
+/// \return True if _a comes before _b.
+static bool PersistentPairLess(const ODEPersistentPair &_a,
+    const ODEPersistentPair &_b)
+{
+  return std::tie(_a.collision1, _a.collision2) <
+      std::tie(_b.collision1, _b.collision2);
+}
 
 //////////////////////////////////////////////////
 extern "C" void dMessageQuiet(int, const char *, va_list)
@@ -365,6 +382,7 @@ void ODEPhysics::UpdateCollision()
   IGN_PROFILE_BEGIN("dSpaceCollide");
 
   boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  this->SaveContactImpulses();
   dJointGroupEmpty(this->dataPtr->contactGroup);
 
   unsigned int i = 0;
@@ -380,6 +398,18 @@ void ODEPhysics::UpdateCollision()
   DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "dSpaceCollide");
   IGN_PROFILE_END();
 
+  if (this->dataPtr->collisionArena &&
+      this->dataPtr->collidersCount + this->dataPtr->trimeshCollidersCount > 1)
+  {
+    IGN_PROFILE_BEGIN("collideParallel");
+    this->CollideParallel();
+    DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "collideParallel");
+    IGN_PROFILE_END();
+
+    DIAG_TIMER_STOP("ODEPhysics::UpdateCollision");
+    return;
+  }
+
   IGN_PROFILE_BEGIN("collideShapes");
   // Generate non-trimesh collisions.
   for (i = 0; i < this->dataPtr->collidersCount; ++i)
@@ -406,6 +436,145 @@ void ODEPhysics::UpdateCollision()
   DIAG_TIMER_STOP("ODEPhysics::UpdateCollision");
 }
 
+//////////////////////////////////////////////////
+void ODEPhysics::CollideParallel()
+{
+  ODEPhysicsPrivate *data = this->dataPtr;
+  const unsigned int pairCount =
+      data->collidersCount + data->trimeshCollidersCount;
+
+  // Pairs are numbered in the order of the serial narrow phase: normal
+  // colliders first, then trimesh colliders.
+  auto pairAt = [data](const unsigned int _index)
+      -> const std::pair<ODECollision*, ODECollision*> &
+  {
+    if (_index < data->collidersCount)
+      return data->colliders[_index];
+    return data->trimeshColliders[_index - data->collidersCount];
+  };
+
+  // Put the pairs that share a stateful geom in the same group. Every
+  // other pair gets a group of its own.
+  data->geomGroups.clear();
+  data->pairGroups.resize(pairCount);
+  unsigned int groupCount = 0;
+  for (unsigned int i = 0; i < pairCount; ++i)
+  {
+    const auto &pair = pairAt(i);
+    dGeomID geom = StatefulGeom(pair.first, pair.second);
+    if (geom)
+    {
+      auto inserted = data->geomGroups.emplace(geom, groupCount);
+      if (inserted.second)
+        ++groupCount;
+      data->pairGroups[i] = inserted.first->second;
+    }
+    else
+      data->pairGroups[i] = groupCount++;
+  }
+
+  // Sort the pairs by group, keeping the serial order within a group.
+  data->groupStart.assign(groupCount + 1, 0);
+  for (unsigned int i = 0; i < pairCount; ++i)
+    ++data->groupStart[data->pairGroups[i] + 1];
+  for (unsigned int g = 0; g < groupCount; ++g)
+    data->groupStart[g + 1] += data->groupStart[g];
+  data->groupPairs.resize(pairCount);
+  for (unsigned int i = 0; i < pairCount; ++i)
+    data->groupPairs[data->groupStart[data->pairGroups[i]]++] = i;
+  for (unsigned int g = groupCount; g > 0; --g)
+    data->groupStart[g] = data->groupStart[g - 1];
+  data->groupStart[0] = 0;
+
+  for (auto &buffer : data->narrowPhaseBuffers)
+  {
+    buffer.contacts.clear();
+    buffer.pairs.clear();
+  }
+
+  // Generate the contacts of each group on the arena. Each thread writes
+  // into its own buffer, and the ODE trimesh colliders use a per thread
+  // cache.
+  data->collisionArena->execute([this, data, &pairAt, groupCount]()
+  {
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, groupCount),
+        [this, data, &pairAt](const tbb::blocked_range<unsigned int> &_r)
+    {
+      ODENarrowPhaseBuffer &buffer = data->narrowPhaseBuffers.local();
+      for (unsigned int g = _r.begin(); g != _r.end(); ++g)
+      {
+        for (unsigned int k = data->groupStart[g];
+             k < data->groupStart[g + 1]; ++k)
+        {
+          unsigned int index = data->groupPairs[k];
+          const auto &pair = pairAt(index);
+          unsigned int numc = this->NarrowPhase(pair.first, pair.second,
+              buffer.contactCollisions);
+          if (numc == 0)
+            continue;
+
+          ODEPairContacts contacts;
+          contacts.pair = index;
+          contacts.start = buffer.contacts.size();
+          contacts.count = numc;
+          contacts.buffer = &buffer.contacts;
+          buffer.contacts.insert(buffer.contacts.end(),
+              buffer.contactCollisions, buffer.contactCollisions + numc);
+          buffer.pairs.push_back(contacts);
+        }
+      }
+    });
+  });
+
+  // Create the contact joints on this thread, in the order of the serial
+  // narrow phase, so that the result doesn't depend on the scheduling.
+  data->mergedContacts.clear();
+  for (const auto &buffer : data->narrowPhaseBuffers)
+  {
+    data->mergedContacts.insert(data->mergedContacts.end(),
+        buffer.pairs.begin(), buffer.pairs.end());
+  }
+  std::sort(data->mergedContacts.begin(), data->mergedContacts.end(),
+      [](const ODEPairContacts &_a, const ODEPairContacts &_b)
+      {
+        return _a.pair < _b.pair;
+      });
+
+  for (const auto &contacts : data->mergedContacts)
+  {
+    const auto &pair = pairAt(contacts.pair);
+    this->AddContactJoints(pair.first, pair.second,
+        contacts.buffer->data() + contacts.start, contacts.count);
+  }
+}
+
+//////////////////////////////////////////////////
+void ODEPhysics::SaveContactImpulses()
+{
+  ODEPhysicsPrivate *data = this->dataPtr;
+
+  data->lastContacts.clear();
+  data->lastPairs.clear();
+  if (!data->contactPersistence)
+  {
+    data->persistentContacts.clear();
+    data->persistentPairs.clear();
+    return;
+  }
+
+  for (auto &contact : data->persistentContacts)
+  {
+    dJointGetLambda(contact.joint, contact.lambda, contact.lambdaErp);
+    contact.matched = false;
+  }
+
+  // The buffers are swapped to be reused without allocations.
+  std::swap(data->lastContacts, data->persistentContacts);
+  std::swap(data->lastPairs, data->persistentPairs);
+  std::sort(data->lastPairs.begin(), data->lastPairs.end(),
+      PersistentPairLess);
+}
+
 //////////////////////////////////////////////////
 void ODEPhysics::UpdatePhysics()
 {
@@ -494,6 +663,10 @@ void ODEPhysics::Reset()
   boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
   // Very important to clear out the contact group
   dJointGroupEmpty(this->dataPtr->contactGroup);
+
+  // The contact joints are gone, and so are their impulses.
+  this->dataPtr->persistentContacts.clear();
+  this->dataPtr->persistentPairs.clear();
 }
 
 //////////////////////////////////////////////////
@@ -652,6 +825,8 @@ ODEPhysics::ConvertWorldStepSolverType(const std::string &_solverType)
     result = BULLET_LEMKE;
   else if (_solverType.compare("BULLET_PGS") == 0)
     result = BULLET_PGS;
+  else if (_solverType.compare("ODE_COLORED_PGS") == 0)
+    result = ODE_COLORED_PGS;
   else
   {
     gzerr << "Unrecognized world step solver ["
@@ -689,6 +864,11 @@ ODEPhysics::ConvertWorldStepSolverType(const World_Solver_Type _solverType)
       result = "BULLET_PGS";
       break;
     }
+    case ODE_COLORED_PGS:
+    {
+      result = "ODE_COLORED_PGS";
+      break;
+    }
     default:
     {
       result = "unknown";
@@ -849,6 +1029,55 @@ double ODEPhysics::GetContactSurfaceLayer()
       "constraints")->Get<double>("contact_surface_layer");
 }
 
+//////////////////////////////////////////////////
+void ODEPhysics::SetCollisionThreads(const unsigned int _threads)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  this->dataPtr->collisionThreads = _threads;
+  if (_threads == 0)
+  {
+    this->dataPtr->collisionArena.reset();
+  }
+  else
+  {
+    this->dataPtr->collisionArena.reset(
+        new tbb::task_arena(static_cast<int>(_threads)));
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int ODEPhysics::CollisionThreads() const
+{
+  return this->dataPtr->collisionThreads;
+}
+
+//////////////////////////////////////////////////
+void ODEPhysics::SetContactPersistence(const bool _enable)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  this->dataPtr->contactPersistence = _enable;
+}
+
+//////////////////////////////////////////////////
+bool ODEPhysics::ContactPersistence() const
+{
+  return this->dataPtr->contactPersistence;
+}
+
+//////////////////////////////////////////////////
+void ODEPhysics::SetContactPersistenceDistance(const double _distance)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  this->dataPtr->contactPersistenceDistance = std::max(0.0, _distance);
+}
+
+//////////////////////////////////////////////////
+double ODEPhysics::ContactPersistenceDistance() const
+{
+  return this->dataPtr->contactPersistenceDistance;
+}
+
 //////////////////////////////////////////////////
 unsigned int ODEPhysics::GetMaxContacts()
 {
@@ -1012,11 +1241,22 @@ void ODEPhysics::CollisionCallback(void *_data, dGeomID _o1, dGeomID _o2)
 //////////////////////////////////////////////////
 void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
                          dContactGeom *_contactCollisions)
+{
+  unsigned int numc = this->NarrowPhase(_collision1, _collision2,
+      _contactCollisions);
+
+  if (numc > 0)
+    this->AddContactJoints(_collision1, _collision2, _contactCollisions, numc);
+}
+
+/////////////////////////////////////////////////
+unsigned int ODEPhysics::NarrowPhase(ODECollision *_collision1,
+    ODECollision *_collision2, dContactGeom *_contactCollisions)
 {
   // Filter collisions based on collide bitmask.
   if ((_collision1->GetSurface()->collideBitmask &
         _collision2->GetSurface()->collideBitmask) == 0)
-    return;
+    return 0;
 
   // Filter collisions based on contact bitmask if collide_without_contact is
   // on.The bitmask is set mainly for speed improvements otherwise a collision
@@ -1028,7 +1268,7 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
     if ((_collision1->GetSurface()->collideWithoutContactBitmask &
          _collision2->GetSurface()->collideWithoutContactBitmask) == 0)
     {
-      return;
+      return 0;
     }
   }
 
@@ -1045,9 +1285,8 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
   }*/
 
   unsigned int numc = 0;
-  dContact contact;
 
-  // maxCollide must less than the size of this->dataPtr->indices
+  // maxCollide must not be larger than MAX_CONTACT_JOINTS
   // Check the header
   unsigned int maxCollide = MAX_CONTACT_JOINTS;
 
@@ -1068,29 +1307,39 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
 
   // Return if no contacts.
   if (numc == 0)
-    return;
+    return 0;
 
-  // Store the indices of the contacts.
-  for (int i = 0; i < MAX_CONTACT_JOINTS; i++)
-    this->dataPtr->indices[i] = i;
-
-  // Choose only the best contacts if too many were generated.
+  // Choose only the best contacts if too many were generated. The last
+  // kept contact is replaced by the deepest of the dropped ones.
   if (maxCollide > 0 && numc > maxCollide)
   {
-    double max = _contactCollisions[maxCollide-1].depth;
+    unsigned int best = maxCollide - 1;
+    double max = _contactCollisions[best].depth;
     for (unsigned int i = maxCollide; i < numc; ++i)
     {
       if (_contactCollisions[i].depth > max)
       {
         max = _contactCollisions[i].depth;
-        this->dataPtr->indices[maxCollide-1] = i;
+        best = i;
       }
     }
+    _contactCollisions[maxCollide - 1] = _contactCollisions[best];
 
     // Make sure numc has the valid number of contacts.
     numc = maxCollide;
   }
 
+  return numc;
+}
+
+/////////////////////////////////////////////////
+void ODEPhysics::AddContactJoints(ODECollision *_collision1,
+    ODECollision *_collision2, const dContactGeom *_contacts,
+    const unsigned int _count)
+{
+  const unsigned int numc = _count;
+  dContact contact;
+
   // Set the contact surface parameter flags.
   contact.surface.mode = dContactBounce |
                          dContactMu2 |
@@ -1287,34 +1536,120 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
     jointFeedback->contact = contactFeedback;
   }
 
+  // Find the contacts of the pair in the last step, to warm start the
+  // matching contacts.
+  ODEPhysicsPrivate *data = this->dataPtr;
+  const bool persistence = data->contactPersistence;
+  unsigned int lastStart = 0;
+  unsigned int lastEnd = 0;
+  bool swapped = false;
+  if (persistence)
+  {
+    // The collisions of a pair aren't always reported in the same order,
+    // so the pair is stored with the lower collision first.
+    swapped = std::less<ODECollision *>()(_collision2, _collision1);
+    ODEPersistentPair pair;
+    pair.collision1 = swapped ? _collision2 : _collision1;
+    pair.collision2 = swapped ? _collision1 : _collision2;
+    auto iter = std::lower_bound(data->lastPairs.begin(),
+        data->lastPairs.end(), pair, PersistentPairLess);
+    if (iter != data->lastPairs.end() &&
+        iter->collision1 == pair.collision1 &&
+        iter->collision2 == pair.collision2)
+    {
+      lastStart = iter->start;
+      lastEnd = iter->start + iter->count;
+    }
+
+    pair.start = data->persistentContacts.size();
+    pair.count = numc;
+    data->persistentPairs.push_back(pair);
+  }
+
   // Create a joint for each contact
   for (unsigned int j = 0; j < numc; ++j)
   {
-    contact.geom = _contactCollisions[this->dataPtr->indices[j]];
+    contact.geom = _contacts[j];
 
     // Create the contact joint. This introduces the contact constraint to
     // ODE
     dJointID contactJoint = dJointCreateContact(this->dataPtr->worldId,
       this->dataPtr->contactGroup, &contact);
 
+    if (persistence)
+    {
+      ODEPersistentContact persistent;
+      persistent.pos.Set(_contacts[j].pos[0], _contacts[j].pos[1],
+          _contacts[j].pos[2]);
+      dBodyID frameBody = swapped ? b2 : b1;
+      if (frameBody)
+      {
+        dVector3 pos;
+        dBodyGetPosRelPoint(frameBody, _contacts[j].pos[0],
+            _contacts[j].pos[1], _contacts[j].pos[2], pos);
+        persistent.pos.Set(pos[0], pos[1], pos[2]);
+      }
+      persistent.side1 = swapped ? _contacts[j].side2 : _contacts[j].side1;
+      persistent.side2 = swapped ? _contacts[j].side1 : _contacts[j].side2;
+      persistent.joint = contactJoint;
+      persistent.swapped = swapped;
+      persistent.matched = false;
+
+      // Take the impulses of the closest contact of the last step on the
+      // same features that no other contact took.
+      ODEPersistentContact *closest = nullptr;
+      double closestDistance = data->contactPersistenceDistance;
+      for (unsigned int k = lastStart; k < lastEnd; ++k)
+      {
+        ODEPersistentContact &last = data->lastContacts[k];
+        if (last.matched || last.side1 != persistent.side1 ||
+            last.side2 != persistent.side2)
+        {
+          continue;
+        }
+
+        double distance = last.pos.Distance(persistent.pos);
+        if (distance <= closestDistance)
+        {
+          closest = &last;
+          closestDistance = distance;
+        }
+      }
+
+      if (closest)
+      {
+        closest->matched = true;
+        if (closest->swapped == swapped)
+        {
+          dJointSetLambda(contactJoint, closest->lambda, closest->lambdaErp);
+        }
+        else
+        {
+          // Swapping the collisions flips the normal along with the
+          // bodies, so the normal impulse holds, but the friction
+          // directions change. Only the normal impulse is carried over.
+          dReal lambda[6] = {closest->lambda[0], 0, 0, 0, 0, 0};
+          dReal lambdaErp[6] = {closest->lambdaErp[0], 0, 0, 0, 0, 0};
+          dJointSetLambda(contactJoint, lambda, lambdaErp);
+        }
+      }
+
+      data->persistentContacts.push_back(persistent);
+    }
+
     // Store contact information.
     if (contactFeedback && jointFeedback)
     {
       // Store the contact depth
-      contactFeedback->depths[j] =
-        _contactCollisions[this->dataPtr->indices[j]].depth;
+      contactFeedback->depths[j] = _contacts[j].depth;
 
       // Store the contact position
-      contactFeedback->positions[j].Set(
-          _contactCollisions[this->dataPtr->indices[j]].pos[0],
-          _contactCollisions[this->dataPtr->indices[j]].pos[1],
-          _contactCollisions[this->dataPtr->indices[j]].pos[2]);
+      contactFeedback->positions[j].Set(_contacts[j].pos[0],
+          _contacts[j].pos[1], _contacts[j].pos[2]);
 
       // Store the contact normal
-      contactFeedback->normals[j].Set(
-          _contactCollisions[this->dataPtr->indices[j]].normal[0],
-          _contactCollisions[this->dataPtr->indices[j]].normal[1],
-          _contactCollisions[this->dataPtr->indices[j]].normal[2]);
+      contactFeedback->normals[j].Set(_contacts[j].normal[0],
+          _contacts[j].normal[1], _contacts[j].normal[2]);
 
       // Set the joint feedback.
       dJointSetFeedback(contactJoint, &(jointFeedback->feedbacks[j]));
@@ -1555,6 +1890,38 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
       }
       dWorldSetIslandThreads(this->dataPtr->worldId, value);
     }
+    else if (_key == "quickstep_threads")
+    {
+      int value;
+      try
+      {
+        value = any_cast<int>(_value);
+      }
+      catch(const boost::bad_any_cast &e)
+      {
+        gzerr << "boost any_cast error:" << e.what() << "\n";
+        return false;
+      }
+      dWorldSetQuickStepThreads(this->dataPtr->worldId, value);
+    }
+    else if (_key == "collision_threads")
+    {
+      int value;
+      try
+      {
+        value = any_cast<int>(_value);
+      }
+      catch(const boost::bad_any_cast &e)
+      {
+        gzerr << "boost any_cast error:" << e.what() << "\n";
+        return false;
+      }
+      this->SetCollisionThreads(value < 0 ? 0u : static_cast<unsigned>(value));
+    }
+    else if (_key == "contact_persistence")
+      this->SetContactPersistence(any_cast<bool>(_value));
+    else if (_key == "contact_persistence_distance")
+      this->SetContactPersistenceDistance(any_cast<double>(_value));
     else if (_key == "ode_quiet")
     {
       bool odeQuiet = any_cast<bool>(_value);
@@ -1662,6 +2029,16 @@ bool ODEPhysics::GetParam(const std::string &_key, boost::any &_value) const
     _value = this->GetFrictionModel();
   else if (_key == "island_threads")
     _value = dWorldGetIslandThreads(this->dataPtr->worldId);
+  else if (_key == "quickstep_threads")
+    _value = dWorldGetQuickStepThreads(this->dataPtr->worldId);
+  else if (_key == "colored_pgs_threads")
+    _value = dWorldGetQuickStepColoredPGSThreads(this->dataPtr->worldId);
+  else if (_key == "collision_threads")
+    _value = static_cast<int>(this->dataPtr->collisionThreads);
+  else if (_key == "contact_persistence")
+    _value = this->dataPtr->contactPersistence;
+  else if (_key == "contact_persistence_distance")
+    _value = this->dataPtr->contactPersistenceDistance;
   else if (_key == "ode_quiet")
     _value = dGetMessageHandler() != 0;
   else if (_key == "world_step_solver")
@@ -168,6 +168,10 @@ namespace gazebo
       public: virtual void SetFrictionModel(const std::string &_fricModel);
 
       /// \brief Set world step solver type.
+      /// "ODE_COLORED_PGS" applies to the quick step instead: it solves
+      /// the constraint rows in groups that share no link, with the
+      /// "quickstep_threads" parameter setting the number of threads. The
+      /// result doesn't depend on the number of threads.
       /// \param[in] _worldSolverType Type of solver used by world step.
       public: virtual void
               SetWorldStepSolverType(const std::string &_worldSolverType);
@@ -207,6 +211,53 @@ namespace gazebo
       // Documentation inherited
       public: virtual unsigned int GetMaxContacts();
 
+      /// \brief Set the number of threads used to generate contacts. With
+      /// zero threads, the default, the collision pairs are collided one
+      /// after another on the physics thread. Otherwise they are split
+      /// across a persistent pool of worker threads, and the contact joints
+      /// are still created in the serial order, so that the simulation
+      /// doesn't depend on the number of threads.
+      /// This is also available as the "collision_threads" parameter.
+      /// \param[in] _threads Number of threads.
+      public: void SetCollisionThreads(const unsigned int _threads);
+
+      /// \brief Get the number of threads used to generate contacts.
+      /// \return Number of threads, zero when contacts are generated on the
+      /// physics thread.
+      /// \sa SetCollisionThreads
+      public: unsigned int CollisionThreads() const;
+
+      /// \brief Enable contact persistence. Contact joints are recreated
+      /// every step, so the quickstep solver would start every contact
+      /// from a zero impulse. With persistence, a contact that matches a
+      /// contact of the last step, with the same collisions, the same geom
+      /// features and a position within ContactPersistenceDistance, is
+      /// warm started from the impulses of that contact, scaled by the
+      /// "warm_start_factor" parameter. Resting and grasping contacts then
+      /// need fewer iterations. Disabled by default.
+      /// This is also available as the "contact_persistence" parameter.
+      /// \param[in] _enable True to enable contact persistence.
+      public: void SetContactPersistence(const bool _enable);
+
+      /// \brief Get whether contact persistence is enabled.
+      /// \return True if contacts are warm started.
+      /// \sa SetContactPersistence
+      public: bool ContactPersistence() const;
+
+      /// \brief Set the distance within which a contact matches a contact
+      /// of the last step. Positions are compared in the frame of the link
+      /// of the first collision, or in the world frame if it is static.
+      /// This is also available as the "contact_persistence_distance"
+      /// parameter.
+      /// \param[in] _distance Distance in meters, 0.01 by default.
+      public: void SetContactPersistenceDistance(const double _distance);
+
+      /// \brief Get the distance within which a contact matches a contact
+      /// of the last step.
+      /// \return Distance in meters.
+      /// \sa SetContactPersistenceDistance
+      public: double ContactPersistenceDistance() const;
+
       // Documentation inherited
       public: virtual void DebugPrint() const;
 
@@ -287,6 +338,37 @@ namespace gazebo
       public: void Collide(ODECollision *_collision1, ODECollision *_collision2,
                            dContactGeom *_contactCollisions);
 
+      /// \brief Generate the contact points of two collision objects,
+      /// without creating contact joints. Can be called from several
+      /// threads at once, as long as the pairs don't share a heightfield,
+      /// or a trimesh colliding with a primitive shape.
+      /// \param[in] _collision1 First collision object.
+      /// \param[in] _collision2 Second collision object.
+      /// \param[out] _contactCollisions Array of MAX_COLLIDE_RETURNS
+      /// contacts. The contacts to keep are stored first.
+      /// \return Number of contacts to keep.
+      private: unsigned int NarrowPhase(ODECollision *_collision1,
+                   ODECollision *_collision2,
+                   dContactGeom *_contactCollisions);
+
+      /// \brief Create the contact joints between two collision objects.
+      /// \param[in] _collision1 First collision object.
+      /// \param[in] _collision2 Second collision object.
+      /// \param[in] _contacts Contacts returned by NarrowPhase.
+      /// \param[in] _count Number of contacts.
+      private: void AddContactJoints(ODECollision *_collision1,
+                   ODECollision *_collision2, const dContactGeom *_contacts,
+                   const unsigned int _count);
+
+      /// \brief Collide all the colliders and trimesh colliders on the
+      /// collision threads.
+      private: void CollideParallel();
+
+      /// \brief Read the impulses of the contact joints of the last step,
+      /// before they are destroyed, so that the contacts of the next step
+      /// can be warm started from them.
+      private: void SaveContactImpulses();
+
       /// \brief process joint feedbacks.
       /// \param[in] _feedback ODE Joint Contact feedback information.
       public: void ProcessJointFeedback(ODEJointFeedback *_feedback);
@@ -18,11 +18,18 @@
 #ifndef _ODEPHYSICS_PRIVATE_HH_
 #define _ODEPHYSICS_PRIVATE_HH_
 
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
+
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
+#include <ignition/math/Vector3.hh>
+
 #include "gazebo/physics/Contact.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 
@@ -45,6 +52,86 @@ namespace gazebo
       public: dJointFeedback feedbacks[MAX_CONTACT_JOINTS];
     };
 
+    /// \brief Contacts generated for one collision pair by a collision
+    /// thread.
+    class ODEPairContacts
+    {
+      /// \brief Index of the pair, normal colliders first and then trimesh
+      /// colliders.
+      public: unsigned int pair;
+
+      /// \brief Index of the first contact in buffer.
+      public: unsigned int start;
+
+      /// \brief Number of contacts.
+      public: unsigned int count;
+
+      /// \brief Contacts of the collision thread.
+      public: const std::vector<dContactGeom> *buffer;
+    };
+
+    /// \brief Data of a collision thread.
+    class ODENarrowPhaseBuffer
+    {
+      /// \brief Contacts returned by dCollide for the current pair.
+      public: dContactGeom contactCollisions[MAX_COLLIDE_RETURNS];
+
+      /// \brief Contacts kept for all the pairs of the thread.
+      public: std::vector<dContactGeom> contacts;
+
+      /// \brief Pairs with contacts.
+      public: std::vector<ODEPairContacts> pairs;
+    };
+
+    /// \brief A contact joint of the last step, kept so that the contact
+    /// that replaces it can start from its impulses.
+    class ODEPersistentContact
+    {
+      /// \brief Position of the contact in the frame of the body of the
+      /// lower collision of the pair, or in the world frame if that
+      /// collision is static.
+      public: ignition::math::Vector3d pos;
+
+      /// \brief Feature of the geom of the lower collision.
+      public: int side1;
+
+      /// \brief Feature of the geom of the higher collision.
+      public: int side2;
+
+      /// \brief The contact joint, valid until the contact group is
+      /// emptied.
+      public: dJointID joint;
+
+      /// \brief True if the joint was created with the higher collision
+      /// first.
+      public: bool swapped;
+
+      /// \brief Impulses of the constraint rows.
+      public: dReal lambda[6];
+
+      /// \brief Impulses of the constraint rows used for error reduction.
+      public: dReal lambdaErp[6];
+
+      /// \brief True once a contact of the current step took the impulses.
+      public: bool matched;
+    };
+
+    /// \brief Contacts of a collision pair in the last step.
+    class ODEPersistentPair
+    {
+      /// \brief Lower collision of the pair.
+      public: ODECollision *collision1;
+
+      /// \brief Higher collision of the pair.
+      public: ODECollision *collision2;
+
+      /// \brief Index of the first contact of the pair.
+      public: unsigned int start;
+
+      /// \brief Number of contacts.
+      public: unsigned int count;
+    };
+
     class ODEPhysicsPrivate
     {
       /// \brief Top-level world for all bodies
@@ -78,9 +165,6 @@ namespace gazebo
       /// \brief Array of contact collisions.
       public: dContactGeom contactCollisions[MAX_COLLIDE_RETURNS];
 
-      /// \brief Indices used during creation of contact joints.
-      public: int indices[MAX_CONTACT_JOINTS];
-
       /// \brief Current index into the contactFeedbacks buffer
       public: unsigned int jointFeedbackIndex;
 
@@ -92,6 +176,53 @@ namespace gazebo
 
       /// \brief Maximum number of contact points per collision pair.
       public: unsigned int maxContacts;
+
+      /// \brief Number of threads used to generate contacts.
+      public: unsigned int collisionThreads = 0;
+
+      /// \brief Persistent task arena used to generate contacts in
+      /// parallel. Null when contacts are generated on the physics thread.
+      public: std::unique_ptr<tbb::task_arena> collisionArena;
+
+      /// \brief Scratch space and generated contacts of each collision
+      /// thread.
+      public: tbb::enumerable_thread_specific<ODENarrowPhaseBuffer>
+              narrowPhaseBuffers;
+
+      /// \brief Group of each collision pair.
+      public: std::vector<unsigned int> pairGroups;
+
+      /// \brief Index of the first pair of each group in groupPairs.
+      public: std::vector<unsigned int> groupStart;
+
+      /// \brief Collision pairs sorted by group.
+      public: std::vector<unsigned int> groupPairs;
+
+      /// \brief Group of the pairs that share a stateful geom.
+      public: std::unordered_map<dGeomID, unsigned int> geomGroups;
+
+      /// \brief Contacts of all the collision threads, sorted by pair.
+      public: std::vector<ODEPairContacts> mergedContacts;
+
+      /// \brief True to warm start the solver with the impulses of the
+      /// matching contacts of the last step.
+      public: bool contactPersistence = false;
+
+      /// \brief Distance within which a contact matches a contact of the
+      /// last step.
+      public: double contactPersistenceDistance = 0.01;
+
+      /// \brief Contacts created in the current step.
+      public: std::vector<ODEPersistentContact> persistentContacts;
+
+      /// \brief Collision pairs of persistentContacts.
+      public: std::vector<ODEPersistentPair> persistentPairs;
+
+      /// \brief Contacts of the last step.
+      public: std::vector<ODEPersistentContact> lastContacts;
+
+      /// \brief Collision pairs of lastContacts, sorted by collisions.
+      public: std::vector<ODEPersistentPair> lastPairs;
     };
   }
 }
@@ -17,8 +17,16 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "gazebo/physics/physics.hh"
 #include "gazebo/physics/PhysicsEngine.hh"
+#include "gazebo/physics/ode/ODELink.hh"
 #include "gazebo/physics/ode/ODEPhysics.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 #include "gazebo/test/ServerFixture.hh"
@@ -29,6 +37,7 @@ using namespace physics;
 class ODEPhysics_TEST : public ServerFixture
 {
   public: void PhysicsMsgParam();
+  public: void ParallelCollision(const std::string &_worldFile);
   public: void OnPhysicsMsgResponse(ConstResponsePtr &_msg);
   public: static msgs::Physics physicsPubMsg;
   public: static msgs::Physics physicsResponseMsg;
@@ -320,6 +329,76 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
     }
   }
 
+  // Test quickstep_threads
+  {
+    // quickstep_threads should be 0 by default
+    int quickstepThreads = 1;
+    EXPECT_NO_THROW(quickstepThreads =
+      boost::any_cast<int>(odePhysics->GetParam("quickstep_threads")));
+    EXPECT_FALSE(quickstepThreads);
+
+    // try enabling threads, then disabling
+    std::vector<int> threads = {1, 2, 3, 0};
+    for (auto const quickstepThreadsSet : threads)
+    {
+      odePhysics->SetParam("quickstep_threads", quickstepThreadsSet);
+      EXPECT_NO_THROW(quickstepThreads =
+        boost::any_cast<int>(odePhysics->GetParam("quickstep_threads")));
+      EXPECT_EQ(quickstepThreads, quickstepThreadsSet);
+    }
+  }
+
+  // Test collision_threads
+  {
+    // collision_threads should be 0 by default
+    int collisionThreads = 1;
+    EXPECT_NO_THROW(collisionThreads =
+      boost::any_cast<int>(odePhysics->GetParam("collision_threads")));
+    EXPECT_EQ(0, collisionThreads);
+
+    // try enabling threads, then disabling
+    std::vector<int> threads = {1, 2, 3, 0};
+    for (auto const collisionThreadsSet : threads)
+    {
+      odePhysics->SetParam("collision_threads", collisionThreadsSet);
+      EXPECT_NO_THROW(collisionThreads =
+        boost::any_cast<int>(odePhysics->GetParam("collision_threads")));
+      EXPECT_EQ(collisionThreads, collisionThreadsSet);
+      EXPECT_EQ(odePhysics->CollisionThreads(),
+          static_cast<unsigned int>(collisionThreadsSet));
+    }
+  }
+
+  // Test contact_persistence and contact_persistence_distance
+  {
+    // contact persistence should be off by default
+    bool persistence = true;
+    EXPECT_NO_THROW(persistence =
+      boost::any_cast<bool>(odePhysics->GetParam("contact_persistence")));
+    EXPECT_FALSE(persistence);
+
+    double distance = 0;
+    EXPECT_NO_THROW(distance = boost::any_cast<double>(
+          odePhysics->GetParam("contact_persistence_distance")));
+    EXPECT_DOUBLE_EQ(0.01, distance);
+
+    for (bool persistenceSet : {true, false})
+    {
+      odePhysics->SetParam("contact_persistence", persistenceSet);
+      EXPECT_NO_THROW(persistence =
+        boost::any_cast<bool>(odePhysics->GetParam("contact_persistence")));
+      EXPECT_EQ(persistenceSet, persistence);
+      EXPECT_EQ(persistenceSet, odePhysics->ContactPersistence());
+    }
+
+    odePhysics->SetParam("contact_persistence_distance", 0.002);
+    EXPECT_NO_THROW(distance = boost::any_cast<double>(
+          odePhysics->GetParam("contact_persistence_distance")));
+    EXPECT_DOUBLE_EQ(0.002, distance);
+    EXPECT_DOUBLE_EQ(0.002, odePhysics->ContactPersistenceDistance());
+    odePhysics->SetContactPersistenceDistance(0.01);
+  }
+
   // Test ode_quiet
   // convenient for disabling LCP internal error messages from world solver
   {
@@ -372,6 +451,17 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
       odePhysics->GetParam("world_step_solver")));
     EXPECT_EQ(param, worldSolverType);
   }
+
+  {
+    // Switch to "ODE_COLORED_PGS" using SetParam
+    const std::string worldSolverType = "ODE_COLORED_PGS";
+    odePhysics->SetParam("world_step_solver", worldSolverType);
+    EXPECT_EQ(odePhysics->GetWorldStepSolverType(), worldSolverType);
+    std::string param;
+    EXPECT_NO_THROW(param = boost::any_cast<std::string>(
+      odePhysics->GetParam("world_step_solver")));
+    EXPECT_EQ(param, worldSolverType);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -490,6 +580,297 @@ TEST_F(ODEPhysics_TEST, PhysicsMsgParam)
   PhysicsMsgParam();
 }
 
+/////////////////////////////////////////////////
+/// \brief Get the contacts generated by one collision update, with all the
+/// values written exactly.
+/// \param[in] _physics Physics engine.
+/// \return One line per contact point.
+static std::vector<std::string> CollisionContacts(PhysicsEnginePtr _physics)
+{
+  _physics->UpdateCollision();
+
+  std::vector<std::string> result;
+  ContactManager *manager = _physics->GetContactManager();
+  for (unsigned int i = 0; i < manager->GetContactCount(); ++i)
+  {
+    Contact *contact = manager->GetContact(i);
+    for (int j = 0; j < contact->count; ++j)
+    {
+      std::ostringstream stream;
+      stream << std::hexfloat << contact->collision1->GetScopedName() << " "
+             << contact->collision2->GetScopedName() << " "
+             << contact->depths[j] << " "
+             << contact->positions[j].X() << " "
+             << contact->positions[j].Y() << " "
+             << contact->positions[j].Z() << " "
+             << contact->normals[j].X() << " "
+             << contact->normals[j].Y() << " "
+             << contact->normals[j].Z();
+      result.push_back(stream.str());
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+void ODEPhysics_TEST::ParallelCollision(const std::string &_worldFile)
+{
+  Load(_worldFile, true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+  ODEPhysicsPtr odePhysics = boost::static_pointer_cast<ODEPhysics>(physics);
+
+  // Let the models come to rest on the ground.
+  world->Step(200);
+
+  physics->GetContactManager()->SetNeverDropContacts(true);
+  std::vector<std::string> serial = CollisionContacts(physics);
+  EXPECT_FALSE(serial.empty());
+
+  // The contacts must be the same, in the same order, whatever the number
+  // of threads.
+  for (int threads : {1, 2, 4})
+  {
+    odePhysics->SetParam("collision_threads", threads);
+    std::vector<std::string> parallel = CollisionContacts(physics);
+    ASSERT_EQ(serial.size(), parallel.size()) << threads << " threads";
+    for (unsigned int i = 0; i < serial.size(); ++i)
+      EXPECT_EQ(serial[i], parallel[i]) << threads << " threads";
+  }
+
+  // Keep simulating with the parallel narrow phase.
+  world->Step(100);
+  EXPECT_EQ(4u, odePhysics->CollisionThreads());
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEPhysics_TEST, ParallelCollisionShapes)
+{
+  ParallelCollision("worlds/shapes.world");
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEPhysics_TEST, ParallelCollisionHeightmap)
+{
+  ParallelCollision("test/worlds/heightmap_test_with_boxes.world");
+}
+
+/////////////////////////////////////////////////
+// Trimeshes collided on the worker threads use caches of their own.
+TEST_F(ODEPhysics_TEST, ParallelCollisionTrimesh)
+{
+  ParallelCollision("test/worlds/mesh_instances.world");
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the normal impulses of the contact joints of a link, in
+/// increasing order.
+/// \param[in] _link The link.
+/// \return The impulses.
+static std::vector<double> ContactImpulses(const LinkPtr &_link)
+{
+  ODELinkPtr odeLink = boost::dynamic_pointer_cast<ODELink>(_link);
+  std::vector<double> impulses;
+  if (!odeLink)
+    return impulses;
+
+  dBodyID body = odeLink->GetODEId();
+  for (int i = 0; i < dBodyGetNumJoints(body); ++i)
+  {
+    dJointID joint = dBodyGetJoint(body, i);
+    if (dJointGetType(joint) != dJointTypeContact)
+      continue;
+
+    dReal lambda[6];
+    dReal lambdaErp[6];
+    dJointGetLambda(joint, lambda, lambdaErp);
+    impulses.push_back(lambda[0]);
+  }
+  std::sort(impulses.begin(), impulses.end());
+  return impulses;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that the contacts of a resting box start from the
+/// impulses of the last step, with the collision threads and across a
+/// world reset.
+TEST_F(ODEPhysics_TEST, ContactPersistence)
+{
+  Load("worlds/shapes.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+  odePhysics->SetContactPersistence(true);
+
+  // Carry the impulses without scaling, and with no extra friction
+  // iterations, so that a step without iterations leaves them unchanged.
+  odePhysics->SetParam("warm_start_factor", 1.0);
+  odePhysics->SetParam("extra_friction_iterations", 0);
+
+  ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  box->SetAutoDisable(false);
+  LinkPtr link = box->GetLink();
+  ASSERT_TRUE(link != nullptr);
+
+  for (int threads : {0, 2})
+  {
+    odePhysics->SetParam("collision_threads", threads);
+    odePhysics->SetParam("iters", 50);
+    world->Step(500);
+
+    // The box rests on the ground plane.
+    EXPECT_NEAR(0.5, box->WorldPose().Pos().Z(), 5e-3);
+    EXPECT_NEAR(0.0, box->WorldLinearVel().Length(), 1e-3);
+
+    std::vector<double> impulses = ContactImpulses(link);
+    ASSERT_FALSE(impulses.empty());
+    EXPECT_GT(impulses.front(), 0.0);
+
+    // The new contact joints of the next step start from the impulses of
+    // the matching contacts, which the solver keeps without iterations.
+    odePhysics->SetParam("iters", 0);
+    world->Step(1);
+    std::vector<double> warmImpulses = ContactImpulses(link);
+    ASSERT_EQ(impulses.size(), warmImpulses.size());
+    for (unsigned int i = 0; i < impulses.size(); ++i)
+      EXPECT_DOUBLE_EQ(impulses[i], warmImpulses[i]) << i;
+
+    world->Reset();
+  }
+
+  // Without persistence, the contacts start from a zero impulse.
+  odePhysics->SetContactPersistence(false);
+  odePhysics->SetParam("iters", 50);
+  world->Step(500);
+  EXPECT_NEAR(0.5, box->WorldPose().Pos().Z(), 5e-3);
+  odePhysics->SetParam("iters", 0);
+  world->Step(1);
+  std::vector<double> coldImpulses = ContactImpulses(link);
+  ASSERT_FALSE(coldImpulses.empty());
+  for (double impulse : coldImpulses)
+    EXPECT_DOUBLE_EQ(0.0, impulse);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the SDF of a chain of boxes linked by revolute joints, along
+/// the X axis. The chain is a single island with many constraint blocks
+/// of each color.
+/// \param[in] _name Name of the model.
+/// \param[in] _links Number of links.
+/// \param[in] _z Height of the chain.
+/// \return The SDF.
+static std::string ChainSdf(const std::string &_name,
+    const unsigned int _links, const double _z)
+{
+  const double size = 0.1;
+  std::ostringstream sdf;
+  sdf << "<sdf version='" << SDF_VERSION << "'>"
+      << "<model name='" << _name << "'>";
+  for (unsigned int i = 0; i < _links; ++i)
+  {
+    sdf << "<link name='link_" << i << "'>"
+        << "  <pose>" << i * size << " 0 " << _z << " 0 0 0</pose>"
+        << "  <inertial><mass>0.1</mass><inertia>"
+        << "    <ixx>1.7e-4</ixx><iyy>1.7e-4</iyy><izz>1.7e-4</izz>"
+        << "  </inertia></inertial>"
+        << "  <collision name='collision'><geometry><box>"
+        << "    <size>" << 0.9 * size << " " << size << " " << size
+        << "</size></box></geometry></collision>"
+        << "</link>";
+    if (i > 0)
+    {
+      sdf << "<joint name='joint_" << i << "' type='revolute'>"
+          << "  <pose>" << -size / 2 << " 0 0 0 0 0</pose>"
+          << "  <parent>link_" << i - 1 << "</parent>"
+          << "  <child>link_" << i << "</child>"
+          << "  <axis><xyz>0 1 0</xyz></axis>"
+          << "</joint>";
+    }
+  }
+  sdf << "</model></sdf>";
+  return sdf.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief The graph colored PGS solver gives the same poses, bit for bit,
+/// whatever the number of quickstep threads.
+TEST_F(ODEPhysics_TEST, ColoredPGSDeterministic)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+  odePhysics->SetWorldStepSolverType("ODE_COLORED_PGS");
+
+  // A chain falling on the ground plane, so that joint and contact rows
+  // are solved together.
+  SpawnSDF(ChainSdf("chain", 200, 0.1));
+  ModelPtr chain = world->ModelByName("chain");
+  ASSERT_TRUE(chain != nullptr);
+  ASSERT_EQ(200u, chain->GetLinks().size());
+
+  // The serial run is repeated last, to tell a difference due to threads
+  // from one due to the reset.
+  std::vector<double> serialPoses;
+  for (int threads : {0, 3, 1, 0})
+  {
+    odePhysics->SetParam("quickstep_threads", threads);
+    world->Reset();
+
+    // Keep the largest number of threads that solved a color together.
+    int threadsUsed = 0;
+    for (int i = 0; i < 500; ++i)
+    {
+      world->Step(1);
+      threadsUsed = std::max(threadsUsed,
+          boost::any_cast<int>(odePhysics->GetParam("colored_pgs_threads")));
+    }
+    if (threads == 0)
+    {
+      EXPECT_EQ(1, threadsUsed);
+    }
+    else if (threads == 1)
+    {
+      EXPECT_LE(threadsUsed, 2);
+    }
+    else
+    {
+      EXPECT_GT(threadsUsed, 1) << threads;
+    }
+
+    std::vector<double> poses;
+    for (auto const &link : chain->GetLinks())
+    {
+      const ignition::math::Pose3d pose = link->WorldPose();
+      poses.insert(poses.end(), {pose.Pos().X(), pose.Pos().Y(),
+          pose.Pos().Z(), pose.Rot().W(), pose.Rot().X(), pose.Rot().Y(),
+          pose.Rot().Z()});
+    }
+
+    if (serialPoses.empty())
+    {
+      serialPoses = poses;
+      continue;
+    }
+    ASSERT_EQ(serialPoses.size(), poses.size());
+    EXPECT_EQ(0, std::memcmp(serialPoses.data(), poses.data(),
+          poses.size() * sizeof(double))) << threads;
+  }
+
+  // The chain rests on the ground plane.
+  EXPECT_NEAR(0.05, chain->GetLinks()[100]->WorldPose().Pos().Z(), 5e-3);
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -40,6 +40,25 @@ SimbodyJoint::SimbodyJoint(BasePtr _parent)
 //////////////////////////////////////////////////
 SimbodyJoint::~SimbodyJoint()
 {
+  if (this->simbodyPhysics)
+    this->simbodyPhysics->RemoveSimbodyJoint(this);
+}
+
+//////////////////////////////////////////////////
+void SimbodyJoint::Init()
+{
+  Joint::Init();
+
+  this->simbodyPhysics->AddSimbodyJoint(this);
+}
+
+//////////////////////////////////////////////////
+void SimbodyJoint::Fini()
+{
+  if (this->simbodyPhysics)
+    this->simbodyPhysics->RemoveSimbodyJoint(this);
+
+  Joint::Fini();
 }
 
 //////////////////////////////////////////////////
@@ -46,6 +46,8 @@ SimbodyLink::SimbodyLink(EntityPtr _parent)
 //////////////////////////////////////////////////
 SimbodyLink::~SimbodyLink()
 {
+  if (this->simbodyPhysics)
+    this->simbodyPhysics->RemoveSimbodyLink(this);
 }
 
 //////////////////////////////////////////////////
@@ -102,6 +104,8 @@ void SimbodyLink::Init()
   // lock or unlock the link if requested by user
   this->staticLinkConnection = event::Events::ConnectWorldUpdateEnd(
     boost::bind(&SimbodyLink::ProcessSetLinkStatic, this));
+
+  this->simbodyPhysics->AddSimbodyLink(this);
 }
 
 //////////////////////////////////////////////////
@@ -109,6 +113,10 @@ void SimbodyLink::Fini()
 {
   this->gravityModeConnection.reset();
   this->staticLinkConnection.reset();
+
+  if (this->simbodyPhysics)
+    this->simbodyPhysics->RemoveSimbodyLink(this);
+
   Link::Fini();
 }
 
@@ -15,7 +15,11 @@
  *
 */
 
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -69,6 +73,46 @@ using namespace SimTK;
 
 GZ_REGISTER_PHYSICS_ENGINE("simbody", SimbodyPhysics)
 
+/// \brief A link whose pose is pushed to gazebo after each step.
+struct SimbodySyncedLink
+{
+  /// \brief The link.
+  SimbodyLink *link;
+
+  /// \brief True if transform holds the transform of the last dirty pose.
+  bool poseSynced;
+
+  /// \brief Transform of the master mobilized body at the last dirty pose.
+  SimTK::Transform transform;
+};
+
+/// \brief Links and joints of a SimbodyPhysics updated after each step.
+struct SimbodySync
+{
+  /// \brief All the initialized links.
+  std::vector<SimbodySyncedLink> links;
+
+  /// \brief All the initialized joints.
+  std::vector<SimbodyJoint *> joints;
+
+  /// \brief Number of links pushed to the dirty poses by the last step.
+  unsigned int movedLinkCount = 0;
+};
+
+// TODO added here for ABI compatibility
+// move to class when merging forward
+static std::mutex gSimbodySyncMutex;
+static std::map<const SimbodyPhysics *, SimbodySync> gSimbodySync;
+
+/// \brief Get the links and joints updated after each step.
+/// \param[in] _physics The physics engine.
+/// \return The links and joints of _physics.
+static SimbodySync &simbodySync(const SimbodyPhysics *_physics)
+{
+  std::lock_guard<std::mutex> lock(gSimbodySyncMutex);
+  return gSimbodySync[_physics];
+}
+
 //////////////////////////////////////////////////
 SimbodyPhysics::SimbodyPhysics(WorldPtr _world)
     : PhysicsEngine(_world), system(), matter(system), forces(system),
@@ -98,6 +142,8 @@ SimbodyPhysics::SimbodyPhysics(WorldPtr _world)
 //////////////////////////////////////////////////
 SimbodyPhysics::~SimbodyPhysics()
 {
+  std::lock_guard<std::mutex> lock(gSimbodySyncMutex);
+  gSimbodySync.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -683,34 +729,35 @@ void SimbodyPhysics::UpdatePhysics()
   //       << "]\n";
   // this->lastUpdateTime = currTime;
 
-  // pushing new entity pose into dirtyPoses for visualization
-  physics::Model_V models = this->world->Models();
-  for (physics::Model_V::iterator mi = models.begin();
-       mi != models.end(); ++mi)
+  // pushing new entity pose into dirtyPoses for visualization, only for
+  // the links that moved
+  SimbodySync &sync = simbodySync(this);
+  sync.movedLinkCount = 0;
+  for (SimbodySyncedLink &synced : sync.links)
   {
-    physics::Link_V links = (*mi)->GetLinks();
-    for (physics::Link_V::iterator lx = links.begin();
-         lx != links.end(); ++lx)
-    {
-      physics::SimbodyLinkPtr simbodyLink =
-        boost::dynamic_pointer_cast<physics::SimbodyLink>(*lx);
-      auto pose = SimbodyPhysics::Transform2PoseIgn(
-        simbodyLink->masterMobod.getBodyTransform(s));
-      simbodyLink->SetDirtyPose(pose);
-      this->world->dataPtr->dirtyPoses.push_back(
-        boost::static_pointer_cast<Entity>(*lx).get());
-    }
+    if (synced.link->masterMobod.isEmptyHandle())
+      continue;
+
+    const SimTK::Transform &transform =
+      synced.link->masterMobod.getBodyTransform(s);
 
-    physics::Joint_V joints = (*mi)->GetJoints();
-    for (physics::Joint_V::iterator jx = joints.begin();
-         jx != joints.end(); ++jx)
+    // Exact comparison, static bodies keep the very same transform
+    if (synced.poseSynced && transform.p() == synced.transform.p() &&
+        transform.R().asMat33() == synced.transform.R().asMat33())
     {
-      SimbodyJointPtr simbodyJoint =
-        boost::dynamic_pointer_cast<physics::SimbodyJoint>(*jx);
-      simbodyJoint->CacheForceTorque();
+      continue;
     }
+
+    synced.transform = transform;
+    synced.poseSynced = true;
+    synced.link->SetDirtyPose(SimbodyPhysics::Transform2PoseIgn(transform));
+    this->world->dataPtr->dirtyPoses.push_back(synced.link);
+    ++sync.movedLinkCount;
   }
 
+  for (SimbodyJoint *joint : sync.joints)
+    joint->CacheForceTorque();
+
   // FIXME:  this needs to happen before forces are applied for the next step
   // FIXME:  but after we've gotten everything from current state
   this->discreteForces.clearAllForces(this->integ->updAdvancedState());
@@ -1616,6 +1663,71 @@ SimTK::Transform SimbodyPhysics::GetPose(sdf::ElementPtr _element)
   return Pose2Transform(pose);
 }
 
+/////////////////////////////////////////////////
+void SimbodyPhysics::AddSimbodyLink(SimbodyLink *_link)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  SimbodySync &sync = simbodySync(this);
+  for (const SimbodySyncedLink &synced : sync.links)
+  {
+    if (synced.link == _link)
+      return;
+  }
+
+  SimbodySyncedLink synced;
+  synced.link = _link;
+  synced.poseSynced = false;
+  sync.links.push_back(synced);
+}
+
+//////////////////////////////////////////////////
+void SimbodyPhysics::RemoveSimbodyLink(SimbodyLink *_link)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  SimbodySync &sync = simbodySync(this);
+  auto iter = std::find_if(sync.links.begin(), sync.links.end(),
+      [_link](const SimbodySyncedLink &_synced)
+      {
+        return _synced.link == _link;
+      });
+  if (iter != sync.links.end())
+    sync.links.erase(iter);
+}
+
+//////////////////////////////////////////////////
+void SimbodyPhysics::AddSimbodyJoint(SimbodyJoint *_joint)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  SimbodySync &sync = simbodySync(this);
+  if (std::find(sync.joints.begin(), sync.joints.end(), _joint) ==
+      sync.joints.end())
+  {
+    sync.joints.push_back(_joint);
+  }
+}
+
+//////////////////////////////////////////////////
+void SimbodyPhysics::RemoveSimbodyJoint(SimbodyJoint *_joint)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+  SimbodySync &sync = simbodySync(this);
+  auto iter = std::find(sync.joints.begin(), sync.joints.end(), _joint);
+  if (iter != sync.joints.end())
+    sync.joints.erase(iter);
+}
+
+//////////////////////////////////////////////////
+unsigned int SimbodyPhysics::SyncedLinkCount() const
+{
+  return simbodySync(this).links.size();
+}
+
+//////////////////////////////////////////////////
+unsigned int SimbodyPhysics::MovedLinkCount() const
+{
+  return simbodySync(this).movedLinkCount;
+}
+
 /////////////////////////////////////////////////
 std::string SimbodyPhysics::GetTypeString(unsigned int _type)
 {
@@ -150,6 +150,40 @@ namespace gazebo
       /// is more than one <pose> element, only the first one is processed.
       public: static SimTK::Transform GetPose(sdf::ElementPtr _element);
 
+      /// \internal
+      /// \brief Add a link whose pose is pushed to gazebo after each step.
+      /// Called by SimbodyLink::Init.
+      /// \param[in] _link The link.
+      public: void AddSimbodyLink(SimbodyLink *_link);
+
+      /// \internal
+      /// \brief Remove a link added with AddSimbodyLink.
+      /// \param[in] _link The link.
+      public: void RemoveSimbodyLink(SimbodyLink *_link);
+
+      /// \internal
+      /// \brief Add a joint whose forces are cached after each step.
+      /// Called by SimbodyJoint::Init.
+      /// \param[in] _joint The joint.
+      public: void AddSimbodyJoint(SimbodyJoint *_joint);
+
+      /// \internal
+      /// \brief Remove a joint added with AddSimbodyJoint.
+      /// \param[in] _joint The joint.
+      public: void RemoveSimbodyJoint(SimbodyJoint *_joint);
+
+      /// \internal
+      /// \brief Get the number of links whose poses are checked after
+      /// each step.
+      /// \return Number of links added with AddSimbodyLink.
+      public: unsigned int SyncedLinkCount() const;
+
+      /// \internal
+      /// \brief Get the number of links whose poses were pushed to gazebo
+      /// by the last step, because they moved.
+      /// \return Number of links pushed by the last step.
+      public: unsigned int MovedLinkCount() const;
+
       /// \brief Convert Base::GetType() to string,
       /// this is needed by the MultibodyGraphMaker.
       /// \param[in] _type Joint type returned by Joint::GetType().
@@ -15,8 +15,16 @@
  *
 */
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
 
 #include "gazebo/physics/Link.hh"
 #include "gazebo/physics/Model.hh"
@@ -46,6 +54,128 @@ boost::mutex g_sensorTimingMutex;
 /// max update rate needs to be recalculated
 bool g_sensorsDirty = true;
 
+// TODO added here for ABI compatibility
+// move to class when merging forward
+/// \brief Protects g_sensorUpdateThreads, g_sensorUpdateArena and
+/// g_sensorGroups.
+static std::mutex g_sensorUpdateMutex;
+
+/// \brief Number of threads used to update non-image sensors.
+static unsigned int g_sensorUpdateThreads = 0;
+
+/// \brief Thread pool shared by the sensor containers, null when sensors
+/// are updated serially. Containers hold a reference while they use it, so
+/// that it can be replaced at any time.
+static std::shared_ptr<tbb::task_arena> g_sensorUpdateArena;
+
+/// \brief Connection to the world created event, to load the number of
+/// threads from the world.
+static event::ConnectionPtr g_worldCreatedConnection;
+
+/// \brief Parallel update state of a sensor container.
+class SensorContainerGroups
+{
+  /// \brief The sensors of the container grouped by model, each group in
+  /// the order of the container. Image sensors are all in one group.
+  /// Protected by updateMutex.
+  public: std::vector<Sensor_V> groups;
+
+  /// \brief True when groups doesn't match the sensors of the container.
+  /// Protected by the mutex of the container.
+  public: bool dirty = true;
+
+  /// \brief Held during parallel updates, which release the mutex of the
+  /// container, so that sensors are not removed while they are updated.
+  /// Locked before the mutex of the container.
+  public: std::mutex updateMutex;
+};
+
+/// \brief Parallel update state of each sensor container, by container.
+/// Protected by g_sensorUpdateMutex.
+static std::map<const void *, std::unique_ptr<SensorContainerGroups>>
+    g_sensorGroups;
+
+/////////////////////////////////////////////////
+/// \brief Get the parallel update state of a sensor container.
+/// \param[in] _container The container.
+/// \return The state, created on first use and erased with the container.
+static SensorContainerGroups &sensorGroups(const void *_container)
+{
+  std::lock_guard<std::mutex> lock(g_sensorUpdateMutex);
+  std::unique_ptr<SensorContainerGroups> &state = g_sensorGroups[_container];
+  if (!state)
+    state.reset(new SensorContainerGroups());
+  return *state;
+}
+
+/////////////////////////////////////////////////
+/// \brief Group the sensors that are updated one after the other in
+/// parallel updates.
+/// \param[in] _sensors Sensors of a container.
+/// \param[out] _groups The groups.
+static void groupSensors(const Sensor_V &_sensors,
+    std::vector<Sensor_V> &_groups)
+{
+  _groups.clear();
+
+  // Sensors of one model may feed the same model plugin, they are kept in
+  // one group. Image sensors share the rendering engine.
+  std::map<std::string, size_t> groupIndices;
+  for (auto const &sensor : _sensors)
+  {
+    std::string key;
+    if (sensor->Category() != IMAGE)
+    {
+      std::string parentName = sensor->ParentName();
+      key = "model:" + parentName.substr(0, parentName.find("::"));
+    }
+
+    auto inserted = groupIndices.insert(
+        std::make_pair(key, _groups.size()));
+    if (inserted.second)
+      _groups.emplace_back();
+    _groups[inserted.first->second].push_back(sensor);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Load the number of threads used to update sensors from a world.
+/// The SDF specification has no element for it, so it is read from a custom
+/// element of <world>. The gzserver --sensor_update_threads flag is applied
+/// after loading and overrides it.
+/// \param[in] _worldName Name of the world.
+static void loadSensorUpdateThreads(const std::string &_worldName)
+{
+  if (!physics::has_world(_worldName))
+    return;
+
+  sdf::ElementPtr worldElem = physics::get_world(_worldName)->SDF();
+  if (!worldElem || !worldElem->HasElement("gazebo:sensor_update_threads"))
+    return;
+
+  std::string threads = worldElem->GetElement(
+      "gazebo:sensor_update_threads")->Get<std::string>();
+  int value = -1;
+  try
+  {
+    value = std::stoi(threads);
+  }
+  catch(...)
+  {
+  }
+
+  if (value >= 0)
+  {
+    SensorManager::Instance()->SetSensorUpdateThreads(
+        static_cast<unsigned int>(value));
+  }
+  else
+  {
+    gzerr << "Invalid <gazebo:sensor_update_threads> [" << threads
+          << "], sensors are updated serially\n";
+  }
+}
+
 /// Performance metrics variables
 /// \brief last sensor measurement sim time
 std::map<std::string, gazebo::common::Time> sensorsLastMeasurementTime;
@@ -442,6 +572,11 @@ void SensorManager::Init()
         std::placeholders::_1, std::placeholders::_2,
         std::placeholders::_3, std::placeholders::_4));
 
+  // Connect to the world created event, sensors are initialized before
+  // worlds are loaded.
+  g_worldCreatedConnection = event::Events::ConnectWorldCreated(
+      std::bind(&loadSensorUpdateThreads, std::placeholders::_1));
+
   this->initialized = true;
 }
 
@@ -463,6 +598,8 @@ void SensorManager::Fini()
   this->initSensors.clear();
   this->worlds.clear();
 
+  g_worldCreatedConnection.reset();
+
   delete this->simTimeEventHandler;
   this->simTimeEventHandler = nullptr;
 
@@ -637,6 +774,27 @@ void SensorManager::RemoveSensors()
   this->removeAllSensors = true;
 }
 
+//////////////////////////////////////////////////
+void SensorManager::SetSensorUpdateThreads(const unsigned int _threads)
+{
+  std::lock_guard<std::mutex> lock(g_sensorUpdateMutex);
+
+  g_sensorUpdateThreads = _threads;
+  g_sensorUpdateArena.reset();
+  if (_threads > 0)
+  {
+    g_sensorUpdateArena = std::make_shared<tbb::task_arena>(
+        static_cast<int>(_threads));
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int SensorManager::SensorUpdateThreads() const
+{
+  std::lock_guard<std::mutex> lock(g_sensorUpdateMutex);
+  return g_sensorUpdateThreads;
+}
+
 //////////////////////////////////////////////////
 SensorManager::SensorContainer::SensorContainer()
 {
@@ -649,6 +807,9 @@ SensorManager::SensorContainer::SensorContainer()
 SensorManager::SensorContainer::~SensorContainer()
 {
   this->sensors.clear();
+
+  std::lock_guard<std::mutex> lock(g_sensorUpdateMutex);
+  g_sensorGroups.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -668,6 +829,8 @@ void SensorManager::SensorContainer::Init()
 //////////////////////////////////////////////////
 void SensorManager::SensorContainer::Fini()
 {
+  SensorContainerGroups &state = sensorGroups(this);
+  std::lock_guard<std::mutex> updateLock(state.updateMutex);
   boost::recursive_mutex::scoped_lock lock(this->mutex);
 
   Sensor_V::iterator iter;
@@ -681,6 +844,8 @@ void SensorManager::SensorContainer::Fini()
 
   // Remove all the sensors from the current sensor vector.
   this->sensors.clear();
+  state.groups.clear();
+  state.dirty = true;
 
   this->initialized = false;
 }
@@ -850,6 +1015,69 @@ void SensorManager::SensorContainer::RunLoop()
 //////////////////////////////////////////////////
 void SensorManager::SensorContainer::Update(bool _force)
 {
+  std::shared_ptr<tbb::task_arena> arena;
+  {
+    std::lock_guard<std::mutex> arenaLock(g_sensorUpdateMutex);
+    arena = g_sensorUpdateArena;
+  }
+
+  if (arena)
+  {
+    SensorContainerGroups &state = sensorGroups(this);
+    std::lock_guard<std::mutex> updateLock(state.updateMutex);
+    {
+      boost::recursive_mutex::scoped_lock lock(this->mutex);
+      if (state.dirty)
+      {
+        groupSensors(this->sensors, state.groups);
+        state.dirty = false;
+      }
+    }
+
+    if (state.groups.size() > 1)
+    {
+      // Ray sensors run collision queries, which need the physics engine
+      // to be set up for the calling thread.
+      physics::PhysicsEnginePtr engine;
+      physics::WorldPtr world = physics::get_world();
+      if (world)
+        engine = world->Physics();
+
+      // The sensor mutex isn't held by the worker threads, sensors that
+      // look up other sensors while they update would otherwise block.
+      // Sensors that aren't due return from Sensor::Update at once. This
+      // returns once all the groups are updated, the run loop then waits
+      // for the next update time as in serial updates.
+      std::vector<Sensor_V> *groups = &state.groups;
+      arena->execute([groups, engine, _force]()
+      {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, groups->size(), 1),
+            [groups, engine, _force](const tbb::blocked_range<size_t> &_r)
+        {
+          // Worker threads outlive worlds, set up each new engine.
+          static thread_local boost::weak_ptr<physics::PhysicsEngine>
+              threadEngine;
+          if (engine && threadEngine.lock() != engine)
+          {
+            engine->InitForThread();
+            threadEngine = engine;
+          }
+
+          for (size_t i = _r.begin(); i != _r.end(); ++i)
+          {
+            for (auto &sensor : (*groups)[i])
+            {
+              IGN_PROFILE_BEGIN(sensor->Name().c_str());
+              sensor->Update(_force);
+              IGN_PROFILE_END();
+            }
+          }
+        });
+      });
+      return;
+    }
+  }
+
   boost::recursive_mutex::scoped_lock lock(this->mutex);
 
   if (this->sensors.empty())
@@ -901,6 +1129,7 @@ void SensorManager::SensorContainer::AddSensor(SensorPtr _sensor)
   {
     boost::recursive_mutex::scoped_lock lock(this->mutex);
     this->sensors.push_back(_sensor);
+    sensorGroups(this).dirty = true;
     g_sensorsDirty = true;
   }
 
@@ -911,6 +1140,8 @@ void SensorManager::SensorContainer::AddSensor(SensorPtr _sensor)
 //////////////////////////////////////////////////
 bool SensorManager::SensorContainer::RemoveSensor(const std::string &_name)
 {
+  SensorContainerGroups &state = sensorGroups(this);
+  std::lock_guard<std::mutex> updateLock(state.updateMutex);
   boost::recursive_mutex::scoped_lock lock(this->mutex);
 
   Sensor_V::iterator iter;
@@ -931,6 +1162,8 @@ bool SensorManager::SensorContainer::RemoveSensor(const std::string &_name)
     }
   }
 
+  state.groups.clear();
+  state.dirty = true;
   g_sensorsDirty = true;
 
   return removed;
@@ -957,6 +1190,8 @@ void SensorManager::SensorContainer::ResetLastUpdateTimes()
 //////////////////////////////////////////////////
 void SensorManager::SensorContainer::RemoveSensors()
 {
+  SensorContainerGroups &state = sensorGroups(this);
+  std::lock_guard<std::mutex> updateLock(state.updateMutex);
   boost::recursive_mutex::scoped_lock lock(this->mutex);
 
   Sensor_V::iterator iter;
@@ -971,6 +1206,8 @@ void SensorManager::SensorContainer::RemoveSensors()
   g_sensorsDirty = true;
 
   this->sensors.clear();
+  state.groups.clear();
+  state.dirty = true;
 }
 
 //////////////////////////////////////////////////
@@ -179,6 +179,22 @@ namespace gazebo
       /// \brief Reset last update times in all sensors.
       public: void ResetLastUpdateTimes();
 
+      /// \brief Set the number of threads used to update non-image sensors.
+      /// The sensors of different models are updated in parallel on a
+      /// persistent thread pool. The sensors of one model are updated one
+      /// after the other, in the order they were added. Each container
+      /// still waits for all its sensors before it sleeps until the next
+      /// update time. Image sensors are always updated serially. The number
+      /// of threads is loaded from the <gazebo:sensor_update_threads> element
+      /// of <world> when a world is created.
+      /// \param[in] _threads Number of threads. Zero, the default, updates
+      /// the sensors of each container serially.
+      public: void SetSensorUpdateThreads(const unsigned int _threads);
+
+      /// \brief Get the number of threads used to update non-image sensors.
+      /// \return Number of threads, zero if sensors are updated serially.
+      public: unsigned int SensorUpdateThreads() const;
+
       /// \brief Block until all sensors do not need current world tick
       /// \param[in] _clk simulated clock of the world
       /// \param[in] _dt world time step
@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
 #include "gazebo/physics/PhysicsIface.hh"
 #include "gazebo/common/Time.hh"
 #include "gazebo/test/ServerFixture.hh"
@@ -159,6 +162,132 @@ TEST_F(SensorManager_TEST, InitRemove)
   printf("Done done\n");
 }
 
+/////////////////////////////////////////////////
+/// \brief Test that sensors of different models are updated in parallel,
+/// and that they can be removed while they are.
+TEST_F(SensorManager_TEST, SensorUpdateThreads)
+{
+  Load("worlds/empty.world");
+  sensors::SensorManager *mgr = sensors::SensorManager::Instance();
+  EXPECT_EQ(0u, mgr->SensorUpdateThreads());
+
+  mgr->SetSensorUpdateThreads(4);
+  EXPECT_EQ(4u, mgr->SensorUpdateThreads());
+
+  const unsigned int modelCount = 6;
+  for (unsigned int i = 0; i < modelCount; ++i)
+  {
+    std::string index = std::to_string(i);
+    if (i % 2 == 0)
+    {
+      SpawnImuSensor("imu_model_" + index, "imu",
+          ignition::math::Vector3d(i, 0, 0.5));
+    }
+    else
+    {
+      SpawnRaySensor("ray_model_" + index, "ray",
+          ignition::math::Vector3d(i, 0, 0.5));
+    }
+  }
+
+  std::vector<std::string> sensorNames;
+  for (unsigned int i = 0; i < modelCount; ++i)
+  {
+    std::string index = std::to_string(i);
+    sensorNames.push_back(i % 2 == 0 ?
+        "default::imu_model_" + index + "::body::imu" :
+        "default::ray_model_" + index + "::body::ray");
+  }
+
+  int i = 0;
+  while (mgr->GetSensors().size() < modelCount && i < 100)
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 100);
+
+  // Every sensor is updated.
+  common::Time time = physics::get_world()->SimTime();
+  common::Time::MSleep(1000);
+  for (auto const &name : sensorNames)
+  {
+    sensors::SensorPtr sensor = mgr->GetSensor(name);
+    ASSERT_TRUE(sensor != nullptr) << name;
+    EXPECT_GT(sensor->LastUpdateTime(), time) << name;
+  }
+
+  // Remove a sensor while the others are updated.
+  mgr->RemoveSensor(sensorNames.front());
+  i = 0;
+  while (mgr->GetSensors().size() >= modelCount && i < 100)
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 100);
+
+  // The remaining sensors are still updated, then serially again.
+  for (unsigned int threads : {4u, 0u})
+  {
+    mgr->SetSensorUpdateThreads(threads);
+    EXPECT_EQ(threads, mgr->SensorUpdateThreads());
+
+    time = physics::get_world()->SimTime();
+    common::Time::MSleep(1000);
+    for (size_t j = 1; j < sensorNames.size(); ++j)
+    {
+      sensors::SensorPtr sensor = mgr->GetSensor(sensorNames[j]);
+      ASSERT_TRUE(sensor != nullptr) << sensorNames[j];
+      EXPECT_GT(sensor->LastUpdateTime(), time) << sensorNames[j];
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Test that the number of threads is loaded from the world, and
+/// that the gzserver flag overrides it.
+TEST_F(SensorManager_TEST, SensorUpdateThreadsFromWorld)
+{
+  sensors::SensorManager *mgr = sensors::SensorManager::Instance();
+  mgr->SetSensorUpdateThreads(0);
+
+  Load("test/worlds/sensor_update_threads.world");
+  EXPECT_EQ(3u, mgr->SensorUpdateThreads());
+
+  // Sensors are updated on the threads.
+  SpawnImuSensor("imu_model", "imu", ignition::math::Vector3d(0, 0, 0.5));
+  int i = 0;
+  while (mgr->GetSensors().empty() && i < 100)
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 100);
+
+  common::Time time = physics::get_world()->SimTime();
+  common::Time::MSleep(1000);
+  sensors::SensorPtr sensor =
+    mgr->GetSensor("default::imu_model::body::imu");
+  ASSERT_TRUE(sensor != nullptr);
+  EXPECT_GT(sensor->LastUpdateTime(), time);
+
+  mgr->SetSensorUpdateThreads(0);
+}
+
+/////////////////////////////////////////////////
+TEST_F(SensorManager_TEST, SensorUpdateThreadsFlag)
+{
+  sensors::SensorManager *mgr = sensors::SensorManager::Instance();
+  mgr->SetSensorUpdateThreads(0);
+
+  LoadArgs(" --sensor_update_threads 1 "
+      "test/worlds/sensor_update_threads.world");
+  EXPECT_EQ(1u, mgr->SensorUpdateThreads());
+
+  mgr->SetSensorUpdateThreads(0);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
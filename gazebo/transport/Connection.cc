@@ -48,6 +48,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <array>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -65,6 +68,9 @@ using namespace transport;
 
 extern void dummy_callback_fn(uint32_t);
 
+/// \brief Small messages are coalesced into write buffers of this size.
+static const std::size_t kCoalesceSize = 4096;
+
 unsigned int Connection::idCounter = 0;
 IOManager *Connection::iomanager = NULL;
 
@@ -89,6 +95,11 @@ Connection::Connection()
 {
   this->isOpen = false;
   this->dropMsgLogged = false;
+  this->binaryWrite = false;
+  this->binaryRead = false;
+  this->writeTopicId = 0;
+  this->readTopicId = 0;
+  this->topicIdMismatchLogged = false;
 
   if (iomanager == NULL)
     iomanager = new IOManager();
@@ -100,6 +111,7 @@ Connection::Connection()
 
   this->acceptor = NULL;
   this->readQuit = false;
+  this->readLoopRunning = false;
   this->connectError = false;
   this->writeQueue.clear();
   this->writeCount = 0;
@@ -275,9 +287,19 @@ void Connection::OnAccept(const boost::system::error_code &e)
 }
 
 //////////////////////////////////////////////////
-void Connection::StartRead(const ReadCallback & /*_cb*/)
+void Connection::StartRead(const ReadCallback &_cb)
 {
-  gzerr << "\n\n\n\n DONT USE \n\n\n\n";
+  {
+    boost::recursive_mutex::scoped_lock lock(this->readMutex);
+    this->readCallback = _cb;
+  }
+  this->readQuit = false;
+
+  // A loop that is still running picks up the new callback.
+  if (this->readLoopRunning.exchange(true))
+    return;
+
+  this->ReadLoopHeader();
 }
 
 //////////////////////////////////////////////////
@@ -286,6 +308,88 @@ void Connection::StopRead()
   this->readQuit = true;
 }
 
+//////////////////////////////////////////////////
+void Connection::ReadLoopHeader()
+{
+  if (this->readQuit)
+  {
+    // Release the loop. If StartRead was called in the meantime, either it
+    // or this function restarts the loop, never both.
+    this->readLoopRunning = false;
+    if (this->readQuit || this->readLoopRunning.exchange(true))
+      return;
+  }
+
+  boost::mutex::scoped_lock lock(this->socketMutex);
+  if (!this->IsOpen())
+  {
+    this->readLoopRunning = false;
+    return;
+  }
+
+  boost::asio::async_read(*this->socket,
+      boost::asio::buffer(this->readHeader),
+      common::weakBind(&Connection::OnReadLoopHeader,
+        this->shared_from_this(), boost::asio::placeholders::error));
+}
+
+//////////////////////////////////////////////////
+void Connection::OnReadLoopHeader(const boost::system::error_code &_e)
+{
+  if (_e)
+  {
+    if (_e.value() == boost::asio::error::eof)
+      this->isOpen = false;
+    this->readLoopRunning = false;
+    return;
+  }
+
+  std::size_t size = this->ParseFrameHeader(this->readHeader);
+  if (size == 0)
+  {
+    gzerr << "Header is empty\n";
+    this->ReadLoopHeader();
+    return;
+  }
+
+  // Resizing keeps the capacity of the buffer, so only messages larger
+  // than any previous one allocate.
+  this->readBuffer.resize(size);
+
+  boost::mutex::scoped_lock lock(this->socketMutex);
+  if (!this->IsOpen())
+  {
+    this->readLoopRunning = false;
+    return;
+  }
+
+  boost::asio::async_read(*this->socket,
+      boost::asio::buffer(&this->readBuffer[0], size),
+      common::weakBind(&Connection::OnReadLoopData,
+        this->shared_from_this(), boost::asio::placeholders::error));
+}
+
+//////////////////////////////////////////////////
+void Connection::OnReadLoopData(const boost::system::error_code &_e)
+{
+  if (_e)
+  {
+    if (_e.value() == boost::asio::error::eof)
+      this->isOpen = false;
+    this->readLoopRunning = false;
+    return;
+  }
+
+  if (!this->readQuit && !transport::is_stopped())
+  {
+    boost::recursive_mutex::scoped_lock lock(this->readMutex);
+    if (this->readCallback)
+      this->readCallback(this->readBuffer);
+  }
+
+  this->ReadLoopHeader();
+}
+
 //////////////////////////////////////////////////
 void Connection::EnqueueMsg(const std::string &_buffer, bool _force)
 {
@@ -302,26 +406,73 @@ void Connection::EnqueueMsg(const std::string &_buffer,
     return;
   }
 
-  char headerBuffer[HEADER_LENGTH + 1];
-  snprintf(headerBuffer, HEADER_LENGTH + 1, "%08x",
-      static_cast<unsigned int>(_buffer.size()));
+  // Large messages are not worth coalescing. Copy them once into a shared
+  // buffer, which is then written without being copied again.
+  if (HEADER_LENGTH + _buffer.size() > kCoalesceSize)
+  {
+    this->EnqueueMsg(boost::shared_ptr<const std::string>(
+          new std::string(_buffer)), _cb, _id, _force);
+    return;
+  }
+
+  char header[HEADER_LENGTH];
+  this->WriteFrameHeader(_buffer.size(), header);
 
   {
     boost::recursive_mutex::scoped_lock lock(this->writeMutex);
 
     if (this->writeQueue.empty() ||
         (this->writeCount > 0 && this->writeQueue.size() == 1) ||
-        (this->writeQueue.back().size() + HEADER_LENGTH + _buffer.size() >
-         4096))
+        this->writeQueue.back().payload ||
+        (this->writeQueue.back().head.size() + HEADER_LENGTH + _buffer.size() >
+         kCoalesceSize))
     {
-      this->writeQueue.push_back(std::string(headerBuffer) + _buffer);
+      this->writeQueue.push_back(WriteBuffer());
       this->callbacks.push_back({std::make_pair(_cb, _id)});
     }
     else
     {
-      this->writeQueue.back() += std::string(headerBuffer) + _buffer;
       this->callbacks.back().push_back(std::make_pair(_cb, _id));
     }
+
+    std::string &head = this->writeQueue.back().head;
+    head.append(header, HEADER_LENGTH);
+    head.append(_buffer);
+  }
+
+  if (_force)
+  {
+    this->ProcessWriteQueue();
+  }
+  else
+  {
+    // Tell the connection manager that it needs to update
+    ConnectionManager::Instance()->TriggerUpdate();
+  }
+}
+
+//////////////////////////////////////////////////
+void Connection::EnqueueMsg(
+    const boost::shared_ptr<const std::string> &_buffer,
+    boost::function<void(uint32_t)> _cb, uint32_t _id, bool _force)
+{
+  // Don't enqueue empty messages
+  if (!_buffer || _buffer->empty() || !this->IsOpen())
+  {
+    return;
+  }
+
+  char header[HEADER_LENGTH];
+  this->WriteFrameHeader(_buffer->size(), header);
+
+  {
+    boost::recursive_mutex::scoped_lock lock(this->writeMutex);
+
+    WriteBuffer buffer;
+    buffer.head.assign(header, HEADER_LENGTH);
+    buffer.payload = _buffer;
+    this->writeQueue.push_back(buffer);
+    this->callbacks.push_back({std::make_pair(_cb, _id)});
   }
 
   if (_force)
@@ -335,6 +486,83 @@ void Connection::EnqueueMsg(const std::string &_buffer,
   }
 }
 
+//////////////////////////////////////////////////
+void Connection::SetBinaryWrite(uint32_t _topicId)
+{
+  this->writeTopicId = _topicId;
+  this->binaryWrite = true;
+}
+
+//////////////////////////////////////////////////
+void Connection::SetBinaryRead(uint32_t _topicId)
+{
+  this->readTopicId = _topicId;
+  this->binaryRead = true;
+}
+
+//////////////////////////////////////////////////
+uint32_t Connection::TopicId(const std::string &_topic,
+    const std::string &_msgType)
+{
+  // 32 bit FNV-1a of "topic:type"
+  uint32_t hash = 2166136261u;
+  const std::string key = _topic + ":" + _msgType;
+  for (const char c : key)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//////////////////////////////////////////////////
+void Connection::WriteFrameHeader(std::size_t _size, char *_header) const
+{
+  if (this->binaryWrite)
+  {
+    uint32_t size = static_cast<uint32_t>(_size);
+    for (int i = 0; i < 4; ++i)
+    {
+      _header[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+      _header[4 + i] =
+          static_cast<char>((this->writeTopicId >> (8 * i)) & 0xFF);
+    }
+  }
+  else
+  {
+    char headerBuffer[HEADER_LENGTH + 1];
+    snprintf(headerBuffer, HEADER_LENGTH + 1, "%08x",
+        static_cast<unsigned int>(_size));
+    memcpy(_header, headerBuffer, HEADER_LENGTH);
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t Connection::ParseFrameHeader(const char *_header)
+{
+  if (!this->binaryRead)
+    return ParseHeader(_header, HEADER_LENGTH);
+
+  const unsigned char *header = reinterpret_cast<const unsigned char *>(
+      _header);
+  uint32_t size = 0;
+  uint32_t topicId = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    size |= static_cast<uint32_t>(header[i]) << (8 * i);
+    topicId |= static_cast<uint32_t>(header[4 + i]) << (8 * i);
+  }
+
+  if (topicId != this->readTopicId && !this->topicIdMismatchLogged)
+  {
+    gzerr << "Connection[" << this->id << "] received topic id[" << topicId
+          << "], expected[" << this->readTopicId << "]\n";
+    this->topicIdMismatchLogged = true;
+  }
+
+  return size;
+}
+
 /////////////////////////////////////////////////
 void Connection::ProcessWriteQueue(bool _blocking)
 {
@@ -354,14 +582,17 @@ void Connection::ProcessWriteQueue(bool _blocking)
 
   this->writeCount++;
 
-  // Write the serialized data to the socket. We use
-  // "gather-write" to send both the head and the data in
-  // a single write operation
+  // Write the header and the data in a single "gather-write". The buffers
+  // stay in the queue until PostWrite, so they outlive the write.
+  const WriteBuffer &front = this->writeQueue.front();
+  std::array<boost::asio::const_buffer, 2> buffers = {{
+    boost::asio::buffer(front.head),
+    front.payload ? boost::asio::buffer(*front.payload) :
+        boost::asio::const_buffer()}};
+
   if (!_blocking)
   {
-    boost::asio::async_write(*this->socket,
-        boost::asio::buffer(this->writeQueue.front().c_str(),
-          this->writeQueue.front().size()),
+    boost::asio::async_write(*this->socket, buffers,
           common::weakBind(&Connection::OnWrite, this->shared_from_this(),
             boost::asio::placeholders::error));
   }
@@ -369,9 +600,7 @@ void Connection::ProcessWriteQueue(bool _blocking)
   {
     try
     {
-      boost::asio::write(*this->socket,
-          boost::asio::buffer(this->writeQueue.front().c_str(),
-            this->writeQueue.front().size()));
+      boost::asio::write(*this->socket, buffers);
     }
     catch(...)
     {
@@ -425,6 +654,12 @@ void Connection::OnWrite(const boost::system::error_code &_e)
     // It will reach this point if the remote connection disconnects.
     this->Shutdown();
   }
+  else
+  {
+    // Send whatever was queued during this write right away, instead of
+    // waiting for the ConnectionManager to come around.
+    this->ProcessWriteQueue();
+  }
 }
 
 //////////////////////////////////////////////////
@@ -527,19 +762,15 @@ void Connection::Cancel()
 }
 
 //////////////////////////////////////////////////
-bool Connection::Read(std::string &data)
+bool Connection::Read(std::string &_data)
 {
-  bool result = false;
   char header[HEADER_LENGTH];
-  std::vector<char> incoming;
-
-  std::size_t incoming_size;
   boost::system::error_code error;
 
   boost::recursive_mutex::scoped_lock lock(this->readMutex);
 
   // First read the header
-  this->socket->read_some(boost::asio::buffer(header), error);
+  boost::asio::read(*this->socket, boost::asio::buffer(header), error);
 
   if (error)
   {
@@ -548,33 +779,19 @@ bool Connection::Read(std::string &data)
   }
 
   // Parse the header to get the size of the incoming data packet
-  incoming_size = this->ParseHeader(std::string(header, HEADER_LENGTH));
-  if (incoming_size > 0)
-  {
-    incoming.resize(incoming_size);
-
-    std::size_t len = 0;
-    do
-    {
-      // Read in the actual data
-      len += this->socket->read_some(boost::asio::buffer(&incoming[len],
-            incoming_size - len), error);
-    } while (len < incoming_size && !error && !this->readQuit);
-
-    if (len != incoming_size)
-    {
-      gzerr << "Did not read everying. Read[" << len
-        << "] Needed[" << incoming_size << "]\n";
-    }
+  std::size_t incomingSize = this->ParseFrameHeader(header);
+  if (incomingSize == 0)
+    return false;
 
-    if (error)
-      throw boost::system::system_error(error);
+  // Read the data straight into the destination, reusing its capacity
+  _data.resize(incomingSize);
+  boost::asio::read(*this->socket,
+      boost::asio::buffer(&_data[0], incomingSize), error);
 
-    data = std::string(&incoming[0], incoming.size());
-    result = true;
-  }
+  if (error)
+    throw boost::system::system_error(error);
 
-  return result;
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -627,49 +844,31 @@ unsigned int Connection::GetRemotePort() const
 
 
 //////////////////////////////////////////////////
-std::size_t Connection::ParseHeader(const std::string &header)
-{
-  std::size_t data_size = 0;
-  std::istringstream is(header);
-
-  if (!(is >> std::hex >> data_size))
-  {
-    // Header doesn't seem to be valid. Inform the caller
-    boost::system::error_code error(boost::asio::error::invalid_argument);
-  }
-
-  return data_size;
-}
-
-//////////////////////////////////////////////////
-void Connection::ReadLoop(const ReadCallback &cb)
+std::size_t Connection::ParseHeader(const char *_header, std::size_t _size)
 {
-  std::string data;
-
-  this->readQuit = false;
-  while (!this->readQuit)
+  // The header is the size of the packet as zero padded hex, see
+  // EnqueueMsg. Parse it by hand, this runs for every incoming message.
+  std::size_t i = 0;
+  while (i < _size && _header[i] == ' ')
+    ++i;
+
+  std::size_t dataSize = 0;
+  for (; i < _size; ++i)
   {
-    try
-    {
-      if (this->socket->available() >= HEADER_LENGTH)
-      {
-        if (this->Read(data))
-        {
-          (cb)(data);
-        }
-      }
-      else
-      {
-        common::Time::MSleep(10);
-        continue;
-      }
-    }
-    catch(std::exception &e)
-    {
-      // The connection closed
+    char c = _header[i];
+    std::size_t digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else
       break;
-    }
+    dataSize = dataSize * 16 + digit;
   }
+
+  return dataSize;
 }
 
 //////////////////////////////////////////////////
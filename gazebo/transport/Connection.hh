@@ -23,9 +23,11 @@
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -125,12 +127,20 @@ namespace gazebo
       /// \brief The signature of a connection read callback
       typedef boost::function<void(const std::string &_data)> ReadCallback;
 
-      /// \brief Start a thread that reads from the connection and passes
-      ///        new message to the ReadCallback
+      /// \brief Start reading every message from the connection and pass
+      /// each one to the ReadCallback.
+      ///
+      /// Reads are driven by the IOManager io_service: the header and then
+      /// the body are read asynchronously into buffers that are reused from
+      /// one message to the next, and the next read is issued as soon as
+      /// the callback returns. Nothing polls or sleeps, so a message is
+      /// delivered as soon as it arrives. The callback runs on the io
+      /// thread, so it must not block, and its data argument is only valid
+      /// for the duration of the call.
       /// \param[in] _cb The callback to invoke when a new message is received
       public: void StartRead(const ReadCallback &_cb);
 
-      /// \brief Stop the read loop
+      /// \brief Stop the read loop started by StartRead
       public: void StopRead();
 
       /// \brief Shutdown the socket
@@ -168,6 +178,43 @@ namespace gazebo
       /// to the socket, otherwise just enqueue the data for asynchronous write
       public: void EnqueueMsg(const std::string &_buffer, bool _force = false);
 
+      /// \brief Write shared data to the socket. The data is written
+      /// directly from _buffer, together with its header, in a single
+      /// gather-write, so it is never copied. This is the preferred way to
+      /// send large messages, or the same message on several connections.
+      /// \param[in] _buffer Data to write. It must not be modified
+      /// afterwards.
+      /// \param[in] _cb If non-null, callback to be invoked after
+      /// transmission is complete.
+      /// \param[in] _id ID associated with the message data.
+      /// \param[in] _force If true, block until the data has been written
+      /// to the socket, otherwise just enqueue the data for asynchronous write
+      public: void EnqueueMsg(
+                  const boost::shared_ptr<const std::string> &_buffer,
+                  boost::function<void(uint32_t)> _cb, uint32_t _id,
+                  bool _force = false);
+
+      /// \brief Use binary framing for all messages written from now on.
+      /// Each message is then preceded by its size and a topic id, both as
+      /// 32 bit little endian integers, instead of its size as 8 hex
+      /// characters. Only call this once the remote end agreed to binary
+      /// framing, see msgs::Subscribe::binary_framing.
+      /// \param[in] _topicId Topic id to write in each header.
+      /// \sa TopicId()
+      public: void SetBinaryWrite(uint32_t _topicId);
+
+      /// \brief Expect binary framing for all messages read from now on.
+      /// \param[in] _topicId Topic id the incoming headers should carry.
+      /// \sa SetBinaryWrite()
+      public: void SetBinaryRead(uint32_t _topicId);
+
+      /// \brief Get the id of a topic, as written in binary frame headers.
+      /// \param[in] _topic Name of the topic.
+      /// \param[in] _msgType Type of the messages on the topic.
+      /// \return Id of the topic.
+      public: static uint32_t TopicId(const std::string &_topic,
+                  const std::string &_msgType);
+
       /// \brief Get the local URI
       /// \return The local URI
       public: std::string GetLocalURI() const;
@@ -241,13 +288,10 @@ namespace gazebo
                 }
                 else
                 {
-                  std::size_t inboundData_size = 0;
-                  std::string header(&this->inboundHeader[0],
-                                      this->inboundHeader.size());
+                  std::size_t inboundData_size =
+                      this->ParseFrameHeader(&this->inboundHeader[0]);
                   this->inboundHeader.clear();
 
-                  inboundData_size = this->ParseHeader(header);
-
                  if (inboundData_size > 0)
                   {
                     // Start the asynchronous call to receive data
@@ -356,12 +400,35 @@ namespace gazebo
       /// \param[in] _e Error code for accept method
       private: void OnAccept(const boost::system::error_code &_e);
 
-      /// \brief Parse a header to get the size of a packet
-      /// \param[in] _header Header as a string
-      private: std::size_t ParseHeader(const std::string &_header);
+      /// \brief Parse a header to get the size of a packet, without
+      /// allocating.
+      /// \param[in] _header Header characters
+      /// \param[in] _size Number of characters in _header
+      /// \return Size of the packet, or zero if the header is invalid
+      private: static std::size_t ParseHeader(const char *_header,
+                   std::size_t _size);
+
+      /// \brief Parse a message header according to the read framing.
+      /// \param[in] _header HEADER_LENGTH header characters
+      /// \return Size of the message, or zero if the header is invalid
+      private: std::size_t ParseFrameHeader(const char *_header);
+
+      /// \brief Write a message header according to the write framing.
+      /// \param[in] _size Size of the message.
+      /// \param[out] _header HEADER_LENGTH characters of header
+      private: void WriteFrameHeader(std::size_t _size, char *_header) const;
+
+      /// \brief Issue the asynchronous read of the next message header for
+      /// the read loop started by StartRead.
+      private: void ReadLoopHeader();
+
+      /// \brief Handle a completed header read of the read loop.
+      /// \param[in] _e Error code, if any, associated with the read
+      private: void OnReadLoopHeader(const boost::system::error_code &_e);
 
-      /// \brief the read thread
-      private: void ReadLoop(const ReadCallback &_cb);
+      /// \brief Handle a completed body read of the read loop.
+      /// \param[in] _e Error code, if any, associated with the read
+      private: void OnReadLoopData(const boost::system::error_code &_e);
 
       /// \brief Get the local endpoint
       /// \return The endpoint
@@ -388,8 +455,20 @@ namespace gazebo
       /// \brief Accepts new connections.
       private: boost::asio::ip::tcp::acceptor *acceptor;
 
+      /// \brief Outgoing data, as written by one gather-write.
+      private: struct WriteBuffer
+               {
+                 /// \brief Frames of small messages that were coalesced,
+                 /// or the header of payload.
+                 std::string head;
+
+                 /// \brief Large message written right after head, without
+                 /// copying it. May be null.
+                 boost::shared_ptr<const std::string> payload;
+               };
+
       /// \brief Outgoing data queue
-      private: std::deque<std::string> writeQueue;
+      private: std::deque<WriteBuffer> writeQueue;
 
       /// \brief List of callbacks, paired with writeQueue. The callbacks
       /// are used to notify a publisher when a message is successfully sent.
@@ -422,7 +501,21 @@ namespace gazebo
       private: std::vector<char> inboundData;
 
       /// \brief Set to true to stop reading on the connection.
-      private: bool readQuit;
+      private: std::atomic<bool> readQuit;
+
+      /// \brief True while the read loop started by StartRead has a read
+      /// in flight.
+      private: std::atomic<bool> readLoopRunning;
+
+      /// \brief Callback of the read loop started by StartRead.
+      private: ReadCallback readCallback;
+
+      /// \brief Header buffer of the read loop.
+      private: char readHeader[HEADER_LENGTH];
+
+      /// \brief Body buffer of the read loop. It keeps its capacity from one
+      /// message to the next, so steady-state reads don't allocate.
+      private: std::string readBuffer;
 
       /// \brief Integer id of the connection.
       private: unsigned int id;
@@ -465,6 +558,21 @@ namespace gazebo
 
       /// \brief True if the connection is open.
       private: bool isOpen;
+
+      /// \brief True if messages are written with binary framing.
+      private: std::atomic<bool> binaryWrite;
+
+      /// \brief True if messages are read with binary framing.
+      private: std::atomic<bool> binaryRead;
+
+      /// \brief Topic id written in binary frame headers.
+      private: uint32_t writeTopicId;
+
+      /// \brief Topic id expected in binary frame headers.
+      private: uint32_t readTopicId;
+
+      /// \brief Used to report a topic id mismatch only once.
+      private: bool topicIdMismatchLogged;
     };
     /// \}
   }
@@ -21,6 +21,7 @@
 #include "gazebo/common/Events.hh"
 #include "gazebo/transport/TopicManager.hh"
 #include "gazebo/transport/ConnectionManager.hh"
+#include "gazebo/transport/ShmRing.hh"
 
 #include "gazebo/gazebo_config.h"
 
@@ -478,11 +479,24 @@ void ConnectionManager::OnRead(ConnectionPtr _connection,
     msgs::Subscribe sub;
     sub.ParseFromString(packet.serialized_data());
 
+    // Switch to binary framing if the subscriber asked for it. Old
+    // subscribers don't know the field and keep the hex framing.
+    if (sub.binary_framing())
+    {
+      _connection->SetBinaryWrite(
+          Connection::TopicId(sub.topic(), sub.msg_type()));
+    }
+
     // Create a transport link for the publisher to the remote subscriber
     // via the connection
     SubscriptionTransportPtr subLink(new SubscriptionTransport());
     subLink->Init(_connection, sub.latching());
 
+    // Write the data to the shared memory ring of the subscriber, if it
+    // sent one and the ring is reachable from this process.
+    if (sub.has_shm_name())
+      subLink->OpenSharedMemory(sub.shm_name());
+
     // Connect the publisher to this transport mechanism
     TopicManager::Instance()->ConnectPubToSub(sub.topic(), subLink);
   }
@@ -502,6 +516,11 @@ void ConnectionManager::Advertise(const std::string &topic,
   msg.set_msg_type(msgType);
   msg.set_host(this->serverConn->GetLocalAddress());
   msg.set_port(this->serverConn->GetLocalPort());
+  msg.set_binary_framing(true);
+
+  // Subscribers on this host may ask for a shared memory ring.
+  if (ShmRing::Enabled())
+    msg.set_shm_host(ShmRing::HostId());
 
   this->masterConn->EnqueueMsg(msgs::Package("advertise", msg));
 }
@@ -16,7 +16,11 @@
 */
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <stdlib.h>
 
 #include "gazebo/transport/Connection.hh"
@@ -64,8 +68,111 @@ TEST_F(Connection, IPWhiteList)
     setenv("GAZEBO_IP_WHITE_LIST", ipEnv, 1);
 }
 
+/////////////////////////////////////////////////
+// Send messages in both framings, and make sure they arrive unchanged.
+void CheckFraming(bool _binary)
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  transport::ConnectionPtr accepted;
+  std::vector<std::string> received;
+
+  transport::ConnectionPtr server(new transport::Connection());
+  server->Listen(0, [&](const transport::ConnectionPtr &_conn)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        accepted = _conn;
+        cond.notify_all();
+      });
+
+  transport::ConnectionPtr client(new transport::Connection());
+  ASSERT_TRUE(client->Connect("127.0.0.1", server->GetLocalPort()));
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(10),
+          [&] { return accepted != nullptr; }));
+  }
+
+  uint32_t topicId = transport::Connection::TopicId("/gazebo/default/pose",
+      "gazebo.msgs.Pose");
+  if (_binary)
+  {
+    accepted->SetBinaryWrite(topicId);
+    client->SetBinaryRead(topicId);
+  }
+
+  client->StartRead([&](const std::string &_data)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(_data);
+        cond.notify_all();
+      });
+
+  // Small messages are coalesced, large ones are written without a copy.
+  std::vector<std::string> sent;
+  sent.push_back("small");
+  sent.push_back(std::string(6 * 1024 * 1024, 'i'));
+  sent.push_back(std::string(300, 's'));
+  sent.push_back(std::string(5000, 'l'));
+  sent.push_back(std::string(1, '\0'));
+
+  for (size_t i = 0; i < sent.size(); ++i)
+  {
+    if (i == 3)
+    {
+      accepted->EnqueueMsg(boost::shared_ptr<const std::string>(
+            new std::string(sent[i])), boost::function<void(uint32_t)>(), 0,
+            true);
+    }
+    else
+      accepted->EnqueueMsg(sent[i], true);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(10),
+          [&] { return received.size() == sent.size(); }));
+  }
+
+  EXPECT_EQ(sent, received);
+
+  client->StopRead();
+  client->Shutdown();
+  accepted->Shutdown();
+  server->Shutdown();
+}
+
+/////////////////////////////////////////////////
+TEST_F(Connection, HexFraming)
+{
+  CheckFraming(false);
+}
+
+/////////////////////////////////////////////////
+TEST_F(Connection, BinaryFraming)
+{
+  CheckFraming(true);
+}
+
+/////////////////////////////////////////////////
+TEST_F(Connection, TopicId)
+{
+  EXPECT_EQ(transport::Connection::TopicId("~/pose", "gazebo.msgs.Pose"),
+      transport::Connection::TopicId("~/pose", "gazebo.msgs.Pose"));
+  EXPECT_NE(transport::Connection::TopicId("~/pose", "gazebo.msgs.Pose"),
+      transport::Connection::TopicId("~/pose", "gazebo.msgs.Vector3d"));
+  EXPECT_NE(transport::Connection::TopicId("~/pose", "gazebo.msgs.Pose"),
+      transport::Connection::TopicId("~/poses", "gazebo.msgs.Pose"));
+}
+
 int main(int argc, char **argv)
 {
+  // Keep the IOManager alive for all tests. Otherwise the last connection
+  // of a test may be released by a handler on the io thread, which would
+  // then try to join itself.
+  transport::ConnectionPtr ioKeeper(new transport::Connection());
+
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
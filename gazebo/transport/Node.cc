@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/bind.hpp>
 #include "gazebo/transport/TransportIface.hh"
@@ -63,9 +64,12 @@ void Node::Fini()
     this->publishers.clear();
   }
 
+  // Destroy the callbacks outside of the lock, since a queued callback
+  // waits for its executor to finish a running callback.
+  Callback_M oldCallbacks;
   {
     boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
-    this->callbacks.clear();
+    this->callbacks.swap(oldCallbacks);
   }
 }
 
@@ -221,6 +225,10 @@ void Node::ProcessIncoming()
   Callback_M::iterator cbIter;
   Callback_L::iterator liter;
 
+  // Queued callbacks which run on this thread, drained once all the
+  // incoming messages are queued.
+  std::vector<QueuedCallbackHelperPtr> queued;
+
   // For each topic
   {
     std::list<std::string>::iterator msgIter;
@@ -254,6 +262,8 @@ void Node::ProcessIncoming()
                 boost::bind(&dummy_callback_fn, _1), 0);
           }
         }
+
+        this->AppendConnectionThreadQueues(cbIter->second, queued);
       }
     }
 
@@ -291,11 +301,16 @@ void Node::ProcessIncoming()
             (*liter)->HandleMessage(*msgIter);
           }
         }
+
+        this->AppendConnectionThreadQueues(cbIter->second, queued);
       }
     }
 
     this->incomingMsgsLocal.clear();
   }
+
+  for (auto &queue : queued)
+    queue->ProcessQueue();
 }
 
 //////////////////////////////////////////////////
@@ -316,6 +331,13 @@ void Node::InsertLatchedMsg(const std::string &_topic, const std::string &_msg)
         (*liter)->SetLatching(false);
       }
     }
+
+    // Queues run on this thread are otherwise drained on the next incoming
+    // message only.
+    std::vector<QueuedCallbackHelperPtr> queued;
+    this->AppendConnectionThreadQueues(cbIter->second, queued);
+    for (auto &queue : queued)
+      queue->ProcessQueue();
   }
 }
 
@@ -337,6 +359,13 @@ void Node::InsertLatchedMsg(const std::string &_topic, MessagePtr _msg)
         (*liter)->SetLatching(false);
       }
     }
+
+    // Queues run on this thread are otherwise drained on the next incoming
+    // message only.
+    std::vector<QueuedCallbackHelperPtr> queued;
+    this->AppendConnectionThreadQueues(cbIter->second, queued);
+    for (auto &queue : queued)
+      queue->ProcessQueue();
   }
 }
 
@@ -366,6 +395,10 @@ void Node::RemoveCallback(const std::string &_topic, unsigned int _id)
   if (!this->initialized)
     return;
 
+  // Destroyed outside of the lock, since a queued callback waits for its
+  // executor to finish a running callback.
+  CallbackHelperPtr removed;
+
   boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
 
   // Find the topic list in the map.
@@ -380,10 +413,70 @@ void Node::RemoveCallback(const std::string &_topic, unsigned int _id)
     {
       if ((*liter)->GetId() == _id)
       {
-        (*liter).reset();
+        removed.swap(*liter);
         iter->second.erase(liter);
         break;
       }
     }
   }
 }
+
+/////////////////////////////////////////////////
+SubscriberPtr Node::AddSubscription(const SubscribeOptions &_ops,
+                                    CallbackHelperPtr _callback)
+{
+  if (_ops.IsQueued())
+    _callback.reset(new QueuedCallbackHelper(_callback, _ops));
+
+  {
+    boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
+    this->callbacks[_ops.GetTopic()].push_back(_callback);
+  }
+
+  SubscriberPtr result = TopicManager::Instance()->Subscribe(_ops);
+  result->SetCallbackId(_callback->GetId());
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool Node::GetQueueStats(const std::string &_topic, unsigned int _id,
+                         CallbackQueueStats &_stats)
+{
+  boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
+
+  Callback_M::const_iterator iter = this->callbacks.find(_topic);
+  if (iter == this->callbacks.end())
+    return false;
+
+  for (auto const &callback : iter->second)
+  {
+    if (callback->GetId() != _id)
+      continue;
+
+    QueuedCallbackHelperPtr queued =
+      boost::dynamic_pointer_cast<QueuedCallbackHelper>(callback);
+    if (!queued)
+      return false;
+    _stats = queued->GetStats();
+    return true;
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+void Node::AppendConnectionThreadQueues(const Callback_L &_callbacks,
+    std::vector<QueuedCallbackHelperPtr> &_queued) const
+{
+  for (auto const &callback : _callbacks)
+  {
+    QueuedCallbackHelperPtr queue =
+      boost::dynamic_pointer_cast<QueuedCallbackHelper>(callback);
+    if (queue && queue->GetExecutor() == SubscribeOptions::CONNECTION_THREAD &&
+        std::find(_queued.begin(), _queued.end(), queue) == _queued.end())
+    {
+      _queued.push_back(queue);
+    }
+  }
+}
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "gazebo/transport/TransportTypes.hh"
+#include "gazebo/transport/QueuedCallbackHelper.hh"
 #include "gazebo/transport/TopicManager.hh"
 #include "gazebo/util/system.hh"
 
@@ -43,9 +44,8 @@ namespace gazebo
       /// \param[in] _message Message to publish
       public: PublishTask(transport::PublisherPtr _pub,
                   const google::protobuf::Message &_message)
-              : pub(_pub)
+              : pub(_pub), msg(_message.New())
       {
-        this->msg = _message.New();
         this->msg->CopyFrom(_message);
       }
 
@@ -54,9 +54,9 @@ namespace gazebo
       public: tbb::task *execute()
               {
                 this->pub->WaitForConnection();
-                this->pub->Publish(*this->msg, true);
+                this->pub->Publish(this->msg, true);
                 this->pub->SendMessage();
-                delete this->msg;
+                this->msg.reset();
                 this->pub.reset();
                 return NULL;
               }
@@ -65,7 +65,7 @@ namespace gazebo
       private: transport::PublisherPtr pub;
 
       /// \brief Message to publish
-      private: google::protobuf::Message *msg;
+      private: MessagePtr msg;
     };
     /// \endcond
 
@@ -243,21 +243,28 @@ namespace gazebo
           bool _latching = false)
       {
         SubscribeOptions ops;
-        std::string decodedTopic = this->DecodeTopicName(_topic);
-        ops.template Init<M>(decodedTopic, shared_from_this(), _latching);
-
-        {
-          boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
-          this->callbacks[decodedTopic].push_back(CallbackHelperPtr(
-                new CallbackHelperT<M>(boost::bind(_fp, _obj, _1), _latching)));
-        }
-
-        SubscriberPtr result =
-          transport::TopicManager::Instance()->Subscribe(ops);
-
-        result->SetCallbackId(this->callbacks[decodedTopic].back()->GetId());
+        ops.SetLatching(_latching);
+        return this->Subscribe(_topic, _fp, _obj, ops);
+      }
 
-        return result;
+      /// \brief Subscribe to a topic using a class method as the callback
+      /// \param[in] _topic The topic to subscribe to
+      /// \param[in] _fp Class method to be called on receipt of new message
+      /// \param[in] _obj Class instance to be used on receipt of new message
+      /// \param[in] _options Latching, executor and queue of the
+      /// subscription. The topic and node are set by this function.
+      /// \return Pointer to new Subscriber object
+      public: template<typename M, typename T>
+      SubscriberPtr Subscribe(const std::string &_topic,
+          void(T::*_fp)(const boost::shared_ptr<M const> &), T *_obj,
+          const SubscribeOptions &_options)
+      {
+        SubscribeOptions ops = _options;
+        ops.template Init<M>(this->DecodeTopicName(_topic),
+            shared_from_this(), _options.GetLatching());
+        return this->AddSubscription(ops, CallbackHelperPtr(
+              new CallbackHelperT<M>(boost::bind(_fp, _obj, _1),
+                _options.GetLatching())));
       }
 
       /// \brief Subscribe to a topic using a bare function as the callback
@@ -272,21 +279,26 @@ namespace gazebo
                      bool _latching = false)
       {
         SubscribeOptions ops;
-        std::string decodedTopic = this->DecodeTopicName(_topic);
-        ops.template Init<M>(decodedTopic, shared_from_this(), _latching);
-
-        {
-          boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
-          this->callbacks[decodedTopic].push_back(
-              CallbackHelperPtr(new CallbackHelperT<M>(_fp, _latching)));
-        }
-
-        SubscriberPtr result =
-          transport::TopicManager::Instance()->Subscribe(ops);
-
-        result->SetCallbackId(this->callbacks[decodedTopic].back()->GetId());
+        ops.SetLatching(_latching);
+        return this->Subscribe(_topic, _fp, ops);
+      }
 
-        return result;
+      /// \brief Subscribe to a topic using a bare function as the callback
+      /// \param[in] _topic The topic to subscribe to
+      /// \param[in] _fp Function to be called on receipt of new message
+      /// \param[in] _options Latching, executor and queue of the
+      /// subscription. The topic and node are set by this function.
+      /// \return Pointer to new Subscriber object
+      public: template<typename M>
+      SubscriberPtr Subscribe(const std::string &_topic,
+          void(*_fp)(const boost::shared_ptr<M const> &),
+          const SubscribeOptions &_options)
+      {
+        SubscribeOptions ops = _options;
+        ops.template Init<M>(this->DecodeTopicName(_topic),
+            shared_from_this(), _options.GetLatching());
+        return this->AddSubscription(ops, CallbackHelperPtr(
+              new CallbackHelperT<M>(_fp, _options.GetLatching())));
       }
 
       /// \brief Subscribe to a topic using a class method as the callback
@@ -302,23 +314,28 @@ namespace gazebo
           bool _latching = false)
       {
         SubscribeOptions ops;
-        std::string decodedTopic = this->DecodeTopicName(_topic);
-        ops.Init(decodedTopic, shared_from_this(), _latching);
-
-        {
-          boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
-          this->callbacks[decodedTopic].push_back(CallbackHelperPtr(
-                new RawCallbackHelper(boost::bind(_fp, _obj, _1))));
-        }
-
-        SubscriberPtr result =
-          transport::TopicManager::Instance()->Subscribe(ops);
-
-        result->SetCallbackId(this->callbacks[decodedTopic].back()->GetId());
-
-        return result;
+        ops.SetLatching(_latching);
+        return this->Subscribe(_topic, _fp, _obj, ops);
       }
 
+      /// \brief Subscribe to a topic using a class method as the callback
+      /// \param[in] _topic The topic to subscribe to
+      /// \param[in] _fp Class method to be called on receipt of new message
+      /// \param[in] _obj Class instance to be used on receipt of new message
+      /// \param[in] _options Latching, executor and queue of the
+      /// subscription. The topic and node are set by this function.
+      /// \return Pointer to new Subscriber object
+      template<typename T>
+      SubscriberPtr Subscribe(const std::string &_topic,
+          void(T::*_fp)(const std::string &), T *_obj,
+          const SubscribeOptions &_options)
+      {
+        SubscribeOptions ops = _options;
+        ops.Init(this->DecodeTopicName(_topic), shared_from_this(),
+            _options.GetLatching());
+        return this->AddSubscription(ops, CallbackHelperPtr(
+              new RawCallbackHelper(boost::bind(_fp, _obj, _1))));
+      }
 
       /// \brief Subscribe to a topic using a bare function as the callback
       /// \param[in] _topic The topic to subscribe to
@@ -330,21 +347,24 @@ namespace gazebo
           void(*_fp)(const std::string &), bool _latching = false)
       {
         SubscribeOptions ops;
-        std::string decodedTopic = this->DecodeTopicName(_topic);
-        ops.Init(decodedTopic, shared_from_this(), _latching);
-
-        {
-          boost::recursive_mutex::scoped_lock lock(this->incomingMutex);
-          this->callbacks[decodedTopic].push_back(
-              CallbackHelperPtr(new RawCallbackHelper(_fp)));
-        }
-
-        SubscriberPtr result =
-          transport::TopicManager::Instance()->Subscribe(ops);
-
-        result->SetCallbackId(this->callbacks[decodedTopic].back()->GetId());
+        ops.SetLatching(_latching);
+        return this->Subscribe(_topic, _fp, ops);
+      }
 
-        return result;
+      /// \brief Subscribe to a topic using a bare function as the callback
+      /// \param[in] _topic The topic to subscribe to
+      /// \param[in] _fp Function to be called on receipt of new message
+      /// \param[in] _options Latching, executor and queue of the
+      /// subscription. The topic and node are set by this function.
+      /// \return Pointer to new Subscriber object
+      SubscriberPtr Subscribe(const std::string &_topic,
+          void(*_fp)(const std::string &), const SubscribeOptions &_options)
+      {
+        SubscribeOptions ops = _options;
+        ops.Init(this->DecodeTopicName(_topic), shared_from_this(),
+            _options.GetLatching());
+        return this->AddSubscription(ops,
+            CallbackHelperPtr(new RawCallbackHelper(_fp)));
       }
 
       /// \brief Handle incoming data.
@@ -390,6 +410,25 @@ namespace gazebo
       /// \param[in] _id Id of the callback.
       public: void RemoveCallback(const std::string &_topic, unsigned int _id);
 
+      /// \brief Get the counters of the message queue of a subscription.
+      /// \param[in] _topic Name of the topic.
+      /// \param[in] _id Id of the callback.
+      /// \param[out] _stats Counters of the queue.
+      /// \return False if the subscription has no queue of its own, see
+      /// SubscribeOptions::SetExecutor and SubscribeOptions::SetQueueDepth.
+      public: bool GetQueueStats(const std::string &_topic, unsigned int _id,
+                                 CallbackQueueStats &_stats);
+
+      /// \internal
+      /// \brief Add the callback of a new subscription, wrapped in a
+      /// QueuedCallbackHelper when the options ask for a queue, and
+      /// subscribe to the topic.
+      /// \param[in] _ops Options of the subscription.
+      /// \param[in] _callback Callback of the subscription.
+      /// \return Pointer to new Subscriber object
+      private: SubscriberPtr AddSubscription(const SubscribeOptions &_ops,
+                                             CallbackHelperPtr _callback);
+
       /// \internal
       /// \brief Private implementation of Init() and TryInit()
       /// \param[in] _space Namespace to initialize this Node to. Use an empty
@@ -413,6 +452,15 @@ namespace gazebo
 
       private: typedef std::list<CallbackHelperPtr> Callback_L;
       private: typedef std::map<std::string, Callback_L> Callback_M;
+
+      /// \internal
+      /// \brief Append the queued callbacks that run on the ConnectionManager
+      /// thread to a list, once each.
+      /// \param[in] _callbacks Callbacks of a topic.
+      /// \param[in,out] _queued List of queued callbacks.
+      private: void AppendConnectionThreadQueues(const Callback_L &_callbacks,
+                   std::vector<QueuedCallbackHelperPtr> &_queued) const;
+
       private: Callback_M callbacks;
       private: std::map<std::string, std::list<std::string> > incomingMsgs;
 
@@ -319,14 +319,40 @@ int Publication::Publish(MessagePtr _msg, boost::function<void(uint32_t)> _cb,
 
     if (!this->callbacks.empty())
     {
-      std::string data;
-      _msg->SerializeToString(&data);
+      // Serialize lazily: local callbacks share the message object, so the
+      // wire format is produced at most once, and only for remote or raw
+      // subscribers. Remote subscribers all write the same buffer.
+      boost::shared_ptr<std::string> data;
       std::list<CallbackHelperPtr>::iterator cbIter;
       cbIter = this->callbacks.begin();
 
       while (cbIter != this->callbacks.end())
       {
-        if ((*cbIter)->HandleData(data, _cb, _id))
+        bool handled;
+        if ((*cbIter)->IsLocal() &&
+            !boost::dynamic_pointer_cast<RawCallbackHelper>(*cbIter))
+        {
+          handled = (*cbIter)->HandleMessage(_msg);
+          if (handled && !_cb.empty())
+            _cb(_id);
+        }
+        else
+        {
+          if (!data)
+          {
+            data.reset(new std::string);
+            _msg->SerializeToString(data.get());
+          }
+
+          SubscriptionTransportPtr subLink =
+              boost::dynamic_pointer_cast<SubscriptionTransport>(*cbIter);
+          if (subLink)
+            handled = subLink->HandleData(data, _cb, _id);
+          else
+            handled = (*cbIter)->HandleData(*data, _cb, _id);
+        }
+
+        if (handled)
         {
           ++result;
           ++cbIter;
@@ -398,6 +424,23 @@ unsigned int Publication::GetRemoteSubscriptionCount()
   return count;
 }
 
+//////////////////////////////////////////////////
+unsigned int Publication::GetSharedMemorySubscriptionCount()
+{
+  unsigned int count = 0;
+
+  boost::mutex::scoped_lock lock(this->callbackMutex);
+  for (auto const &callback : this->callbacks)
+  {
+    auto transport =
+      boost::dynamic_pointer_cast<SubscriptionTransport>(callback);
+    if (transport && transport->UsesSharedMemory())
+      count++;
+  }
+
+  return count;
+}
+
 //////////////////////////////////////////////////
 bool Publication::GetLocallyAdvertised() const
 {
@@ -102,6 +102,11 @@ namespace gazebo
       /// \return The number of remote subscriptions
       public: unsigned int GetRemoteSubscriptionCount();
 
+      /// \brief Get the number of remote subscriptions that receive the
+      /// messages through shared memory.
+      /// \return The number of shared memory subscriptions
+      public: unsigned int GetSharedMemorySubscriptionCount();
+
       /// \brief Was the topic has been advertised from this process?
       /// \return true if the topic has been advertised from this process,
       /// false otherwise
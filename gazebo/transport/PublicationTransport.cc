@@ -16,6 +16,7 @@
 */
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include "gazebo/common/Console.hh"
 #include "gazebo/transport/TopicManager.hh"
 #include "gazebo/transport/ConnectionManager.hh"
 #include "gazebo/transport/PublicationTransport.hh"
@@ -38,6 +39,8 @@ PublicationTransport::PublicationTransport(const std::string &_topic,
 /////////////////////////////////////////////////
 PublicationTransport::~PublicationTransport()
 {
+  this->CloseRing();
+
   if (this->connection)
   {
     msgs::Subscribe sub;
@@ -55,7 +58,8 @@ PublicationTransport::~PublicationTransport()
 }
 
 /////////////////////////////////////////////////
-void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched)
+void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched,
+    bool _binaryFraming, bool _sharedMemory)
 {
   this->connection = _conn;
   msgs::Subscribe sub;
@@ -65,11 +69,34 @@ void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched)
   sub.set_port(this->connection->GetLocalPort());
   sub.set_latching(_latched);
 
+  // The publisher switches to binary framing as soon as it reads this
+  // request, so expect it before sending the request.
+  if (_binaryFraming)
+  {
+    sub.set_binary_framing(true);
+    this->connection->SetBinaryRead(
+        Connection::TopicId(this->topic, this->msgType));
+  }
+
+  // The publisher writes to the ring if it can open it, and keeps using
+  // the connection otherwise, so read both.
+  if (_sharedMemory)
+  {
+    this->ring = ShmRing::Create();
+    if (this->ring)
+    {
+      sub.set_shm_name(this->ring->GetName());
+      this->ringThread = std::thread(&PublicationTransport::ReadRing,
+          boost::weak_ptr<PublicationTransport>(this->shared_from_this()),
+          this->ring);
+    }
+  }
+
   this->connection->EnqueueMsg(msgs::Package("sub", sub));
 
-  // Put this in PublicationTransportPtr
-  // Start reading messages from the remote publisher
-  this->connection->AsyncRead(common::weakBind(&PublicationTransport::OnPublish,
+  // Start reading messages from the remote publisher. The read loop
+  // delivers each message as soon as it arrives.
+  this->connection->StartRead(common::weakBind(&PublicationTransport::OnPublish,
         this->shared_from_this(), _1));
 }
 
@@ -84,17 +111,51 @@ void PublicationTransport::AddCallback(
 /////////////////////////////////////////////////
 void PublicationTransport::OnPublish(const std::string &_data)
 {
-  if (this->connection && this->connection->IsOpen())
-  {
-    this->connection->AsyncRead(
-        common::weakBind(&PublicationTransport::OnPublish,
-            this->shared_from_this(), _1));
+  if (!_data.empty() && this->callback)
+    (this->callback)(_data);
+}
 
-    if (!_data.empty())
+/////////////////////////////////////////////////
+void PublicationTransport::ReadRing(
+    boost::weak_ptr<PublicationTransport> _transport, ShmRingPtr _ring)
+{
+  std::string data;
+  uint64_t dropped = 0;
+  while (!_ring->IsClosed())
+  {
+    // Wake up now and then to report drops.
+    if (!_ring->Read(data, 1000))
     {
-      if (this->callback)
-        (this->callback)(_data);
+      if (_ring->GetDropped() != dropped)
+      {
+        gzwarn << "Shared memory ring full, dropped "
+               << _ring->GetDropped() - dropped << " messages\n";
+        dropped = _ring->GetDropped();
+      }
+      continue;
     }
+
+    boost::shared_ptr<PublicationTransport> transport = _transport.lock();
+    if (!transport)
+      break;
+    transport->OnPublish(data);
+  }
+}
+
+/////////////////////////////////////////////////
+void PublicationTransport::CloseRing()
+{
+  if (!this->ring)
+    return;
+
+  this->ring->Close();
+  if (this->ringThread.joinable())
+  {
+    // The last reference may be released by a callback on the thread.
+    if (this->ringThread.get_id() == std::this_thread::get_id())
+      this->ringThread.detach();
+    else
+      this->ringThread.join();
   }
 }
 
@@ -119,6 +180,8 @@ std::string PublicationTransport::GetMsgType() const
 /////////////////////////////////////////////////
 void PublicationTransport::Fini()
 {
+  this->CloseRing();
+
   /// Cancel all async operatiopns.
   if (this->connection)
   {
@@ -20,9 +20,12 @@
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <string>
+#include <thread>
 
 #include "gazebo/transport/Connection.hh"
+#include "gazebo/transport/ShmRing.hh"
 #include "gazebo/common/Event.hh"
 #include "gazebo/util/system.hh"
 
@@ -53,7 +56,13 @@ namespace gazebo
       /// \param[in] _conn The underlying connection.
       /// \param[in] _latched True to grab the last message sent on the
       /// topic.
-      public: void Init(const ConnectionPtr &_conn, bool _latched);
+      /// \param[in] _binaryFraming True to ask the publisher for binary
+      /// framing. Only set it if the publisher advertised support for it.
+      /// \param[in] _sharedMemory True to create a shared memory ring, and
+      /// ask the publisher to write the data to it instead of the
+      /// connection. Only set it if the publisher runs on this host.
+      public: void Init(const ConnectionPtr &_conn, bool _latched,
+                  bool _binaryFraming = false, bool _sharedMemory = false);
 
       /// \brief Finalize the transport
       public: void Fini();
@@ -79,6 +88,17 @@ namespace gazebo
       /// \param[in] _data Data to be published.
       private: void OnPublish(const std::string &_data);
 
+      /// \brief Body of the thread that reads the shared memory ring.
+      /// \param[in] _transport The transport, which may be destroyed while
+      /// the thread waits for data.
+      /// \param[in] _ring The ring.
+      private: static void ReadRing(
+                   boost::weak_ptr<PublicationTransport> _transport,
+                   ShmRingPtr _ring);
+
+      /// \brief Close the shared memory ring, and stop its thread.
+      private: void CloseRing();
+
       /// \brief The topic for this publication transport.
       private: std::string topic;
 
@@ -96,6 +116,12 @@ namespace gazebo
 
       /// \brief The unique id for the publication transport.
       private: int id;
+
+      /// \brief Shared memory ring written by the publisher, if any.
+      private: ShmRingPtr ring;
+
+      /// \brief Thread that reads the shared memory ring.
+      private: std::thread ringThread;
     };
     /// \}
   }
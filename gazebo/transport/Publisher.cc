@@ -84,8 +84,7 @@ bool Publisher::WaitForConnection(const common::Time &_timeout) const
 }
 
 //////////////////////////////////////////////////
-void Publisher::PublishImpl(const google::protobuf::Message &_message,
-                            bool _block)
+bool Publisher::PrepareMessage(const google::protobuf::Message &_message)
 {
   if (_message.GetTypeName() != this->msgType)
     gzthrow("Invalid message type\n");
@@ -95,7 +94,7 @@ void Publisher::PublishImpl(const google::protobuf::Message &_message,
     gzerr << "Publishing an uninitialized message on topic[" <<
       this->topic << "]. Required field [" <<
       _message.InitializationErrorString() << "] missing.\n";
-    return;
+    return false;
   }
 
   // Check if a throttling rate has been set
@@ -109,23 +108,56 @@ void Publisher::PublishImpl(const google::protobuf::Message &_message,
         (this->currentTime - this->prevPublishTime).Double() <
         this->updatePeriod)
     {
-      return;
+      return false;
     }
 
     // Set the previous time a message was published
     this->prevPublishTime = this->currentTime;
   }
 
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Publisher::PublishImpl(const google::protobuf::Message &_message,
+                            bool _block)
+{
+  if (!this->PrepareMessage(_message))
+    return;
+
   // Save the latest message
   MessagePtr msgPtr(_message.New());
   msgPtr->CopyFrom(_message);
 
-  this->publication->SetPrevMsg(this->id, msgPtr);
+  this->EnqueueMessage(msgPtr, _block);
+}
+
+//////////////////////////////////////////////////
+void Publisher::PublishImpl(const MessagePtr &_message, bool _block)
+{
+  if (!_message)
+  {
+    gzerr << "Publishing a null message on topic[" << this->topic << "]\n";
+    return;
+  }
+
+  if (!this->PrepareMessage(*_message))
+    return;
+
+  // The message is shared with the caller, who promised not to modify it,
+  // so it can be queued as is.
+  this->EnqueueMessage(_message, _block);
+}
+
+//////////////////////////////////////////////////
+void Publisher::EnqueueMessage(const MessagePtr &_msgPtr, bool _block)
+{
+  this->publication->SetPrevMsg(this->id, _msgPtr);
 
   {
     boost::mutex::scoped_lock lock(this->mutex);
 
-    this->messages.push_back(msgPtr);
+    this->messages.push_back(_msgPtr);
 
     if (this->messages.size() > this->queueLimit)
     {
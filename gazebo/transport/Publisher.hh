@@ -27,6 +27,7 @@
 #include <string>
 #include <list>
 #include <map>
+#include <utility>
 
 #include "gazebo/common/Time.hh"
 #include "gazebo/transport/TransportTypes.hh"
@@ -99,7 +100,31 @@ namespace gazebo
       /// there are still messages in the queue which need to be sent out.
       public: template< typename M>
               void Publish(M _message, bool _block = false)
-              { this->PublishImpl(_message, _block); }
+              {
+                // _message is already our own copy, so move it into the
+                // queued object instead of copying it a second time.
+                this->PublishImpl(MessagePtr(new M(std::move(_message))),
+                    _block);
+              }
+
+      /// \brief Publish a shared, immutable message on the topic without
+      /// copying it. Local subscribers receive this same object, and it is
+      /// serialized at most once, and only if a remote subscriber is
+      /// connected. The message must not be modified after this call.
+      /// \param[in] _message Message to be published
+      /// \param[in] _block Whether to block until the message is actually
+      /// written into the local message buffer, and SendMessage() is called.
+      /// \sa Publish(const google::protobuf::Message &, bool)
+      public: template<typename M>
+              void Publish(const boost::shared_ptr<M> &_message,
+                  bool _block = false)
+              {
+                boost::shared_ptr<const google::protobuf::Message> msg =
+                    _message;
+                this->PublishImpl(
+                    boost::const_pointer_cast<google::protobuf::Message>(msg),
+                    _block);
+              }
 
       /// \brief Get the number of outgoing messages
       /// \return The number of outgoing messages
@@ -147,6 +172,23 @@ namespace gazebo
       private: void PublishImpl(const google::protobuf::Message &_message,
                                 bool _block);
 
+      /// \brief Implementation of Publish for shared messages. The message
+      /// is queued without being copied.
+      /// \param[in] _message Message to be published.
+      /// \param[in] _block Whether to block until the message is actually
+      /// written out.
+      private: void PublishImpl(const MessagePtr &_message, bool _block);
+
+      /// \brief Check that a message can be published now.
+      /// \param[in] _message Message to check.
+      /// \return False if the message is invalid or throttled.
+      private: bool PrepareMessage(const google::protobuf::Message &_message);
+
+      /// \brief Store a message as the latest one and queue it.
+      /// \param[in] _msgPtr Message to queue.
+      /// \param[in] _block Whether to send the queue immediately.
+      private: void EnqueueMessage(const MessagePtr &_msgPtr, bool _block);
+
       /// \brief Callback when a publish is completed
       /// \param[in] _id ID associated with the publication.
       private: void OnPublishComplete(uint32_t _id);
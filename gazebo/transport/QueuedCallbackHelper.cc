@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <tbb/task.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "gazebo/transport/QueuedCallbackHelper.hh"
+
+namespace gazebo
+{
+namespace transport
+{
+/////////////////////////////////////////////////
+class QueuedCallbackHelperPrivate
+{
+  /// \brief A waiting message, either serialized or not.
+  public: struct Entry
+          {
+            /// \brief Serialized message, when msg is null.
+            std::string data;
+
+            /// \brief Message.
+            MessagePtr msg;
+          };
+
+  /// \brief Callback helper that handles the messages.
+  public: CallbackHelperPtr callback;
+
+  /// \brief Where the callback runs.
+  public: SubscribeOptions::CallbackExecutor executor;
+
+  /// \brief Largest number of waiting messages, 0 for no limit.
+  public: unsigned int maxDepth = 0;
+
+  /// \brief Protects the members below.
+  public: std::mutex mutex;
+
+  /// \brief Signals new messages, or Stop(), to the dedicated thread.
+  public: std::condition_variable wakeup;
+
+  /// \brief Signals the end of a callback to Stop().
+  public: std::condition_variable idle;
+
+  /// \brief Waiting messages, oldest first.
+  public: std::deque<Entry> queue;
+
+  /// \brief True after Stop().
+  public: bool stopped = false;
+
+  /// \brief True while a SHARED_POOL task is queued or running.
+  public: bool scheduled = false;
+
+  /// \brief True while the callback runs.
+  public: bool inCallback = false;
+
+  /// \brief Thread running the callback, while inCallback.
+  public: std::thread::id callbackThread;
+
+  /// \brief Thread of the DEDICATED_THREAD executor.
+  public: std::thread thread;
+
+  /// \brief Counters of the queue.
+  public: CallbackQueueStats stats;
+};
+
+/////////////////////////////////////////////////
+// Run the callback on the front message, with the lock released.
+static void RunFront(QueuedCallbackHelperPrivate &_data,
+                     std::unique_lock<std::mutex> &_lock)
+{
+  QueuedCallbackHelperPrivate::Entry entry = std::move(_data.queue.front());
+  _data.queue.pop_front();
+  _data.inCallback = true;
+  _data.callbackThread = std::this_thread::get_id();
+  _lock.unlock();
+
+  if (entry.msg)
+  {
+    _data.callback->HandleMessage(entry.msg);
+  }
+  else
+  {
+    _data.callback->HandleData(entry.data,
+        boost::function<void(uint32_t)>(), 0);
+  }
+
+  _lock.lock();
+  _data.inCallback = false;
+  _data.stats.processed++;
+  _data.idle.notify_all();
+}
+
+/////////////////////////////////////////////////
+// Run the callback until the queue is empty.
+static void Drain(QueuedCallbackHelperPrivate &_data)
+{
+  std::unique_lock<std::mutex> lock(_data.mutex);
+  while (!_data.stopped && !_data.queue.empty())
+    RunFront(_data, lock);
+  _data.scheduled = false;
+}
+
+/////////////////////////////////////////////////
+// Body of the DEDICATED_THREAD executor. The thread holds the private data,
+// so that it may outlive the helper when a callback unsubscribes itself.
+static void RunThread(std::shared_ptr<QueuedCallbackHelperPrivate> _data)
+{
+  std::unique_lock<std::mutex> lock(_data->mutex);
+  while (true)
+  {
+    _data->wakeup.wait(lock, [&_data]
+        {
+          return _data->stopped || !_data->queue.empty();
+        });
+    if (_data->stopped)
+      break;
+    RunFront(*_data, lock);
+  }
+}
+
+/// \brief Task of the SHARED_POOL executor, which drains the queue.
+class QueuedCallbackTask : public tbb::task
+{
+  /// \brief Constructor
+  /// \param[in] _data Private data of the helper.
+  public: explicit QueuedCallbackTask(
+              std::shared_ptr<QueuedCallbackHelperPrivate> _data)
+          : data(_data) {}
+
+  /// \brief Overridden function from tbb::task that drains the queue.
+  public: tbb::task *execute()
+          {
+            Drain(*this->data);
+            return NULL;
+          }
+
+  /// \brief Private data of the helper.
+  private: std::shared_ptr<QueuedCallbackHelperPrivate> data;
+};
+
+/////////////////////////////////////////////////
+// Append a message to the queue, dropping the oldest one when it is full,
+// and wake up the executor.
+static void Enqueue(const std::shared_ptr<QueuedCallbackHelperPrivate> &_data,
+                    QueuedCallbackHelperPrivate::Entry &&_entry)
+{
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(_data->mutex);
+    if (_data->stopped)
+      return;
+
+    CallbackQueueStats &stats = _data->stats;
+    stats.received++;
+    if (_data->maxDepth > 0 && _data->queue.size() >= _data->maxDepth)
+    {
+      _data->queue.pop_front();
+      stats.dropped++;
+    }
+    _data->queue.push_back(std::move(_entry));
+    stats.peakDepth = std::max(stats.peakDepth,
+        static_cast<unsigned int>(_data->queue.size()));
+
+    if (_data->executor == SubscribeOptions::DEDICATED_THREAD)
+    {
+      _data->wakeup.notify_one();
+    }
+    else if (_data->executor == SubscribeOptions::SHARED_POOL &&
+             !_data->scheduled)
+    {
+      _data->scheduled = true;
+      schedule = true;
+    }
+  }
+
+  if (schedule)
+  {
+    QueuedCallbackTask *task = new(tbb::task::allocate_root())
+      QueuedCallbackTask(_data);
+    tbb::task::enqueue(*task);
+  }
+}
+}
+}
+
+using namespace gazebo;
+using namespace transport;
+
+/////////////////////////////////////////////////
+QueuedCallbackHelper::QueuedCallbackHelper(CallbackHelperPtr _callback,
+    const SubscribeOptions &_options)
+  : CallbackHelper(_options.GetLatching()),
+    dataPtr(new QueuedCallbackHelperPrivate)
+{
+  this->dataPtr->callback = _callback;
+  this->dataPtr->executor = _options.GetExecutor();
+  this->dataPtr->maxDepth = _options.GetQueueDepth();
+
+  if (this->dataPtr->executor == SubscribeOptions::DEDICATED_THREAD)
+    this->dataPtr->thread = std::thread(RunThread, this->dataPtr);
+}
+
+/////////////////////////////////////////////////
+QueuedCallbackHelper::~QueuedCallbackHelper()
+{
+  this->Stop();
+}
+
+/////////////////////////////////////////////////
+std::string QueuedCallbackHelper::GetMsgType() const
+{
+  return this->dataPtr->callback->GetMsgType();
+}
+
+/////////////////////////////////////////////////
+bool QueuedCallbackHelper::IsLocal() const
+{
+  return this->dataPtr->callback->IsLocal();
+}
+
+/////////////////////////////////////////////////
+SubscribeOptions::CallbackExecutor QueuedCallbackHelper::GetExecutor() const
+{
+  return this->dataPtr->executor;
+}
+
+/////////////////////////////////////////////////
+bool QueuedCallbackHelper::HandleData(const std::string &_newdata,
+    boost::function<void(uint32_t)> _cb, uint32_t _id)
+{
+  this->SetLatching(false);
+
+  QueuedCallbackHelperPrivate::Entry entry;
+  entry.data = _newdata;
+  Enqueue(this->dataPtr, std::move(entry));
+
+  if (!_cb.empty())
+    _cb(_id);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool QueuedCallbackHelper::HandleMessage(MessagePtr _newMsg)
+{
+  this->SetLatching(false);
+
+  QueuedCallbackHelperPrivate::Entry entry;
+  entry.msg = _newMsg;
+  Enqueue(this->dataPtr, std::move(entry));
+  return true;
+}
+
+/////////////////////////////////////////////////
+void QueuedCallbackHelper::ProcessQueue()
+{
+  Drain(*this->dataPtr);
+}
+
+/////////////////////////////////////////////////
+CallbackQueueStats QueuedCallbackHelper::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  CallbackQueueStats stats = this->dataPtr->stats;
+  stats.depth = static_cast<unsigned int>(this->dataPtr->queue.size());
+  return stats;
+}
+
+/////////////////////////////////////////////////
+void QueuedCallbackHelper::Stop()
+{
+  const std::thread::id self = std::this_thread::get_id();
+  {
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stopped = true;
+    this->dataPtr->queue.clear();
+    this->dataPtr->wakeup.notify_all();
+
+    // A callback that unsubscribes itself can't wait for itself.
+    this->dataPtr->idle.wait(lock, [this, &self]
+        {
+          return !this->dataPtr->inCallback ||
+                 this->dataPtr->callbackThread == self;
+        });
+  }
+
+  if (this->dataPtr->thread.joinable())
+  {
+    if (this->dataPtr->thread.get_id() == self)
+      this->dataPtr->thread.detach();
+    else
+      this->dataPtr->thread.join();
+  }
+}
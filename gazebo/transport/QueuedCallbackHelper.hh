@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TRANSPORT_QUEUEDCALLBACKHELPER_HH_
+#define GAZEBO_TRANSPORT_QUEUEDCALLBACKHELPER_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gazebo/transport/CallbackHelper.hh"
+#include "gazebo/transport/SubscribeOptions.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace transport
+  {
+    // Forward declare private class.
+    class QueuedCallbackHelperPrivate;
+
+    /// \addtogroup gazebo_transport
+    /// \{
+
+    /// \brief Counters of the message queue of a subscription.
+    struct CallbackQueueStats
+    {
+      /// \brief Number of messages waiting for the callback.
+      unsigned int depth = 0;
+
+      /// \brief Largest number of messages that waited for the callback.
+      unsigned int peakDepth = 0;
+
+      /// \brief Number of messages received.
+      uint64_t received = 0;
+
+      /// \brief Number of messages dropped because the queue was full.
+      uint64_t dropped = 0;
+
+      /// \brief Number of messages passed to the callback.
+      uint64_t processed = 0;
+    };
+
+    /// \class QueuedCallbackHelper QueuedCallbackHelper.hh
+    /// transport/transport.hh
+    /// \brief Callback helper that queues incoming messages for another
+    /// callback helper, and runs it on the executor set in the
+    /// SubscribeOptions. Receiving a message only appends it to the
+    /// queue, so it doesn't wait for the callback.
+    class GZ_TRANSPORT_VISIBLE QueuedCallbackHelper : public CallbackHelper
+    {
+      /// \brief Constructor
+      /// \param[in] _callback Callback helper that handles the messages.
+      /// \param[in] _options Executor and queue depth of the subscription.
+      public: QueuedCallbackHelper(CallbackHelperPtr _callback,
+                                   const SubscribeOptions &_options);
+
+      /// \brief Destructor. Stops the executor.
+      public: virtual ~QueuedCallbackHelper();
+
+      // documentation inherited
+      public: virtual std::string GetMsgType() const;
+
+      // documentation inherited
+      public: virtual bool HandleData(const std::string &_newdata,
+                  boost::function<void(uint32_t)> _cb, uint32_t _id);
+
+      // documentation inherited
+      public: virtual bool HandleMessage(MessagePtr _newMsg);
+
+      // documentation inherited
+      public: virtual bool IsLocal() const;
+
+      /// \brief Get where the callback runs.
+      /// \return Where the callback runs.
+      public: SubscribeOptions::CallbackExecutor GetExecutor() const;
+
+      /// \brief Run the callback on the waiting messages, in the calling
+      /// thread. Used by Node for the CONNECTION_THREAD executor.
+      public: void ProcessQueue();
+
+      /// \brief Get the counters of the queue.
+      /// \return The counters of the queue.
+      public: CallbackQueueStats GetStats() const;
+
+      /// \brief Drop the waiting messages, and wait for a running callback
+      /// to return unless it is the caller. The callback isn't run
+      /// anymore afterwards.
+      public: void Stop();
+
+      /// \internal
+      /// \brief Private data. It is shared with the executor, so that a
+      /// callback which unsubscribes itself can return safely.
+      private: std::shared_ptr<QueuedCallbackHelperPrivate> dataPtr;
+    };
+
+    /// \brief boost shared pointer to transport::QueuedCallbackHelper
+    typedef boost::shared_ptr<QueuedCallbackHelper> QueuedCallbackHelperPtr;
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,624 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include <boost/asio/ip/host_name.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/transport/ShmRing.hh"
+
+namespace gazebo
+{
+namespace transport
+{
+/// \brief Start of the shared memory object. Both processes run the same
+/// build, so they agree on its layout; the magic number and version catch
+/// the other cases.
+struct alignas(64) ShmRingHeader
+{
+  /// \brief ShmRingMagic.
+  uint32_t magic;
+
+  /// \brief ShmRingVersion.
+  uint32_t version;
+
+  /// \brief Number of slots.
+  uint32_t slotCount;
+
+  /// \brief Largest message size.
+  uint64_t slotSize;
+
+  /// \brief Number of messages written.
+  std::atomic<uint64_t> writeSeq;
+
+  /// \brief Number of messages read.
+  std::atomic<uint64_t> readSeq;
+
+  /// \brief Number of messages dropped because the ring was full.
+  std::atomic<uint64_t> dropped;
+
+  /// \brief Futex word, bumped on each write and on Close().
+  std::atomic<uint32_t> wakeup;
+
+  /// \brief Nonzero while the reader sleeps on wakeup.
+  std::atomic<uint32_t> sleeping;
+
+  /// \brief Futex word, bumped on each read.
+  std::atomic<uint32_t> readWakeup;
+
+  /// \brief Nonzero while the writer sleeps on readWakeup.
+  std::atomic<uint32_t> writerSleeping;
+
+  /// \brief Nonzero after Close().
+  std::atomic<uint32_t> closed;
+};
+
+/// \brief Start of a slot, followed by the message.
+struct alignas(64) ShmRingSlot
+{
+  /// \brief Sequence number of the message in the slot, plus one.
+  std::atomic<uint64_t> seq;
+
+  /// \brief Size of the message.
+  uint64_t size;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "Shared memory transport needs address free atomics");
+
+static const uint32_t ShmRingMagic = 0x477a5368;
+static const uint32_t ShmRingVersion = 1;
+
+/// \brief Default largest message size, enough for an uncompressed
+/// 1080p RGB image. The slots are only backed by memory once written.
+static const size_t ShmRingDefaultSlotSize = 8 * 1024 * 1024;
+
+/// \brief Default number of slots.
+static const unsigned int ShmRingDefaultSlotCount = 4;
+
+/////////////////////////////////////////////////
+class ShmRingPrivate
+{
+  /// \brief Name of the shared memory object.
+  public: std::string name;
+
+  /// \brief File descriptor of the shared memory object.
+  public: int fd = -1;
+
+  /// \brief Mapped memory.
+  public: void *memory = nullptr;
+
+  /// \brief Size of the mapped memory.
+  public: size_t size = 0;
+
+  /// \brief True for the reader, which created the object.
+  public: bool creator = false;
+
+  /// \brief Number of slots. The header is shared with another process,
+  /// so this side uses its own checked copy.
+  public: uint32_t slotCount = 0;
+
+  /// \brief Largest message size, checked copy of the header's.
+  public: uint64_t slotSize = 0;
+
+  /// \brief Distance between two slots.
+  public: size_t stride = 0;
+
+  /// \brief Bytes of each slot backed by memory, for the writer.
+  public: std::vector<size_t> reserved;
+
+  /// \brief Serializes writers.
+  public: std::mutex writeMutex;
+
+  /// \brief True from a wait of the writer for a free slot that timed
+  /// out, until the reader empties the ring.
+  public: bool stalled = false;
+
+  /// \brief Header of the ring.
+  public: ShmRingHeader *Header() const
+          {
+            return static_cast<ShmRingHeader *>(this->memory);
+          }
+
+  /// \brief Get a slot.
+  /// \param[in] _seq Sequence number of a message in the slot.
+  public: ShmRingSlot *Slot(const uint64_t _seq) const
+          {
+            return reinterpret_cast<ShmRingSlot *>(
+                static_cast<char *>(this->memory) + sizeof(ShmRingHeader) +
+                (_seq % this->slotCount) * this->stride);
+          }
+
+  /// \brief Get the message of a slot.
+  /// \param[in] _slot The slot.
+  public: static char *Payload(ShmRingSlot *_slot)
+          {
+            return reinterpret_cast<char *>(_slot) + sizeof(ShmRingSlot);
+          }
+
+  /// \brief Offset of a slot in the shared memory object.
+  /// \param[in] _seq Sequence number of a message in the slot.
+  public: size_t SlotOffset(const uint64_t _seq) const
+          {
+            return reinterpret_cast<char *>(this->Slot(_seq)) -
+              static_cast<char *>(this->memory);
+          }
+};
+
+/////////////////////////////////////////////////
+// Size of the slots, rounded up so that every slot header is aligned.
+static size_t SlotStride(const size_t _slotSize)
+{
+  const size_t align = alignof(ShmRingSlot);
+  return (sizeof(ShmRingSlot) + _slotSize + align - 1) / align * align;
+}
+
+/////////////////////////////////////////////////
+// Read a size from the environment.
+static size_t EnvSize(const char *_name, const size_t _default)
+{
+  const char *env = getenv(_name);
+  if (!env || *env == '\0')
+    return _default;
+
+  char *end = nullptr;
+  unsigned long long value = strtoull(env, &end, 10);
+  if (*end != '\0' || value == 0)
+  {
+    gzwarn << "Invalid value of " << _name << "[" << env << "], using "
+           << _default << "\n";
+    return _default;
+  }
+  return static_cast<size_t>(value);
+}
+
+#ifdef __linux__
+/////////////////////////////////////////////////
+// Sleep while the futex word is _value, for at most _timeoutMs. The word is
+// in shared memory, so the futex must not be process private.
+static void FutexWait(std::atomic<uint32_t> *_word, const uint32_t _value,
+                      const unsigned int _timeoutMs)
+{
+  struct timespec timeout;
+  timeout.tv_sec = _timeoutMs / 1000;
+  timeout.tv_nsec = (_timeoutMs % 1000) * 1000000L;
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(_word), FUTEX_WAIT,
+      _value, &timeout, nullptr, 0);
+}
+
+/////////////////////////////////////////////////
+// Wake up the threads sleeping on the futex word.
+static void FutexWake(std::atomic<uint32_t> *_word)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(_word), FUTEX_WAKE,
+      INT_MAX, nullptr, nullptr, 0);
+}
+#endif
+}
+}
+
+using namespace gazebo;
+using namespace transport;
+
+/////////////////////////////////////////////////
+ShmRing::ShmRing()
+  : dataPtr(new ShmRingPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ShmRing::~ShmRing()
+{
+#ifdef __linux__
+  if (this->dataPtr->memory)
+  {
+    if (this->dataPtr->creator)
+      this->Close();
+    munmap(this->dataPtr->memory, this->dataPtr->size);
+  }
+
+  if (this->dataPtr->fd >= 0)
+    close(this->dataPtr->fd);
+
+  // The writer removes the name when it opens the ring. Remove it here when
+  // no writer ever did.
+  if (this->dataPtr->creator)
+    shm_unlink(this->dataPtr->name.c_str());
+#endif
+}
+
+/////////////////////////////////////////////////
+ShmRingPtr ShmRing::Create(const std::string &_name,
+    unsigned int _slotCount, size_t _slotSize)
+{
+#ifdef __linux__
+  if (_slotCount == 0 || _slotSize == 0 || _slotSize > SIZE_MAX / 2 ||
+      _slotCount > (SIZE_MAX - sizeof(ShmRingHeader)) / SlotStride(_slotSize))
+  {
+    return ShmRingPtr();
+  }
+
+  ShmRingPtr ring(new ShmRing);
+  ShmRingPrivate &data = *ring->dataPtr;
+  data.name = _name;
+  data.slotCount = _slotCount;
+  data.slotSize = _slotSize;
+  data.stride = SlotStride(_slotSize);
+  data.size = sizeof(ShmRingHeader) + _slotCount * data.stride;
+
+  data.fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (data.fd < 0)
+  {
+    gzerr << "Unable to create shared memory[" << _name << "]: "
+          << strerror(errno) << "\n";
+    return ShmRingPtr();
+  }
+  data.creator = true;
+
+  // The slots stay sparse until the writer reserves them.
+  if (ftruncate(data.fd, data.size) != 0 ||
+      posix_fallocate(data.fd, 0, sizeof(ShmRingHeader)) != 0)
+  {
+    gzerr << "Unable to size shared memory[" << _name << "]\n";
+    return ShmRingPtr();
+  }
+
+  data.memory = mmap(nullptr, data.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      data.fd, 0);
+  if (data.memory == MAP_FAILED)
+  {
+    data.memory = nullptr;
+    gzerr << "Unable to map shared memory[" << _name << "]: "
+          << strerror(errno) << "\n";
+    return ShmRingPtr();
+  }
+
+  // The reader only needs the mapping.
+  close(data.fd);
+  data.fd = -1;
+
+  ShmRingHeader *header = new(data.memory) ShmRingHeader;
+  header->magic = ShmRingMagic;
+  header->version = ShmRingVersion;
+  header->slotCount = _slotCount;
+  header->slotSize = _slotSize;
+  header->writeSeq.store(0);
+  header->readSeq.store(0);
+  header->dropped.store(0);
+  header->wakeup.store(0);
+  header->sleeping.store(0);
+  header->readWakeup.store(0);
+  header->writerSleeping.store(0);
+  header->closed.store(0);
+
+  return ring;
+#else
+  (void)_name;
+  (void)_slotCount;
+  (void)_slotSize;
+  return ShmRingPtr();
+#endif
+}
+
+/////////////////////////////////////////////////
+ShmRingPtr ShmRing::Create()
+{
+  return Create(UniqueName(),
+      EnvSize("GAZEBO_SHM_SLOT_COUNT", ShmRingDefaultSlotCount),
+      EnvSize("GAZEBO_SHM_SLOT_SIZE", ShmRingDefaultSlotSize));
+}
+
+/////////////////////////////////////////////////
+ShmRingPtr ShmRing::Open(const std::string &_name)
+{
+#ifdef __linux__
+  ShmRingPtr ring(new ShmRing);
+  ShmRingPrivate &data = *ring->dataPtr;
+  data.name = _name;
+
+  // Fails if the reader runs in another shared memory namespace, such as
+  // another container, even on the same host.
+  data.fd = shm_open(_name.c_str(), O_RDWR, 0600);
+  if (data.fd < 0)
+    return ShmRingPtr();
+  shm_unlink(_name.c_str());
+
+  struct stat st;
+  if (fstat(data.fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(ShmRingHeader))
+  {
+    return ShmRingPtr();
+  }
+  data.size = st.st_size;
+
+  data.memory = mmap(nullptr, data.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      data.fd, 0);
+  if (data.memory == MAP_FAILED)
+  {
+    data.memory = nullptr;
+    return ShmRingPtr();
+  }
+
+  // Check that the slots described by the header fit in the mapped size,
+  // without overflows, and only use the checked copies afterwards, since
+  // the other process may still change the header.
+  const ShmRingHeader *header = data.Header();
+  data.slotCount = header->slotCount;
+  data.slotSize = header->slotSize;
+  const size_t slotsSize = data.size - sizeof(ShmRingHeader);
+  if (header->magic != ShmRingMagic || header->version != ShmRingVersion ||
+      data.slotCount == 0 || data.slotSize == 0 ||
+      data.slotSize > slotsSize ||
+      data.slotCount > slotsSize / SlotStride(data.slotSize))
+  {
+    gzerr << "Invalid shared memory[" << _name << "]\n";
+    return ShmRingPtr();
+  }
+  data.stride = SlotStride(data.slotSize);
+  data.reserved.assign(data.slotCount, 0);
+
+  return ring;
+#else
+  (void)_name;
+  return ShmRingPtr();
+#endif
+}
+
+/////////////////////////////////////////////////
+bool ShmRing::Enabled()
+{
+#ifdef __linux__
+  const char *env = getenv("GAZEBO_SHM_TRANSPORT");
+  return !env || std::string(env) != "0";
+#else
+  return false;
+#endif
+}
+
+/////////////////////////////////////////////////
+std::string ShmRing::HostId()
+{
+  static const std::string id = []
+  {
+    std::string result = boost::asio::ip::host_name();
+
+    // Containers may reuse a host name, but not a boot id.
+    std::ifstream bootId("/proc/sys/kernel/random/boot_id");
+    std::string boot;
+    if (bootId >> boot)
+      result += "/" + boot;
+
+    return result;
+  }();
+
+  return id;
+}
+
+/////////////////////////////////////////////////
+std::string ShmRing::UniqueName()
+{
+  static std::atomic<unsigned int> counter(0);
+
+  std::ostringstream name;
+  name << "/gazebo_shm_"
+#ifdef __linux__
+       << getpid() << "_"
+#endif
+       << counter++ << "_" << std::chrono::steady_clock::now().
+         time_since_epoch().count();
+  return name.str();
+}
+
+/////////////////////////////////////////////////
+std::string ShmRing::GetName() const
+{
+  return this->dataPtr->name;
+}
+
+/////////////////////////////////////////////////
+size_t ShmRing::GetSlotSize() const
+{
+  return this->dataPtr->slotSize;
+}
+
+/////////////////////////////////////////////////
+uint64_t ShmRing::GetDropped() const
+{
+  return this->dataPtr->Header()->dropped.load();
+}
+
+/////////////////////////////////////////////////
+ShmRing::WriteResult ShmRing::Write(const std::string &_data,
+    unsigned int _timeoutMs)
+{
+#ifdef __linux__
+  std::lock_guard<std::mutex> lock(this->dataPtr->writeMutex);
+  ShmRingHeader *header = this->dataPtr->Header();
+
+  if (header->closed.load())
+    return CLOSED;
+
+  if (_data.size() > this->dataPtr->slotSize)
+    return TOO_LARGE;
+
+  const uint64_t seq = header->writeSeq.load(std::memory_order_relaxed);
+
+  // A reader that emptied the ring isn't stalled anymore.
+  if (this->dataPtr->stalled && header->readSeq.load() == seq)
+    this->dataPtr->stalled = false;
+
+  if (seq - header->readSeq.load() >= this->dataPtr->slotCount)
+  {
+    if (_timeoutMs > 0 && !this->dataPtr->stalled)
+    {
+      const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(_timeoutMs);
+      auto now = std::chrono::steady_clock::now();
+      while (seq - header->readSeq.load() >= this->dataPtr->slotCount &&
+             !header->closed.load() && now < deadline)
+      {
+        const uint32_t wakeup = header->readWakeup.load();
+        header->writerSleeping.store(1);
+        if (seq - header->readSeq.load() >= this->dataPtr->slotCount)
+        {
+          FutexWait(&header->readWakeup, wakeup, static_cast<unsigned int>(
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - now).count() + 1));
+        }
+        header->writerSleeping.store(0);
+        now = std::chrono::steady_clock::now();
+      }
+    }
+
+    if (header->closed.load())
+      return CLOSED;
+
+    if (seq - header->readSeq.load() >= this->dataPtr->slotCount)
+    {
+      if (_timeoutMs > 0)
+        this->dataPtr->stalled = true;
+      header->dropped++;
+      return FULL;
+    }
+  }
+
+  // Back the slot by memory before touching it, so that a full
+  // /dev/shm fails here instead of raising SIGBUS.
+  size_t &reserved =
+    this->dataPtr->reserved[seq % this->dataPtr->slotCount];
+  const size_t needed = sizeof(ShmRingSlot) + _data.size();
+  if (needed > reserved)
+  {
+    if (posix_fallocate(this->dataPtr->fd, this->dataPtr->SlotOffset(seq),
+          needed) != 0)
+    {
+      return TOO_LARGE;
+    }
+    reserved = needed;
+  }
+
+  ShmRingSlot *slot = this->dataPtr->Slot(seq);
+  memcpy(ShmRingPrivate::Payload(slot), _data.data(), _data.size());
+  slot->size = _data.size();
+  slot->seq.store(seq + 1, std::memory_order_release);
+
+  // Sequentially consistent with the reader's store to sleeping and load
+  // of writeSeq, so that either the reader sees the message or the writer
+  // sees the reader asleep.
+  header->writeSeq.store(seq + 1);
+  header->wakeup.fetch_add(1);
+  if (header->sleeping.load())
+    FutexWake(&header->wakeup);
+
+  return WRITTEN;
+#else
+  (void)_data;
+  (void)_timeoutMs;
+  return CLOSED;
+#endif
+}
+
+/////////////////////////////////////////////////
+bool ShmRing::Read(std::string &_data, unsigned int _timeoutMs)
+{
+#ifdef __linux__
+  ShmRingHeader *header = this->dataPtr->Header();
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(_timeoutMs);
+
+  while (!header->closed.load())
+  {
+    const uint64_t seq = header->readSeq.load(std::memory_order_relaxed);
+    if (header->writeSeq.load(std::memory_order_acquire) > seq)
+    {
+      ShmRingSlot *slot = this->dataPtr->Slot(seq);
+      if (slot->seq.load(std::memory_order_acquire) != seq + 1 ||
+          slot->size > this->dataPtr->slotSize)
+      {
+        gzerr << "Corrupted shared memory[" << this->dataPtr->name << "]\n";
+        this->Close();
+        return false;
+      }
+
+      _data.assign(ShmRingPrivate::Payload(slot), slot->size);
+      // Sequentially consistent, as in Write().
+      header->readSeq.store(seq + 1);
+      header->readWakeup.fetch_add(1);
+      if (header->writerSleeping.load())
+        FutexWake(&header->readWakeup);
+      return true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline)
+      return false;
+
+    const uint32_t wakeup = header->wakeup.load();
+    header->sleeping.store(1);
+    if (header->writeSeq.load() == seq && !header->closed.load())
+    {
+      FutexWait(&header->wakeup, wakeup, static_cast<unsigned int>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - now).count() + 1));
+    }
+    header->sleeping.store(0);
+  }
+  return false;
+#else
+  (void)_data;
+  (void)_timeoutMs;
+  return false;
+#endif
+}
+
+/////////////////////////////////////////////////
+void ShmRing::Close()
+{
+#ifdef __linux__
+  ShmRingHeader *header = this->dataPtr->Header();
+  header->closed.store(1);
+  header->wakeup.fetch_add(1);
+  header->readWakeup.fetch_add(1);
+  FutexWake(&header->wakeup);
+  FutexWake(&header->readWakeup);
+#endif
+}
+
+/////////////////////////////////////////////////
+bool ShmRing::IsClosed() const
+{
+  return this->dataPtr->Header()->closed.load() != 0;
+}
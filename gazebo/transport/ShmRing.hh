@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TRANSPORT_SHMRING_HH_
+#define GAZEBO_TRANSPORT_SHMRING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace transport
+  {
+    // Forward declare private class.
+    class ShmRingPrivate;
+
+    class ShmRing;
+
+    /// \brief Shared pointer to transport::ShmRing
+    typedef std::shared_ptr<ShmRing> ShmRingPtr;
+
+    /// \addtogroup gazebo_transport
+    /// \{
+
+    /// \class ShmRing ShmRing.hh transport/transport.hh
+    /// \brief Ring of message slots in POSIX shared memory, which carries
+    /// the messages of one topic from a publisher to a subscriber on the
+    /// same host, without going through the network stack.
+    ///
+    /// The subscriber creates the ring and reads it, the publisher opens it
+    /// by name and writes it. Each slot holds one serialized message and
+    /// the sequence number of that message. The publisher never overwrites
+    /// a slot that wasn't read: it drops the message instead, and counts
+    /// it, unless the subscriber makes room in time. Each side sleeps on a
+    /// futex in the ring while it waits for the other.
+    ///
+    /// Only supported on Linux. Set GAZEBO_SHM_TRANSPORT=0 to disable it,
+    /// and GAZEBO_SHM_SLOT_SIZE and GAZEBO_SHM_SLOT_COUNT to change the
+    /// size of the rings created by subscribers.
+    class GZ_TRANSPORT_VISIBLE ShmRing
+    {
+      /// \brief Result of Write().
+      public: enum WriteResult
+              {
+                /// \brief The message is in the ring.
+                WRITTEN,
+
+                /// \brief The ring was full, the message was dropped.
+                FULL,
+
+                /// \brief The message doesn't fit in a slot.
+                TOO_LARGE,
+
+                /// \brief The reader closed the ring.
+                CLOSED
+              };
+
+      /// \brief Destructor. Unmaps the ring.
+      public: ~ShmRing();
+
+      /// \brief Create a ring, to read it.
+      /// \param[in] _name Name of the shared memory object, see UniqueName().
+      /// \param[in] _slotCount Number of slots.
+      /// \param[in] _slotSize Largest message size.
+      /// \return The ring, or null on failure.
+      public: static ShmRingPtr Create(const std::string &_name,
+                  unsigned int _slotCount, size_t _slotSize);
+
+      /// \brief Create a ring with the size set by the environment, to read
+      /// it.
+      /// \return The ring, or null on failure.
+      public: static ShmRingPtr Create();
+
+      /// \brief Open a ring created by another process, to write it. The
+      /// name is removed afterwards, so that the memory is freed when both
+      /// processes unmap it.
+      /// \param[in] _name Name given to Create().
+      /// \return The ring, or null on failure.
+      public: static ShmRingPtr Open(const std::string &_name);
+
+      /// \brief Tell whether shared memory transport can be used.
+      /// \return False if it isn't supported, or disabled by
+      /// GAZEBO_SHM_TRANSPORT=0.
+      public: static bool Enabled();
+
+      /// \brief Get an identifier of this host. Two processes may share a
+      /// ring only if their identifiers are equal.
+      /// \return The host name and boot id.
+      public: static std::string HostId();
+
+      /// \brief Get a new name for a ring.
+      /// \return A name unique to this process and call.
+      public: static std::string UniqueName();
+
+      /// \brief Get the name of the shared memory object.
+      /// \return The name.
+      public: std::string GetName() const;
+
+      /// \brief Get the largest message size.
+      /// \return Size of a slot in bytes.
+      public: size_t GetSlotSize() const;
+
+      /// \brief Get the number of messages dropped because the ring was
+      /// full.
+      /// \return The number of dropped messages.
+      public: uint64_t GetDropped() const;
+
+      /// \brief Copy a message in the next slot, and wake up the reader.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _timeoutMs Longest wait for a free slot in milliseconds.
+      /// After a wait that timed out, the writer doesn't wait again until
+      /// the reader emptied the ring, so that a slow or stalled reader
+      /// doesn't stall the writer.
+      /// \return What happened to the message.
+      public: WriteResult Write(const std::string &_data,
+                  unsigned int _timeoutMs = 0);
+
+      /// \brief Copy out the oldest message, waiting for one if the ring is
+      /// empty.
+      /// \param[out] _data The message.
+      /// \param[in] _timeoutMs Longest wait in milliseconds.
+      /// \return False on timeout, or if the ring is closed.
+      public: bool Read(std::string &_data, unsigned int _timeoutMs);
+
+      /// \brief Close the ring. The writer stops writing it, and Read()
+      /// returns false from now on.
+      public: void Close();
+
+      /// \brief Tell whether the ring was closed.
+      /// \return True after Close().
+      public: bool IsClosed() const;
+
+      /// \brief Constructor, used by Create() and Open().
+      private: ShmRing();
+
+      /// \internal
+      /// \brief Private data.
+      private: std::unique_ptr<ShmRingPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
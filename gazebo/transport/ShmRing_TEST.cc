@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "gazebo/transport/ShmRing.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class ShmRing : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+// Messages written by another thread arrive in order, and the ring never
+// overwrites a message that wasn't read.
+TEST_F(ShmRing, WriteRead)
+{
+  if (!transport::ShmRing::Enabled())
+    return;
+
+  transport::ShmRingPtr reader =
+    transport::ShmRing::Create(transport::ShmRing::UniqueName(), 4, 1024);
+  ASSERT_TRUE(reader != nullptr);
+
+  transport::ShmRingPtr writer =
+    transport::ShmRing::Open(reader->GetName());
+  ASSERT_TRUE(writer != nullptr);
+  EXPECT_EQ(1024u, writer->GetSlotSize());
+
+  // The writer removed the name.
+  EXPECT_TRUE(transport::ShmRing::Open(reader->GetName()) == nullptr);
+
+  const unsigned int count = 10000;
+  std::thread thread([&writer, count]
+      {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+          const std::string data = std::to_string(i) + std::string(i % 1000,
+              'x');
+          while (writer->Write(data, 1000) == transport::ShmRing::FULL)
+            std::this_thread::yield();
+        }
+      });
+
+  std::string data;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    ASSERT_TRUE(reader->Read(data, 5000)) << i;
+    EXPECT_EQ(std::to_string(i) + std::string(i % 1000, 'x'), data);
+  }
+  thread.join();
+
+  // The writer waited for free slots.
+  EXPECT_EQ(0u, reader->GetDropped());
+
+  // Empty ring
+  EXPECT_FALSE(reader->Read(data, 10));
+}
+
+/////////////////////////////////////////////////
+TEST_F(ShmRing, FullAndTooLarge)
+{
+  if (!transport::ShmRing::Enabled())
+    return;
+
+  transport::ShmRingPtr reader =
+    transport::ShmRing::Create(transport::ShmRing::UniqueName(), 2, 16);
+  ASSERT_TRUE(reader != nullptr);
+  transport::ShmRingPtr writer = transport::ShmRing::Open(reader->GetName());
+  ASSERT_TRUE(writer != nullptr);
+
+  EXPECT_EQ(transport::ShmRing::TOO_LARGE, writer->Write(std::string(17, 'x')));
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("a"));
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("b"));
+  EXPECT_EQ(transport::ShmRing::FULL, writer->Write("c"));
+  EXPECT_EQ(1u, reader->GetDropped());
+
+  // After a wait that timed out, the writer doesn't wait anymore.
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(transport::ShmRing::FULL, writer->Write("c", 20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(20));
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(transport::ShmRing::FULL, writer->Write("c", 10000));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+      std::chrono::seconds(5));
+  EXPECT_EQ(3u, reader->GetDropped());
+
+  // Reading some messages isn't enough, the reader must empty the ring.
+  std::string data;
+  EXPECT_TRUE(reader->Read(data, 0));
+  EXPECT_EQ("a", data);
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("d", 10000));
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(transport::ShmRing::FULL, writer->Write("e", 10000));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+      std::chrono::seconds(5));
+  EXPECT_TRUE(reader->Read(data, 0));
+  EXPECT_EQ("b", data);
+  EXPECT_TRUE(reader->Read(data, 0));
+  EXPECT_EQ("d", data);
+
+  // The writer waits again once the ring was empty.
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("f"));
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("g"));
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(transport::ShmRing::FULL, writer->Write("h", 20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(20));
+}
+
+/////////////////////////////////////////////////
+// A full ring makes the writer wait for the reader.
+TEST_F(ShmRing, WaitForReader)
+{
+  if (!transport::ShmRing::Enabled())
+    return;
+
+  transport::ShmRingPtr reader =
+    transport::ShmRing::Create(transport::ShmRing::UniqueName(), 1, 16);
+  ASSERT_TRUE(reader != nullptr);
+  transport::ShmRingPtr writer = transport::ShmRing::Open(reader->GetName());
+  ASSERT_TRUE(writer != nullptr);
+
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("a"));
+
+  std::string first;
+  std::thread thread([&reader, &first]
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reader->Read(first, 1000);
+      });
+
+  EXPECT_EQ(transport::ShmRing::WRITTEN, writer->Write("b", 10000));
+  thread.join();
+  EXPECT_EQ("a", first);
+  EXPECT_EQ(0u, writer->GetDropped());
+
+  std::string data;
+  EXPECT_TRUE(reader->Read(data, 0));
+  EXPECT_EQ("b", data);
+}
+
+/////////////////////////////////////////////////
+// Closing the ring wakes up a sleeping reader, and stops the writer.
+TEST_F(ShmRing, Close)
+{
+  if (!transport::ShmRing::Enabled())
+    return;
+
+  transport::ShmRingPtr reader =
+    transport::ShmRing::Create(transport::ShmRing::UniqueName(), 2, 16);
+  ASSERT_TRUE(reader != nullptr);
+  transport::ShmRingPtr writer = transport::ShmRing::Open(reader->GetName());
+  ASSERT_TRUE(writer != nullptr);
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread thread([&reader]
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        reader->Close();
+      });
+
+  std::string data;
+  EXPECT_FALSE(reader->Read(data, 10000));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+      std::chrono::seconds(5));
+  thread.join();
+
+  EXPECT_TRUE(writer->IsClosed());
+  EXPECT_EQ(transport::ShmRing::CLOSED, writer->Write("a"));
+}
+
+/////////////////////////////////////////////////
+TEST_F(ShmRing, OpenMissing)
+{
+  EXPECT_TRUE(transport::ShmRing::Open(
+        transport::ShmRing::UniqueName()) == nullptr);
+  EXPECT_FALSE(transport::ShmRing::HostId().empty());
+}
+
+/////////////////////////////////////////////////
+// A header that describes more slots, or larger slots, than the shared
+// memory holds is rejected.
+TEST_F(ShmRing, OpenInvalidHeader)
+{
+#ifdef __linux__
+  if (!transport::ShmRing::Enabled())
+    return;
+
+  // Offsets of slotCount and slotSize in the header, after the 32 bit
+  // magic number and version.
+  for (const size_t offset : {8u, 16u})
+  {
+    transport::ShmRingPtr reader =
+      transport::ShmRing::Create(transport::ShmRing::UniqueName(), 4, 1024);
+    ASSERT_TRUE(reader != nullptr);
+
+    const int fd = shm_open(reader->GetName().c_str(), O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    void *memory = mmap(nullptr, 64, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+        0);
+    close(fd);
+    ASSERT_NE(MAP_FAILED, memory);
+    if (offset == 8u)
+    {
+      const uint32_t slotCount = UINT32_MAX;
+      memcpy(static_cast<char *>(memory) + offset, &slotCount,
+          sizeof(slotCount));
+    }
+    else
+    {
+      const uint64_t slotSize = UINT64_MAX / 2;
+      memcpy(static_cast<char *>(memory) + offset, &slotSize,
+          sizeof(slotSize));
+    }
+    munmap(memory, 64);
+
+    EXPECT_TRUE(transport::ShmRing::Open(reader->GetName()) == nullptr)
+      << offset;
+  }
+#endif
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -34,9 +34,25 @@ namespace gazebo
     /// \brief Options for a subscription
     class GZ_TRANSPORT_VISIBLE SubscribeOptions
     {
+      /// \brief Where the callback of a subscription runs.
+      public: enum CallbackExecutor
+              {
+                /// \brief On the ConnectionManager thread, one callback
+                /// after the other with every subscription of the process.
+                CONNECTION_THREAD,
+
+                /// \brief On a thread owned by the subscription.
+                DEDICATED_THREAD,
+
+                /// \brief On the TBB worker threads shared by the process.
+                /// A subscription runs one callback at a time.
+                SHARED_POOL
+              };
+
       /// \brief Constructor
       public: SubscribeOptions()
-              : latching(false)
+              : latching(false), executor(CONNECTION_THREAD), queueDepth(0),
+                keepLatest(false)
               {}
 
       /// \brief Initialize the options
@@ -103,10 +119,89 @@ namespace gazebo
                 return this->latching;
               }
 
+      /// \brief Set whether to latch the latest message.
+      /// \param[in] _latching If true, latch the latest message; if false,
+      /// don't latch
+      public: void SetLatching(const bool _latching)
+              {
+                this->latching = _latching;
+              }
+
+      /// \brief Set where the callback runs. With an executor other than
+      /// CONNECTION_THREAD, incoming messages are queued for the
+      /// subscription, so a slow callback doesn't hold up the other
+      /// subscriptions of the process.
+      /// \param[in] _executor Where the callback runs.
+      public: void SetExecutor(const CallbackExecutor _executor)
+              {
+                this->executor = _executor;
+              }
+
+      /// \brief Get where the callback runs.
+      /// \return Where the callback runs.
+      public: CallbackExecutor GetExecutor() const
+              {
+                return this->executor;
+              }
+
+      /// \brief Set the largest number of messages waiting for the
+      /// callback. When the queue is full, the oldest message is dropped.
+      /// With CONNECTION_THREAD, the queue holds the messages received
+      /// between two runs of the ConnectionManager thread.
+      /// \param[in] _depth Largest number of waiting messages, 0 for no
+      /// limit.
+      public: void SetQueueDepth(const unsigned int _depth)
+              {
+                this->queueDepth = _depth;
+              }
+
+      /// \brief Get the largest number of messages waiting for the
+      /// callback, see SetQueueDepth.
+      /// \return Largest number of waiting messages, 0 for no limit. It is
+      /// 1 when keeping the latest message only.
+      public: unsigned int GetQueueDepth() const
+              {
+                return this->keepLatest ? 1u : this->queueDepth;
+              }
+
+      /// \brief Set whether only the latest message waits for the
+      /// callback, which suits topics such as poses and images where a
+      /// stale message is of no use.
+      /// \param[in] _keepLatest True to keep the latest message only.
+      public: void SetKeepLatest(const bool _keepLatest)
+              {
+                this->keepLatest = _keepLatest;
+              }
+
+      /// \brief Get whether only the latest message waits for the
+      /// callback.
+      /// \return True if only the latest message is kept.
+      public: bool GetKeepLatest() const
+              {
+                return this->keepLatest;
+              }
+
+      /// \brief Whether the subscription needs a queue of its own.
+      /// \return True if the options set an executor or a queue depth.
+      public: bool IsQueued() const
+              {
+                return this->executor != CONNECTION_THREAD ||
+                       this->GetQueueDepth() > 0;
+              }
+
       private: std::string topic;
       private: std::string msgType;
       private: NodePtr node;
       private: bool latching;
+
+      /// \brief Where the callback runs.
+      private: CallbackExecutor executor;
+
+      /// \brief Largest number of waiting messages, 0 for no limit.
+      private: unsigned int queueDepth;
+
+      /// \brief True to keep the latest message only.
+      private: bool keepLatest;
     };
     /// \}
   }
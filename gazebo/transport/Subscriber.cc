@@ -53,6 +53,14 @@ void Subscriber::Unsubscribe() const
   }
 }
 
+//////////////////////////////////////////////////
+bool Subscriber::GetQueueStats(CallbackQueueStats &_stats) const
+{
+  if (!this->node)
+    return false;
+  return this->node->GetQueueStats(this->topic, this->callbackId, _stats);
+}
+
 //////////////////////////////////////////////////
 void Subscriber::SetCallbackId(unsigned int _id)
 {
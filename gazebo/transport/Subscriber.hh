@@ -25,6 +25,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include "gazebo/transport/CallbackHelper.hh"
+#include "gazebo/transport/QueuedCallbackHelper.hh"
 #include "gazebo/util/system.hh"
 
 namespace gazebo
@@ -65,6 +66,12 @@ namespace gazebo
       /// \brief Unsubscribe from the topic
       public: void Unsubscribe() const;
 
+      /// \brief Get the counters of the message queue of the subscription.
+      /// \param[out] _stats Counters of the queue.
+      /// \return False if the subscription has no queue of its own, see
+      /// SubscribeOptions::SetExecutor and SubscribeOptions::SetQueueDepth.
+      public: bool GetQueueStats(CallbackQueueStats &_stats) const;
+
       /// \brief Topic this object is subscribe to.
       private: std::string topic;
 
@@ -16,6 +16,7 @@
 */
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include "gazebo/common/Console.hh"
 #include "gazebo/transport/ConnectionManager.hh"
 #include "gazebo/transport/SubscriptionTransport.hh"
 
@@ -43,6 +44,49 @@ void SubscriptionTransport::Init(ConnectionPtr _conn, bool _latching)
   this->latching = _latching;
 }
 
+//////////////////////////////////////////////////
+bool SubscriptionTransport::OpenSharedMemory(const std::string &_name)
+{
+  this->ring = ShmRing::Open(_name);
+  return this->ring != nullptr;
+}
+
+//////////////////////////////////////////////////
+bool SubscriptionTransport::WriteRing(const std::string &_newdata,
+    const boost::function<void(uint32_t)> &_cb, uint32_t _id, bool &_result)
+{
+  // A subscriber that died leaves the ring behind, but not the connection.
+  if (!this->ring || !this->connection->IsOpen())
+    return false;
+
+  // Never wait for a free slot, so that a slow subscriber can't block
+  // Publish. The ring drops and counts the messages that don't fit.
+  switch (this->ring->Write(_newdata))
+  {
+    case ShmRing::WRITTEN:
+    case ShmRing::FULL:
+      _result = true;
+      break;
+    case ShmRing::CLOSED:
+      this->ring.reset();
+      this->connection.reset();
+      _result = false;
+      return true;
+    case ShmRing::TOO_LARGE:
+      gzwarn << "Unable to write a message of " << _newdata.size()
+             << " bytes to shared memory slots of "
+             << this->ring->GetSlotSize() << " bytes, using TCP from now on. "
+             << "Set GAZEBO_SHM_SLOT_SIZE on the subscriber to change the "
+             << "slot size.\n";
+      this->ring.reset();
+      return false;
+  }
+
+  if (!_cb.empty())
+    _cb(_id);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool SubscriptionTransport::HandleMessage(MessagePtr _newMsg)
 {
@@ -56,6 +100,9 @@ bool SubscriptionTransport::HandleData(const std::string &_newdata,
     boost::function<void(uint32_t)> _cb, uint32_t _id)
 {
   bool result = false;
+  if (this->WriteRing(_newdata, _cb, _id, result))
+    return result;
+
   if (this->connection->IsOpen())
   {
     this->connection->EnqueueMsg(_newdata, _cb, _id);
@@ -67,6 +114,38 @@ bool SubscriptionTransport::HandleData(const std::string &_newdata,
   return result;
 }
 
+//////////////////////////////////////////////////
+bool SubscriptionTransport::HandleData(
+    const boost::shared_ptr<const std::string> &_newdata,
+    boost::function<void(uint32_t)> _cb, uint32_t _id)
+{
+  bool result = false;
+  if (this->WriteRing(*_newdata, _cb, _id, result))
+    return result;
+
+  if (this->connection->IsOpen())
+  {
+    this->connection->EnqueueMsg(_newdata, _cb, _id);
+    result = true;
+  }
+  else
+    this->connection.reset();
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool SubscriptionTransport::UsesSharedMemory() const
+{
+  return this->ring != nullptr;
+}
+
+//////////////////////////////////////////////////
+uint64_t SubscriptionTransport::GetSharedMemoryDropped() const
+{
+  return this->ring ? this->ring->GetDropped() : 0;
+}
+
 //////////////////////////////////////////////////
 const ConnectionPtr &SubscriptionTransport::GetConnection() const
 {
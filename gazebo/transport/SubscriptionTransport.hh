@@ -23,6 +23,7 @@
 
 #include "Connection.hh"
 #include "CallbackHelper.hh"
+#include "ShmRing.hh"
 #include "gazebo/util/system.hh"
 
 namespace gazebo
@@ -50,6 +51,14 @@ namespace gazebo
       /// don't latch
       public: void Init(ConnectionPtr _conn, bool _latching);
 
+      /// \brief Write the data to a shared memory ring created by the
+      /// subscriber, instead of the connection. Messages that don't fit in
+      /// the ring are sent on the connection, and so are all the following
+      /// ones, to keep their order.
+      /// \param[in] _name Name of the ring.
+      /// \return True if the ring was opened.
+      public: bool OpenSharedMemory(const std::string &_name);
+
       /// \brief Output a message to a connection
       /// \param[in] _newdata The message to be handled
       /// \return true if the message was handled successfully, false otherwise
@@ -59,9 +68,32 @@ namespace gazebo
       public: virtual bool HandleData(const std::string &_newdata,
                   boost::function<void(uint32_t)> _cb, uint32_t _id);
 
+      /// \brief Output shared message data to a connection, without
+      /// copying it.
+      /// \param[in] _newdata The message to be handled. It must not be
+      /// modified afterwards.
+      /// \param[in] _cb If non-null, callback to be invoked after
+      /// transmission is complete.
+      /// \param[in] _id ID associated with the message data.
+      /// \return true if the message was handled successfully, false otherwise
+      public: bool HandleData(
+                  const boost::shared_ptr<const std::string> &_newdata,
+                  boost::function<void(uint32_t)> _cb, uint32_t _id);
+
       // Documentation inherited
       public: virtual bool HandleMessage(MessagePtr _newMsg);
 
+      /// \brief Tell whether the messages are written to a shared memory
+      /// ring instead of the connection.
+      /// \return True if a ring is in use.
+      public: bool UsesSharedMemory() const;
+
+      /// \brief Get the number of messages dropped because the shared
+      /// memory ring was full. Messages are never waited for, so a slow
+      /// subscriber loses messages instead of blocking the publisher.
+      /// \return Number of dropped messages, 0 without a ring.
+      public: uint64_t GetSharedMemoryDropped() const;
+
       /// \brief Get the connection we're using
       /// \return Pointer to the connection we're using
       public: const ConnectionPtr &GetConnection() const;
@@ -71,7 +103,21 @@ namespace gazebo
       /// is tied to a  remote connection
       public: virtual bool IsLocal() const;
 
+      /// \brief Write the data to the shared memory ring, if any.
+      /// \param[in] _newdata The message.
+      /// \param[in] _cb If non-null, callback to be invoked after the
+      /// message was written.
+      /// \param[in] _id ID associated with the message data.
+      /// \param[out] _result Return value of HandleData.
+      /// \return True if the message was handled.
+      private: bool WriteRing(const std::string &_newdata,
+                   const boost::function<void(uint32_t)> &_cb, uint32_t _id,
+                   bool &_result);
+
       private: ConnectionPtr connection;
+
+      /// \brief Shared memory ring of the subscriber, if any.
+      private: ShmRingPtr ring;
     };
     /// \}
   }
@@ -21,6 +21,7 @@
 #include "gazebo/msgs/msgs.hh"
 #include "gazebo/transport/Node.hh"
 #include "gazebo/transport/Publication.hh"
+#include "gazebo/transport/ShmRing.hh"
 #include "gazebo/transport/TopicManager.hh"
 
 using namespace gazebo;
@@ -354,7 +355,11 @@ void TopicManager::ConnectSubToPub(const msgs::Publish &_pub)
         }
       }
 
-      publink->Init(conn, latched);
+      // Read through shared memory if the publisher runs on this host.
+      bool sharedMemory = _pub.has_shm_host() && ShmRing::Enabled() &&
+        _pub.shm_host() == ShmRing::HostId();
+
+      publink->Init(conn, latched, _pub.binary_framing(), sharedMemory);
 
       publication->AddTransport(publink);
     }
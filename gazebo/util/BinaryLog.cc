@@ -0,0 +1,603 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/util/BinaryLog.hh"
+
+using namespace gazebo;
+using namespace util;
+
+/// \brief Version of the binary container format.
+static const uint32_t kFormatVersion = 1;
+
+/// \brief Magic string at the beginning of each chunk.
+static const char kChunkMagic[] = "GZCK";
+
+/// \brief Magic string at the beginning of the index.
+static const char kIndexMagic[] = "GZIX";
+
+/// \brief Magic string at the end of the file.
+static const char kEndMagic[] = "GZLOGEND";
+
+/// \brief Size of the footer: index offset and end magic.
+static const size_t kFooterSize = 16;
+
+/// \brief Size of an entry in the index.
+static const size_t kIndexEntrySize = 36;
+
+/// \brief Largest compression ratio expected from zlib, used to bound the
+/// memory reserved for a chunk before decompressing it.
+static const uint64_t kMaxCompressionRatio = 1032;
+
+/// \brief Chunk payload compression types.
+static const uint8_t kCompressionNone = 0;
+static const uint8_t kCompressionZlib = 1;
+
+const char BinaryLog::kFileMagic[9] = "GZLOGBIN";
+
+/////////////////////////////////////////////////
+/// \brief Get the number of bytes left to read in a stream.
+/// \param[in] _in The stream, its read position is left unchanged.
+/// \return Number of bytes after the read position.
+static uint64_t remainingBytes(std::istream &_in)
+{
+  const std::streampos pos = _in.tellg();
+  if (pos < 0 || !_in.seekg(0, std::ios::end))
+  {
+    _in.clear();
+    return 0;
+  }
+  const std::streampos end = _in.tellg();
+  _in.seekg(pos);
+  return end > pos ? static_cast<uint64_t>(end - pos) : 0;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a little-endian value from a stream.
+/// \param[in] _in The stream.
+/// \param[out] _value Value read.
+/// \return False if there is not enough data left.
+template<typename T>
+static bool readValue(std::istream &_in, T &_value)
+{
+  char bytes[sizeof(T)];
+  if (!_in.read(bytes, sizeof(bytes)))
+    return false;
+  return BinaryLogReader(bytes, sizeof(bytes)).Read(_value);
+}
+
+/////////////////////////////////////////////////
+BinaryLogWriter::BinaryLogWriter(std::string &_buffer)
+  : buffer(_buffer)
+{
+}
+
+/////////////////////////////////////////////////
+void BinaryLogWriter::WriteString(const std::string &_str)
+{
+  this->Write(static_cast<uint32_t>(_str.size()));
+  this->buffer.append(_str);
+}
+
+/////////////////////////////////////////////////
+void BinaryLogWriter::WriteTime(const common::Time &_time)
+{
+  this->Write(_time.sec);
+  this->Write(_time.nsec);
+}
+
+/////////////////////////////////////////////////
+void BinaryLogWriter::WriteVector3(const ignition::math::Vector3d &_vec)
+{
+  this->Write(_vec.X());
+  this->Write(_vec.Y());
+  this->Write(_vec.Z());
+}
+
+/////////////////////////////////////////////////
+void BinaryLogWriter::WritePose(const ignition::math::Pose3d &_pose)
+{
+  this->WriteVector3(_pose.Pos());
+  this->Write(_pose.Rot().W());
+  this->Write(_pose.Rot().X());
+  this->Write(_pose.Rot().Y());
+  this->Write(_pose.Rot().Z());
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogWriter::WriteDeltaPose(const ignition::math::Pose3d &_delta)
+{
+  const double maxSteps = std::numeric_limits<int32_t>::max();
+  int32_t pos[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    double steps = std::round(_delta.Pos()[i] / BinaryLog::kDeltaPosition);
+    if (std::abs(steps) > maxSteps)
+      return false;
+    pos[i] = static_cast<int32_t>(steps);
+  }
+
+  // Store the vector part of the quaternion with a positive w, so w can be
+  // recovered from the unit norm.
+  const ignition::math::Quaterniond &rot = _delta.Rot();
+  const double sign = rot.W() < 0 ? -1.0 : 1.0;
+  const double comps[3] = {rot.X(), rot.Y(), rot.Z()};
+
+  for (int i = 0; i < 3; ++i)
+    this->Write(pos[i]);
+  for (int i = 0; i < 3; ++i)
+  {
+    this->Write(static_cast<int32_t>(
+          std::round(sign * comps[i] / BinaryLog::kDeltaRotation)));
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+size_t BinaryLogWriter::BeginFrame(const BinaryLogFrameType _type,
+    const common::Time &_simTime, const uint64_t _iterations)
+{
+  size_t offset = this->buffer.size();
+  this->buffer.push_back('G');
+  this->buffer.push_back('Z');
+  this->Write(static_cast<uint8_t>(_type));
+  this->Write(static_cast<uint8_t>(0));
+  this->Write(static_cast<uint32_t>(0));
+  this->WriteTime(_simTime);
+  this->Write(_iterations);
+  return offset;
+}
+
+/////////////////////////////////////////////////
+void BinaryLogWriter::EndFrame(const size_t _offset)
+{
+  std::string size;
+  BinaryLogWriter(size).Write(static_cast<uint32_t>(
+      this->buffer.size() - _offset - BinaryLogFrameHeader::kSize));
+  this->buffer.replace(_offset + 4, size.size(), size);
+}
+
+/////////////////////////////////////////////////
+BinaryLogReader::BinaryLogReader(const char *_data, const size_t _size)
+  : data(_data), size(_size)
+{
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadString(std::string &_str)
+{
+  uint32_t length;
+  if (!this->Read(length) || this->Remaining() < length)
+    return false;
+
+  _str.assign(this->data + this->offset, length);
+  this->offset += length;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadTime(common::Time &_time)
+{
+  return this->Read(_time.sec) && this->Read(_time.nsec);
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadVector3(ignition::math::Vector3d &_vec)
+{
+  double x, y, z;
+  if (!this->Read(x) || !this->Read(y) || !this->Read(z))
+    return false;
+  _vec.Set(x, y, z);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadPose(ignition::math::Pose3d &_pose)
+{
+  ignition::math::Vector3d pos;
+  double w, x, y, z;
+  if (!this->ReadVector3(pos) || !this->Read(w) || !this->Read(x) ||
+      !this->Read(y) || !this->Read(z))
+  {
+    return false;
+  }
+  _pose.Set(pos, ignition::math::Quaterniond(w, x, y, z));
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadDeltaPose(ignition::math::Pose3d &_delta)
+{
+  int32_t values[6];
+  for (int i = 0; i < 6; ++i)
+  {
+    if (!this->Read(values[i]))
+      return false;
+  }
+
+  double x = values[3] * BinaryLog::kDeltaRotation;
+  double y = values[4] * BinaryLog::kDeltaRotation;
+  double z = values[5] * BinaryLog::kDeltaRotation;
+  double w = std::sqrt(std::max(0.0, 1.0 - x*x - y*y - z*z));
+
+  _delta.Set(ignition::math::Vector3d(
+        values[0] * BinaryLog::kDeltaPosition,
+        values[1] * BinaryLog::kDeltaPosition,
+        values[2] * BinaryLog::kDeltaPosition),
+      ignition::math::Quaterniond(w, x, y, z));
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::ReadFrameHeader(BinaryLogFrameHeader &_header)
+{
+  if (this->Remaining() < BinaryLogFrameHeader::kSize ||
+      this->data[this->offset] != 'G' || this->data[this->offset + 1] != 'Z')
+  {
+    return false;
+  }
+  this->offset += 2;
+
+  uint8_t type, reserved;
+  this->Read(type);
+  this->Read(reserved);
+  this->Read(_header.size);
+  this->ReadTime(_header.simTime);
+  this->Read(_header.iterations);
+  _header.type = static_cast<BinaryLogFrameType>(type);
+
+  return this->Remaining() >= _header.size;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLogReader::Skip(const size_t _bytes)
+{
+  if (this->Remaining() < _bytes)
+    return false;
+  this->offset += _bytes;
+  return true;
+}
+
+/////////////////////////////////////////////////
+size_t BinaryLogReader::Offset() const
+{
+  return this->offset;
+}
+
+/////////////////////////////////////////////////
+const char *BinaryLogReader::Data() const
+{
+  return this->data;
+}
+
+/////////////////////////////////////////////////
+size_t BinaryLogReader::Remaining() const
+{
+  return this->size - this->offset;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::IsBinaryLog(const std::string &_filename)
+{
+  std::ifstream in(_filename, std::ios::binary);
+  char magic[8];
+  if (!in.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, kFileMagic, sizeof(magic)) == 0;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::IsFrame(const std::string &_data)
+{
+  BinaryLogReader reader(_data.data(), _data.size());
+  BinaryLogFrameHeader header;
+  return reader.ReadFrameHeader(header);
+}
+
+/////////////////////////////////////////////////
+void BinaryLog::WriteFileHeader(std::string &_buffer,
+    const std::string &_logVersion, const std::string &_gazeboVersion,
+    const uint32_t _randSeed)
+{
+  BinaryLogWriter writer(_buffer);
+  _buffer.append(kFileMagic, 8);
+  writer.Write(kFormatVersion);
+  writer.WriteString(_logVersion);
+  writer.WriteString(_gazeboVersion);
+  writer.Write(_randSeed);
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::ReadFileHeader(std::istream &_in, std::string &_logVersion,
+    std::string &_gazeboVersion, uint32_t &_randSeed)
+{
+  // Magic and format version
+  char fixed[12];
+  if (!_in.read(fixed, sizeof(fixed)) ||
+      std::memcmp(fixed, kFileMagic, 8) != 0)
+  {
+    return false;
+  }
+
+  uint32_t version;
+  BinaryLogReader(fixed + 8, sizeof(version)).Read(version);
+  if (version != kFormatVersion)
+  {
+    gzerr << "Unsupported binary log format version[" << version << "]\n";
+    return false;
+  }
+
+  auto readString = [&_in](std::string &_str)
+  {
+    // Don't trust the length before allocating the string.
+    uint32_t length;
+    if (!readValue(_in, length) || length > remainingBytes(_in))
+      return false;
+    _str.resize(length);
+    return length == 0 || static_cast<bool>(_in.read(&_str[0], length));
+  };
+
+  return readString(_logVersion) && readString(_gazeboVersion) &&
+    readValue(_in, _randSeed);
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::WriteChunk(const std::string &_frames, std::string &_buffer,
+    BinaryLogChunkInfo &_info)
+{
+  // Summarize the frames for the index.
+  _info.frameCount = 0;
+  BinaryLogReader reader(_frames.data(), _frames.size());
+  BinaryLogFrameHeader header;
+  while (reader.Remaining() > 0)
+  {
+    if (!reader.ReadFrameHeader(header))
+    {
+      gzerr << "Invalid frame in binary log chunk\n";
+      return false;
+    }
+    reader.Skip(header.size);
+
+    if (_info.frameCount == 0)
+    {
+      _info.startTime = header.simTime;
+      _info.iterations = header.iterations;
+    }
+    _info.endTime = header.simTime;
+    _info.frameCount++;
+  }
+
+  if (_info.frameCount == 0)
+    return false;
+
+  std::string payload;
+  {
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::zlib_compressor());
+    out.push(std::back_inserter(payload));
+    boost::iostreams::copy(boost::make_iterator_range(_frames), out);
+  }
+
+  BinaryLogWriter writer(_buffer);
+  _buffer.append(kChunkMagic, 4);
+  writer.Write(kCompressionZlib);
+  writer.Write(static_cast<uint8_t>(0));
+  writer.Write(static_cast<uint16_t>(0));
+  writer.Write(_info.frameCount);
+  writer.WriteTime(_info.startTime);
+  writer.WriteTime(_info.endTime);
+  writer.Write(_info.iterations);
+  writer.Write(static_cast<uint64_t>(_frames.size()));
+  writer.Write(static_cast<uint64_t>(payload.size()));
+  _buffer.append(payload);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::ReadChunkHeader(const char *_data, const size_t _size,
+    BinaryLogChunkInfo &_info, uint64_t &_chunkSize)
+{
+  if (_size < kChunkHeaderSize || std::memcmp(_data, kChunkMagic, 4) != 0)
+    return false;
+
+  BinaryLogReader reader(_data + 8, kChunkHeaderSize - 8);
+  uint64_t uncompressedSize, payloadSize;
+  reader.Read(_info.frameCount);
+  reader.ReadTime(_info.startTime);
+  reader.ReadTime(_info.endTime);
+  reader.Read(_info.iterations);
+  reader.Read(uncompressedSize);
+  reader.Read(payloadSize);
+
+  // The payload size comes from the file, it must not wrap the sum.
+  if (payloadSize > std::numeric_limits<uint64_t>::max() - kChunkHeaderSize)
+    return false;
+
+  _chunkSize = kChunkHeaderSize + payloadSize;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::ReadChunk(const char *_data, const size_t _size,
+    std::string &_frames, BinaryLogChunkInfo &_info, uint64_t &_chunkSize)
+{
+  if (!ReadChunkHeader(_data, _size, _info, _chunkSize) ||
+      _chunkSize - kChunkHeaderSize > _size - kChunkHeaderSize)
+  {
+    return false;
+  }
+
+  uint8_t compression = static_cast<uint8_t>(_data[4]);
+  uint64_t uncompressedSize;
+  BinaryLogReader(_data + 36, sizeof(uncompressedSize)).Read(uncompressedSize);
+
+  const char *payload = _data + kChunkHeaderSize;
+  size_t payloadSize = _chunkSize - kChunkHeaderSize;
+
+  _frames.clear();
+  if (compression == kCompressionNone)
+  {
+    _frames.assign(payload, payloadSize);
+  }
+  else if (compression == kCompressionZlib)
+  {
+    // The uncompressed size comes from the file, zlib can't expand the
+    // payload more than kMaxCompressionRatio times.
+    if (uncompressedSize / kMaxCompressionRatio > payloadSize)
+      return false;
+    _frames.reserve(uncompressedSize);
+
+    try
+    {
+      boost::iostreams::filtering_istream in;
+      in.push(boost::iostreams::zlib_decompressor());
+      in.push(boost::make_iterator_range(payload, payload + payloadSize));
+      boost::iostreams::copy(in, std::back_inserter(_frames));
+    }
+    catch(boost::iostreams::zlib_error &_e)
+    {
+      gzerr << "Invalid binary log chunk payload: " << _e.what() << "\n";
+      return false;
+    }
+  }
+  else
+  {
+    gzerr << "Unknown binary log chunk compression["
+      << static_cast<int>(compression) << "]\n";
+    return false;
+  }
+
+  return _frames.size() == uncompressedSize;
+}
+
+/////////////////////////////////////////////////
+void BinaryLog::WriteIndex(const std::vector<BinaryLogChunkInfo> &_chunks,
+    const uint64_t _indexOffset, std::string &_buffer)
+{
+  BinaryLogWriter writer(_buffer);
+  _buffer.append(kIndexMagic, 4);
+  writer.Write(static_cast<uint64_t>(_chunks.size()));
+  for (auto const &chunk : _chunks)
+  {
+    writer.Write(chunk.offset);
+    writer.WriteTime(chunk.startTime);
+    writer.WriteTime(chunk.endTime);
+    writer.Write(chunk.iterations);
+    writer.Write(chunk.frameCount);
+  }
+  writer.Write(_indexOffset);
+  _buffer.append(kEndMagic, 8);
+}
+
+/////////////////////////////////////////////////
+bool BinaryLog::ReadIndex(std::istream &_in,
+    std::vector<BinaryLogChunkInfo> &_chunks)
+{
+  _chunks.clear();
+
+  // Read the footer
+  char footer[kFooterSize];
+  _in.clear();
+  if (!_in.seekg(-static_cast<int>(kFooterSize), std::ios::end) ||
+      !_in.read(footer, kFooterSize) ||
+      std::memcmp(footer + 8, kEndMagic, 8) != 0)
+  {
+    _in.clear();
+    return false;
+  }
+
+  uint64_t indexOffset;
+  BinaryLogReader(footer, sizeof(indexOffset)).Read(indexOffset);
+
+  // Read the index
+  char head[12];
+  if (!_in.seekg(indexOffset) || !_in.read(head, sizeof(head)) ||
+      std::memcmp(head, kIndexMagic, 4) != 0)
+  {
+    _in.clear();
+    return false;
+  }
+
+  uint64_t count;
+  BinaryLogReader(head + 4, sizeof(count)).Read(count);
+
+  // Don't trust the count before allocating the entries.
+  if (count > remainingBytes(_in) / kIndexEntrySize)
+  {
+    _in.clear();
+    return false;
+  }
+
+  std::string entries(count * kIndexEntrySize, '\0');
+  if (!entries.empty() && !_in.read(&entries[0], entries.size()))
+  {
+    _in.clear();
+    return false;
+  }
+
+  BinaryLogReader reader(entries.data(), entries.size());
+  _chunks.resize(count);
+  for (auto &chunk : _chunks)
+  {
+    reader.Read(chunk.offset);
+    reader.ReadTime(chunk.startTime);
+    reader.ReadTime(chunk.endTime);
+    reader.Read(chunk.iterations);
+    reader.Read(chunk.frameCount);
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void BinaryLog::RebuildIndex(std::istream &_in, const uint64_t _firstChunk,
+    std::vector<BinaryLogChunkInfo> &_chunks)
+{
+  _chunks.clear();
+  _in.clear();
+
+  uint64_t offset = _firstChunk;
+  char header[kChunkHeaderSize];
+  while (_in.seekg(offset) && _in.read(header, kChunkHeaderSize))
+  {
+    BinaryLogChunkInfo info;
+    uint64_t chunkSize;
+    if (!ReadChunkHeader(header, kChunkHeaderSize, info, chunkSize))
+      break;
+
+    // Make sure the payload was completely written. The size comes from
+    // the file, so it is compared to what is left rather than added to the
+    // offset.
+    if (!_in.seekg(offset) || chunkSize > remainingBytes(_in))
+      break;
+
+    info.offset = offset;
+    _chunks.push_back(info);
+    offset += chunkSize;
+  }
+
+  _in.clear();
+}
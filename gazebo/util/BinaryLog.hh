@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_UTIL_BINARYLOG_HH_
+#define GAZEBO_UTIL_BINARYLOG_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace util
+  {
+    /// \addtogroup gazebo_util
+    /// \{
+
+    /// \brief Type of the frames stored in a binary log.
+    enum class BinaryLogFrameType : uint8_t
+    {
+      /// \brief SDF text, used for the world description.
+      SDF = 0,
+
+      /// \brief A complete world state, also called keyframe.
+      STATE = 1,
+
+      /// \brief Quantized difference to the state of the previous frame.
+      /// A chunk always starts with a complete state.
+      DELTA = 2
+    };
+
+    /// \internal
+    /// \brief Convert a value between the host byte order and little-endian,
+    /// in place. Does nothing on little-endian hosts.
+    /// \param[in,out] _bytes Bytes of the value.
+    /// \param[in] _size Size of the value in bytes.
+    inline void BinaryLogSwapBytes(char *_bytes, const size_t _size)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      std::reverse(_bytes, _bytes + _size);
+#else
+      (void)_bytes;
+      (void)_size;
+#endif
+    }
+
+    /// \brief Header that precedes every frame in a binary log.
+    class GZ_UTIL_VISIBLE BinaryLogFrameHeader
+    {
+      /// \brief Size of a serialized frame header in bytes.
+      public: static const size_t kSize = 24;
+
+      /// \brief Type of the frame.
+      public: BinaryLogFrameType type = BinaryLogFrameType::STATE;
+
+      /// \brief Size of the frame payload in bytes, excluding the header.
+      public: uint32_t size = 0;
+
+      /// \brief Simulation time of the frame.
+      public: common::Time simTime;
+
+      /// \brief Simulation iterations of the frame.
+      public: uint64_t iterations = 0;
+    };
+
+    /// \brief Summary of a chunk of frames, as stored in the index at the
+    /// end of a binary log.
+    class GZ_UTIL_VISIBLE BinaryLogChunkInfo
+    {
+      /// \brief Offset of the chunk from the beginning of the file.
+      public: uint64_t offset = 0;
+
+      /// \brief Simulation time of the first frame in the chunk.
+      public: common::Time startTime;
+
+      /// \brief Simulation time of the last frame in the chunk.
+      public: common::Time endTime;
+
+      /// \brief Simulation iterations of the first frame in the chunk.
+      public: uint64_t iterations = 0;
+
+      /// \brief Number of frames in the chunk.
+      public: uint32_t frameCount = 0;
+    };
+
+    /// \brief Appends little-endian binary data to a string buffer.
+    class GZ_UTIL_VISIBLE BinaryLogWriter
+    {
+      /// \brief Constructor.
+      /// \param[in] _buffer Buffer to append data to. It must outlive the
+      /// writer.
+      public: explicit BinaryLogWriter(std::string &_buffer);
+
+      /// \brief Append a plain value.
+      /// \param[in] _value Value to append.
+      public: template<typename T>
+              void Write(const T &_value)
+              {
+                char bytes[sizeof(T)];
+                std::memcpy(bytes, &_value, sizeof(T));
+                BinaryLogSwapBytes(bytes, sizeof(T));
+                this->buffer.append(bytes, sizeof(T));
+              }
+
+      /// \brief Append a length prefixed string.
+      /// \param[in] _str String to append.
+      public: void WriteString(const std::string &_str);
+
+      /// \brief Append a time value.
+      /// \param[in] _time Time to append.
+      public: void WriteTime(const common::Time &_time);
+
+      /// \brief Append a vector, as three doubles.
+      /// \param[in] _vec Vector to append.
+      public: void WriteVector3(const ignition::math::Vector3d &_vec);
+
+      /// \brief Append a pose, as a position and a quaternion.
+      /// \param[in] _pose Pose to append.
+      public: void WritePose(const ignition::math::Pose3d &_pose);
+
+      /// \brief Append a pose difference, quantized with
+      /// BinaryLog::kDeltaPosition and BinaryLog::kDeltaRotation.
+      /// \param[in] _delta Pose difference. The rotation must be normalized.
+      /// \return False, and nothing is appended, if the position difference
+      /// is too large to be quantized.
+      public: bool WriteDeltaPose(const ignition::math::Pose3d &_delta);
+
+      /// \brief Start a new frame. The frame size is filled in by EndFrame.
+      /// \param[in] _type Type of the frame.
+      /// \param[in] _simTime Simulation time of the frame.
+      /// \param[in] _iterations Simulation iterations of the frame.
+      /// \return Offset of the frame header in the buffer.
+      public: size_t BeginFrame(const BinaryLogFrameType _type,
+                  const common::Time &_simTime, const uint64_t _iterations);
+
+      /// \brief Finish a frame started with BeginFrame.
+      /// \param[in] _offset Offset returned by BeginFrame.
+      public: void EndFrame(const size_t _offset);
+
+      /// \brief The buffer data is appended to.
+      private: std::string &buffer;
+    };
+
+    /// \brief Reads little-endian binary data from a memory block.
+    class GZ_UTIL_VISIBLE BinaryLogReader
+    {
+      /// \brief Constructor.
+      /// \param[in] _data Pointer to the data. It must outlive the reader.
+      /// \param[in] _size Size of the data in bytes.
+      public: BinaryLogReader(const char *_data, const size_t _size);
+
+      /// \brief Read a plain value.
+      /// \param[out] _value Value read.
+      /// \return False if there is not enough data left.
+      public: template<typename T>
+              bool Read(T &_value)
+              {
+                if (this->size - this->offset < sizeof(T))
+                  return false;
+                char bytes[sizeof(T)];
+                std::memcpy(bytes, this->data + this->offset, sizeof(T));
+                BinaryLogSwapBytes(bytes, sizeof(T));
+                std::memcpy(&_value, bytes, sizeof(T));
+                this->offset += sizeof(T);
+                return true;
+              }
+
+      /// \brief Read a length prefixed string.
+      /// \param[out] _str String read.
+      /// \return False if there is not enough data left.
+      public: bool ReadString(std::string &_str);
+
+      /// \brief Read a time value.
+      /// \param[out] _time Time read.
+      /// \return False if there is not enough data left.
+      public: bool ReadTime(common::Time &_time);
+
+      /// \brief Read a vector written with BinaryLogWriter::WriteVector3.
+      /// \param[out] _vec Vector read.
+      /// \return False if there is not enough data left.
+      public: bool ReadVector3(ignition::math::Vector3d &_vec);
+
+      /// \brief Read a pose written with BinaryLogWriter::WritePose.
+      /// \param[out] _pose Pose read.
+      /// \return False if there is not enough data left.
+      public: bool ReadPose(ignition::math::Pose3d &_pose);
+
+      /// \brief Read a pose difference written with
+      /// BinaryLogWriter::WriteDeltaPose.
+      /// \param[out] _delta Pose difference read.
+      /// \return False if there is not enough data left.
+      public: bool ReadDeltaPose(ignition::math::Pose3d &_delta);
+
+      /// \brief Read a frame header.
+      /// \param[out] _header Header read.
+      /// \return False if there is not enough data left, or the data is
+      /// not a frame header.
+      public: bool ReadFrameHeader(BinaryLogFrameHeader &_header);
+
+      /// \brief Skip bytes.
+      /// \param[in] _bytes Number of bytes to skip.
+      /// \return False if there is not enough data left.
+      public: bool Skip(const size_t _bytes);
+
+      /// \brief Get the current read offset.
+      /// \return Offset from the beginning of the data.
+      public: size_t Offset() const;
+
+      /// \brief Get a pointer to the data.
+      /// \return Pointer to the beginning of the data.
+      public: const char *Data() const;
+
+      /// \brief Get the number of bytes left to read.
+      /// \return Number of bytes left.
+      public: size_t Remaining() const;
+
+      /// \brief Pointer to the data.
+      private: const char *data;
+
+      /// \brief Size of the data.
+      private: size_t size;
+
+      /// \brief Current read offset.
+      private: size_t offset = 0;
+    };
+
+    /// \brief Indexed binary log format, used by the "bin" log encoding.
+    ///
+    /// A binary log file starts with a header, followed by compressed
+    /// chunks of frames and ends with an index of the chunks:
+    ///
+    ///   header: "GZLOGBIN", format version, log version, gazebo version,
+    ///           random seed
+    ///   chunk:  "GZCK", compression, frame count, start and end sim time,
+    ///           first iterations, uncompressed size, payload size, payload
+    ///   index:  "GZIX", chunk count, BinaryLogChunkInfo entries,
+    ///           index offset, "GZLOGEND"
+    ///
+    /// Each chunk payload is a sequence of frames, each one starting with a
+    /// BinaryLogFrameHeader. All values are stored little-endian. If the
+    /// index is missing, e.g. because recording was interrupted, it can be
+    /// rebuilt by walking the chunk headers.
+    class GZ_UTIL_VISIBLE BinaryLog
+    {
+      /// \brief Magic string at the beginning of binary log files.
+      public: static const char kFileMagic[9];
+
+      /// \brief Resolution of quantized position differences, in meters.
+      public: static constexpr double kDeltaPosition = 1e-6;
+
+      /// \brief Resolution of quantized quaternion differences.
+      public: static constexpr double kDeltaRotation = 1.0 / (1 << 30);
+
+      /// \brief Check whether a file is a binary log.
+      /// \param[in] _filename Path to the file.
+      /// \return True if the file starts with kFileMagic.
+      public: static bool IsBinaryLog(const std::string &_filename);
+
+      /// \brief Check whether data returned by LogPlay::Step starts with a
+      /// binary frame.
+      /// \param[in] _data Data to check.
+      /// \return True if _data starts with a valid frame header.
+      public: static bool IsFrame(const std::string &_data);
+
+      /// \brief Append the file header to a buffer.
+      /// \param[out] _buffer Buffer to append to.
+      /// \param[in] _logVersion Version of the log format.
+      /// \param[in] _gazeboVersion Version of Gazebo.
+      /// \param[in] _randSeed Random number seed.
+      public: static void WriteFileHeader(std::string &_buffer,
+                  const std::string &_logVersion,
+                  const std::string &_gazeboVersion, const uint32_t _randSeed);
+
+      /// \brief Read the file header.
+      /// \param[in] _in Stream positioned at the beginning of the file.
+      /// \param[out] _logVersion Version of the log format.
+      /// \param[out] _gazeboVersion Version of Gazebo.
+      /// \param[out] _randSeed Random number seed.
+      /// \return True on success.
+      public: static bool ReadFileHeader(std::istream &_in,
+                  std::string &_logVersion, std::string &_gazeboVersion,
+                  uint32_t &_randSeed);
+
+      /// \brief Compress a sequence of frames and append it as a chunk.
+      /// \param[in] _frames Frames to store in the chunk.
+      /// \param[out] _buffer Buffer to append the chunk to.
+      /// \param[out] _info Summary of the chunk. The offset is not set.
+      /// \return False if _frames is not a valid sequence of frames.
+      public: static bool WriteChunk(const std::string &_frames,
+                  std::string &_buffer, BinaryLogChunkInfo &_info);
+
+      /// \brief Read and decompress a chunk.
+      /// \param[in] _data Pointer to the chunk in memory.
+      /// \param[in] _size Number of bytes available at _data.
+      /// \param[out] _frames Decompressed frames.
+      /// \param[out] _info Summary of the chunk. The offset is not set.
+      /// \param[out] _chunkSize Size of the chunk in bytes.
+      /// \return True on success.
+      public: static bool ReadChunk(const char *_data, const size_t _size,
+                  std::string &_frames, BinaryLogChunkInfo &_info,
+                  uint64_t &_chunkSize);
+
+      /// \brief Read a chunk header, without reading the payload.
+      /// \param[in] _data Pointer to the chunk in memory.
+      /// \param[in] _size Number of bytes available at _data.
+      /// \param[out] _info Summary of the chunk. The offset is not set.
+      /// \param[out] _chunkSize Size of the chunk in bytes.
+      /// \return True on success.
+      public: static bool ReadChunkHeader(const char *_data,
+                  const size_t _size, BinaryLogChunkInfo &_info,
+                  uint64_t &_chunkSize);
+
+      /// \brief Size of a chunk header in bytes.
+      public: static const size_t kChunkHeaderSize = 52;
+
+      /// \brief Append the chunk index to a buffer.
+      /// \param[in] _chunks Summary of all the chunks in the file.
+      /// \param[in] _indexOffset Offset of the index from the beginning of
+      /// the file.
+      /// \param[out] _buffer Buffer to append to.
+      public: static void WriteIndex(
+                  const std::vector<BinaryLogChunkInfo> &_chunks,
+                  const uint64_t _indexOffset, std::string &_buffer);
+
+      /// \brief Read the chunk index at the end of a file.
+      /// \param[in] _in Stream of the whole file.
+      /// \param[out] _chunks Summary of all the chunks in the file.
+      /// \return False if the file has no valid index.
+      public: static bool ReadIndex(std::istream &_in,
+                  std::vector<BinaryLogChunkInfo> &_chunks);
+
+      /// \brief Rebuild the chunk index by walking the chunk headers.
+      /// \param[in] _in Stream of the whole file.
+      /// \param[in] _firstChunk Offset of the first chunk.
+      /// \param[out] _chunks Summary of all the valid chunks in the file.
+      public: static void RebuildIndex(std::istream &_in,
+                  const uint64_t _firstChunk,
+                  std::vector<BinaryLogChunkInfo> &_chunks);
+    };
+    /// \}
+  }
+}
+#endif
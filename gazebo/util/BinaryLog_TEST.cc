@@ -0,0 +1,621 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gazebo/util/BinaryLog.hh"
+#include "gazebo/util/LogPlay.hh"
+#include "gazebo/util/LogRecord.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class BinaryLog_TEST : public gazebo::testing::AutoLogFixture { };
+
+/// \brief World description stored in the first frame of the test logs.
+static const char kWorldSdf[] =
+  "<sdf version='1.6'><world name='default'></world></sdf>\n";
+
+/////////////////////////////////////////////////
+/// \brief Append a frame with a fake state payload.
+/// \param[in] _sec Simulation time of the frame, in seconds.
+/// \param[out] _frames Buffer to append the frame to.
+/// \param[in] _type Type of the frame.
+static void AppendStateFrame(const int _sec, std::string &_frames,
+    const util::BinaryLogFrameType _type = util::BinaryLogFrameType::STATE)
+{
+  util::BinaryLogWriter writer(_frames);
+  size_t offset = writer.BeginFrame(_type, common::Time(_sec, 0), _sec * 1000);
+  writer.WriteString("state");
+  writer.Write(static_cast<int32_t>(_sec));
+  writer.EndFrame(offset);
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a binary log with a world description and one state per
+/// second, split in chunks.
+/// \param[in] _filename Path of the log file.
+/// \param[in] _chunks Number of chunks.
+/// \param[in] _framesPerChunk Number of state frames per chunk.
+/// \param[in] _index True to write the chunk index.
+/// \param[in] _keyframeInterval Number of frames between keyframes, the
+/// other frames are delta frames.
+static void WriteLog(const std::string &_filename, const int _chunks,
+    const int _framesPerChunk, const bool _index,
+    const int _keyframeInterval = 1)
+{
+  std::string buffer;
+  util::BinaryLog::WriteFileHeader(buffer, GZ_LOG_VERSION, "11.0.0", 1234);
+
+  std::vector<util::BinaryLogChunkInfo> index;
+  for (int c = 0; c < _chunks; ++c)
+  {
+    std::string frames;
+    if (c == 0)
+    {
+      util::BinaryLogWriter writer(frames);
+      size_t offset = writer.BeginFrame(util::BinaryLogFrameType::SDF,
+          common::Time::Zero, 0);
+      frames.append(kWorldSdf);
+      writer.EndFrame(offset);
+    }
+
+    for (int f = 0; f < _framesPerChunk; ++f)
+    {
+      AppendStateFrame(1 + c * _framesPerChunk + f, frames,
+          f % _keyframeInterval == 0 ? util::BinaryLogFrameType::STATE :
+          util::BinaryLogFrameType::DELTA);
+    }
+
+    util::BinaryLogChunkInfo info;
+    uint64_t offset = buffer.size();
+    ASSERT_TRUE(util::BinaryLog::WriteChunk(frames, buffer, info));
+    info.offset = offset;
+    index.push_back(info);
+  }
+
+  if (_index)
+    util::BinaryLog::WriteIndex(index, buffer.size(), buffer);
+
+  std::ofstream out(_filename, std::ios::binary);
+  out.write(buffer.data(), buffer.size());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the simulation time of a state frame returned by LogPlay.
+/// \param[in] _frame Frame data.
+/// \return Simulation time of the frame.
+static common::Time FrameTime(const std::string &_frame)
+{
+  util::BinaryLogReader reader(_frame.data(), _frame.size());
+  util::BinaryLogFrameHeader header;
+  EXPECT_TRUE(reader.ReadFrameHeader(header));
+  EXPECT_EQ(header.type, util::BinaryLogFrameType::STATE);
+  return header.simTime;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the simulation times of the frames returned by LogPlay.
+/// \param[in] _data Frame data, possibly containing several frames.
+/// \param[out] _types Types of the frames.
+/// \return Simulation times of the frames.
+static std::vector<common::Time> FrameTimes(const std::string &_data,
+    std::vector<util::BinaryLogFrameType> &_types)
+{
+  std::vector<common::Time> times;
+  _types.clear();
+  util::BinaryLogReader reader(_data.data(), _data.size());
+  util::BinaryLogFrameHeader header;
+  while (reader.ReadFrameHeader(header))
+  {
+    times.push_back(header.simTime);
+    _types.push_back(header.type);
+    reader.Skip(header.size);
+  }
+  EXPECT_EQ(reader.Remaining(), 0u);
+  return times;
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, ReadWrite)
+{
+  std::string buffer;
+  util::BinaryLogWriter writer(buffer);
+  size_t offset = writer.BeginFrame(util::BinaryLogFrameType::STATE,
+      common::Time(3, 500), 42);
+  writer.WriteString("box");
+  writer.WriteTime(common::Time(1, 2));
+  writer.WritePose(ignition::math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+  writer.WriteVector3(ignition::math::Vector3d(4, 5, 6));
+  writer.EndFrame(offset);
+
+  util::BinaryLogReader reader(buffer.data(), buffer.size());
+  util::BinaryLogFrameHeader header;
+  ASSERT_TRUE(reader.ReadFrameHeader(header));
+  EXPECT_EQ(header.type, util::BinaryLogFrameType::STATE);
+  EXPECT_EQ(header.simTime, common::Time(3, 500));
+  EXPECT_EQ(header.iterations, 42u);
+  EXPECT_EQ(header.size, buffer.size() - util::BinaryLogFrameHeader::kSize);
+
+  std::string str;
+  common::Time time;
+  ignition::math::Pose3d pose;
+  ignition::math::Vector3d vec;
+  EXPECT_TRUE(reader.ReadString(str));
+  EXPECT_TRUE(reader.ReadTime(time));
+  EXPECT_TRUE(reader.ReadPose(pose));
+  EXPECT_TRUE(reader.ReadVector3(vec));
+  EXPECT_EQ(str, "box");
+  EXPECT_EQ(time, common::Time(1, 2));
+  EXPECT_EQ(pose, ignition::math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+  EXPECT_EQ(vec, ignition::math::Vector3d(4, 5, 6));
+  EXPECT_EQ(reader.Remaining(), 0u);
+
+  // Reading past the end fails
+  EXPECT_FALSE(reader.ReadString(str));
+  EXPECT_FALSE(reader.ReadTime(time));
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, DeltaPose)
+{
+  std::string buffer;
+  util::BinaryLogWriter writer(buffer);
+  ignition::math::Pose3d delta(0.25, -1e-3, 3, 0.1, -0.2, 2.5);
+  EXPECT_TRUE(writer.WriteDeltaPose(delta));
+  EXPECT_EQ(buffer.size(), 6 * sizeof(int32_t));
+
+  util::BinaryLogReader reader(buffer.data(), buffer.size());
+  ignition::math::Pose3d decoded;
+  ASSERT_TRUE(reader.ReadDeltaPose(decoded));
+  EXPECT_EQ(reader.Remaining(), 0u);
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_NEAR(decoded.Pos()[i], delta.Pos()[i],
+        util::BinaryLog::kDeltaPosition);
+  }
+
+  // The quaternion is stored with a positive w, q and -q are the same
+  // rotation.
+  EXPECT_GE(decoded.Rot().W(), 0.0);
+  EXPECT_NEAR(std::abs(decoded.Rot().Dot(delta.Rot())), 1.0, 1e-9);
+
+  // Positions that don't fit the delta encoding aren't written.
+  buffer.clear();
+  EXPECT_FALSE(writer.WriteDeltaPose(
+        ignition::math::Pose3d(1e4, 0, 0, 0, 0, 0)));
+  EXPECT_TRUE(buffer.empty());
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, Chunk)
+{
+  std::string frames;
+  for (int i = 1; i <= 10; ++i)
+    AppendStateFrame(i, frames);
+
+  std::string buffer;
+  util::BinaryLogChunkInfo info;
+  ASSERT_TRUE(util::BinaryLog::WriteChunk(frames, buffer, info));
+  EXPECT_EQ(info.frameCount, 10u);
+  EXPECT_EQ(info.startTime, common::Time(1, 0));
+  EXPECT_EQ(info.endTime, common::Time(10, 0));
+  EXPECT_EQ(info.iterations, 1000u);
+
+  std::string decoded;
+  util::BinaryLogChunkInfo decodedInfo;
+  uint64_t chunkSize = 0;
+  ASSERT_TRUE(util::BinaryLog::ReadChunk(buffer.data(), buffer.size(),
+        decoded, decodedInfo, chunkSize));
+  EXPECT_EQ(decoded, frames);
+  EXPECT_EQ(chunkSize, buffer.size());
+  EXPECT_EQ(decodedInfo.frameCount, info.frameCount);
+  EXPECT_EQ(decodedInfo.startTime, info.startTime);
+  EXPECT_EQ(decodedInfo.endTime, info.endTime);
+
+  // Truncated chunk
+  EXPECT_FALSE(util::BinaryLog::ReadChunk(buffer.data(), buffer.size() - 1,
+        decoded, decodedInfo, chunkSize));
+
+  // Invalid frames
+  std::string invalid = "not a frame";
+  EXPECT_FALSE(util::BinaryLog::WriteChunk(invalid, buffer, info));
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, Index)
+{
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gazebo_binary_log_%%%%%%.log");
+
+  // Complete log
+  WriteLog(path.string(), 4, 5, true);
+  EXPECT_TRUE(util::BinaryLog::IsBinaryLog(path.string()));
+
+  std::ifstream in(path.string(), std::ios::binary);
+  std::string logVersion, gazeboVersion;
+  uint32_t seed = 0;
+  ASSERT_TRUE(util::BinaryLog::ReadFileHeader(in, logVersion, gazeboVersion,
+        seed));
+  EXPECT_EQ(logVersion, GZ_LOG_VERSION);
+  EXPECT_EQ(gazeboVersion, "11.0.0");
+  EXPECT_EQ(seed, 1234u);
+  uint64_t firstChunk = in.tellg();
+
+  std::vector<util::BinaryLogChunkInfo> index, rebuilt;
+  ASSERT_TRUE(util::BinaryLog::ReadIndex(in, index));
+  ASSERT_EQ(index.size(), 4u);
+  EXPECT_EQ(index[0].offset, firstChunk);
+  EXPECT_EQ(index[0].frameCount, 6u);
+  EXPECT_EQ(index[3].endTime, common::Time(20, 0));
+
+  util::BinaryLog::RebuildIndex(in, firstChunk, rebuilt);
+  ASSERT_EQ(rebuilt.size(), index.size());
+  for (size_t i = 0; i < index.size(); ++i)
+  {
+    EXPECT_EQ(rebuilt[i].offset, index[i].offset);
+    EXPECT_EQ(rebuilt[i].startTime, index[i].startTime);
+    EXPECT_EQ(rebuilt[i].frameCount, index[i].frameCount);
+  }
+  in.close();
+
+  // Log without an index, e.g. after a crash
+  WriteLog(path.string(), 3, 5, false);
+  std::ifstream noIndex(path.string(), std::ios::binary);
+  EXPECT_FALSE(util::BinaryLog::ReadIndex(noIndex, index));
+  util::BinaryLog::RebuildIndex(noIndex, firstChunk, rebuilt);
+  EXPECT_EQ(rebuilt.size(), 3u);
+  noIndex.close();
+
+  // A text log is not a binary log
+  std::ofstream(path.string()) << "<?xml version='1.0'?>\n<gazebo_log>";
+  EXPECT_FALSE(util::BinaryLog::IsBinaryLog(path.string()));
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+// Sizes read from a corrupted log are checked before allocating memory.
+TEST_F(BinaryLog_TEST, CorruptedSizes)
+{
+  std::string buffer;
+  util::BinaryLog::WriteFileHeader(buffer, GZ_LOG_VERSION, "11.0.0", 1234);
+  const size_t indexOffset = buffer.size();
+  util::BinaryLog::WriteIndex({util::BinaryLogChunkInfo()}, indexOffset,
+      buffer);
+
+  // All values are little-endian.
+  EXPECT_EQ(buffer[8], 1);
+  EXPECT_EQ(buffer[9], 0);
+
+  std::string logVersion, gazeboVersion;
+  uint32_t seed = 0;
+  std::vector<util::BinaryLogChunkInfo> index;
+  {
+    std::istringstream in(buffer);
+    EXPECT_TRUE(util::BinaryLog::ReadFileHeader(in, logVersion,
+          gazeboVersion, seed));
+    EXPECT_TRUE(util::BinaryLog::ReadIndex(in, index));
+    EXPECT_EQ(index.size(), 1u);
+  }
+
+  // Huge string length
+  std::string corrupted = buffer;
+  corrupted.replace(12, 4, 4, '\xff');
+  {
+    std::istringstream in(corrupted);
+    EXPECT_FALSE(util::BinaryLog::ReadFileHeader(in, logVersion,
+          gazeboVersion, seed));
+  }
+
+  // Huge chunk count
+  corrupted = buffer;
+  corrupted.replace(indexOffset + 4, 8, 8, '\x7f');
+  {
+    std::istringstream in(corrupted);
+    EXPECT_FALSE(util::BinaryLog::ReadIndex(in, index));
+    EXPECT_TRUE(index.empty());
+  }
+
+  // Chunk sizes and payload
+  std::string frames;
+  for (int i = 1; i <= 10; ++i)
+    AppendStateFrame(i, frames);
+  std::string chunk;
+  util::BinaryLogChunkInfo info;
+  ASSERT_TRUE(util::BinaryLog::WriteChunk(frames, chunk, info));
+
+  std::string decoded;
+  uint64_t chunkSize = 0;
+  const size_t uncompressedSizeOffset = 36;
+  const size_t payloadSizeOffset = 44;
+
+  // Payload size that wraps the chunk size
+  corrupted = chunk;
+  corrupted.replace(payloadSizeOffset, 8, 8, '\xff');
+  EXPECT_FALSE(util::BinaryLog::ReadChunk(corrupted.data(), corrupted.size(),
+        decoded, info, chunkSize));
+
+  // Uncompressed size that no payload of this size can have
+  corrupted = chunk;
+  corrupted.replace(uncompressedSizeOffset, 8, 8, '\x7f');
+  EXPECT_FALSE(util::BinaryLog::ReadChunk(corrupted.data(), corrupted.size(),
+        decoded, info, chunkSize));
+
+  // Payload that isn't zlib data
+  corrupted = chunk;
+  corrupted[util::BinaryLog::kChunkHeaderSize] = '\0';
+  EXPECT_FALSE(util::BinaryLog::ReadChunk(corrupted.data(), corrupted.size(),
+        decoded, info, chunkSize));
+
+  // A chunk that would end past the end of the file isn't indexed.
+  corrupted = buffer.substr(0, indexOffset) + chunk + chunk;
+  corrupted.replace(indexOffset + chunk.size() + payloadSizeOffset, 8, 8,
+      '\xff');
+  {
+    std::istringstream in(corrupted);
+    util::BinaryLog::RebuildIndex(in, indexOffset, index);
+    ASSERT_EQ(index.size(), 1u);
+    EXPECT_EQ(index[0].offset, indexOffset);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, LogPlay)
+{
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gazebo_binary_log_%%%%%%.log");
+  WriteLog(path.string(), 4, 5, true);
+
+  util::LogPlay *player = util::LogPlay::Instance();
+  ASSERT_NO_THROW(player->Open(path.string()));
+  EXPECT_TRUE(player->IsOpen());
+  EXPECT_EQ(player->Encoding(), "bin");
+  EXPECT_EQ(player->LogVersion(), GZ_LOG_VERSION);
+  EXPECT_EQ(player->GazeboVersion(), "11.0.0");
+  EXPECT_EQ(player->RandSeed(), 1234u);
+  EXPECT_EQ(player->ChunkCount(), 4u);
+  EXPECT_EQ(player->LogStartTime(), common::Time(1, 0));
+  EXPECT_EQ(player->LogEndTime(), common::Time(20, 0));
+  EXPECT_TRUE(player->HasIterations());
+  EXPECT_EQ(player->InitialIterations(), 1000u);
+
+  // The world description comes first, as text.
+  std::string frame;
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, kWorldSdf);
+
+  // Step across the chunk boundaries.
+  for (int i = 1; i <= 20; ++i)
+  {
+    ASSERT_TRUE(player->Step(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i, 0));
+  }
+  EXPECT_FALSE(player->Step(frame));
+
+  // Step back across a chunk boundary.
+  ASSERT_TRUE(player->Seek(common::Time(11, 0)));
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(11, 0));
+  ASSERT_TRUE(player->Step(-2, frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(9, 0));
+
+  // Seek to the first frame skips the world description.
+  ASSERT_TRUE(player->Seek(common::Time(1, 0)));
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(1, 0));
+
+  // Rewind skips the world description.
+  ASSERT_TRUE(player->Rewind());
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(1, 0));
+  EXPECT_FALSE(player->StepBack(frame));
+
+  // Forward jumps to the last frame.
+  ASSERT_TRUE(player->Forward());
+  ASSERT_TRUE(player->StepBack(frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(20, 0));
+
+  // A log without an index can still be played.
+  WriteLog(path.string(), 2, 5, false);
+  ASSERT_NO_THROW(player->Open(path.string()));
+  EXPECT_EQ(player->ChunkCount(), 2u);
+  EXPECT_EQ(player->LogEndTime(), common::Time(10, 0));
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, LogPlayPrefetch)
+{
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gazebo_binary_log_%%%%%%.log");
+
+  // More chunks than the chunk cache holds.
+  const int chunks = 40;
+  const int framesPerChunk = 5;
+  const int frames = chunks * framesPerChunk;
+  WriteLog(path.string(), chunks, framesPerChunk, true);
+
+  util::LogPlay *player = util::LogPlay::Instance();
+  ASSERT_NO_THROW(player->Open(path.string()));
+  EXPECT_EQ(player->LogEndTime(), common::Time(frames, 0));
+
+  // Play forward, with the following chunks decoded in the background.
+  std::string frame;
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, kWorldSdf);
+  for (int i = 1; i <= frames; ++i)
+  {
+    ASSERT_TRUE(player->Step(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i, 0));
+  }
+
+  // Play backward, with the preceding chunks decoded in the background.
+  for (int i = frames - 1; i >= 1; --i)
+  {
+    ASSERT_TRUE(player->StepBack(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i, 0));
+  }
+
+  // Scrub through the log.
+  for (int i : {150, 3, 77, 199, 42, 120, 6})
+  {
+    ASSERT_TRUE(player->Seek(common::Time(i, 0)));
+    ASSERT_TRUE(player->Step(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i, 0));
+    ASSERT_TRUE(player->Step(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i + 1, 0));
+  }
+
+  // Chunks are the same whether or not they were prefetched.
+  std::string chunk;
+  for (unsigned int i = 0; i < player->ChunkCount(); ++i)
+  {
+    ASSERT_TRUE(player->Chunk(i, chunk));
+    util::BinaryLogReader reader(chunk.data(), chunk.size());
+    util::BinaryLogFrameHeader header;
+    ASSERT_TRUE(reader.ReadFrameHeader(header));
+    if (i > 0)
+    {
+      EXPECT_EQ(header.simTime, common::Time(1 + i * framesPerChunk, 0));
+    }
+  }
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+// A corrupted chunk decoded in the background is reported by the step that
+// reaches it, instead of ending the process.
+TEST_F(BinaryLog_TEST, LogPlayCorruptedChunk)
+{
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gazebo_binary_log_%%%%%%.log");
+  WriteLog(path.string(), 4, 5, true);
+
+  // Break the zlib header of the third chunk.
+  std::vector<util::BinaryLogChunkInfo> index;
+  {
+    std::ifstream in(path.string(), std::ios::binary);
+    ASSERT_TRUE(util::BinaryLog::ReadIndex(in, index));
+  }
+  ASSERT_EQ(index.size(), 4u);
+  {
+    std::fstream out(path.string(),
+        std::ios::binary | std::ios::in | std::ios::out);
+    out.seekp(index[2].offset + util::BinaryLog::kChunkHeaderSize);
+    out.put('\0');
+  }
+
+  util::LogPlay *player = util::LogPlay::Instance();
+  ASSERT_NO_THROW(player->Open(path.string()));
+
+  // The first two chunks play, the third one is prefetched meanwhile.
+  std::string frame;
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, kWorldSdf);
+  for (int i = 1; i <= 10; ++i)
+  {
+    ASSERT_TRUE(player->Step(frame));
+    EXPECT_EQ(FrameTime(frame), common::Time(i, 0));
+  }
+  EXPECT_FALSE(player->Step(frame));
+
+  // The chunks around it still play.
+  ASSERT_TRUE(player->Seek(common::Time(17, 0)));
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(FrameTime(frame), common::Time(17, 0));
+  EXPECT_FALSE(player->Seek(common::Time(12, 0)));
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+TEST_F(BinaryLog_TEST, LogPlayDelta)
+{
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gazebo_binary_log_%%%%%%.log");
+
+  // Chunks of 5 frames, with a keyframe every 3 frames:
+  // [1 2 3 4 5] [6 7 8 9 10], where 1, 4, 6 and 9 are keyframes.
+  WriteLog(path.string(), 2, 5, true, 3);
+
+  util::LogPlay *player = util::LogPlay::Instance();
+  ASSERT_NO_THROW(player->Open(path.string()));
+  EXPECT_EQ(player->LogStartTime(), common::Time(1, 0));
+
+  std::string frame;
+  std::vector<util::BinaryLogFrameType> types;
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, kWorldSdf);
+
+  // Stepping forward returns delta frames on their own.
+  for (int i = 1; i <= 10; ++i)
+  {
+    ASSERT_TRUE(player->Step(frame));
+    std::vector<common::Time> times = FrameTimes(frame, types);
+    ASSERT_EQ(times.size(), 1u);
+    EXPECT_EQ(times[0], common::Time(i, 0));
+  }
+
+  // Seeking to a delta frame returns the frames from the keyframe on.
+  ASSERT_TRUE(player->Seek(common::Time(3, 0)));
+  ASSERT_TRUE(player->Step(frame));
+  std::vector<common::Time> times = FrameTimes(frame, types);
+  ASSERT_EQ(times.size(), 3u);
+  EXPECT_EQ(times[0], common::Time(1, 0));
+  EXPECT_EQ(types[0], util::BinaryLogFrameType::STATE);
+  EXPECT_EQ(times[2], common::Time(3, 0));
+  EXPECT_EQ(types[2], util::BinaryLogFrameType::DELTA);
+
+  // The next delta follows a keyframe.
+  ASSERT_TRUE(player->Step(frame));
+  EXPECT_EQ(FrameTimes(frame, types).size(), 1u);
+  ASSERT_TRUE(player->Step(frame));
+  times = FrameTimes(frame, types);
+  ASSERT_EQ(times.size(), 1u);
+  EXPECT_EQ(times[0], common::Time(5, 0));
+
+  // Stepping back to a delta frame also returns its keyframe.
+  ASSERT_TRUE(player->Step(-3, frame));
+  times = FrameTimes(frame, types);
+  ASSERT_EQ(times.size(), 2u);
+  EXPECT_EQ(times[0], common::Time(1, 0));
+  EXPECT_EQ(times[1], common::Time(2, 0));
+
+  // Chunks start with a keyframe.
+  ASSERT_TRUE(player->Seek(common::Time(7, 0)));
+  ASSERT_TRUE(player->Step(frame));
+  times = FrameTimes(frame, types);
+  ASSERT_EQ(times.size(), 2u);
+  EXPECT_EQ(times[0], common::Time(6, 0));
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -29,6 +29,8 @@
 #include <boost/iostreams/filter/zlib.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 #include <boost/archive/iterators/base64_from_binary.hpp>
 #include <boost/archive/iterators/binary_from_base64.hpp>
 #include <boost/archive/iterators/remove_whitespace.hpp>
@@ -40,6 +42,7 @@
 #include "gazebo/common/Exception.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Base64.hh"
+#include "gazebo/util/BinaryLog.hh"
 #include "gazebo/util/LogRecord.hh"
 
 #include "gazebo/util/LogPlayPrivate.hh"
@@ -63,7 +66,12 @@ LogPlay::~LogPlay()
 /////////////////////////////////////////////////
 void LogPlay::Open(const std::string &_logFile)
 {
+  // The decode threads may still be reading the previous log file.
+  this->dataPtr->StopDecode();
   this->dataPtr->currentChunk.clear();
+  this->dataPtr->textChunks.clear();
+  this->dataPtr->chunkStartTimes.clear();
+  this->dataPtr->chunkPos = 0;
 
   boost::filesystem::path path(_logFile);
   if (!boost::filesystem::exists(path))
@@ -72,6 +80,16 @@ void LogPlay::Open(const std::string &_logFile)
   if (boost::filesystem::is_directory(path))
     gzthrow("Invalid logfile [" + _logFile + "]. This is a directory.");
 
+  if (BinaryLog::IsBinaryLog(_logFile))
+  {
+    this->dataPtr->OpenBinary(_logFile);
+    return;
+  }
+
+  this->dataPtr->binary = false;
+  this->dataPtr->binaryMap.close();
+  this->dataPtr->chunkIndex.clear();
+
   // Flag use to indicate if a parser failure has occurred
   bool xmlParserFail = this->dataPtr->xmlDoc.LoadFile(_logFile.c_str()) !=
     tinyxml2::XML_SUCCESS;
@@ -147,7 +165,18 @@ void LogPlay::Open(const std::string &_logFile)
   // Read in the header.
   this->ReadHeader();
 
-  this->dataPtr->logCurrXml = this->dataPtr->logStartXml;
+  // Index the chunks, so they can be accessed by index.
+  for (auto chunkXml = this->dataPtr->logStartXml->FirstChildElement("chunk");
+       chunkXml; chunkXml = chunkXml->NextSiblingElement("chunk"))
+  {
+    LogPlayTextChunk chunk;
+    const char *chunkEncoding = chunkXml->Attribute("encoding");
+    if (chunkEncoding)
+      chunk.encoding = chunkEncoding;
+    chunk.text = chunkXml->GetText();
+    this->dataPtr->textChunks.push_back(chunk);
+  }
+
   this->dataPtr->encoding.clear();
 
   // Extract the start/end log times from the log.
@@ -156,17 +185,11 @@ void LogPlay::Open(const std::string &_logFile)
   // Extract the initial "iterations" value from the log.
   this->dataPtr->iterationsFound = this->ReadIterations();
 
-  this->dataPtr->logCurrXml =
-    this->dataPtr->logStartXml->FirstChildElement("chunk");
-
-  if (!this->dataPtr->logCurrXml)
+  if (this->dataPtr->textChunks.empty())
     gzthrow("Unable to find the first chunk");
 
-  if (!this->dataPtr->ChunkData(this->dataPtr->logCurrXml,
-                                this->dataPtr->currentChunk))
-  {
+  if (!this->dataPtr->LoadChunk(0, 1, this->dataPtr->currentChunk))
     gzthrow("Unable to decode log file");
-  }
 
   this->dataPtr->start = 0;
   this->dataPtr->end = -1 * this->dataPtr->kEndFrame.size();
@@ -261,7 +284,11 @@ void LogPlay::ReadLogTimes()
   std::string chunk;
   bool found = false;
 
-  auto chunkXml = this->dataPtr->logStartXml->FirstChildElement("chunk");
+  if (this->dataPtr->textChunks.empty())
+  {
+    gzerr << "Unable to find the first chunk" << std::endl;
+    return;
+  }
 
   // Try to read the start time of the log.
   auto numChunksToTry =
@@ -269,13 +296,7 @@ void LogPlay::ReadLogTimes()
 
   for (unsigned int i = 0; i < numChunksToTry; ++i)
   {
-    if (!chunkXml)
-    {
-      gzerr << "Unable to find the first chunk" << std::endl;
-      return;
-    }
-
-    if (!this->dataPtr->ChunkData(chunkXml, chunk))
+    if (!this->dataPtr->LoadChunk(i, 0, chunk))
       return;
 
     // Find the first <sim_time> of the log.
@@ -292,22 +313,13 @@ void LogPlay::ReadLogTimes()
       found = true;
       break;
     }
-
-    chunkXml = chunkXml->NextSiblingElement("chunk");
   }
 
   if (!found)
     gzwarn << "Unable to find <sim_time> tags in any chunk." << std::endl;
 
   // Jump to the last chunk for finding the last <sim_time>.
-  auto lastChunk = this->dataPtr->logStartXml->LastChildElement("chunk");
-  if (!lastChunk)
-  {
-    gzerr << "Unable to jump to the last chunk of the log file\n";
-    return;
-  }
-
-  if (!this->dataPtr->ChunkData(lastChunk, chunk))
+  if (!this->dataPtr->LoadChunk(this->ChunkCount() - 1, 0, chunk))
     return;
 
   // Update the last <sim_time> of the log.
@@ -336,22 +348,20 @@ bool LogPlay::ReadIterations()
   const std::string kStartDelim = "<iterations>";
   const std::string kEndDelim = "</iterations>";
 
-  auto chunkXml = this->dataPtr->logStartXml->FirstChildElement("chunk");
-
   // Read the first "iterations" value of the log from the first chunk.
   auto numChunksToTry =
     std::min(this->ChunkCount(), this->dataPtr->kNumChunksToTry);
 
-  for (unsigned int i = 0; i < numChunksToTry; ++i)
+  if (numChunksToTry == 0)
   {
-    if (!chunkXml)
-    {
-      gzerr << "Unable to find the first chunk" << std::endl;
-      return false;
-    }
+    gzerr << "Unable to find the first chunk" << std::endl;
+    return false;
+  }
 
+  for (unsigned int i = 0; i < numChunksToTry; ++i)
+  {
     std::string chunk;
-    if (!this->dataPtr->ChunkData(chunkXml, chunk))
+    if (!this->dataPtr->LoadChunk(i, 0, chunk))
       return false;
 
     // Find the first <iterations> of the log.
@@ -365,8 +375,6 @@ bool LogPlay::ReadIterations()
       ss >> this->dataPtr->initialIterations;
       return true;
     }
-
-    chunkXml = chunkXml->NextSiblingElement("chunk");
   }
 
   gzwarn << "Unable to find <iterations>...</iterations> tags in the first "
@@ -378,7 +386,7 @@ bool LogPlay::ReadIterations()
 /////////////////////////////////////////////////
 bool LogPlay::IsOpen() const
 {
-  return this->dataPtr->logStartXml != NULL;
+  return this->dataPtr->logStartXml != NULL || this->dataPtr->binary;
 }
 
 /////////////////////////////////////////////////
@@ -434,6 +442,9 @@ uintmax_t LogPlay::FileSize() const
 /////////////////////////////////////////////////
 bool LogPlay::Step(std::string &_data)
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->BinaryStep(_data);
+
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   auto from = this->dataPtr->currentChunk.find(this->dataPtr->kStartFrame,
@@ -492,6 +503,9 @@ bool LogPlay::Step(const int _step, std::string &_data)
 /////////////////////////////////////////////////
 bool LogPlay::StepBack(std::string &_data)
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->BinaryStepBack(_data);
+
   auto from = std::string::npos;
   auto to = std::string::npos;
 
@@ -533,23 +547,22 @@ bool LogPlay::StepBack(std::string &_data)
 /////////////////////////////////////////////////
 bool LogPlay::Rewind()
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->BinaryRewind();
+
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   this->dataPtr->currentChunk.clear();
-  this->dataPtr->logCurrXml =
-    this->dataPtr->logStartXml->FirstChildElement("chunk");
 
-  if (!this->dataPtr->logCurrXml)
+  if (this->dataPtr->textChunks.empty())
   {
     gzerr << "Unable to jump to the beginning of the log file\n";
     return false;
   }
 
-  if (!this->dataPtr->ChunkData(this->dataPtr->logCurrXml,
-                                this->dataPtr->currentChunk))
-  {
+  this->dataPtr->chunkPos = 0;
+  if (!this->dataPtr->LoadChunk(0, 1, this->dataPtr->currentChunk))
     return false;
-  }
 
   // Skip first <sdf> block (it doesn't have a world state).
   this->dataPtr->end = this->dataPtr->currentChunk.find(
@@ -573,20 +586,21 @@ bool LogPlay::Rewind()
 /////////////////////////////////////////////////
 bool LogPlay::Forward()
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->BinaryForward();
+
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   // Get the last chunk.
-  this->dataPtr->logCurrXml =
-    this->dataPtr->logStartXml->LastChildElement("chunk");
-
-  if (!this->dataPtr->logCurrXml)
+  if (this->dataPtr->textChunks.empty())
   {
     gzerr << "Unable to jump to the end of the log file\n";
     return false;
   }
 
-  if (!this->dataPtr->ChunkData(this->dataPtr->logCurrXml,
-                                this->dataPtr->currentChunk))
+  this->dataPtr->chunkPos = this->dataPtr->textChunks.size() - 1;
+  if (!this->dataPtr->LoadChunk(this->dataPtr->chunkPos, -1,
+        this->dataPtr->currentChunk))
   {
     return false;
   }
@@ -608,131 +622,34 @@ bool LogPlay::Seek(const common::Time &_time)
     return true;
   }
 
-  common::Time logTime = this->dataPtr->logStartTime;
-
-  // 1st step: Locate the chunk: We're looking for the first chunk that has
-  // a time greater than the target time.
-  int64_t imin = 0;
-  int64_t imax = this->ChunkCount() - 1;
-  while (imin <= imax)
-  {
-    int64_t imid = imin + ((imax - imin) / 2);
-    this->Chunk(imid, this->dataPtr->currentChunk);
-
-    this->dataPtr->start = 0;
-    this->dataPtr->end = -1 * this->dataPtr->kEndFrame.size();
-
-    // We try a few times looking for <sim_time>.
-    for (unsigned int i = 0; i < 2; ++i)
-    {
-      std::string frame;
-      if (!this->Step(frame))
-        return false;
-
-      // Search the <sim_time> in the first frame of the current chunk.
-      auto from = frame.find(this->dataPtr->kStartTime);
-      auto to = frame.find(
-          this->dataPtr->kEndTime, from + this->dataPtr->kStartTime.size());
-      if (from != std::string::npos && to != std::string::npos)
-      {
-        auto length = to - from - this->dataPtr->kStartTime.size();
-        auto logTimeStr = frame.substr(
-            from + this->dataPtr->kStartTime.size(), length);
-        std::stringstream ss(logTimeStr);
-        ss >> logTime;
-        break;
-      }
-    }
-
-    // Chunk found.
-    if (logTime == _time)
-      break;
-    else if (logTime < _time)
-      imin = imid + 1;
-    else
-      imax = imid - 1;
-  }
-
-  if (logTime < _time)
-  {
-    if (!this->NextChunk())
-      this->Forward();
-  }
-
-  // 2nd step: Locate the frame in the previous chunk.
-  while (true)
-  {
-    std::string frame;
-    if (!this->StepBack(frame))
-      break;
+  if (this->dataPtr->binary)
+    return this->dataPtr->BinarySeek(_time);
 
-    // Search the <sim_time> in the frame of the current chunk.
-    auto from = frame.find(this->dataPtr->kStartTime);
-    auto to = frame.find(
-        this->dataPtr->kEndTime, from + this->dataPtr->kStartTime.size());
-    if (from != std::string::npos && to != std::string::npos)
-    {
-      auto length = to - from - this->dataPtr->kStartTime.size();
-      auto logTimeStr = frame.substr(
-          from + this->dataPtr->kStartTime.size(), length);
-      std::stringstream ss(logTimeStr);
-      ss >> logTime;
-
-      // frame found.
-      if (logTime < _time)
-        break;
-    }
-  }
-
-  return true;
+  return this->dataPtr->TextSeek(_time);
 }
 
 /////////////////////////////////////////////////
 bool LogPlay::Chunk(unsigned int _index, std::string &_data) const
 {
-  unsigned int count = 0;
-  this->dataPtr->logCurrXml =
-    this->dataPtr->logStartXml->FirstChildElement("chunk");
+  if (this->dataPtr->binary)
+    return this->dataPtr->LoadChunk(_index, 0, _data);
 
-  while (this->dataPtr->logCurrXml && count < _index)
-  {
-    count++;
-    this->dataPtr->logCurrXml =
-      this->dataPtr->logCurrXml->NextSiblingElement("chunk");
-  }
-
-  if (this->dataPtr->logCurrXml && count == _index)
-    return this->dataPtr->ChunkData(this->dataPtr->logCurrXml, _data);
-  else
+  if (_index >= this->dataPtr->textChunks.size())
     return false;
+
+  return this->dataPtr->LoadChunk(_index, 0, _data);
 }
 
 /////////////////////////////////////////////////
-bool LogPlayPrivate::ChunkData(
-    tinyxml2::XMLElement *_xml,
+bool LogPlayPrivate::DecodeTextChunk(const LogPlayTextChunk &_chunk,
     std::string &_data)
 {
-  // Make sure we have valid xml pointer
-  if (!_xml)
-  {
-    gzerr << "NULL XML element" << std::endl;
-    return false;
-  }
+  const std::string data = _chunk.text ? _chunk.text : "";
 
-  /// Get the chunk's encoding
-  this->encoding = _xml->Attribute("encoding");
-
-  // Make sure there is an encoding value.
-  if (this->encoding.empty())
+  if (_chunk.encoding == "txt")
+    _data = data;
+  else if (_chunk.encoding == "bz2")
   {
-    gzthrow("Encoding missing for a chunk in log file[" + this->filename + "]");
-  }
-
-  if (this->encoding == "txt")
-    _data = _xml->GetText();
-  else if (this->encoding == "bz2")
-  {
-    std::string data = _xml->GetText();
     std::string buffer;
 
     // Decode the base64 string
@@ -749,9 +666,8 @@ bool LogPlayPrivate::ChunkData(
       _data += '\0';
     }
   }
-  else if (this->encoding == "zlib")
+  else if (_chunk.encoding == "zlib")
   {
-    std::string data = _xml->GetText();
     std::string buffer;
 
     // Decode the base64 string
@@ -770,8 +686,6 @@ bool LogPlayPrivate::ChunkData(
   }
   else
   {
-    gzerr << "Invalid encoding[" << this->encoding << "] in log file["
-      << this->filename << "]\n";
     return false;
   }
 
@@ -787,27 +701,20 @@ std::string LogPlay::Encoding() const
 /////////////////////////////////////////////////
 unsigned int LogPlay::ChunkCount() const
 {
-  unsigned int count = 0;
-  auto xml = this->dataPtr->logStartXml->FirstChildElement("chunk");
-
-  while (xml)
-  {
-    count++;
-    xml = xml->NextSiblingElement("chunk");
-  }
+  if (this->dataPtr->binary)
+    return this->dataPtr->chunkIndex.size();
 
-  return count;
+  return this->dataPtr->textChunks.size();
 }
 
 /////////////////////////////////////////////////
 bool LogPlay::NextChunk()
 {
-  auto next = this->dataPtr->logCurrXml->NextSiblingElement("chunk");
-  if (!next)
+  if (this->dataPtr->chunkPos + 1 >= this->dataPtr->textChunks.size())
     return false;
 
-  this->dataPtr->logCurrXml = next;
-  if (!this->dataPtr->ChunkData(this->dataPtr->logCurrXml,
+  this->dataPtr->chunkPos++;
+  if (!this->dataPtr->LoadChunk(this->dataPtr->chunkPos, 1,
                                 this->dataPtr->currentChunk))
   {
     return false;
@@ -822,12 +729,11 @@ bool LogPlay::NextChunk()
 /////////////////////////////////////////////////
 bool LogPlay::PrevChunk()
 {
-  auto prev = this->dataPtr->logCurrXml->PreviousSiblingElement("chunk");
-  if (!prev)
+  if (this->dataPtr->chunkPos == 0 || this->dataPtr->textChunks.empty())
     return false;
 
-  this->dataPtr->logCurrXml = prev;
-  if (!this->dataPtr->ChunkData(this->dataPtr->logCurrXml,
+  this->dataPtr->chunkPos--;
+  if (!this->dataPtr->LoadChunk(this->dataPtr->chunkPos, -1,
                                 this->dataPtr->currentChunk))
   {
     return false;
@@ -838,3 +744,652 @@ bool LogPlay::PrevChunk()
 
   return true;
 }
+
+/////////////////////////////////////////////////
+LogPlayPrivate::~LogPlayPrivate()
+{
+  this->StopDecode();
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::DecodeChunk(const unsigned int _index,
+    std::string &_data) const
+{
+  if (this->binary)
+    return this->BinaryChunkData(_index, _data);
+
+  if (_index >= this->textChunks.size())
+    return false;
+
+  return DecodeTextChunk(this->textChunks[_index], _data);
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::LoadChunk(const unsigned int _index,
+    const int _direction, std::string &_data)
+{
+  std::shared_ptr<const std::string> chunk;
+  {
+    std::unique_lock<std::mutex> lock(this->cacheMutex);
+
+    // A decode thread may already be working on this chunk.
+    this->cacheCondition.wait(lock, [&]
+        {
+          return this->decoding.find(_index) == this->decoding.end();
+        });
+
+    auto iter = this->chunkCache.find(_index);
+    if (iter != this->chunkCache.end())
+      chunk = iter->second;
+
+    // Report errors of the decode threads here, in the thread that plays
+    // the log.
+    auto failed = this->failedChunks.find(_index);
+    if (!chunk && failed != this->failedChunks.end())
+    {
+      gzerr << "Unable to decode chunk[" << _index << "] in log file["
+        << this->filename << "]: " << failed->second << "\n";
+      this->failedChunks.erase(failed);
+      return false;
+    }
+  }
+
+  if (!this->binary && _index < this->textChunks.size())
+  {
+    // Make sure there is an encoding value.
+    this->encoding = this->textChunks[_index].encoding;
+    if (this->encoding.empty())
+    {
+      gzthrow("Encoding missing for a chunk in log file[" +
+          this->filename + "]");
+    }
+  }
+
+  if (!chunk)
+  {
+    auto data = std::make_shared<std::string>();
+    bool decoded = false;
+    try
+    {
+      decoded = this->DecodeChunk(_index, *data);
+    }
+    catch(std::exception &_e)
+    {
+      gzerr << "Unable to decode chunk[" << _index << "] in log file["
+        << this->filename << "]: " << _e.what() << "\n";
+      return false;
+    }
+
+    if (!decoded)
+    {
+      if (!this->binary)
+      {
+        gzerr << "Invalid encoding[" << this->encoding << "] in log file["
+          << this->filename << "]\n";
+      }
+      return false;
+    }
+
+    chunk = data;
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    this->chunkCache[_index] = chunk;
+    this->TrimCache(_index);
+  }
+
+  _data = *chunk;
+
+  if (_direction != 0)
+    this->Prefetch(_index, _direction);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::Prefetch(const unsigned int _index, const int _direction)
+{
+  const int64_t count = this->binary ?
+    this->chunkIndex.size() : this->textChunks.size();
+
+  std::lock_guard<std::mutex> lock(this->cacheMutex);
+
+  // Start the decode threads on first use.
+  if (this->decodeThreads.empty())
+  {
+    this->stopDecode = false;
+    for (unsigned int i = 0; i < this->kDecodeThreads; ++i)
+    {
+      this->decodeThreads.push_back(
+          std::thread(&LogPlayPrivate::DecodeWorker, this));
+    }
+  }
+
+  // Requests for a previous position are no longer useful.
+  this->prefetchQueue.clear();
+  for (unsigned int i = 1; i <= this->kPrefetchChunks; ++i)
+  {
+    const int64_t next = static_cast<int64_t>(_index) +
+      _direction * static_cast<int64_t>(i);
+    if (next < 0 || next >= count)
+      break;
+
+    if (this->chunkCache.find(next) == this->chunkCache.end() &&
+        this->decoding.find(next) == this->decoding.end() &&
+        this->failedChunks.find(next) == this->failedChunks.end())
+    {
+      this->prefetchQueue.push_back(next);
+    }
+  }
+
+  this->cacheCondition.notify_all();
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::DecodeWorker()
+{
+  std::unique_lock<std::mutex> lock(this->cacheMutex);
+  while (true)
+  {
+    this->cacheCondition.wait(lock, [this]
+        {
+          return this->stopDecode || !this->prefetchQueue.empty();
+        });
+
+    if (this->stopDecode)
+      return;
+
+    const unsigned int index = this->prefetchQueue.front();
+    this->prefetchQueue.pop_front();
+    if (this->chunkCache.find(index) != this->chunkCache.end() ||
+        this->decoding.find(index) != this->decoding.end() ||
+        this->failedChunks.find(index) != this->failedChunks.end())
+    {
+      continue;
+    }
+
+    // Decode without holding the lock. A corrupted chunk may make the
+    // decompressors throw, the error is kept for LoadChunk.
+    this->decoding.insert(index);
+    lock.unlock();
+    auto data = std::make_shared<std::string>();
+    bool decoded = false;
+    std::string error = "invalid data";
+    try
+    {
+      decoded = this->DecodeChunk(index, *data);
+    }
+    catch(common::Exception &_e)
+    {
+      error = _e.GetErrorStr();
+    }
+    catch(std::exception &_e)
+    {
+      error = _e.what();
+    }
+    lock.lock();
+    this->decoding.erase(index);
+
+    if (!this->stopDecode)
+    {
+      if (decoded)
+      {
+        this->chunkCache[index] = data;
+        this->TrimCache(index);
+      }
+      else
+      {
+        this->failedChunks[index] = error;
+      }
+    }
+
+    this->cacheCondition.notify_all();
+  }
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::TrimCache(const unsigned int _index)
+{
+  while (this->chunkCache.size() > this->kMaxCachedChunks)
+  {
+    // The cache is ordered by index, so the furthest chunk is at one end.
+    auto first = this->chunkCache.begin();
+    auto last = std::prev(this->chunkCache.end());
+    if (_index - std::min(_index, first->first) >=
+        last->first - std::min(last->first, _index))
+    {
+      this->chunkCache.erase(first);
+    }
+    else
+    {
+      this->chunkCache.erase(last);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::StopDecode()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    this->stopDecode = true;
+  }
+  this->cacheCondition.notify_all();
+
+  for (auto &thread : this->decodeThreads)
+    thread.join();
+  this->decodeThreads.clear();
+
+  std::lock_guard<std::mutex> lock(this->cacheMutex);
+  this->stopDecode = false;
+  this->prefetchQueue.clear();
+  this->decoding.clear();
+  this->failedChunks.clear();
+  this->chunkCache.clear();
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::ChunkStartTime(const unsigned int _index,
+    common::Time &_time)
+{
+  auto iter = this->chunkStartTimes.find(_index);
+  if (iter != this->chunkStartTimes.end())
+  {
+    _time = iter->second;
+    return true;
+  }
+
+  std::string chunk;
+  if (!this->LoadChunk(_index, 0, chunk))
+    return false;
+
+  auto from = chunk.find(this->kStartTime);
+  if (from == std::string::npos)
+    return false;
+  from += this->kStartTime.size();
+
+  auto to = chunk.find(this->kEndTime, from);
+  if (to == std::string::npos)
+    return false;
+
+  std::stringstream ss(chunk.substr(from, to - from));
+  ss >> _time;
+  this->chunkStartTimes[_index] = _time;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::TextSeek(const common::Time &_time)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // 1st step: Locate the last chunk that starts before the target time.
+  // Chunks without a <sim_time>, such as a chunk with only the world
+  // description, count as before any time.
+  unsigned int index = 0;
+  int64_t imin = 0;
+  int64_t imax = static_cast<int64_t>(this->textChunks.size()) - 1;
+  while (imin <= imax)
+  {
+    int64_t imid = imin + ((imax - imin) / 2);
+    common::Time chunkTime;
+    if (!this->ChunkStartTime(imid, chunkTime) || chunkTime < _time)
+    {
+      index = imid;
+      imin = imid + 1;
+    }
+    else
+    {
+      imax = imid - 1;
+    }
+  }
+
+  this->chunkPos = index;
+  if (!this->LoadChunk(index, 1, this->currentChunk))
+    return false;
+
+  // 2nd step: Move to the last frame before the target time, so that the
+  // next Step returns the first frame at or after it.
+  this->start = 0;
+  this->end = -1 * this->kEndFrame.size();
+
+  size_t pos = 0;
+  while (true)
+  {
+    auto from = this->currentChunk.find(this->kStartFrame, pos);
+    auto to = this->currentChunk.find(this->kEndFrame, pos);
+    if (from == std::string::npos || to == std::string::npos)
+      break;
+
+    auto timeFrom = this->currentChunk.find(this->kStartTime, from);
+    if (timeFrom != std::string::npos && timeFrom < to)
+    {
+      timeFrom += this->kStartTime.size();
+      auto timeTo = this->currentChunk.find(this->kEndTime, timeFrom);
+      common::Time frameTime;
+      std::stringstream ss(
+          this->currentChunk.substr(timeFrom, timeTo - timeFrom));
+      ss >> frameTime;
+      if (frameTime >= _time)
+        break;
+    }
+
+    this->start = from;
+    this->end = to;
+    pos = to + this->kEndFrame.size();
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::OpenBinary(const std::string &_logFile)
+{
+  // The log file is memory mapped, chunks are decoded straight from the
+  // mapping, which can be shared by the decode threads.
+  this->binaryMap.close();
+  try
+  {
+    this->binaryMap.open(_logFile);
+  }
+  catch(std::exception &_e)
+  {
+    gzthrow("Unable to open log file[" + _logFile + "]: " + _e.what());
+  }
+  boost::iostreams::stream<boost::iostreams::array_source> logStream(
+      this->binaryMap.data(), this->binaryMap.size());
+
+  this->xmlDoc.Clear();
+  this->logStartXml = nullptr;
+  this->filename = _logFile;
+  this->encoding = "bin";
+  this->binary = true;
+
+  // Read in the header.
+  this->randSeed = ignition::math::Rand::Seed();
+  if (!BinaryLog::ReadFileHeader(logStream, this->logVersion,
+        this->gazeboVersion, this->randSeed))
+  {
+    gzthrow("Log file has no header");
+  }
+
+  if (this->logVersion != GZ_LOG_VERSION)
+  {
+    gzwarn << "Log version[" << this->logVersion << "] in file["
+           << this->filename << "] does not match Gazebo's log version["
+           << GZ_LOG_VERSION << "]\n";
+  }
+  else
+  {
+    // Set the random number seed for simulation
+    ignition::math::Rand::Seed(this->randSeed);
+  }
+
+  const uint64_t firstChunk = logStream.tellg();
+
+  // The index is missing if recording did not stop cleanly.
+  if (!BinaryLog::ReadIndex(logStream, this->chunkIndex))
+  {
+    gzwarn << "Log file[" << _logFile << "] has no chunk index. "
+           << "Rebuilding it from the chunk headers.\n";
+    BinaryLog::RebuildIndex(logStream, firstChunk, this->chunkIndex);
+  }
+
+  if (this->chunkIndex.empty())
+    gzthrow("Unable to find the first chunk");
+
+  // Extract the start time and the initial iterations from the first
+  // state frame, the end time comes from the index.
+  this->logStartTime = this->chunkIndex.front().startTime;
+  this->logEndTime = this->chunkIndex.back().endTime;
+  this->initialIterations = 0;
+  this->iterationsFound = false;
+
+  auto numChunksToTry = std::min(
+      static_cast<unsigned int>(this->chunkIndex.size()),
+      this->kNumChunksToTry);
+  for (unsigned int i = 0; i < numChunksToTry && !this->iterationsFound; ++i)
+  {
+    std::string chunk;
+    if (!this->LoadChunk(i, 0, chunk))
+      break;
+
+    BinaryLogReader reader(chunk.data(), chunk.size());
+    BinaryLogFrameHeader header;
+    while (reader.ReadFrameHeader(header))
+    {
+      if (header.type != BinaryLogFrameType::SDF)
+      {
+        this->logStartTime = header.simTime;
+        this->initialIterations = header.iterations;
+        this->iterationsFound = true;
+        break;
+      }
+      reader.Skip(header.size);
+    }
+  }
+
+  if (!this->LoadBinaryChunk(0))
+    gzthrow("Unable to decode log file");
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryChunkData(const unsigned int _index,
+    std::string &_data) const
+{
+  if (_index >= this->chunkIndex.size() ||
+      this->chunkIndex[_index].offset >= this->binaryMap.size())
+  {
+    return false;
+  }
+
+  const uint64_t offset = this->chunkIndex[_index].offset;
+  BinaryLogChunkInfo info;
+  uint64_t chunkSize = 0;
+  if (!BinaryLog::ReadChunk(this->binaryMap.data() + offset,
+        this->binaryMap.size() - offset, _data, info, chunkSize))
+  {
+    gzerr << "Invalid chunk[" << _index << "] in log file["
+          << this->filename << "]\n";
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::LoadBinaryChunk(const unsigned int _index,
+    const int _direction)
+{
+  if (!this->LoadChunk(_index, _direction, this->currentChunk))
+    return false;
+
+  this->chunkPos = _index;
+  this->framePos = -1;
+  this->lastFrame = -1;
+  this->frameOffsets.clear();
+
+  BinaryLogReader reader(this->currentChunk.data(),
+      this->currentChunk.size());
+  BinaryLogFrameHeader header;
+  size_t offset = 0;
+  while (reader.ReadFrameHeader(header))
+  {
+    this->frameOffsets.push_back(offset);
+    reader.Skip(header.size);
+    offset = reader.Offset();
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrivate::BinaryFrame(const size_t _frame, std::string &_data)
+{
+  const size_t offset = this->frameOffsets[_frame];
+  BinaryLogReader reader(this->currentChunk.data() + offset,
+      this->currentChunk.size() - offset);
+  BinaryLogFrameHeader header;
+  reader.ReadFrameHeader(header);
+
+  const size_t end = offset + BinaryLogFrameHeader::kSize + header.size;
+  const bool continuous =
+    this->lastFrame >= 0 && this->lastFrame + 1 == static_cast<int64_t>(_frame);
+  this->lastFrame = _frame;
+
+  // SDF frames are handed out as text, so they can be parsed as in the
+  // other encodings.
+  if (header.type == BinaryLogFrameType::SDF)
+  {
+    _data.assign(this->currentChunk, offset + BinaryLogFrameHeader::kSize,
+        header.size);
+    return;
+  }
+
+  // A delta frame is only meaningful on top of the previous state. If that
+  // state wasn't the last one returned, also return every frame from the
+  // preceding keyframe on. Chunks always start with a keyframe.
+  size_t start = offset;
+  if (header.type == BinaryLogFrameType::DELTA && !continuous)
+  {
+    for (size_t i = _frame; i-- > 0;)
+    {
+      BinaryLogReader prev(this->currentChunk.data() + this->frameOffsets[i],
+          this->currentChunk.size() - this->frameOffsets[i]);
+      BinaryLogFrameHeader prevHeader;
+      if (!prev.ReadFrameHeader(prevHeader) ||
+          prevHeader.type == BinaryLogFrameType::SDF)
+      {
+        break;
+      }
+
+      start = this->frameOffsets[i];
+      if (prevHeader.type == BinaryLogFrameType::STATE)
+        break;
+    }
+  }
+
+  _data.assign(this->currentChunk, start, end - start);
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryStep(std::string &_data)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (this->framePos + 1 >= static_cast<int64_t>(this->frameOffsets.size()))
+  {
+    if (this->chunkPos + 1 >= this->chunkIndex.size() ||
+        !this->LoadBinaryChunk(this->chunkPos + 1))
+    {
+      return false;
+    }
+
+    if (this->frameOffsets.empty())
+    {
+      gzerr << "Unable to find a frame in current chunk\n";
+      return false;
+    }
+  }
+
+  this->framePos++;
+  this->BinaryFrame(this->framePos, _data);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryStepBack(std::string &_data)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (this->framePos <= 0)
+  {
+    if (this->chunkPos == 0 || !this->LoadBinaryChunk(this->chunkPos - 1, -1))
+      return false;
+
+    if (this->frameOffsets.empty())
+    {
+      gzerr << "Unable to find a frame in current chunk\n";
+      return false;
+    }
+    this->framePos = this->frameOffsets.size();
+  }
+
+  this->framePos--;
+  this->BinaryFrame(this->framePos, _data);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryRewind()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (!this->LoadBinaryChunk(0))
+  {
+    gzerr << "Unable to jump to the beginning of the log file\n";
+    return false;
+  }
+
+  // Skip the world description, it doesn't have a world state.
+  BinaryLogReader reader(this->currentChunk.data(), this->currentChunk.size());
+  BinaryLogFrameHeader header;
+  if (reader.ReadFrameHeader(header) &&
+      header.type == BinaryLogFrameType::SDF)
+  {
+    this->frameOffsets.erase(this->frameOffsets.begin());
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryForward()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (!this->LoadBinaryChunk(this->chunkIndex.size() - 1, -1))
+  {
+    gzerr << "Unable to jump to the end of the log file\n";
+    return false;
+  }
+
+  this->framePos = this->frameOffsets.size();
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinarySeek(const common::Time &_time)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // 1st step: Locate the last chunk that starts before the target time.
+  auto iter = std::lower_bound(this->chunkIndex.begin(),
+      this->chunkIndex.end(), _time,
+      [](const BinaryLogChunkInfo &_info, const common::Time &_t)
+      {
+        return _info.startTime < _t;
+      });
+  unsigned int index = iter == this->chunkIndex.begin() ? 0 :
+    std::distance(this->chunkIndex.begin(), iter) - 1;
+
+  if (!this->LoadBinaryChunk(index))
+    return false;
+
+  // 2nd step: Locate the last frame before the target time, using only the
+  // frame headers.
+  BinaryLogReader reader(this->currentChunk.data(), this->currentChunk.size());
+  BinaryLogFrameHeader header;
+  for (size_t i = 0; i < this->frameOffsets.size(); ++i)
+  {
+    if (!reader.ReadFrameHeader(header))
+      break;
+    reader.Skip(header.size);
+
+    // The world description is always skipped.
+    if (header.type != BinaryLogFrameType::SDF && header.simTime >= _time)
+      break;
+
+    this->framePos = i;
+  }
+
+  return true;
+}
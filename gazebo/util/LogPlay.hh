@@ -103,6 +103,9 @@ namespace gazebo
       public: uintmax_t FileSize() const;
 
       /// \brief Step through the open log file.
+      /// For logs with the "bin" encoding, world states are returned in
+      /// binary form, starting with a BinaryLogFrameHeader, and the world
+      /// description is returned as SDF text.
       /// \param[out] _data Data from next entry in the log file.
       public: bool Step(std::string &_data);
 
@@ -25,31 +25,166 @@
 #include <tinyxml2.h>
 #endif
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gazebo/common/Time.hh"
+#include "gazebo/util/BinaryLog.hh"
 #include "gazebo/util/system.hh"
 
 namespace gazebo
 {
   namespace util
   {
+    /// \internal
+    /// \brief Chunk of a text log.
+    class LogPlayTextChunk
+    {
+      /// \brief Encoding of the chunk (txt, zlib or bz2).
+      public: std::string encoding;
+
+      /// \brief Encoded chunk data, owned by the XML document.
+      public: const char *text = nullptr;
+    };
+
     /// \internal
     /// \brief Private data for log play
     class LogPlayPrivate
     {
-      /// \brief Helper function to get chunk data from XML.
-      /// \param[in] _xml Pointer to an xml block that has state data.
+      /// \brief Destructor. Stops the decode threads.
+      public: ~LogPlayPrivate();
+
+      /// \brief Decode the data of a text log chunk. Safe to call from any
+      /// thread, since it doesn't access the XML document.
+      /// \param[in] _chunk Chunk to decode.
+      /// \param[out] _data Storage for the chunk's data.
+      /// \return True if the chunk was successfully decoded.
+      public: static bool DecodeTextChunk(const LogPlayTextChunk &_chunk,
+                  std::string &_data);
+
+      /// \brief Decode a chunk of the open log file, without going through
+      /// the chunk cache. Safe to call from the decode threads.
+      /// \param[in] _index Index of the chunk.
+      /// \param[out] _data Storage for the chunk's data.
+      /// \return True if the chunk was successfully decoded.
+      public: bool DecodeChunk(const unsigned int _index,
+                  std::string &_data) const;
+
+      /// \brief Get the data of a chunk, from the chunk cache if it was
+      /// already decoded. Then queue the next chunks in the play direction
+      /// for decoding in the background.
+      /// \param[in] _index Index of the chunk.
+      /// \param[in] _direction 1 if playing forward, -1 if playing backward,
+      /// 0 to skip prefetching.
       /// \param[out] _data Storage for the chunk's data.
-      /// \return True if the chunk was successfully parsed.
-      public: bool ChunkData(
-                  tinyxml2::XMLElement *_xml,
+      /// \return True if the chunk was successfully decoded.
+      public: bool LoadChunk(const unsigned int _index, const int _direction,
                   std::string &_data);
 
+      /// \brief Queue chunks for decoding in the background.
+      /// \param[in] _index Index of the current chunk.
+      /// \param[in] _direction 1 to prefetch the following chunks, -1 to
+      /// prefetch the preceding chunks.
+      public: void Prefetch(const unsigned int _index, const int _direction);
+
+      /// \brief Decode thread. Decodes the chunks queued by Prefetch.
+      public: void DecodeWorker();
+
+      /// \brief Remove the cached chunks furthest from a chunk, until the
+      /// cache is within kMaxCachedChunks. cacheMutex must be locked.
+      /// \param[in] _index Index of the chunk to keep the cache around.
+      public: void TrimCache(const unsigned int _index);
+
+      /// \brief Stop the decode threads and clear the chunk cache.
+      public: void StopDecode();
+
+      /// \brief Get the first simulation time of a chunk of a text log.
+      /// The times are kept, so each chunk is only searched once.
+      /// \param[in] _index Index of the chunk.
+      /// \param[out] _time First simulation time in the chunk.
+      /// \return False if the chunk has no simulation time.
+      public: bool ChunkStartTime(const unsigned int _index,
+                  common::Time &_time);
+
+      /// \brief Text log version of LogPlay::Seek. Uses a binary search
+      /// over the chunks, then a search of the frames of a single chunk.
+      /// \param[in] _time Target simulation time.
+      /// \return True on success.
+      public: bool TextSeek(const common::Time &_time);
+
+      /// \brief Open a log file that uses the binary "bin" encoding. Reads
+      /// the header, the chunk index and the log times.
+      /// \param[in] _logFile Path to the log file.
+      public: void OpenBinary(const std::string &_logFile);
+
+      /// \brief Read and decompress a chunk of a binary log.
+      /// \param[in] _index Index of the chunk.
+      /// \param[out] _data Frames stored in the chunk.
+      /// \return True if the chunk was successfully read.
+      public: bool BinaryChunkData(const unsigned int _index,
+                  std::string &_data) const;
+
+      /// \brief Make a chunk of a binary log the current chunk.
+      /// \param[in] _index Index of the chunk.
+      /// \param[in] _direction Play direction, see LoadChunk.
+      /// \return True if the chunk was successfully read.
+      public: bool LoadBinaryChunk(const unsigned int _index,
+                  const int _direction = 1);
+
+      /// \brief Get a frame of the current binary chunk, in the form
+      /// returned by LogPlay::Step. SDF frames are returned as text, state
+      /// frames are returned with their BinaryLogFrameHeader. Delta frames
+      /// are preceded by the frames they depend on, unless the previous
+      /// frame was the last one returned.
+      /// \param[in] _frame Index of the frame in the current chunk.
+      /// \param[out] _data Frame data.
+      public: void BinaryFrame(const size_t _frame, std::string &_data);
+
+      /// \brief Binary log version of LogPlay::Step.
+      /// \param[out] _data Data from next entry in the log file.
+      /// \return True on success.
+      public: bool BinaryStep(std::string &_data);
+
+      /// \brief Binary log version of LogPlay::StepBack.
+      /// \param[out] _data Data from previous entry in the log file.
+      /// \return True on success.
+      public: bool BinaryStepBack(std::string &_data);
+
+      /// \brief Binary log version of LogPlay::Rewind.
+      /// \return True on success.
+      public: bool BinaryRewind();
+
+      /// \brief Binary log version of LogPlay::Forward.
+      /// \return True on success.
+      public: bool BinaryForward();
+
+      /// \brief Binary log version of LogPlay::Seek. Uses the chunk index
+      /// and the frame headers, so no state has to be decoded.
+      /// \param[in] _time Target simulation time.
+      /// \return True on success.
+      public: bool BinarySeek(const common::Time &_time);
+
       /// \brief Max number of chunks to inspect when looking for XML elements.
       public: const unsigned int kNumChunksToTry = 2u;
 
+      /// \brief Number of threads decoding chunks in the background.
+      public: const unsigned int kDecodeThreads = 2u;
+
+      /// \brief Number of chunks to decode ahead of the current chunk.
+      public: const unsigned int kPrefetchChunks = 2u;
+
+      /// \brief Max number of decoded chunks kept in memory.
+      public: const size_t kMaxCachedChunks = 8u;
+
       /// \brief XML tag delimiting the beginning of a frame.
       public: const std::string kStartFrame = "<sdf ";
 
@@ -68,8 +203,14 @@ namespace gazebo
       /// \brief Start of the log.
       public: tinyxml2::XMLElement *logStartXml = nullptr;
 
-      /// \brief Current position in the log file.
-      public: tinyxml2::XMLElement *logCurrXml = nullptr;
+      /// \brief Chunks of a text log, built on open so that chunks can be
+      /// accessed by index. tinyxml2 unescapes strings on first access, so
+      /// the decode threads only use these and never the XML document.
+      public: std::vector<LogPlayTextChunk> textChunks;
+
+      /// \brief First simulation time of the chunks of a text log that
+      /// have been searched so far.
+      public: std::map<unsigned int, common::Time> chunkStartTimes;
 
       /// \brief Name of the log file.
       public: std::string filename;
@@ -113,6 +254,57 @@ namespace gazebo
 
       /// \brief A mutex to avoid race conditions.
       public: std::mutex mutex;
+
+      /// \brief True if the open log file uses the binary "bin" encoding.
+      public: bool binary = false;
+
+      /// \brief Memory mapping of the open binary log file.
+      public: boost::iostreams::mapped_file_source binaryMap;
+
+      /// \brief Chunk index of the open binary log file.
+      public: std::vector<BinaryLogChunkInfo> chunkIndex;
+
+      /// \brief Index of the current chunk.
+      public: unsigned int chunkPos = 0;
+
+      /// \brief Offsets of the frames in the current chunk of a binary log.
+      public: std::vector<size_t> frameOffsets;
+
+      /// \brief Index of the last frame dispatched from the current chunk
+      /// of a binary log. -1 means before the first frame, and
+      /// frameOffsets.size() after the last one.
+      public: int64_t framePos = -1;
+
+      /// \brief Index of the last frame returned from the current chunk of
+      /// a binary log, -1 if none. Used to hand out delta frames alone when
+      /// the frame they depend on was just returned.
+      public: int64_t lastFrame = -1;
+
+      /// \brief Decoded chunks, by chunk index.
+      public: std::map<unsigned int, std::shared_ptr<const std::string>>
+              chunkCache;
+
+      /// \brief Chunks being decoded by the decode threads.
+      public: std::set<unsigned int> decoding;
+
+      /// \brief Chunks waiting to be decoded.
+      public: std::deque<unsigned int> prefetchQueue;
+
+      /// \brief Chunks the decode threads failed to decode, with the
+      /// error, until LoadChunk reports it.
+      public: std::map<unsigned int, std::string> failedChunks;
+
+      /// \brief Threads decoding chunks in the background.
+      public: std::vector<std::thread> decodeThreads;
+
+      /// \brief True to stop the decode threads.
+      public: bool stopDecode = false;
+
+      /// \brief Protects the chunk cache and the prefetch queue.
+      public: std::mutex cacheMutex;
+
+      /// \brief Signaled when a chunk is queued or decoded.
+      public: std::condition_variable cacheCondition;
     };
   }
 }
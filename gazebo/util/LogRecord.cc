@@ -138,7 +138,9 @@ bool LogRecord::Init(const std::string &_subdir)
 bool LogRecord::Start(const LogRecordParams &_params)
 {
   this->dataPtr->period = _params.period;
-  this->dataPtr->filter = _params.filter;
+  this->SetFilter(_params.filter);
+  this->dataPtr->keyframeInterval = _params.keyframeInterval;
+  this->dataPtr->keyframePeriod = _params.keyframePeriod;
   this->dataPtr->recordResources = _params.recordResources;
   return this->Start(_params.encoding, _params.path);
 }
@@ -186,9 +188,12 @@ bool LogRecord::Start(const std::string &_encoding, const std::string &_path)
   if (!boost::filesystem::exists(this->dataPtr->logCompletePath))
     boost::filesystem::create_directories(this->dataPtr->logCompletePath);
 
-  if (_encoding != "bz2" && _encoding != "txt" && _encoding != "zlib")
+  if (_encoding != "bz2" && _encoding != "txt" && _encoding != "zlib" &&
+      _encoding != "bin")
+  {
     gzthrow("Invalid log encoding[" + _encoding +
-            "]. Must be one of [bz2, zlib, txt]");
+            "]. Must be one of [bz2, zlib, txt, bin]");
+  }
 
   this->dataPtr->encoding = _encoding;
 
@@ -322,16 +327,47 @@ void LogRecord::SetPeriod(const double _period)
   this->dataPtr->period = _period;
 }
 
+//////////////////////////////////////////////////
+unsigned int LogRecord::KeyframeInterval() const
+{
+  return this->dataPtr->keyframeInterval;
+}
+
+//////////////////////////////////////////////////
+void LogRecord::SetKeyframeInterval(const unsigned int _interval)
+{
+  this->dataPtr->keyframeInterval = _interval;
+}
+
+//////////////////////////////////////////////////
+double LogRecord::KeyframePeriod() const
+{
+  return this->dataPtr->keyframePeriod;
+}
+
+//////////////////////////////////////////////////
+void LogRecord::SetKeyframePeriod(const double _period)
+{
+  this->dataPtr->keyframePeriod = _period;
+}
+
 //////////////////////////////////////////////////
 std::string LogRecord::Filter() const
 {
   return this->dataPtr->filter;
 }
 
+//////////////////////////////////////////////////
+uint32_t LogRecord::FilterVersion() const
+{
+  return this->dataPtr->filterVersion;
+}
+
 //////////////////////////////////////////////////
 void LogRecord::SetFilter(const std::string &_filter)
 {
   this->dataPtr->filter = _filter;
+  ++this->dataPtr->filterVersion;
 }
 
 //////////////////////////////////////////////////
@@ -792,7 +828,25 @@ unsigned int LogRecordPrivate::Log::Update()
   if (this->logCB(stream))
   {
     std::string data = stream.str();
-    if (!data.empty())
+    if (!data.empty() && this->binary)
+    {
+      // Binary logs store the frames as a single compressed chunk, and
+      // remember where the chunk is for the index.
+      BinaryLogChunkInfo info;
+      size_t start = this->buffer.size();
+      if (BinaryLog::WriteChunk(data, this->buffer, info))
+      {
+        info.offset = this->bytesAppended;
+        this->chunks.push_back(info);
+        this->bytesAppended += this->buffer.size() - start;
+      }
+      else
+      {
+        gzerr << "Invalid binary log data from " << this->relativeFilename
+              << "\n";
+      }
+    }
+    else if (!data.empty())
     {
       const std::string &encodingLocal = this->parent->Encoding();
 
@@ -877,8 +931,17 @@ void LogRecordPrivate::Log::Stop()
     this->Update();
     this->Write();
 
-    std::string xmlEnd = "</gazebo_log>";
-    this->logFile.write(xmlEnd.c_str(), xmlEnd.size());
+    if (this->binary)
+    {
+      std::string index;
+      BinaryLog::WriteIndex(this->chunks, this->bytesAppended, index);
+      this->logFile.write(index.c_str(), index.size());
+    }
+    else
+    {
+      std::string xmlEnd = "</gazebo_log>";
+      this->logFile.write(xmlEnd.c_str(), xmlEnd.size());
+    }
 
     this->logFile.close();
   }
@@ -897,6 +960,17 @@ void LogRecordPrivate::Log::Start(const boost::filesystem::path &_path)
     gzlog << "Filename [" + this->completePath.string() + "], already exists."
           << " The log file will be overwritten.\n";
 
+  this->binary = this->parent->Encoding() == "bin";
+  this->chunks.clear();
+
+  if (this->binary)
+  {
+    BinaryLog::WriteFileHeader(this->buffer, GZ_LOG_VERSION,
+        GAZEBO_VERSION_FULL, ignition::math::Rand::Seed());
+    this->bytesAppended = this->buffer.size();
+    return;
+  }
+
   std::ostringstream stream;
   stream << "<?xml version='1.0'?>\n"
          << "<gazebo_log>\n"
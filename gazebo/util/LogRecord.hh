@@ -38,7 +38,7 @@ namespace gazebo
     /// \sa LogRecord::Start
     class LogRecordParams
     {
-      /// \brief The type of encoding (txt, zlib, or bz2).
+      /// \brief The type of encoding (txt, zlib, bz2, or bin).
       public: std::string encoding = "zlib";
 
       /// \brief Path in which to store log files.
@@ -51,6 +51,15 @@ namespace gazebo
       /// \brief Log filter string
       public: std::string filter;
 
+      /// \brief Number of frames between keyframes of a "bin" log. Frames
+      /// between keyframes are stored as deltas. A value of 0 disables the
+      /// interval.
+      public: unsigned int keyframeInterval = 0;
+
+      /// \brief Sim time in seconds between keyframes of a "bin" log. A
+      /// value <= 0 disables the period.
+      public: double keyframePeriod = 0;
+
       /// \brief Recording resources. True will record state logs
       /// together with model meshes and materials.
       public: bool recordResources = false;
@@ -145,10 +154,31 @@ namespace gazebo
       /// \param[in] _period New log recording period in seconds.
       public: void SetPeriod(const double _period);
 
+      /// \brief Get the number of frames between keyframes of a "bin" log.
+      /// \return Keyframe interval, 0 if disabled.
+      public: unsigned int KeyframeInterval() const;
+
+      /// \brief Set the number of frames between keyframes of a "bin" log.
+      /// \param[in] _interval New keyframe interval, 0 to disable.
+      public: void SetKeyframeInterval(const unsigned int _interval);
+
+      /// \brief Get the sim time between keyframes of a "bin" log.
+      /// \return Keyframe period in seconds, <= 0 if disabled.
+      public: double KeyframePeriod() const;
+
+      /// \brief Set the sim time between keyframes of a "bin" log.
+      /// \param[in] _period New keyframe period in seconds, <= 0 to disable.
+      public: void SetKeyframePeriod(const double _period);
+
       /// \brief Get the log recording filter string.
       /// \return Log recording filter string.
       public: std::string Filter() const;
 
+      /// \brief Get the number of times the filter string was set, so that
+      /// users of the filter can tell when to parse it again.
+      /// \return Version of the filter string.
+      public: uint32_t FilterVersion() const;
+
       /// \brief Set the log recording filter string.
       /// \param[in] _filter New log record filter regex string
       public: void SetFilter(const std::string &_filter);
@@ -176,14 +206,15 @@ namespace gazebo
       public: bool Start(const LogRecordParams &_params);
 
       /// \brief Start the logger.
-      /// \param[in] _encoding The type of encoding (txt, zlib, or bz2).
+      /// \param[in] _encoding The type of encoding (txt, zlib, bz2, or bin).
       /// \param[in] _path Path in which to store log files.
       public: bool Start(const std::string &_encoding="zlib",
                          const std::string &_path="");
 
       /// \brief Get the encoding used.
-      /// \return Either [txt, zlib, or bz2], where txt is plain txt and bz2
-      /// and zlib are compressed data with Base64 encoding.
+      /// \return Either [txt, zlib, bz2, or bin], where txt is plain txt,
+      /// bz2 and zlib are compressed data with Base64 encoding, and bin is
+      /// the indexed binary format described in BinaryLog.
       public: const std::string &Encoding() const;
 
       /// \brief Get the filename for a log object.
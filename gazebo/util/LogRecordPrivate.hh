@@ -17,15 +17,19 @@
 #ifndef _GAZEBO_UTIL_LOGRECORD_PRIVATE_HH_
 #define _GAZEBO_UTIL_LOGRECORD_PRIVATE_HH_
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
 #include <thread>
+#include <vector>
 #include <functional>
 #include <condition_variable>
 #include <boost/filesystem.hpp>
 
+#include "gazebo/util/BinaryLog.hh"
+
 namespace gazebo
 {
   namespace util
@@ -101,6 +105,17 @@ namespace gazebo
 
         /// \brief Complete file path.
         public: boost::filesystem::path completePath;
+
+        /// \brief True if the log uses the binary "bin" encoding.
+        public: bool binary = false;
+
+        /// \brief Number of bytes appended to the buffer since Start. This
+        /// is the file offset of the next chunk in a binary log.
+        public: uint64_t bytesAppended = 0;
+
+        /// \brief Chunks written to a binary log, stored in the index when
+        /// the log is stopped.
+        public: std::vector<BinaryLogChunkInfo> chunks;
       };
 
       /// \def Log_M
@@ -206,9 +221,18 @@ namespace gazebo
       /// \brief Record period.
       public: double period = -1.0;
 
+      /// \brief Number of frames between keyframes of a "bin" log.
+      public: unsigned int keyframeInterval = 0;
+
+      /// \brief Sim time between keyframes of a "bin" log.
+      public: double keyframePeriod = 0;
+
       /// \brief Record filter string.
       public: std::string filter = "";
 
+      /// \brief Number of times the filter was set.
+      public: std::atomic<uint32_t> filterVersion{0};
+
       /// \brief Record with model resources.
       public: bool recordResources = false;
 
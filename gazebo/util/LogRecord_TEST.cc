@@ -203,8 +203,10 @@ TEST_F(LogRecord_TEST, Filter)
 
 
   // filter by regex string
+  uint32_t filterVersion = recorder->FilterVersion();
   recorder->SetFilter("robot*");
   EXPECT_EQ(recorder->Filter(), "robot*");
+  EXPECT_EQ(recorder->FilterVersion(), filterVersion + 1);
 
   recorder->SetFilter("");
   EXPECT_EQ(recorder->Filter(), "");
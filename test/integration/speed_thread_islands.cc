@@ -176,6 +176,18 @@ TEST_F(SpeedThreadIslandsTest, DualPR2WorldStep)
   ThreadSpeedup("ode", "world", "worlds/dual_pr2.world", 2, 50);
 }
 
+// One 40 link chain and 400 single body islands, the tiny islands must not
+// be scheduled one by one nor keep the chain from starting first.
+TEST_F(SpeedThreadIslandsTest, MixedIslandsQuickStep)
+{
+  ThreadSpeedup("ode", "quick", "test/worlds/island_scaling.world", 4, 100);
+}
+
+TEST_F(SpeedThreadIslandsTest, MixedIslandsWorldStep)
+{
+  ThreadSpeedup("ode", "world", "test/worlds/island_scaling.world", 4, 100);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -18,6 +18,8 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#include <atomic>
+
 #include "gazebo/test/ServerFixture.hh"
 
 using namespace gazebo;
@@ -788,6 +790,151 @@ TEST_F(TransportTest, TryInit)
   EXPECT_EQ(physics::get_world()->Name(), node->GetTopicNamespace());
 }
 
+/////////////////////////////////////////////////
+std::atomic<int> g_slowMsgs(0);
+std::atomic<int> g_fastMsgs(0);
+std::atomic<int> g_poolMsgs(0);
+
+void ReceiveSlow(ConstGzStringPtr &/*_msg*/)
+{
+  common::Time::MSleep(50);
+  g_slowMsgs++;
+}
+
+void ReceiveFast(ConstGzStringPtr &/*_msg*/)
+{
+  g_fastMsgs++;
+}
+
+void ReceivePool(ConstGzStringPtr &/*_msg*/)
+{
+  g_poolMsgs++;
+}
+
+/////////////////////////////////////////////////
+// A slow subscriber on its own thread, keeping the latest message only,
+// doesn't delay the other subscribers and doesn't build a backlog.
+TEST_F(TransportTest, DedicatedExecutorKeepLatest)
+{
+  Load("worlds/empty.world");
+
+  g_slowMsgs = 0;
+  g_fastMsgs = 0;
+
+  transport::NodePtr node = transport::NodePtr(new transport::Node());
+  node->Init();
+
+  transport::SubscribeOptions opts;
+  opts.SetExecutor(transport::SubscribeOptions::DEDICATED_THREAD);
+  opts.SetKeepLatest(true);
+  EXPECT_EQ(opts.GetQueueDepth(), 1u);
+
+  transport::SubscriberPtr slowSub =
+    node->Subscribe("~/test/slow", &ReceiveSlow, opts);
+  transport::SubscriberPtr fastSub =
+    node->Subscribe("~/test/fast", &ReceiveFast);
+
+  transport::PublisherPtr slowPub =
+    node->Advertise<msgs::GzString>("~/test/slow", 1000);
+  transport::PublisherPtr fastPub =
+    node->Advertise<msgs::GzString>("~/test/fast", 1000);
+  slowPub->WaitForConnection();
+  fastPub->WaitForConnection();
+
+  const int count = 100;
+  msgs::GzString msg;
+  msg.set_data("test");
+  for (int i = 0; i < count; ++i)
+  {
+    slowPub->Publish(msg);
+    fastPub->Publish(msg);
+  }
+
+  // The fast subscriber gets all the messages, well before the slow one
+  // could have processed them all.
+  for (int i = 0; i < 100 && g_fastMsgs < count; ++i)
+    common::Time::MSleep(10);
+  EXPECT_EQ(g_fastMsgs.load(), count);
+  EXPECT_LT(g_slowMsgs.load(), count);
+
+  // Wait for the slow subscriber to catch up with the latest message.
+  transport::CallbackQueueStats stats;
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_TRUE(slowSub->GetQueueStats(stats));
+    if (stats.received == static_cast<uint64_t>(count) && stats.depth == 0 &&
+        stats.processed + stats.dropped == stats.received)
+    {
+      break;
+    }
+    common::Time::MSleep(50);
+  }
+  EXPECT_EQ(stats.received, static_cast<uint64_t>(count));
+  EXPECT_EQ(stats.depth, 0u);
+  EXPECT_LE(stats.peakDepth, 1u);
+  EXPECT_GT(stats.dropped, 0u);
+  EXPECT_EQ(stats.processed + stats.dropped, stats.received);
+  EXPECT_EQ(stats.processed, static_cast<uint64_t>(g_slowMsgs.load()));
+
+  // Subscriptions without a queue have no counters.
+  EXPECT_FALSE(fastSub->GetQueueStats(stats));
+
+  slowSub.reset();
+  fastSub.reset();
+}
+
+/////////////////////////////////////////////////
+// Subscribers on the shared pool get every message when their queue is
+// unbounded.
+TEST_F(TransportTest, SharedPoolExecutor)
+{
+  Load("worlds/empty.world");
+
+  g_poolMsgs = 0;
+
+  transport::NodePtr node = transport::NodePtr(new transport::Node());
+  node->Init();
+
+  transport::SubscribeOptions opts;
+  opts.SetExecutor(transport::SubscribeOptions::SHARED_POOL);
+
+  transport::SubscriberPtr sub =
+    node->Subscribe("~/test/pool", &ReceivePool, opts);
+  transport::PublisherPtr pub =
+    node->Advertise<msgs::GzString>("~/test/pool", 1000);
+  pub->WaitForConnection();
+
+  const int count = 100;
+  msgs::GzString msg;
+  msg.set_data("test");
+  for (int i = 0; i < count; ++i)
+    pub->Publish(msg);
+
+  for (int i = 0; i < 100 && g_poolMsgs < count; ++i)
+    common::Time::MSleep(10);
+  EXPECT_EQ(g_poolMsgs.load(), count);
+
+  // The processed counter is updated after the callback returns.
+  transport::CallbackQueueStats stats;
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_TRUE(sub->GetQueueStats(stats));
+    if (stats.processed == static_cast<uint64_t>(count))
+      break;
+    common::Time::MSleep(10);
+  }
+  EXPECT_EQ(stats.received, static_cast<uint64_t>(count));
+  EXPECT_EQ(stats.processed, static_cast<uint64_t>(count));
+  EXPECT_EQ(stats.dropped, 0u);
+
+  // No callback runs after unsubscribing.
+  sub.reset();
+  for (int i = 0; i < count; ++i)
+    pub->Publish(msg);
+  common::Time::MSleep(100);
+  EXPECT_EQ(g_poolMsgs.load(), count);
+}
+
 /////////////////////////////////////////////////
 // Main
 int main(int argc, char **argv)
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/physics/ode/ODEPhysics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class ColoredPGSTest : public ServerFixture {};
+
+/// \brief Get the SDF of a chain of boxes linked by revolute joints, lying
+/// on the ground along the X axis, like a conveyor chain.
+/// \param[in] _links Number of links.
+/// \return The SDF.
+static std::string ChainSdf(const unsigned int _links)
+{
+  const double size = 0.1;
+  std::ostringstream sdf;
+  sdf << "<sdf version='" << SDF_VERSION << "'>"
+      << "<model name='chain'>";
+  for (unsigned int i = 0; i < _links; ++i)
+  {
+    sdf << "<link name='link_" << i << "'>"
+        << "  <pose>" << i * size << " 0 " << size / 2 << " 0 0 0</pose>"
+        << "  <inertial><mass>0.1</mass><inertia>"
+        << "    <ixx>1.7e-4</ixx><iyy>1.7e-4</iyy><izz>1.7e-4</izz>"
+        << "  </inertia></inertial>"
+        << "  <collision name='collision'><geometry><box>"
+        << "    <size>" << 0.9 * size << " " << size << " " << size
+        << "</size></box></geometry></collision>"
+        << "</link>";
+    if (i > 0)
+    {
+      sdf << "<joint name='joint_" << i << "' type='revolute'>"
+          << "  <pose>" << -size / 2 << " 0 0 0 0 0</pose>"
+          << "  <parent>link_" << i - 1 << "</parent>"
+          << "  <child>link_" << i << "</child>"
+          << "  <axis><xyz>0 1 0</xyz></axis>"
+          << "</joint>";
+    }
+  }
+  sdf << "</model></sdf>";
+  return sdf.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Time the graph colored PGS solver on a single island of 2000
+/// links, with an increasing number of quickstep threads.
+TEST_F(ColoredPGSTest, LargeIsland)
+{
+  Load("worlds/empty.world", true, "ode");
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<physics::ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+  odePhysics->SetWorldStepSolverType("ODE_COLORED_PGS");
+
+  const unsigned int links = 2000;
+  SpawnSDF(ChainSdf(links));
+  physics::ModelPtr chain = world->ModelByName("chain");
+  ASSERT_TRUE(chain != nullptr);
+  ASSERT_EQ(links, chain->GetLinks().size());
+
+  const int steps = 200;
+  double serialTime = 0;
+  for (int threads : {0, 1, 2, 4, 8})
+  {
+    odePhysics->SetParam("quickstep_threads", threads);
+    world->Reset();
+
+    int threadsUsed = 0;
+    common::Time startTime = common::Time::GetWallTime();
+    for (int i = 0; i < steps; ++i)
+    {
+      world->Step(1);
+      threadsUsed = std::max(threadsUsed,
+          boost::any_cast<int>(odePhysics->GetParam("colored_pgs_threads")));
+    }
+    const double elapsed =
+        (common::Time::GetWallTime() - startTime).Double();
+    if (threads == 0)
+      serialTime = elapsed;
+
+    gzmsg << "quickstep_threads[" << threads << "] threads used["
+          << threadsUsed << "] " << elapsed / steps * 1e3
+          << " ms per step, speedup[" << serialTime / elapsed << "]\n";
+
+    // The island is large enough for the pool threads to join.
+    if (threads > 1)
+    {
+      EXPECT_GT(threadsUsed, 1) << threads;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
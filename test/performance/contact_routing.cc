@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/ContactManager.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class ContactRoutingTest : public ServerFixture {};
+
+/////////////////////////////////////////////////
+// Route contacts of 200 boxes resting on the ground, each with its own
+// contact filter as a contact sensor would create. Routing a pair must not
+// depend on the number of filters nor walk the world.
+TEST_F(ContactRoutingTest, Filters)
+{
+  const unsigned int boxCount = 200;
+  const unsigned int rounds = 1000;
+
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ContactManager *manager = world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  physics::ModelPtr ground = world->ModelByName("ground_plane");
+  ASSERT_TRUE(ground != nullptr);
+  physics::Collision *groundCol =
+      ground->GetLink("link")->GetCollision("collision").get();
+  ASSERT_TRUE(groundCol != nullptr);
+
+  // Half of the filters are created before their box is inserted, so that
+  // both ways of resolving a filter are covered.
+  std::vector<physics::Collision *> boxCols;
+  for (unsigned int i = 0; i < boxCount; ++i)
+  {
+    std::string name = "box_" + std::to_string(i);
+    if (i % 2 == 0)
+      manager->CreateFilter(name, name + "::body::geom");
+
+    SpawnBox(name, ignition::math::Vector3d(0.5, 0.5, 0.5),
+        ignition::math::Vector3d((i % 20) * 2.0, (i / 20) * 2.0, 0.25));
+
+    if (i % 2 == 1)
+      manager->CreateFilter(name, name + "::body::geom");
+
+    physics::ModelPtr box = world->ModelByName(name);
+    ASSERT_TRUE(box != nullptr);
+    boxCols.push_back(box->GetLink("body")->GetCollision("geom").get());
+    ASSERT_TRUE(boxCols.back() != nullptr);
+  }
+  EXPECT_EQ(boxCount, manager->GetFilterCount());
+
+  // Spawning is asynchronous, wait until the last filter is resolved.
+  for (int i = 0; i < 500 &&
+      !manager->SubscribersConnected(boxCols.back(), groundCol); ++i)
+  {
+    common::Time::MSleep(10);
+  }
+
+  common::Time startTime = common::Time::GetWallTime();
+  unsigned int connected = 0;
+  for (unsigned int r = 0; r < rounds; ++r)
+  {
+    for (auto col : boxCols)
+    {
+      if (manager->SubscribersConnected(col, groundCol))
+        ++connected;
+    }
+  }
+  common::Time elapsed = common::Time::GetWallTime() - startTime;
+  EXPECT_EQ(boxCount * rounds, connected);
+
+  double perPair = elapsed.Double() * 1e9 / (boxCount * rounds);
+  gzmsg << "SubscribersConnected with " << boxCount << " filters: "
+        << perPair << " ns per pair\n";
+
+  // Every box touches the ground, so each step routes one contact per
+  // filter.
+  world->Step(10);
+  startTime = common::Time::GetWallTime();
+  world->Step(1000);
+  elapsed = common::Time::GetWallTime() - startTime;
+  EXPECT_GE(manager->GetContactCount(), boxCount);
+
+  gzmsg << "Step with " << boxCount << " filtered contacts: "
+        << elapsed.Double() << " ms per step\n";
+
+  // A lookup in the index is a hash and a compare, a scan of the filters
+  // or of the world takes orders of magnitude longer.
+  EXPECT_LT(perPair, 2000.0);
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/physics/ode/ODEPhysics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class ContactStackingTest : public ServerFixture {};
+
+/// \brief Size of the stacked boxes.
+static const double kBoxSize = 0.1;
+
+/// \brief Get the name of a box of a stack.
+/// \param[in] _height Height of the stack.
+/// \param[in] _index Index of the box, from the bottom.
+/// \return The name of the box model.
+static std::string BoxName(const unsigned int _height,
+    const unsigned int _index)
+{
+  return "stack_" + std::to_string(_height) + "_box_" +
+      std::to_string(_index);
+}
+
+/// \brief Check whether a stack stands still at the end of a run. The top
+/// box must not drift sideways, sink into the boxes below or move.
+/// \param[in] _world The world.
+/// \param[in] _height Height of the stack.
+/// \param[in] _x Position of the stack along the X axis.
+/// \return True if the stack is stable.
+static bool StackStable(const physics::WorldPtr &_world,
+    const unsigned int _height, const double _x)
+{
+  physics::ModelPtr top = _world->ModelByName(BoxName(_height, _height - 1));
+  if (!top)
+    return false;
+
+  const ignition::math::Vector3d pos = top->WorldPose().Pos();
+  const double restZ = kBoxSize * (_height - 0.5);
+  return std::abs(pos.X() - _x) < 0.01 && std::abs(pos.Y()) < 0.01 &&
+      restZ - pos.Z() < 0.2 * kBoxSize &&
+      top->WorldLinearVel().Length() < 0.01;
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the fewest quickstep iterations that keep stacks of boxes
+/// of increasing height standing, with and without contact persistence.
+TEST_F(ContactStackingTest, IterationsVersusHeight)
+{
+  Load("worlds/empty.world", true, "ode");
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<physics::ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+
+  // The stacks stand side by side, and are simulated together.
+  const std::vector<unsigned int> heights = {2, 4, 8, 12};
+  std::map<unsigned int, double> stackX;
+  for (unsigned int i = 0; i < heights.size(); ++i)
+  {
+    const unsigned int height = heights[i];
+    stackX[height] = i * 2.0;
+    for (unsigned int j = 0; j < height; ++j)
+    {
+      SpawnBox(BoxName(height, j),
+          ignition::math::Vector3d(kBoxSize, kBoxSize, kBoxSize),
+          ignition::math::Vector3d(stackX[height], 0, kBoxSize * (j + 0.5)));
+    }
+  }
+
+  const std::vector<int> iterations = {5, 10, 20, 30, 50, 75, 100, 150, 200};
+  const int steps = 2000;
+
+  // Fewest iterations keeping each stack standing, 0 if none did.
+  std::map<unsigned int, int> coldIters;
+  std::map<unsigned int, int> persistentIters;
+  for (bool persistence : {false, true})
+  {
+    odePhysics->SetContactPersistence(persistence);
+    std::map<unsigned int, int> &fewest =
+        persistence ? persistentIters : coldIters;
+    for (unsigned int height : heights)
+      fewest[height] = 0;
+
+    // Start from the most iterations, so that a stack that stands with
+    // fewer iterations by chance, but not with more, doesn't count.
+    for (auto iter = iterations.rbegin(); iter != iterations.rend(); ++iter)
+    {
+      world->Reset();
+      odePhysics->SetParam("iters", *iter);
+
+      common::Time startTime = common::Time::GetWallTime();
+      world->Step(steps);
+      common::Time elapsed = common::Time::GetWallTime() - startTime;
+
+      bool anyStable = false;
+      for (unsigned int height : heights)
+      {
+        bool stable = StackStable(world, height, stackX[height]);
+        if (stable && (fewest[height] == 0 || fewest[height] == *(iter - 1)))
+          fewest[height] = *iter;
+        anyStable = anyStable || stable;
+      }
+
+      gzmsg << "persistence[" << persistence << "] iters[" << *iter
+            << "] wall time[" << elapsed.Double() << " s]\n";
+
+      if (!anyStable)
+        break;
+    }
+  }
+
+  gzmsg << "height | iters without persistence | iters with persistence\n";
+  for (unsigned int height : heights)
+  {
+    gzmsg << height << " | " << coldIters[height] << " | "
+          << persistentIters[height] << "\n";
+  }
+
+  // A stack that stands without persistence stands with it, with no more
+  // iterations.
+  for (unsigned int height : heights)
+  {
+    if (coldIters[height] == 0)
+      continue;
+    EXPECT_GT(persistentIters[height], 0) << height;
+    EXPECT_LE(persistentIters[height], coldIters[height]) << height;
+  }
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include "gazebo/physics/CollisionMesh.hh"
+#include "gazebo/test/ServerFixture.hh"
+#include "gazebo/test/helper_physics_generator.hh"
+
+using namespace gazebo;
+
+class MeshCacheTest : public ServerFixture,
+                      public testing::WithParamInterface<const char*>
+{
+  /// \brief Load a world where 100 models use the same mesh at two scales
+  /// and report the load time and the memory the cache saved.
+  /// \param[in] _physicsEngine Physics engine to use.
+  /// \param[in] _enabled True to share collision meshes.
+  public: void LoadInstances(const std::string &_physicsEngine,
+              const bool _enabled);
+};
+
+/////////////////////////////////////////////////
+void MeshCacheTest::LoadInstances(const std::string &_physicsEngine,
+    const bool _enabled)
+{
+  if (_physicsEngine == "simbody")
+  {
+    gzerr << "Simbody doesn't support mesh collisions\n";
+    return;
+  }
+
+  physics::CollisionMeshCache *cache =
+      physics::CollisionMeshCache::Instance();
+  cache->SetEnabled(_enabled);
+  cache->ResetStats();
+
+  common::Time startTime = common::Time::GetWallTime();
+  Load("worlds/mesh_instances.world", true, _physicsEngine);
+  common::Time elapsed = common::Time::GetWallTime() - startTime;
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  gzmsg << _physicsEngine << " with the cache "
+        << (_enabled ? "enabled" : "disabled") << ": "
+        << elapsed.Double() << " s to load, "
+        << cache->Hits() << " hits, " << cache->Misses() << " misses, "
+        << cache->SavedBytes() / 1024 << " KiB saved\n";
+
+  if (_enabled)
+  {
+    // One entry per scale, the other collisions are hits.
+    EXPECT_EQ(2u, cache->Misses());
+    EXPECT_EQ(98u, cache->Hits());
+    EXPECT_GT(cache->SavedBytes(), 0u);
+  }
+  else
+  {
+    EXPECT_EQ(100u, cache->Misses());
+    EXPECT_EQ(0u, cache->Hits());
+    EXPECT_EQ(0u, cache->SavedBytes());
+  }
+
+  // Step a little so that the shared meshes are exercised.
+  world->Step(100);
+
+  cache->SetEnabled(true);
+}
+
+/////////////////////////////////////////////////
+TEST_P(MeshCacheTest, Uncached)
+{
+  this->LoadInstances(GetParam(), false);
+}
+
+/////////////////////////////////////////////////
+TEST_P(MeshCacheTest, Cached)
+{
+  this->LoadInstances(GetParam(), true);
+}
+
+INSTANTIATE_TEST_CASE_P(PhysicsEngines, MeshCacheTest,
+                        PHYSICS_ENGINE_VALUES,);  // NOLINT
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
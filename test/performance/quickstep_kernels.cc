@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "quickstep_kernels.h"
+
+using namespace ode::quickstep;
+
+/// \brief Synthetic set of constraint rows, with a third of them attached
+/// to a single body.
+class RowSet
+{
+  public: explicit RowSet(const int _m)
+    : m(_m), nb(_m / 3 + 2),
+      J(12 * _m), jb(2 * _m), invMass(nb), invMOI(12 * nb),
+      lambda(_m), vel(6 * nb)
+  {
+    std::mt19937 gen(_m);
+    std::uniform_real_distribution<double> value(-10, 10);
+    std::uniform_int_distribution<int> body(0, this->nb - 1);
+    for (auto &v : this->J) v = value(gen);
+    for (auto &v : this->invMass) v = value(gen);
+    for (auto &v : this->invMOI) v = value(gen);
+    for (auto &v : this->lambda) v = value(gen);
+    for (auto &v : this->vel) v = value(gen);
+    for (int i = 0; i < this->m; ++i)
+    {
+      this->jb[2 * i] = body(gen);
+      this->jb[2 * i + 1] = (i % 3 == 0) ? -1 : body(gen);
+    }
+  }
+
+  public: const int m;
+  public: const int nb;
+  public: std::vector<dReal> J;
+  public: std::vector<int> jb;
+  public: std::vector<dReal> invMass;
+  public: std::vector<dReal> invMOI;
+  public: std::vector<dReal> lambda;
+  public: std::vector<dReal> vel;
+};
+
+/// \brief Outputs of one run of every kernel over a row set.
+struct Results
+{
+  std::vector<dReal> iMJ;
+  std::vector<dReal> cforce;
+  std::vector<dReal> rhs;
+  dReal sum[6];
+};
+
+/////////////////////////////////////////////////
+// Run all kernels _iterations times, and return the time per iteration of
+// each kernel in microseconds.
+std::vector<double> RunKernels(const dxQuickStepKernels &_kernels,
+    const RowSet &_rows, const int _iterations, Results &_results)
+{
+  const int m = _rows.m;
+  const int nb = _rows.nb;
+  _results.iMJ.assign(12 * m, 0);
+  _results.cforce.assign(6 * nb, 0);
+  _results.rhs.assign(m, 0);
+
+  std::vector<double> times(4, 0);
+  for (int it = 0; it < _iterations; ++it)
+  {
+    auto start = std::chrono::steady_clock::now();
+    _kernels.compute_invM_JT(m, _rows.J.data(), _results.iMJ.data(),
+        _rows.jb.data(), _rows.invMass.data(), _rows.invMOI.data());
+    auto t1 = std::chrono::steady_clock::now();
+    _kernels.multiply_invM_JT(m, nb, _results.iMJ.data(), _rows.jb.data(),
+        _rows.lambda.data(), _results.cforce.data());
+    auto t2 = std::chrono::steady_clock::now();
+    _kernels.multiply_J(m, _rows.J.data(), _rows.jb.data(),
+        _rows.vel.data(), _results.rhs.data());
+    auto t3 = std::chrono::steady_clock::now();
+    _kernels.Multiply1_12q1(_results.sum, _rows.J.data(),
+        _rows.lambda.data(), m);
+    auto t4 = std::chrono::steady_clock::now();
+
+    times[0] += std::chrono::duration<double, std::micro>(t1 - start).count();
+    times[1] += std::chrono::duration<double, std::micro>(t2 - t1).count();
+    times[2] += std::chrono::duration<double, std::micro>(t3 - t2).count();
+    times[3] += std::chrono::duration<double, std::micro>(t4 - t3).count();
+  }
+  for (auto &t : times)
+    t /= _iterations;
+  return times;
+}
+
+/////////////////////////////////////////////////
+// Print the times returned by RunKernels.
+void PrintTimes(const int _m, const char *_name,
+    const std::vector<double> &_times)
+{
+  printf("rows[%d] %s compute_invM_JT[%g us] multiply_invM_JT[%g us] "
+      "multiply_J[%g us] Multiply1_12q1[%g us]\n", _m, _name, _times[0],
+      _times[1], _times[2], _times[3]);
+}
+
+/////////////////////////////////////////////////
+bool BitwiseEqual(const std::vector<dReal> &_a, const std::vector<dReal> &_b)
+{
+  return _a.size() == _b.size() &&
+    memcmp(_a.data(), _b.data(), _a.size() * sizeof(dReal)) == 0;
+}
+
+/////////////////////////////////////////////////
+// Time each kernel of each instruction set available on this processor,
+// and check that they all produce the bits of the scalar kernels.
+TEST(QuickStepKernels, CompareInstructionSets)
+{
+  const dxQuickStepKernels *scalarKernels = FindKernels("scalar");
+  ASSERT_TRUE(scalarKernels != NULL);
+
+  const char *names[] = {"sse2", "avx2"};
+  for (const int m : {1000, 10000, 100000})
+  {
+    const RowSet rows(m);
+    const int iterations = 2000000 / m;
+
+    Results scalar;
+    PrintTimes(m, "scalar",
+        RunKernels(*scalarKernels, rows, iterations, scalar));
+
+    for (const char *name : names)
+    {
+      const dxQuickStepKernels *kernels = FindKernels(name);
+      if (!kernels)
+      {
+        printf("rows[%d] %s not available\n", m, name);
+        continue;
+      }
+
+      Results results;
+      PrintTimes(m, name, RunKernels(*kernels, rows, iterations, results));
+
+      EXPECT_TRUE(BitwiseEqual(results.iMJ, scalar.iMJ)) << name;
+      EXPECT_TRUE(BitwiseEqual(results.cforce, scalar.cforce)) << name;
+      EXPECT_TRUE(BitwiseEqual(results.rhs, scalar.rhs)) << name;
+      EXPECT_EQ(memcmp(results.sum, scalar.sum, sizeof(scalar.sum)), 0)
+        << name;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+// Row counts smaller than the vector lanes.
+TEST(QuickStepKernels, SmallRowCounts)
+{
+  const dxQuickStepKernels *scalarKernels = FindKernels("scalar");
+  ASSERT_TRUE(scalarKernels != NULL);
+
+  const dxQuickStepKernels *kernels[] = {
+    FindKernels("sse2"), FindKernels("avx2")};
+  for (const int m : {1, 2, 3, 5, 7})
+  {
+    const RowSet rows(m);
+    Results scalar;
+    RunKernels(*scalarKernels, rows, 1, scalar);
+    for (const dxQuickStepKernels *k : kernels)
+    {
+      if (!k)
+        continue;
+      Results results;
+      RunKernels(*k, rows, 1, results);
+      EXPECT_TRUE(BitwiseEqual(results.iMJ, scalar.iMJ)) << k->name << m;
+      EXPECT_TRUE(BitwiseEqual(results.cforce, scalar.cforce)) << k->name << m;
+      EXPECT_TRUE(BitwiseEqual(results.rhs, scalar.rhs)) << k->name << m;
+      EXPECT_EQ(memcmp(results.sum, scalar.sum, sizeof(scalar.sum)), 0)
+        << k->name << m;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
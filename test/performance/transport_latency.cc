@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gazebo/transport/Connection.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class TransportLatencyTest : public gazebo::testing::AutoLogFixture
+{
+};
+
+/////////////////////////////////////////////////
+// Echo every message received on a connection back to the sender.
+class Echo
+{
+  public: void OnAccept(const transport::ConnectionPtr &_conn)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->conns.push_back(_conn);
+    transport::Connection *conn = _conn.get();
+    _conn->StartRead([conn](const std::string &_data)
+        {
+          conn->EnqueueMsg(_data, true);
+        });
+    this->cond.notify_all();
+  }
+
+  public: std::mutex mutex;
+  public: std::condition_variable cond;
+  public: std::vector<transport::ConnectionPtr> conns;
+};
+
+/////////////////////////////////////////////////
+// Measure round trip latency of small messages over loopback. Every message
+// is sent only after the echo of the previous one arrived, so the numbers
+// show how long a message waits in the read path, which used to include a
+// polling sleep of up to 10 ms.
+TEST_F(TransportLatencyTest, RoundTrip)
+{
+  const unsigned int warmup = 100;
+  const unsigned int count = 10000;
+
+  Echo echo;
+  transport::ConnectionPtr server(new transport::Connection());
+  server->Listen(0, std::bind(&Echo::OnAccept, &echo, std::placeholders::_1));
+  unsigned int port = server->GetLocalPort();
+  ASSERT_NE(0u, port);
+
+  transport::ConnectionPtr client(new transport::Connection());
+  ASSERT_TRUE(client->Connect("127.0.0.1", port));
+
+  {
+    std::unique_lock<std::mutex> lock(echo.mutex);
+    ASSERT_TRUE(echo.cond.wait_for(lock, std::chrono::seconds(10),
+          [&echo] { return !echo.conns.empty(); }));
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  unsigned int received = 0;
+  client->StartRead([&](const std::string &/*_data*/)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++received;
+        cond.notify_all();
+      });
+
+  // A small control message, such as a serialized pose command.
+  const std::string payload(64, 'x');
+  std::vector<double> rtt;
+  rtt.reserve(count);
+
+  for (unsigned int i = 0; i < warmup + count; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    client->EnqueueMsg(payload, true);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(5),
+          [&] { return received == i + 1; })) << "No echo for message " << i;
+
+    if (i >= warmup)
+    {
+      rtt.push_back(std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+  }
+
+  client->StopRead();
+
+  std::sort(rtt.begin(), rtt.end());
+  double p50 = rtt[rtt.size() / 2];
+  double p99 = rtt[rtt.size() * 99 / 100];
+
+  gzmsg << "Round trip of " << count << " messages: p50 = " << p50
+        << " us, p99 = " << p99 << " us, max = " << rtt.back() << " us\n";
+
+  // Without any polling in the read path even the tail of the round trip,
+  // which crosses the read path twice, stays well below one polling period.
+  EXPECT_LT(p99, 10000.0);
+
+  client->Shutdown();
+  server->Shutdown();
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Keep the IOManager alive until the end, so that it is never released
+  // from its own thread by the last connection of the test.
+  transport::ConnectionPtr ioKeeper(new transport::Connection());
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
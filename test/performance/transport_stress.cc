@@ -115,6 +115,94 @@ TEST_F(TransportStressTest, LocalPublish)
   delete [] fakeData;
 }
 
+/////////////////////////////////////////////////
+const msgs::Image *g_sharedPublishMsg = nullptr;
+unsigned int g_sharedPublishSameCount = 0;
+
+void SharedPublishCB(ConstImagePtr &_msg)
+{
+  boost::mutex::scoped_lock lock(g_mutex);
+
+  if (_msg.get() == g_sharedPublishMsg)
+    g_sharedPublishSameCount++;
+
+  if (g_localPublishCount+1 >= g_totalExpectedMsgCount)
+    g_localPublishEndTime = common::Time::GetWallTime();
+  g_localPublishCount++;
+}
+
+/////////////////////////////////////////////////
+// Publish a large image to a local subscriber, first by value and then as
+// a shared pointer. The shared path must hand the subscriber the published
+// object itself, without any copy or serialization.
+TEST_F(TransportStressTest, LocalSharedPublish)
+{
+  Load("worlds/empty.world");
+
+  const unsigned int msgCount = 10000;
+
+  transport::NodePtr testNode = transport::NodePtr(new transport::Node());
+  testNode->Init("default");
+
+  transport::PublisherPtr pub = testNode->Advertise<msgs::Image>(
+      "~/test/local_shared_publish__", msgCount);
+
+  transport::SubscriberPtr sub = testNode->Subscribe(
+      "~/test/local_shared_publish__", &SharedPublishCB);
+
+  unsigned int width = 2048;
+  unsigned int height = 2048;
+  std::string fakeData(width * height, 0);
+
+  boost::shared_ptr<msgs::Image> fakeMsg(new msgs::Image);
+  fakeMsg->set_width(width);
+  fakeMsg->set_height(height);
+  fakeMsg->set_pixel_format(0);
+  fakeMsg->set_step(1);
+  fakeMsg->set_data(fakeData);
+  boost::shared_ptr<const msgs::Image> sharedMsg = fakeMsg;
+
+  common::Time diff[2];
+  for (int shared = 0; shared < 2; ++shared)
+  {
+    {
+      boost::mutex::scoped_lock lock(g_mutex);
+      g_sharedPublishMsg = sharedMsg.get();
+      g_sharedPublishSameCount = 0;
+      g_localPublishCount = 0;
+      g_totalExpectedMsgCount = msgCount;
+    }
+
+    common::Time startTime = common::Time::GetWallTime();
+    for (unsigned int i = 0; i < msgCount; ++i)
+    {
+      if (shared)
+        pub->Publish(sharedMsg);
+      else
+        pub->Publish(*sharedMsg);
+    }
+
+    int waitCount = 0;
+    while (g_localPublishCount < g_totalExpectedMsgCount && waitCount < 50)
+    {
+      common::Time::MSleep(100);
+      waitCount++;
+    }
+    EXPECT_LT(waitCount, 50);
+    EXPECT_EQ(g_totalExpectedMsgCount, g_localPublishCount);
+    EXPECT_EQ(shared ? msgCount : 0u, g_sharedPublishSameCount);
+
+    diff[shared] = g_localPublishEndTime - startTime;
+  }
+
+  // Only report the timings, they depend too much on the load of the host
+  // to compare them.
+  gzmsg << "Time to publish " << msgCount << " copied messages = "
+    << diff[0] << "\n";
+  gzmsg << "Time to publish " << msgCount << " shared messages = "
+    << diff[1] << "\n";
+}
+
 /////////////////////////////////////////////////
 // Create a lot of nodes, each with a publisher and subscriber. Then send
 // out a few large messages.
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gazebo/gazebo.hh>
+#include <gazebo/msgs/msgs.hh>
+#include <gazebo/transport/Publication.hh>
+#include <gazebo/transport/ShmRing.hh>
+#include <gazebo/transport/TopicManager.hh>
+#include <gazebo/transport/transport.hh>
+
+using namespace gazebo;
+
+/// \brief Runs a server in the parent process, and a client with only
+/// transport in a child process, as gzserver and gzclient on one host.
+class TransportThroughputTest : public ::testing::Test
+{
+  protected: virtual void SetUp()
+  {
+    this->pid = fork();
+    if (this->pid > 0)
+    {
+      gazebo::setupServer(1, const_cast<char **>(&this->programName));
+    }
+    else if (this->pid == 0)
+    {
+      if (gazebo::transport::init())
+        gazebo::transport::run();
+      else
+        gzerr << "Unable to initialize transport.\n";
+    }
+  }
+
+  protected: virtual void TearDown()
+  {
+    if (this->pid > 0)
+      kill(this->pid, SIGKILL);
+    gazebo::shutdown();
+  }
+
+  /// \brief Fake argv for gazebo::setupServer().
+  protected: const char *programName = "TransportThroughputTest";
+
+  /// \brief PID of the child process.
+  protected: pid_t pid = -1;
+};
+
+/// \brief Number of images received by the child.
+unsigned int g_received = 0;
+
+/// \brief Publisher of g_received in the child.
+transport::PublisherPtr g_ackPub;
+
+/////////////////////////////////////////////////
+// Child: acknowledge each image.
+void OnImage(ConstImagePtr &/*_msg*/)
+{
+  msgs::Int ack;
+  ack.set_data(++g_received);
+  g_ackPub->Publish(ack);
+}
+
+/// \brief Number of images acknowledged by the child.
+unsigned int g_acked = 0;
+std::mutex g_ackMutex;
+std::condition_variable g_ackCond;
+
+/////////////////////////////////////////////////
+// Parent: count the acknowledged images.
+void OnAck(ConstIntPtr &_msg)
+{
+  std::lock_guard<std::mutex> lock(g_ackMutex);
+  g_acked = _msg->data();
+  g_ackCond.notify_all();
+}
+
+/////////////////////////////////////////////////
+// Publish _count images, with at most _window of them not acknowledged,
+// and return the throughput in MB/s, or 0 if an image was lost.
+double Stream(transport::PublisherPtr _pub, const msgs::Image &_msg,
+    const unsigned int _count, const unsigned int _window)
+{
+  unsigned int base;
+  {
+    std::lock_guard<std::mutex> lock(g_ackMutex);
+    base = g_acked;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    {
+      std::unique_lock<std::mutex> lock(g_ackMutex);
+      if (!g_ackCond.wait_for(lock, std::chrono::seconds(10),
+            [&] { return g_acked + _window > base + i; }))
+      {
+        return 0;
+      }
+    }
+    _pub->Publish(_msg, true);
+  }
+
+  std::unique_lock<std::mutex> lock(g_ackMutex);
+  if (!g_ackCond.wait_for(lock, std::chrono::seconds(10),
+        [&] { return g_acked == base + _count; }))
+  {
+    return 0;
+  }
+
+  double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  return _count * static_cast<double>(_msg.data().size()) / seconds / 1e6;
+}
+
+/////////////////////////////////////////////////
+// Stream uncompressed 1080p images from the server to a client on the same
+// host, over TCP and over shared memory. The TCP topic is advertised with
+// shared memory disabled, so the client can't ask for it.
+TEST_F(TransportThroughputTest, LargeImages)
+{
+  ASSERT_GE(this->pid, 0);
+
+  if (this->pid == 0)
+  {
+    transport::NodePtr node(new transport::Node());
+    node->Init();
+    g_ackPub = node->Advertise<msgs::Int>("/gazebo/test/throughput_ack");
+
+    // No acknowledgement may be lost.
+    g_ackPub->WaitForConnection();
+
+    transport::SubscriberPtr tcpSub =
+      node->Subscribe("/gazebo/test/throughput_tcp", &OnImage);
+    transport::SubscriberPtr shmSub =
+      node->Subscribe("/gazebo/test/throughput_shm", &OnImage);
+
+    // Sleep until the parent kills this process.
+    while (true)
+      common::Time::MSleep(500);
+  }
+
+  transport::NodePtr node(new transport::Node());
+  node->Init();
+
+  transport::SubscriberPtr ackSub =
+    node->Subscribe("/gazebo/test/throughput_ack", &OnAck);
+
+  const char *shmEnv = getenv("GAZEBO_SHM_TRANSPORT");
+  const std::string shmEnvValue = shmEnv ? shmEnv : "";
+  setenv("GAZEBO_SHM_TRANSPORT", "0", 1);
+  transport::PublisherPtr tcpPub =
+    node->Advertise<msgs::Image>("/gazebo/test/throughput_tcp");
+  if (shmEnv)
+    setenv("GAZEBO_SHM_TRANSPORT", shmEnvValue.c_str(), 1);
+  else
+    unsetenv("GAZEBO_SHM_TRANSPORT");
+  transport::PublisherPtr shmPub =
+    node->Advertise<msgs::Image>("/gazebo/test/throughput_shm");
+
+  ASSERT_TRUE(tcpPub->WaitForConnection(common::Time(30, 0)));
+  ASSERT_TRUE(shmPub->WaitForConnection(common::Time(30, 0)));
+
+  const unsigned int width = 1920;
+  const unsigned int height = 1080;
+  std::vector<char> pixels(width * height * 3, 1);
+  msgs::Image image;
+  image.set_width(width);
+  image.set_height(height);
+  image.set_pixel_format(0);
+  image.set_step(width * 3);
+  image.set_data(pixels.data(), pixels.size());
+
+  const unsigned int count = 300;
+  const unsigned int window = 2;
+
+  double tcp = Stream(tcpPub, image, count, window);
+  EXPECT_GT(tcp, 0.0) << "Images lost over TCP";
+
+  double shm = Stream(shmPub, image, count, window);
+  EXPECT_GT(shm, 0.0) << "Images lost over shared memory";
+
+  // The client asked for the shared memory ring only where it was enabled,
+  // so the shared memory numbers aren't TCP numbers in disguise.
+  transport::PublicationPtr tcpPublication =
+    transport::TopicManager::Instance()->FindPublication(
+        "/gazebo/test/throughput_tcp");
+  transport::PublicationPtr shmPublication =
+    transport::TopicManager::Instance()->FindPublication(
+        "/gazebo/test/throughput_shm");
+  ASSERT_TRUE(tcpPublication != nullptr);
+  ASSERT_TRUE(shmPublication != nullptr);
+  EXPECT_EQ(0u, tcpPublication->GetSharedMemorySubscriptionCount());
+  EXPECT_EQ(transport::ShmRing::Enabled() ? 1u : 0u,
+      shmPublication->GetSharedMemorySubscriptionCount());
+
+  gzmsg << count << " images of " << pixels.size() << " bytes: TCP "
+        << tcp << " MB/s, shared memory " << shm << " MB/s\n";
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "gazebo/physics/StateSnapshot.hh"
+#include "gazebo/physics/WorldState.hh"
+#include "gazebo/physics/WorldStateFilter.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+/// \brief Number of heap allocations made by this process.
+static std::atomic<uint64_t> g_allocations(0);
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  ++g_allocations;
+  void *ptr = std::malloc(_size == 0 ? 1 : _size);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+class WorldStateCaptureTest : public gazebo::testing::AutoLogFixture {};
+
+/////////////////////////////////////////////////
+// Build WorldStates from snapshots of a world with 1000 models of 10 links
+// each, as the log worker does for every recorded step. Once the states
+// exist, later captures update them in place without allocating.
+TEST_F(WorldStateCaptureTest, TenThousandLinks)
+{
+  const unsigned int modelCount = 1000;
+  const unsigned int linksPerModel = 10;
+  const unsigned int captures = 100;
+
+  auto layout = std::make_shared<physics::StateSnapshotLayout>();
+  layout->worldName = "default";
+  for (unsigned int m = 0; m < modelCount; ++m)
+  {
+    layout->modelNames.push_back("model_" + std::to_string(m));
+    layout->modelLinkStart.push_back(layout->linkNames.size());
+    layout->nestedModels.emplace_back();
+    layout->topModels.push_back(m);
+    for (unsigned int l = 0; l < linksPerModel; ++l)
+      layout->linkNames.push_back("link_" + std::to_string(l));
+  }
+  layout->modelLinkStart.push_back(layout->linkNames.size());
+  layout->lightNames.push_back("sun");
+  layout->SortByName();
+
+  const unsigned int linkCount = layout->linkNames.size();
+  physics::StateSnapshot snapshot;
+  snapshot.layout = layout;
+  snapshot.modelPoses.resize(modelCount);
+  snapshot.modelScales.assign(modelCount, ignition::math::Vector3d::One);
+  snapshot.linkPoses.resize(linkCount);
+  snapshot.linkLinearVels.resize(linkCount);
+  snapshot.linkAngularVels.resize(linkCount);
+  snapshot.linkLinearAccels.resize(linkCount);
+  snapshot.linkAngularAccels.resize(linkCount);
+  snapshot.linkForces.resize(linkCount);
+  snapshot.lightPoses.resize(1);
+
+  for (auto const &filterStr : {"", "model_1*"})
+  {
+    physics::WorldStateFilter filter(filterStr);
+    physics::WorldState state;
+
+    // The first capture creates the states
+    common::Time startTime = common::Time::GetWallTime();
+    state.Load(physics::WorldPtr(), snapshot, filter);
+    common::Time firstTime = common::Time::GetWallTime() - startTime;
+    unsigned int modelStates = state.GetModelStateCount();
+
+    // Later captures update them
+    uint64_t allocations = g_allocations;
+    startTime = common::Time::GetWallTime();
+    for (unsigned int i = 0; i < captures; ++i)
+    {
+      snapshot.iterations = i;
+      snapshot.linkPoses[i].Pos().X(i);
+      state.Load(physics::WorldPtr(), snapshot, filter);
+    }
+    common::Time elapsed = common::Time::GetWallTime() - startTime;
+    allocations = g_allocations - allocations;
+
+    EXPECT_EQ(0u, allocations) << "filter [" << filterStr << "]";
+    EXPECT_EQ(modelStates, state.GetModelStateCount());
+    EXPECT_EQ(captures - 1, state.GetIterations());
+
+    // Compare with the string based filter, parsed on every call
+    physics::WorldState stringState;
+    startTime = common::Time::GetWallTime();
+    for (unsigned int i = 0; i < captures; ++i)
+      stringState.LoadWithFilter(physics::WorldPtr(), snapshot, filterStr);
+    common::Time stringElapsed = common::Time::GetWallTime() - startTime;
+    EXPECT_EQ(modelStates, stringState.GetModelStateCount());
+
+    gzmsg << "Capture of " << linkCount << " links, filter [" << filterStr
+          << "], " << modelStates << " models: first "
+          << firstTime.Double() * 1e3 << " ms, then "
+          << elapsed.Double() * 1e3 / captures << " ms with "
+          << allocations << " allocations, "
+          << stringElapsed.Double() * 1e3 / captures
+          << " ms with a string filter\n";
+  }
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -30,6 +30,28 @@
 
 sdf::ElementPtr g_stateSdf;
 
+/////////////////////////////////////////////////
+/// \brief Load a world state from a frame returned by LogPlay::Step or
+/// LogPlay::Chunk. Binary frames are decoded directly, other frames are
+/// parsed as SDF. Binary delta frames are applied on top of _state, and a
+/// binary chunk with several frames leaves the last state in _state.
+/// \param[in] _data Frame data.
+/// \param[in,out] _state World state to load.
+static void LoadState(const std::string &_data,
+    gazebo::physics::WorldState &_state)
+{
+  if (gazebo::util::BinaryLog::IsFrame(_data))
+  {
+    gazebo::util::BinaryLogReader reader(_data.data(), _data.size());
+    _state.ReadBinaryFrames(reader);
+    return;
+  }
+
+  g_stateSdf->Clear();
+  sdf::readString(_data, g_stateSdf);
+  _state.Load(g_stateSdf);
+}
+
 using namespace gazebo;
 
 /////////////////////////////////////////////////
@@ -538,12 +560,10 @@ void StateFilter::Init(const std::string &_filter)
 /////////////////////////////////////////////////
 std::string StateFilter::Filter(const std::string &_stateString)
 {
-  gazebo::physics::WorldState state;
-
-  // Read and parse the state information
-  g_stateSdf->Clear();
-  sdf::readString(_stateString, g_stateSdf);
-  state.Load(g_stateSdf);
+  // Read and parse the state information. The state is kept between calls,
+  // since binary delta frames are applied to the previous state.
+  gazebo::physics::WorldState &state = this->state;
+  LoadState(_stateString, state);
 
   std::ostringstream result;
 
@@ -616,7 +636,8 @@ LogCommand::LogCommand()
     ("output,o", po::value<std::string>(),
      "Output file, valid in conjunction with the filter, raw, hz, and "
      "encoding commands. By default, the output file will have the same "
-     "encoding as the source file. Override with the --encoding option")
+     "encoding as the source file, except for bin logs which are "
+     "written with zlib. Override with the --encoding option")
     ("encoding,n", po::value<std::string>(),
      "Specify the encoding (txt, zlib, or bz2) for an output file. "
      "Valid in conjunction with the output command. See also the "
@@ -773,10 +794,7 @@ void LogCommand::Info(const std::string &_filename)
       std::string stateString;
       play->Chunk(play->ChunkCount()-1, stateString);
 
-      g_stateSdf->Clear();
-      sdf::readString(stateString, g_stateSdf);
-
-      state.Load(g_stateSdf);
+      LoadState(stateString, state);
       endTime = state.GetWallTime();
     }
     else
@@ -841,6 +859,12 @@ void LogCommand::Output(const std::string &_outFilename,
   std::string stateString, bufferString;
 
   std::string encoding = _encoding.empty() ? play->Encoding() : _encoding;
+
+  // Filtered states are written as XML, so binary logs are converted to the
+  // default zlib encoding.
+  if (_encoding.empty() && encoding == "bin")
+    encoding = "zlib";
+
   if (encoding != "txt" && encoding != "zlib" && encoding != "bz2")
   {
     std::cerr << "Invalid log file encoding[" << encoding << "]. "
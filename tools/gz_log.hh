@@ -185,6 +185,9 @@ namespace gazebo
 
     /// \brief Previous time a state was output.
     private: gazebo::common::Time prevTime;
+
+    /// \brief Last state read.
+    private: gazebo::physics::WorldState state;
   };
 
   /// \brief Log command